@@ -0,0 +1,117 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include <log/log_message.hpp>
+#include <signal/ring_signal.hpp>
+#include <testing/benchmark.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// The logger's own console writes are not measured: they cost whatever the terminal or pipe does.
+// These time what the logger does around them — capturing a message on the caller's thread,
+// carrying it through the same lock-free ring, and formatting it on the worker.
+
+namespace
+{
+
+    //! Producer threads of the contended case.
+    constexpr uint64_t PRODUCER_COUNT = 4;
+
+    //! The logger's ring size (Logger::QUEUE_CAPACITY).
+    constexpr std::size_t QUEUE_CAPACITY = 256;
+
+    using MessageQueue = SignalsLib::MpscSignal<LoggingLib::LogMessage, QUEUE_CAPACITY, SignalsLib::OverflowPolicy::Block>;
+
+    //! A deferred-format message like the renderer's: a static format and three arguments.
+    [[nodiscard]] LoggingLib::LogMessage makeFormatMessage(uint64_t frame)
+    {
+        LoggingLib::LogMessage message{};
+        message.severity = LoggingLib::Severity::Info;
+        message.format = "Frame {} took {} ms on {}.";
+        message.addArg(frame);
+        message.addArg(16.7f);
+        message.addArg("the graphics queue");
+        return message;
+    }
+
+} // namespace
+
+BENCHMARK_CASE(capture_plain_message)
+{
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        LoggingLib::LogMessage message{};
+        message.severity = LoggingLib::Severity::Info;
+        message.setText("Swapchain recreated at 1920 x 1080.");
+        TestingLib::doNotOptimise(message);
+    }
+}
+
+BENCHMARK_CASE(capture_format_message)
+{
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        LoggingLib::LogMessage message = makeFormatMessage(i);
+        TestingLib::doNotOptimise(message);
+    }
+}
+
+BENCHMARK_CASE(format_deferred_message)
+{
+    LoggingLib::LogMessage message = makeFormatMessage(1234);
+    std::array<char, LoggingLib::LogMessage::TEXT_CAPACITY> line{};
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        std::size_t size = message.formatText(line.data(), line.size());
+        TestingLib::doNotOptimise(size);
+        TestingLib::clobberMemory();
+    }
+}
+
+//! PRODUCER_COUNT threads log iterations() format messages in total through the logger's ring
+//! while this thread drains and formats them, as the worker does.
+BENCHMARK_CASE(queue_and_format_4_producers)
+{
+    std::unique_ptr<MessageQueue> queue = std::make_unique<MessageQueue>();
+    uint64_t per_producer = (state.iterations() + PRODUCER_COUNT - 1) / PRODUCER_COUNT;
+    std::vector<std::thread> threads;
+    for (uint64_t p = 0; p < PRODUCER_COUNT; ++p) {
+        threads.emplace_back([&queue, per_producer] {
+            for (uint64_t i = 0; i < per_producer; ++i) {
+                queue->emit(makeFormatMessage(i));
+            }
+        });
+    }
+
+    uint64_t consumed{0};
+    LoggingLib::LogMessage message{};
+    std::array<char, LoggingLib::LogMessage::TEXT_CAPACITY> line{};
+    while (consumed < (per_producer * PRODUCER_COUNT)) {
+        if (queue->consume(message)) {
+            std::size_t size = message.formatText(line.data(), line.size());
+            TestingLib::doNotOptimise(size);
+            ++consumed;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    return TestingLib::benchmarkMain(argc, argv);
+}
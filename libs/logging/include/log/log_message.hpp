@@ -0,0 +1,179 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace LoggingLib
+{
+
+    //! Message severity levels.
+    enum class Severity {
+        Debug, //!< Verbose diagnostic information.
+        Info, //!< Normal operational messages.
+        Warning, //!< Potential issues that do not prevent operation.
+        Error, //!< Failures that prevent a specific operation.
+        Fatal //!< Unrecoverable failures — the application will terminate.
+    };
+
+    //! One argument of a deferred-format message, captured by value when the message is logged.
+    struct LogArg {
+        //! Which member of the value union is meaningful.
+        enum class Type : uint8_t {
+            Signed, //!< signed_value.
+            Unsigned, //!< unsigned_value.
+            Float, //!< float_value (kept apart from Double so it prints in its own shortest form).
+            Double, //!< double_value.
+            Boolean, //!< boolean_value.
+            Text //!< text_length characters of LogMessage::text from text_offset.
+        };
+
+        Type type{Type::Signed}; //!< Discriminator.
+        uint16_t text_offset{0}; //!< Type::Text: first character in LogMessage::text.
+        uint16_t text_length{0}; //!< Type::Text: character count.
+        union {
+            int64_t signed_value{0};
+            uint64_t unsigned_value;
+            float float_value;
+            double double_value;
+            bool boolean_value;
+        };
+    };
+
+    /*!
+        A log message in a fixed-size slot, so logging never allocates: either the text itself, or
+        a static format string plus up to MAX_ARGS arguments captured by value, which the logger's
+        worker formats later (deferred formatting) — the caller pays for copying the arguments, not
+        for converting them. Text that does not fit TEXT_CAPACITY is cut and the message marked
+        truncated.
+
+        Format strings use "{}" for each argument in order and "{{" / "}}" for literal braces.
+    */
+    struct LogMessage {
+        //! Characters of message text (or of text arguments) a slot holds.
+        static constexpr std::size_t TEXT_CAPACITY = 1024;
+
+        //! Arguments a deferred-format message may carry.
+        static constexpr std::size_t MAX_ARGS = 8;
+
+        Severity severity{Severity::Info}; //!< Severity level.
+        const char* format{nullptr}; //!< Static format string, or nullptr when text is the message itself.
+        uint16_t length{0}; //!< Characters of text in use.
+        uint8_t arg_count{0}; //!< Arguments in use (format != nullptr).
+        bool truncated{false}; //!< Text or arguments did not fit and were cut.
+        uint64_t suppressed{0}; //!< Messages from the same call site a LogThrottle held back before this one.
+        std::array<LogArg, MAX_ARGS> args{}; //!< Captured arguments (format != nullptr).
+        std::array<char, TEXT_CAPACITY> text{}; //!< The message (format == nullptr) or the text arguments' characters.
+
+        //! Makes this a plain message holding (as much as fits of) message.
+        void setText(std::string_view message);
+
+        //! Appends an argument of a deferred-format message: any integer, enumeration, floating-point,
+        //! bool, char or string-like value (strings are copied into text).
+        template <typename T>
+        void addArg(const T& value)
+        {
+            if constexpr (std::is_enum_v<T>) {
+                addArg(static_cast<std::underlying_type_t<T>>(value));
+            } else {
+                if (arg_count == MAX_ARGS) {
+                    truncated = true;
+                    return;
+                }
+                LogArg& arg = args[arg_count++];
+                if constexpr (std::is_same_v<T, bool>) {
+                    arg.type = LogArg::Type::Boolean;
+                    arg.boolean_value = value;
+                } else if constexpr (std::is_same_v<T, char>) {
+                    addText(arg, std::string_view{&value, 1});
+                } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                    arg.type = LogArg::Type::Signed;
+                    arg.signed_value = value;
+                } else if constexpr (std::is_integral_v<T>) {
+                    arg.type = LogArg::Type::Unsigned;
+                    arg.unsigned_value = value;
+                } else if constexpr (std::is_same_v<T, float>) {
+                    arg.type = LogArg::Type::Float;
+                    arg.float_value = value;
+                } else if constexpr (std::is_floating_point_v<T>) {
+                    arg.type = LogArg::Type::Double;
+                    arg.double_value = static_cast<double>(value);
+                } else {
+                    static_assert(std::is_convertible_v<const T&, std::string_view>, "Log arguments are numbers, enumerations, bools, chars or strings.");
+                    addText(arg, std::string_view{value});
+                }
+            }
+        }
+
+        //! Writes the message text — formatted, for a deferred-format message — into out, at most
+        //! capacity characters, and returns how many were written.
+        [[nodiscard]] std::size_t formatText(char* out, std::size_t capacity) const;
+
+    private:
+        //! Makes arg a text argument holding (as much as fits of) value.
+        void addText(LogArg& arg, std::string_view value);
+    };
+
+    //! Never defined and not constexpr: LogFormat calls it to make a mismatched format fail to compile.
+    void logFormatArgumentCountMismatch();
+
+    /*!
+        A deferred-format string checked against its arguments at compile time, like
+        std::format_string: only a constant (in practice a string literal, which outlives the
+        message) converts to it, and its "{}" count must match the argument count.
+    */
+    template <typename... Args>
+    class LogFormat {
+    public:
+        //! Implicit, so a string literal can be passed where a LogFormat is expected.
+        consteval LogFormat(const char* format) :
+            m_format{format}
+        {
+            static_assert(sizeof...(Args) <= LogMessage::MAX_ARGS, "Too many log arguments.");
+            if (placeholderCount(format) != sizeof...(Args)) {
+                logFormatArgumentCountMismatch();
+            }
+        }
+
+        //! The format string.
+        [[nodiscard]] const char* get() const
+        {
+            return m_format;
+        }
+
+    private:
+        //! Counts "{}" in format, skipping the "{{" and "}}" escapes.
+        [[nodiscard]] static consteval std::size_t placeholderCount(const char* format)
+        {
+            std::size_t count{0};
+            for (const char* c = format; *c != '\0'; ++c) {
+                if (((c[0] == '{') && (c[1] == '{')) || ((c[0] == '}') && (c[1] == '}'))) {
+                    ++c;
+                } else if ((c[0] == '{') && (c[1] == '}')) {
+                    ++count;
+                    ++c;
+                }
+            }
+            return count;
+        }
+
+        const char* m_format; //!< The format string.
+    };
+
+} // namespace LoggingLib
@@ -0,0 +1,74 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+namespace LoggingLib
+{
+
+    /*!
+        Rate limit for one log call site (Logger::logThrottled(), LOG_THROTTLED): at most one
+        message per interval gets through, and the ones held back in between are counted and
+        reported with the next one that does — "(suppressed 3600 identical messages)" — so a
+        failure repeating every frame costs the console and the worker one line per interval.
+
+        Holding a message back is two relaxed atomic operations; no message is built. Thread-safe.
+    */
+    class LogThrottle {
+    public:
+        //! Default interval between messages from one call site.
+        static constexpr std::chrono::steady_clock::duration DEFAULT_INTERVAL = std::chrono::seconds{1};
+
+        explicit LogThrottle(std::chrono::steady_clock::duration interval = DEFAULT_INTERVAL) :
+            m_interval_ns{std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count()}
+        {
+        }
+
+        LogThrottle(const LogThrottle&) = delete;
+        LogThrottle& operator=(const LogThrottle&) = delete;
+        LogThrottle(LogThrottle&&) = delete;
+        LogThrottle& operator=(LogThrottle&&) = delete;
+
+        //! Returns true if a message may go out at now, with out_suppressed set to how many were
+        //! held back since the last one; otherwise counts this one as held back.
+        [[nodiscard]] bool admit(std::chrono::steady_clock::time_point now, uint64_t& out_suppressed)
+        {
+            int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+            int64_t next_ns = m_next_ns.load(std::memory_order_relaxed);
+            if ((now_ns < next_ns) || !m_next_ns.compare_exchange_strong(next_ns, now_ns + m_interval_ns, std::memory_order_relaxed)) {
+                m_suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            out_suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+
+        //! admit() at the current time.
+        [[nodiscard]] bool admit(uint64_t& out_suppressed)
+        {
+            return admit(std::chrono::steady_clock::now(), out_suppressed);
+        }
+
+    private:
+        int64_t m_interval_ns; //!< Minimum time between admitted messages.
+        std::atomic<int64_t> m_next_ns{std::numeric_limits<int64_t>::min()}; //!< Earliest steady-clock time (ns) the next message may go out.
+        std::atomic<uint64_t> m_suppressed{0}; //!< Messages held back since the last admitted one.
+    };
+
+} // namespace LoggingLib
@@ -14,38 +14,59 @@
 
 #pragma once
 
-#include <signal/signal.hpp>
+#include "log/log_message.hpp"
+#include "log/log_throttle.hpp"
+#include <signal/ring_signal.hpp>
+#include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
-#include <string>
 #include <string_view>
 #include <thread>
+#include <type_traits>
+
+//! Lowest severity compiled in (Severity as an integer). Set by the build (LOGGING_MIN_SEVERITY):
+//! Debug in Debug builds, Info otherwise.
+#ifndef LOGGINGLIB_MIN_SEVERITY
+#define LOGGINGLIB_MIN_SEVERITY 0
+#endif
 
 namespace LoggingLib
 {
 
-    //! Message severity levels.
-    enum class Severity {
-        Debug, //!< Verbose diagnostic information.
-        Info, //!< Normal operational messages.
-        Warning, //!< Potential issues that do not prevent operation.
-        Error, //!< Failures that prevent a specific operation.
-        Fatal //!< Unrecoverable failures — the application will terminate.
-    };
+    //! Messages below this severity are discarded where they are logged; through the LOG_* macros
+    //! they compile to nothing, arguments included. Fatal messages are always logged.
+    static constexpr Severity MIN_SEVERITY = static_cast<Severity>(LOGGINGLIB_MIN_SEVERITY);
+    static_assert((MIN_SEVERITY >= Severity::Debug) && (MIN_SEVERITY <= Severity::Fatal), "LOGGINGLIB_MIN_SEVERITY must name a Severity.");
+
+    //! True if messages of severity are compiled in.
+    [[nodiscard]] constexpr bool severityEnabled(Severity severity)
+    {
+        return (severity >= MIN_SEVERITY) || (severity == Severity::Fatal);
+    }
 
-    //! A single log message with severity and text.
-    struct LogMessage {
-        Severity severity{Severity::Info}; //!< Severity level.
-        std::string text; //!< Message content.
+    //! What logging does when QUEUE_CAPACITY messages are already waiting for the worker.
+    enum class LogOverflow {
+        Block, //!< Wait for the worker to make room (never loses a message).
+        Drop //!< Discard the message and count it; the worker reports the count (never waits).
     };
 
     /*!
         Thread-safe logger that writes messages on a background thread.
 
-        Uses SignalsLib::Signal<LogMessage> as the internal queue. Any thread
-        can call logDebug(), logInfo(), etc. The background worker drains
-        the queue and writes to stdout (Debug, Info) or stderr (Warning,
-        Error, Fatal).
+        Any thread can call logDebug(), logInfo(), etc. Nothing on that path allocates: a message
+        is copied into a fixed-size LogMessage slot of a lock-free SignalsLib::MpscSignal that is
+        allocated once, at construction. The format overloads — logInfo("{} strings", count) —
+        copy their arguments and leave converting them to the worker. When the ring is full the
+        caller waits for the worker or drops the message, as the LogOverflow chosen at
+        construction says; dropped messages are counted (dropped()) and the worker reports how
+        many it missed on stderr.
+
+        The worker drains the ring in batches: each drain's lines are formatted into a buffer per
+        stream and written with one write() (WriteFile() on Windows) per stream, stdout for Debug
+        and Info and stderr for Warning, Error and Fatal, bypassing the iostreams.
 
         RAII lifecycle: std::jthread auto-joins in the destructor and
         signals the stop_token to wake the worker.
@@ -53,7 +74,7 @@ namespace LoggingLib
     class Logger {
     public:
         //! Spawn the background worker thread.
-        Logger();
+        explicit Logger(LogOverflow overflow = LogOverflow::Block);
 
         //! Destructor — std::jthread auto-joins and signals stop.
         ~Logger();
@@ -79,17 +100,160 @@ namespace LoggingLib
         //! Log a fatal error message. Writes directly to stderr (synchronous).
         void logFatal(std::string_view message);
 
+        //! Log a debug message formatted by the worker (see LogMessage for the format).
+        template <typename... Args>
+            requires(sizeof...(Args) > 0)
+        void logDebug(LogFormat<std::type_identity_t<Args>...> format, const Args&... args)
+        {
+            if constexpr (severityEnabled(Severity::Debug)) {
+                enqueue(makeMessage(Severity::Debug, format.get(), args...));
+            }
+        }
+
+        //! Log an informational message formatted by the worker.
+        template <typename... Args>
+            requires(sizeof...(Args) > 0)
+        void logInfo(LogFormat<std::type_identity_t<Args>...> format, const Args&... args)
+        {
+            if constexpr (severityEnabled(Severity::Info)) {
+                enqueue(makeMessage(Severity::Info, format.get(), args...));
+            }
+        }
+
+        //! Log a warning message formatted by the worker.
+        template <typename... Args>
+            requires(sizeof...(Args) > 0)
+        void logWarning(LogFormat<std::type_identity_t<Args>...> format, const Args&... args)
+        {
+            if constexpr (severityEnabled(Severity::Warning)) {
+                enqueue(makeMessage(Severity::Warning, format.get(), args...));
+            }
+        }
+
+        //! Log an error message formatted by the worker.
+        template <typename... Args>
+            requires(sizeof...(Args) > 0)
+        void logError(LogFormat<std::type_identity_t<Args>...> format, const Args&... args)
+        {
+            if constexpr (severityEnabled(Severity::Error)) {
+                enqueue(makeMessage(Severity::Error, format.get(), args...));
+            }
+        }
+
+        //! Log a fatal error message, formatted and written to stderr at once (synchronous).
+        template <typename... Args>
+            requires(sizeof...(Args) > 0)
+        void logFatal(LogFormat<std::type_identity_t<Args>...> format, const Args&... args)
+        {
+            writeFatal(makeMessage(Severity::Fatal, format.get(), args...));
+        }
+
+        //! Log a message unless throttle held one back within its interval; the next message it lets
+        //! through reports how many it held back. Fatal messages are written at once.
+        void logThrottled(LogThrottle& throttle, Severity severity, std::string_view message);
+
+        //! logThrottled() with a message formatted by the worker.
+        template <typename... Args>
+            requires(sizeof...(Args) > 0)
+        void logThrottled(LogThrottle& throttle, Severity severity, LogFormat<std::type_identity_t<Args>...> format, const Args&... args)
+        {
+            uint64_t suppressed{0};
+            if (!severityEnabled(severity) || !throttle.admit(suppressed)) {
+                return;
+            }
+            LogMessage message = makeMessage(severity, format.get(), args...);
+            message.suppressed = suppressed;
+            submit(message);
+        }
+
+        //! Messages discarded under LogOverflow::Drop since construction.
+        [[nodiscard]] uint64_t dropped() const;
+
     private:
-        //! Push a message onto the queue and wake the worker.
+        //! Pending messages before a caller has to wait for the worker (or drop).
+        static constexpr std::size_t QUEUE_CAPACITY = 256;
+
+        using MessageQueue = SignalsLib::MpscSignal<LogMessage, QUEUE_CAPACITY>;
+
+        //! Captures a deferred-format message.
+        template <typename... Args>
+        [[nodiscard]] static LogMessage makeMessage(Severity severity, const char* format, const Args&... args)
+        {
+            LogMessage message{};
+            message.severity = severity;
+            message.format = format;
+            (message.addArg(args), ...);
+            return message;
+        }
+
+        //! Captures a plain message and pushes it.
         void enqueue(Severity severity, std::string_view message);
 
+        //! Push a message onto the queue (waiting or dropping when full) and wake the worker.
+        void enqueue(const LogMessage& message);
+
+        //! enqueue(), or writeFatal() for a Fatal message.
+        void submit(const LogMessage& message);
+
+        //! Wake the worker; see enqueue() for why this passes through m_mutex.
+        void wakeWorker();
+
+        //! Formats message and writes it straight to stderr.
+        static void writeFatal(const LogMessage& message);
+
         //! Worker thread entry point — drains the queue until stop is requested.
         void workerLoop(std::stop_token stop_token);
 
-        SignalsLib::Signal<LogMessage> m_queue; //!< Thread-safe message queue.
+        LogOverflow m_overflow; //!< What enqueue() does when the ring is full.
+        std::unique_ptr<MessageQueue> m_queue{std::make_unique<MessageQueue>()}; //!< Lock-free message ring (its slots are too big for the stack).
+        std::atomic<uint64_t> m_dropped{0}; //!< See dropped().
+        std::atomic<uint64_t> m_drain_count{0}; //!< Drains completed, for LogOverflow::Block callers waiting for room.
+        std::atomic<int> m_blocked_producers{0}; //!< Callers waiting for room, so the worker only notifies when needed.
         std::mutex m_mutex; //!< Protects the wake-up condition.
         std::condition_variable_any m_cv; //!< Wakes the worker when messages arrive.
         std::jthread m_worker; //!< Background writer thread (auto-joins on destruction).
     };
 
 } // namespace LoggingLib
+
+//! logger.logDebug(...) when Debug is compiled in; otherwise nothing, and the arguments are not evaluated.
+#define LOG_DEBUG(logger, ...) \
+    do { \
+        if constexpr (LoggingLib::severityEnabled(LoggingLib::Severity::Debug)) { \
+            (logger).logDebug(__VA_ARGS__); \
+        } \
+    } while (false)
+
+//! logger.logInfo(...) when Info is compiled in.
+#define LOG_INFO(logger, ...) \
+    do { \
+        if constexpr (LoggingLib::severityEnabled(LoggingLib::Severity::Info)) { \
+            (logger).logInfo(__VA_ARGS__); \
+        } \
+    } while (false)
+
+//! logger.logWarning(...) when Warning is compiled in.
+#define LOG_WARNING(logger, ...) \
+    do { \
+        if constexpr (LoggingLib::severityEnabled(LoggingLib::Severity::Warning)) { \
+            (logger).logWarning(__VA_ARGS__); \
+        } \
+    } while (false)
+
+//! logger.logError(...) when Error is compiled in.
+#define LOG_ERROR(logger, ...) \
+    do { \
+        if constexpr (LoggingLib::severityEnabled(LoggingLib::Severity::Error)) { \
+            (logger).logError(__VA_ARGS__); \
+        } \
+    } while (false)
+
+//! logger.logThrottled() with a LogThrottle of its own (default interval) for this call site;
+//! severity is a Severity enumerator name: LOG_THROTTLED(logger, Error, "Draw failed: {}", what).
+#define LOG_THROTTLED(logger, severity, ...) \
+    do { \
+        if constexpr (LoggingLib::severityEnabled(LoggingLib::Severity::severity)) { \
+            static LoggingLib::LogThrottle log_throttle; \
+            (logger).logThrottled(log_throttle, LoggingLib::Severity::severity, __VA_ARGS__); \
+        } \
+    } while (false)
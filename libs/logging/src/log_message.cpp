@@ -0,0 +1,145 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "log/log_message.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace LoggingLib
+{
+
+    //! Characters std::to_chars may need for any LogArg number (the longest double is 24).
+    static constexpr std::size_t NUMBER_CAPACITY = 32;
+
+    namespace
+    {
+
+        //! Bounded writer into a caller's buffer: whatever does not fit is dropped.
+        class TextWriter {
+        public:
+            TextWriter(char* out, std::size_t capacity) :
+                m_out{out},
+                m_capacity{capacity}
+            {
+            }
+
+            //! Appends as much of text as fits.
+            void append(std::string_view text)
+            {
+                std::size_t count = std::min(text.size(), m_capacity - m_size);
+                std::memcpy(m_out + m_size, text.data(), count);
+                m_size += count;
+            }
+
+            //! Characters written so far.
+            [[nodiscard]] std::size_t size() const
+            {
+                return m_size;
+            }
+
+        private:
+            char* m_out; //!< Destination.
+            std::size_t m_capacity; //!< Characters m_out holds.
+            std::size_t m_size{0}; //!< Characters written.
+        };
+
+    } // namespace
+
+    //! Appends one captured argument in its natural form; numbers use std::to_chars (shortest
+    //! round-trip form for floating point), so the worker formats without allocating.
+    static void appendArg(TextWriter& writer, const LogMessage& message, const LogArg& arg)
+    {
+        char number[NUMBER_CAPACITY];
+        std::to_chars_result result{number, std::errc{}};
+        switch (arg.type) {
+        case LogArg::Type::Signed:
+            result = std::to_chars(number, number + NUMBER_CAPACITY, arg.signed_value);
+            break;
+        case LogArg::Type::Unsigned:
+            result = std::to_chars(number, number + NUMBER_CAPACITY, arg.unsigned_value);
+            break;
+        case LogArg::Type::Float:
+            result = std::to_chars(number, number + NUMBER_CAPACITY, arg.float_value);
+            break;
+        case LogArg::Type::Double:
+            result = std::to_chars(number, number + NUMBER_CAPACITY, arg.double_value);
+            break;
+        case LogArg::Type::Boolean:
+            writer.append(arg.boolean_value ? "true" : "false");
+            return;
+        case LogArg::Type::Text:
+            writer.append(std::string_view{message.text.data() + arg.text_offset, arg.text_length});
+            return;
+        }
+        if (result.ec == std::errc{}) {
+            writer.append(std::string_view{number, static_cast<std::size_t>(result.ptr - number)});
+        }
+    }
+
+    void LogMessage::setText(std::string_view message)
+    {
+        format = nullptr;
+        arg_count = 0;
+        truncated = (message.size() > TEXT_CAPACITY);
+        length = static_cast<uint16_t>(std::min(message.size(), TEXT_CAPACITY));
+        std::memcpy(text.data(), message.data(), length);
+    }
+
+    void LogMessage::addText(LogArg& arg, std::string_view value)
+    {
+        std::size_t count = std::min(value.size(), TEXT_CAPACITY - length);
+        truncated = (truncated || (count < value.size()));
+        arg.type = LogArg::Type::Text;
+        arg.text_offset = length;
+        arg.text_length = static_cast<uint16_t>(count);
+        std::memcpy(text.data() + length, value.data(), count);
+        length = static_cast<uint16_t>(length + count);
+    }
+
+    std::size_t LogMessage::formatText(char* out, std::size_t capacity) const
+    {
+        TextWriter writer{out, capacity};
+        if (format == nullptr) {
+            writer.append(std::string_view{text.data(), length});
+            return writer.size();
+        }
+
+        std::size_t next_arg{0};
+        const char* c = format;
+        while (*c != '\0') {
+            const char* run = c;
+            while ((*c != '\0') && (*c != '{') && (*c != '}')) {
+                ++c;
+            }
+            writer.append(std::string_view{run, static_cast<std::size_t>(c - run)});
+            if (*c == '\0') {
+                break;
+            }
+            if ((c[0] == '{') && (c[1] == '}')) {
+                if (next_arg < arg_count) {
+                    appendArg(writer, *this, args[next_arg]);
+                }
+                ++next_arg;
+                c += 2;
+            } else {
+                // "{{" and "}}" print one brace; so does a lone one.
+                writer.append(std::string_view{c, 1});
+                c += (c[1] == c[0]) ? 2 : 1;
+            }
+        }
+        return writer.size();
+    }
+
+} // namespace LoggingLib
@@ -13,11 +13,40 @@
 */
 
 #include "log/logger.hpp"
-#include <iostream>
+#include <trace/tracer.hpp>
+#include <array>
+#include <charconv>
+#include <cstring>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
 
 namespace LoggingLib
 {
 
+    //! Characters a batch buffers before it is written out early.
+    static constexpr std::size_t BATCH_CAPACITY = 16384;
+
+    //! Longest line: the longest prefix, a space, the message, the truncation mark, the
+    //! suppression note and a newline.
+    static constexpr std::size_t LINE_CAPACITY = LogMessage::TEXT_CAPACITY + 128;
+
+    //! Appended to a message that did not fit its slot.
+    static constexpr std::string_view TRUNCATED_MARK = " [truncated]";
+
+    //! Surrounds the count of a throttled message's held-back repeats.
+    static constexpr std::string_view SUPPRESSED_BEGIN = " (suppressed ";
+    static constexpr std::string_view SUPPRESSED_END = " identical messages)";
+
     //! Convert severity to a human-readable prefix string.
     [[nodiscard]] static std::string_view severityPrefix(Severity severity)
     {
@@ -36,7 +65,101 @@ namespace LoggingLib
         return "[UNKNOWN]";
     }
 
-    Logger::Logger() :
+    //! Writes all of data to stdout, or to stderr if to_stderr, in as few system calls as the
+    //! stream takes; gives up on an error (there is nowhere left to report it).
+    static void writeStream(bool to_stderr, const char* data, std::size_t size)
+    {
+#ifdef _WIN32
+        HANDLE handle = GetStdHandle(to_stderr ? STD_ERROR_HANDLE : STD_OUTPUT_HANDLE);
+        while (size > 0) {
+            DWORD written{0};
+            if (!WriteFile(handle, data, static_cast<DWORD>(size), &written, nullptr) || (written == 0)) {
+                return;
+            }
+            data += written;
+            size -= written;
+        }
+#else
+        int fd = to_stderr ? STDERR_FILENO : STDOUT_FILENO;
+        while (size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+#endif
+    }
+
+    //! Formats message as one line — prefix, text, truncation mark, newline — into line.
+    [[nodiscard]] static std::size_t formatLine(const LogMessage& message, std::array<char, LINE_CAPACITY>& line)
+    {
+        std::string_view prefix{severityPrefix(message.severity)};
+        std::memcpy(line.data(), prefix.data(), prefix.size());
+        std::size_t size = prefix.size();
+        line[size++] = ' ';
+        size += message.formatText(line.data() + size, LogMessage::TEXT_CAPACITY);
+        if (message.truncated) {
+            std::memcpy(line.data() + size, TRUNCATED_MARK.data(), TRUNCATED_MARK.size());
+            size += TRUNCATED_MARK.size();
+        }
+        if (message.suppressed > 0) {
+            std::memcpy(line.data() + size, SUPPRESSED_BEGIN.data(), SUPPRESSED_BEGIN.size());
+            size += SUPPRESSED_BEGIN.size();
+            std::to_chars_result result = std::to_chars(line.data() + size, line.data() + line.size(), message.suppressed);
+            size = static_cast<std::size_t>(result.ptr - line.data());
+            std::memcpy(line.data() + size, SUPPRESSED_END.data(), SUPPRESSED_END.size());
+            size += SUPPRESSED_END.size();
+        }
+        line[size++] = '\n';
+        return size;
+    }
+
+    namespace
+    {
+
+        //! One stream's lines of a drain, written with a single system call when the drain ends
+        //! (or earlier, if they outgrow BATCH_CAPACITY).
+        class LogBatch {
+        public:
+            explicit LogBatch(bool to_stderr) :
+                m_to_stderr{to_stderr}
+            {
+            }
+
+            //! Appends text, writing the batch out first if it would not fit.
+            void append(const char* text, std::size_t size)
+            {
+                if ((m_size + size) > BATCH_CAPACITY) {
+                    flush();
+                }
+                std::memcpy(m_data.data() + m_size, text, size);
+                m_size += size;
+            }
+
+            //! Writes out and empties the batch.
+            void flush()
+            {
+                if (m_size > 0) {
+                    writeStream(m_to_stderr, m_data.data(), m_size);
+                    m_size = 0;
+                }
+            }
+
+        private:
+            bool m_to_stderr; //!< Destination stream.
+            std::size_t m_size{0}; //!< Characters buffered.
+            std::array<char, BATCH_CAPACITY> m_data{}; //!< The buffered lines.
+        };
+
+    } // namespace
+
+    Logger::Logger(LogOverflow overflow) :
+        m_overflow{overflow},
         m_worker([this](std::stop_token token) {
             workerLoop(token);
         })
@@ -54,81 +177,185 @@ namespace LoggingLib
 
     void Logger::logDebug(std::string_view message)
     {
-        enqueue(Severity::Debug, message);
+        if constexpr (severityEnabled(Severity::Debug)) {
+            enqueue(Severity::Debug, message);
+        }
     }
 
     void Logger::logInfo(std::string_view message)
     {
-        enqueue(Severity::Info, message);
+        if constexpr (severityEnabled(Severity::Info)) {
+            enqueue(Severity::Info, message);
+        }
     }
 
     void Logger::logWarning(std::string_view message)
     {
-        enqueue(Severity::Warning, message);
+        if constexpr (severityEnabled(Severity::Warning)) {
+            enqueue(Severity::Warning, message);
+        }
     }
 
     void Logger::logError(std::string_view message)
     {
-        enqueue(Severity::Error, message);
+        if constexpr (severityEnabled(Severity::Error)) {
+            enqueue(Severity::Error, message);
+        }
     }
 
     void Logger::logFatal(std::string_view message)
     {
         // Write directly to stderr — fatal messages must be visible
         // before std::abort(), so we bypass the async queue entirely.
-        std::cerr << "[FATAL] " << message << "\n";
+        LogMessage fatal{};
+        fatal.severity = Severity::Fatal;
+        fatal.setText(message);
+        writeFatal(fatal);
+    }
+
+    void Logger::logThrottled(LogThrottle& throttle, Severity severity, std::string_view message)
+    {
+        uint64_t suppressed{0};
+        if (!severityEnabled(severity) || !throttle.admit(suppressed)) {
+            return;
+        }
+        LogMessage plain{};
+        plain.severity = severity;
+        plain.suppressed = suppressed;
+        plain.setText(message);
+        submit(plain);
+    }
+
+    uint64_t Logger::dropped() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    void Logger::writeFatal(const LogMessage& message)
+    {
+        std::array<char, LINE_CAPACITY> line;
+        std::size_t size = formatLine(message, line);
+        writeStream(true, line.data(), size);
     }
 
     void Logger::enqueue(Severity severity, std::string_view message)
+    {
+        LogMessage plain{};
+        plain.severity = severity;
+        plain.setText(message);
+        enqueue(plain);
+    }
+
+    void Logger::enqueue(const LogMessage& message)
+    {
+        while (!m_queue->emit(message)) {
+            if (m_overflow == LogOverflow::Drop) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            // Full: wait for the worker's next drain. Registering before reading the drain count
+            // (both sequentially consistent, as is the worker's side) means either the worker sees
+            // this caller and notifies, or this caller reads the count the worker already bumped.
+            // The ring may have emptied in between, so retry before sleeping; the worker, woken
+            // with a full ring, always completes another drain.
+            m_blocked_producers.fetch_add(1, std::memory_order_seq_cst);
+            uint64_t drains = m_drain_count.load(std::memory_order_seq_cst);
+            if (m_queue->emit(message)) {
+                m_blocked_producers.fetch_sub(1, std::memory_order_seq_cst);
+                break;
+            }
+            wakeWorker();
+            m_drain_count.wait(drains, std::memory_order_seq_cst);
+            m_blocked_producers.fetch_sub(1, std::memory_order_seq_cst);
+        }
+        wakeWorker();
+    }
+
+    void Logger::submit(const LogMessage& message)
+    {
+        if (message.severity == Severity::Fatal) {
+            writeFatal(message);
+        } else {
+            enqueue(message);
+        }
+    }
+
+    void Logger::wakeWorker()
     {
         // The C++ memory model requires that any state read by the wait predicate be
-        // modified under the same mutex used by the wait. Without this, a notification
-        // emitted after the worker has checked the predicate (true → empty) but before
-        // the worker has registered as a waiter inside cv.wait() is lost — the worker
-        // would sleep indefinitely while messages pile up. Holding m_mutex around the
-        // emit closes the race; notify_one() is intentionally outside the lock so the
+        // modified under the same mutex used by the wait, or a notification emitted after
+        // the worker has checked the predicate (true → empty) but before it has registered
+        // as a waiter inside cv.wait() is lost. The ring is lock-free, so instead of
+        // emitting under m_mutex we pass through it after emitting: the worker has then
+        // either seen the message or is already waiting. The emit must stay outside the
+        // lock — a full ring has the caller wait until the worker drains, and the worker
+        // may be waiting for m_mutex to get there. notify_one() is outside the lock so the
         // woken worker doesn't immediately re-block on the mutex we just released.
         {
             std::lock_guard<std::mutex> lock{m_mutex};
-            m_queue.emit({severity, std::string(message)});
         }
         m_cv.notify_one();
     }
 
     void Logger::workerLoop(std::stop_token stop_token)
     {
+        TracingLib::setThreadName("logger");
+
+        // Everything the worker writes is staged here, so a drain costs one system call per
+        // stream however many messages it holds.
+        LogBatch out_batch{false};
+        LogBatch error_batch{true};
+        std::array<char, LINE_CAPACITY> line;
+        uint64_t reported_drops{0};
+
+        auto drain = [this, &out_batch, &error_batch, &line, &reported_drops]() {
+            TRACE_ZONE("log drain");
+            LogMessage msg{};
+            while (m_queue->consume(msg)) {
+                std::size_t size = formatLine(msg, line);
+                if (msg.severity >= Severity::Warning) {
+                    error_batch.append(line.data(), size);
+                } else {
+                    out_batch.append(line.data(), size);
+                }
+            }
+
+            uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+            if (dropped != reported_drops) {
+                LogMessage report{};
+                report.severity = Severity::Warning;
+                report.format = "{} log message(s) dropped: the queue was full.";
+                report.addArg(dropped - reported_drops);
+                std::size_t size = formatLine(report, line);
+                error_batch.append(line.data(), size);
+                reported_drops = dropped;
+            }
+
+            out_batch.flush();
+            error_batch.flush();
+
+            // Let callers waiting for room (LogOverflow::Block) retry; the system call is only
+            // paid while one is actually waiting.
+            m_drain_count.fetch_add(1, std::memory_order_seq_cst);
+            if (m_blocked_producers.load(std::memory_order_seq_cst) > 0) {
+                m_drain_count.notify_all();
+            }
+        };
+
         while (!stop_token.stop_requested()) {
             // Wait for messages or stop — the CV checks stop_token automatically
             {
                 std::unique_lock<std::mutex> lock{m_mutex};
                 m_cv.wait(lock, stop_token, [this]() {
-                    return !m_queue.empty();
+                    return !m_queue->empty();
                 });
             }
-            // Lock released before draining — no lock ordering issue with Signal's mutex
-
-            // Drain all pending messages.
-            LogMessage msg{};
-            while (m_queue.consume(msg)) {
-                std::string_view prefix{severityPrefix(msg.severity)};
-                if (msg.severity >= Severity::Warning) {
-                    std::cerr << prefix << " " << msg.text << "\n";
-                } else {
-                    std::cout << prefix << " " << msg.text << "\n";
-                }
-            }
+            // Lock released before draining, so producers blocked on a full queue are never waited on
+            drain();
         }
 
         // Final drain — catch messages emitted between last check and stop
-        LogMessage msg;
-        while (m_queue.consume(msg)) {
-            std::string_view prefix{severityPrefix(msg.severity)};
-            if (msg.severity >= Severity::Warning) {
-                std::cerr << prefix << " " << msg.text << "\n";
-            } else {
-                std::cout << prefix << " " << msg.text << "\n";
-            }
-        }
+        drain();
     }
 
 } // namespace LoggingLib
@@ -14,8 +14,40 @@
 
 #include "testing/testing.hpp"
 #include "log/logger.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
 #include <thread>
 
+namespace
+{
+
+    //! The text a message would be logged with.
+    std::string formatted(const LoggingLib::LogMessage& message)
+    {
+        std::array<char, LoggingLib::LogMessage::TEXT_CAPACITY> text{};
+        std::size_t size = message.formatText(text.data(), text.size());
+        return std::string{text.data(), size};
+    }
+
+    //! Captures a deferred-format message the way Logger does.
+    template <typename... Args>
+    LoggingLib::LogMessage capture(LoggingLib::LogFormat<std::type_identity_t<Args>...> format, const Args&... args)
+    {
+        LoggingLib::LogMessage message{};
+        message.format = format.get();
+        (message.addArg(args), ...);
+        return message;
+    }
+
+    enum class Colour : uint8_t {
+        Red = 3
+    };
+
+} // namespace
+
 TEST_CASE(logger_construct_destroy)
 {
     LoggingLib::Logger logger;
@@ -55,6 +87,129 @@ TEST_CASE(logger_thread_safety)
     // Destructor drains remaining messages.
 }
 
+TEST_CASE(log_message_plain_text)
+{
+    LoggingLib::LogMessage message{};
+    message.setText("Plain {} text.");
+    TEST_CHECK_EQUAL(formatted(message), std::string{"Plain {} text."});
+    TEST_CHECK(!message.truncated);
+}
+
+TEST_CASE(log_message_long_text_truncated)
+{
+    LoggingLib::LogMessage message{};
+    std::string text(LoggingLib::LogMessage::TEXT_CAPACITY + 10, 'x');
+    message.setText(text);
+    TEST_CHECK(message.truncated);
+    TEST_CHECK_EQUAL(formatted(message).size(), LoggingLib::LogMessage::TEXT_CAPACITY);
+}
+
+TEST_CASE(log_message_deferred_arguments)
+{
+    std::string name{"ribbon"};
+    LoggingLib::LogMessage message = capture<int, uint64_t, bool, float, double, std::string, char, Colour>(
+        "{} {} {} {} {} {} {} {}", -42, uint64_t{18446744073709551615ull}, true, 0.1f, 2.5, name, 'c', Colour::Red);
+    name = "changed"; // arguments are captured by value
+    TEST_CHECK_EQUAL(formatted(message), std::string{"-42 18446744073709551615 true 0.1 2.5 ribbon c 3"});
+    TEST_CHECK(!message.truncated);
+}
+
+TEST_CASE(log_message_escaped_braces)
+{
+    LoggingLib::LogMessage message = capture<int>("{{{}}} of {{}}", 7);
+    TEST_CHECK_EQUAL(formatted(message), std::string{"{7} of {}"});
+}
+
+TEST_CASE(log_message_long_argument_truncated)
+{
+    std::string long_text(LoggingLib::LogMessage::TEXT_CAPACITY + 1, 'y');
+    LoggingLib::LogMessage message = capture<std::string, int>("{}{}", long_text, 1);
+    TEST_CHECK(message.truncated);
+}
+
+TEST_CASE(logger_formatted_messages)
+{
+    LoggingLib::Logger logger;
+    logger.logDebug("Debug {}.", 1);
+    logger.logInfo("Info {} of {}.", 2u, 5.0f);
+    logger.logWarning("Warning {}.", std::string_view{"three"});
+    logger.logError("Error {}.", false);
+    logger.logFatal("Fatal {}.", 'x');
+}
+
+TEST_CASE(logger_block_keeps_every_message)
+{
+    LoggingLib::Logger logger{LoggingLib::LogOverflow::Block};
+    constexpr int count{2000}; // several rings' worth, so callers wait for room
+
+    std::thread t1([&] {
+        for (int i{0}; i < count; ++i) {
+            logger.logInfo("Thread 1 message {}.", i);
+        }
+    });
+
+    std::thread t2([&] {
+        for (int i{0}; i < count; ++i) {
+            logger.logInfo("Thread 2 message {}.", i);
+        }
+    });
+
+    t1.join();
+    t2.join();
+    TEST_CHECK_EQUAL(logger.dropped(), uint64_t{0});
+}
+
+TEST_CASE(logger_drop_never_waits)
+{
+    LoggingLib::Logger logger{LoggingLib::LogOverflow::Drop};
+    constexpr int count{2000};
+    for (int i{0}; i < count; ++i) {
+        logger.logInfo("Dropping message {}.", i);
+    }
+    TEST_CHECK(logger.dropped() <= uint64_t{count});
+}
+
+TEST_CASE(log_throttle_admits_once_per_interval)
+{
+    LoggingLib::LogThrottle throttle{std::chrono::seconds{1}};
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t suppressed{99};
+    TEST_CHECK(throttle.admit(start, suppressed));
+    TEST_CHECK_EQUAL(suppressed, uint64_t{0});
+    for (int i{0}; i < 3; ++i) {
+        TEST_CHECK(!throttle.admit(start + std::chrono::milliseconds{100 * (i + 1)}, suppressed));
+    }
+    TEST_CHECK(throttle.admit(start + std::chrono::seconds{1}, suppressed));
+    TEST_CHECK_EQUAL(suppressed, uint64_t{3});
+    TEST_CHECK(!throttle.admit(start + std::chrono::milliseconds{1500}, suppressed));
+}
+
+TEST_CASE(logger_throttled_messages)
+{
+    LoggingLib::Logger logger;
+    LoggingLib::LogThrottle throttle;
+    for (int i{0}; i < 1000; ++i) {
+        logger.logThrottled(throttle, LoggingLib::Severity::Warning, "Throttled warning.");
+        logger.logThrottled(throttle, LoggingLib::Severity::Warning, "Throttled warning {}.", i);
+        LOG_THROTTLED(logger, Error, "Throttled error {}.", i);
+    }
+}
+
+TEST_CASE(log_macros_skip_filtered_arguments)
+{
+    LoggingLib::Logger logger;
+    int evaluated{0};
+    auto argument = [&evaluated]() {
+        ++evaluated;
+        return evaluated;
+    };
+    LOG_DEBUG(logger, "Debug macro {}.", argument());
+    TEST_CHECK_EQUAL(evaluated, LoggingLib::severityEnabled(LoggingLib::Severity::Debug) ? 1 : 0);
+    LOG_ERROR(logger, "Error macro {}.", argument());
+    LOG_ERROR(logger, "Error macro without arguments.");
+    TEST_CHECK_EQUAL(evaluated, LoggingLib::severityEnabled(LoggingLib::Severity::Debug) ? 2 : 1);
+}
+
 int main()
 {
     return static_cast<int>(TestingLib::runAll());
@@ -0,0 +1,179 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include <math/vec2_array.hpp>
+#include <math/vector.hpp>
+#include <testing/benchmark.hpp>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+
+    //! Vectors per iteration: a long string's worth, small enough to stay in L1.
+    constexpr std::size_t VECTOR_COUNT = 1024;
+
+    //! Rest length of the constraint pass (the nodes are initially spread along a unit line).
+    constexpr float REST_LENGTH = 1.0f / static_cast<float>(VECTOR_COUNT);
+
+    //! VECTOR_COUNT vectors on a wavy line, so no length is zero and none is the same.
+    [[nodiscard]] std::vector<MathLib::Vec2> makeVectors()
+    {
+        std::vector<MathLib::Vec2> vectors(VECTOR_COUNT);
+        for (std::size_t i = 0; i < VECTOR_COUNT; ++i) {
+            float t = static_cast<float>(i) / static_cast<float>(VECTOR_COUNT);
+            vectors[i] = {t, 0.1f * std::sin(t * 2.0f * MathLib::PI * 8.0f) + 0.5f};
+        }
+        return vectors;
+    }
+
+    //! makeVectors() as a Vec2Array.
+    [[nodiscard]] MathLib::Vec2Array makeArray()
+    {
+        MathLib::Vec2Array array;
+        for (const MathLib::Vec2& v : makeVectors()) {
+            array.pushBack(v);
+        }
+        return array;
+    }
+
+} // namespace
+
+BENCHMARK_CASE(vec2_add_scale)
+{
+    std::vector<MathLib::Vec2> positions = makeVectors();
+    std::vector<MathLib::Vec2> velocities = makeVectors();
+    state.setItemsPerIteration(VECTOR_COUNT);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        for (std::size_t n = 0; n < VECTOR_COUNT; ++n) {
+            positions[n] += velocities[n] * (1.0f / 240.0f);
+        }
+        TestingLib::clobberMemory();
+    }
+    TestingLib::doNotOptimise(positions.data());
+}
+
+BENCHMARK_CASE(vec2_length)
+{
+    std::vector<MathLib::Vec2> vectors = makeVectors();
+    state.setItemsPerIteration(VECTOR_COUNT);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        float sum{0.0f};
+        for (const MathLib::Vec2& v : vectors) {
+            sum += v.length();
+        }
+        TestingLib::doNotOptimise(sum);
+    }
+}
+
+BENCHMARK_CASE(vec2_normalised)
+{
+    std::vector<MathLib::Vec2> vectors = makeVectors();
+    std::vector<MathLib::Vec2> out(VECTOR_COUNT);
+    state.setItemsPerIteration(VECTOR_COUNT);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        for (std::size_t n = 0; n < VECTOR_COUNT; ++n) {
+            out[n] = vectors[n].normalised();
+        }
+        TestingLib::clobberMemory();
+    }
+    TestingLib::doNotOptimise(out.data());
+}
+
+//! One Gauss-Seidel distance-constraint sweep along the chain, the CPU solver's inner loop.
+BENCHMARK_CASE(vec2_distance_constraint_sweep)
+{
+    std::vector<MathLib::Vec2> nodes = makeVectors();
+    state.setItemsPerIteration(VECTOR_COUNT - 1);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        for (std::size_t n = 0; (n + 1) < VECTOR_COUNT; ++n) {
+            MathLib::Vec2 delta = nodes[n + 1] - nodes[n];
+            float length = delta.length();
+            if (length > 0.0f) {
+                MathLib::Vec2 correction = delta * (0.5f * (length - REST_LENGTH) / length);
+                nodes[n] += correction;
+                nodes[n + 1] -= correction;
+            }
+        }
+        TestingLib::clobberMemory();
+    }
+    TestingLib::doNotOptimise(nodes.data());
+}
+
+BENCHMARK_CASE(vec2_array_add_scale)
+{
+    MathLib::Vec2Array positions = makeArray();
+    MathLib::Vec2Array velocities = makeArray();
+    state.setItemsPerIteration(VECTOR_COUNT);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        MathLib::addScaled(positions, velocities, 1.0f / 240.0f);
+        TestingLib::clobberMemory();
+    }
+    TestingLib::doNotOptimise(positions.x());
+}
+
+BENCHMARK_CASE(vec2_array_length)
+{
+    MathLib::Vec2Array vectors = makeArray();
+    std::vector<float> lengths(VECTOR_COUNT);
+    state.setItemsPerIteration(VECTOR_COUNT);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        MathLib::lengths(vectors, lengths.data());
+        TestingLib::clobberMemory();
+    }
+    TestingLib::doNotOptimise(lengths.data());
+}
+
+BENCHMARK_CASE(vec2_array_normalise)
+{
+    MathLib::Vec2Array vectors = makeArray();
+    MathLib::Vec2Array out;
+    state.setItemsPerIteration(VECTOR_COUNT);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        out = vectors;
+        MathLib::normalise(out);
+        TestingLib::clobberMemory();
+    }
+    TestingLib::doNotOptimise(out.x());
+}
+
+BENCHMARK_CASE(vec2_array_bounds)
+{
+    MathLib::Vec2Array vectors = makeArray();
+    state.setItemsPerIteration(VECTOR_COUNT);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        MathLib::Vec2Bounds bounds = MathLib::bounds(vectors);
+        TestingLib::doNotOptimise(bounds);
+    }
+}
+
+//! One Jacobi pass over VECTOR_COUNT independent pairs (half a red-black chain sweep's work twice over).
+BENCHMARK_CASE(vec2_array_relax_distances)
+{
+    MathLib::Vec2Array a = makeArray();
+    MathLib::Vec2Array b = makeArray();
+    MathLib::scale(b, 1.5f);
+    state.setItemsPerIteration(VECTOR_COUNT);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        MathLib::relaxDistances(a, b, REST_LENGTH);
+        TestingLib::clobberMemory();
+    }
+    TestingLib::doNotOptimise(a.x());
+}
+
+int main(int argc, char** argv)
+{
+    return TestingLib::benchmarkMain(argc, argv);
+}
@@ -0,0 +1,323 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+// SIMD lane types for the batch kernels (MathLib::StringBatch, the Vec2Array kernels). Each
+// exposes the same static interface over a Value (WIDTH floats) and a Mask (WIDTH booleans), so a
+// kernel is written once as a template. Only operations that are exact per IEEE 754 (add, sub,
+// mul, div, sqrt, compare, select, min, max) are offered, which is what makes every kernel
+// bit-identical to the scalar one when built without floating-point contraction.
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define MATHLIB_LANES_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define MATHLIB_LANES_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+// AArch64 only: 32-bit NEON has no vector divide or square root.
+#include <arm_neon.h>
+#define MATHLIB_LANES_NEON 1
+#endif
+
+namespace MathLib
+{
+
+    //! One float per lane — the reference every SIMD kernel must match.
+    struct ScalarLanes {
+        using Value = float;
+        using Mask = bool;
+        static constexpr uint32_t WIDTH = 1;
+        static constexpr const char* NAME = "scalar";
+
+        static Value load(const float* p)
+        {
+            return *p;
+        }
+
+        static void store(float* p, Value v)
+        {
+            *p = v;
+        }
+
+        static Value set(float v)
+        {
+            return v;
+        }
+
+        static Value add(Value a, Value b)
+        {
+            return a + b;
+        }
+
+        static Value sub(Value a, Value b)
+        {
+            return a - b;
+        }
+
+        static Value mul(Value a, Value b)
+        {
+            return a * b;
+        }
+
+        static Value div(Value a, Value b)
+        {
+            return a / b;
+        }
+
+        static Value sqrt(Value a)
+        {
+            return std::sqrt(a);
+        }
+
+        static Mask greater(Value a, Value b)
+        {
+            return a > b;
+        }
+
+        //! Lane-wise mask ? a : b.
+        static Value select(Mask mask, Value a, Value b)
+        {
+            return mask ? a : b;
+        }
+
+        //! Lane-wise a < b ? a : b (so b where either is NaN, as minps does).
+        static Value min(Value a, Value b)
+        {
+            return (a < b) ? a : b;
+        }
+
+        //! Lane-wise a > b ? a : b (so b where either is NaN, as maxps does).
+        static Value max(Value a, Value b)
+        {
+            return (a > b) ? a : b;
+        }
+    };
+
+#if defined(MATHLIB_LANES_AVX)
+    //! Eight floats per lane group (AVX).
+    struct NativeLanes {
+        using Value = __m256;
+        using Mask = __m256;
+        static constexpr uint32_t WIDTH = 8;
+        static constexpr const char* NAME = "AVX";
+
+        static Value load(const float* p)
+        {
+            return _mm256_loadu_ps(p);
+        }
+
+        static void store(float* p, Value v)
+        {
+            _mm256_storeu_ps(p, v);
+        }
+
+        static Value set(float v)
+        {
+            return _mm256_set1_ps(v);
+        }
+
+        static Value add(Value a, Value b)
+        {
+            return _mm256_add_ps(a, b);
+        }
+
+        static Value sub(Value a, Value b)
+        {
+            return _mm256_sub_ps(a, b);
+        }
+
+        static Value mul(Value a, Value b)
+        {
+            return _mm256_mul_ps(a, b);
+        }
+
+        static Value div(Value a, Value b)
+        {
+            return _mm256_div_ps(a, b);
+        }
+
+        static Value sqrt(Value a)
+        {
+            return _mm256_sqrt_ps(a);
+        }
+
+        static Mask greater(Value a, Value b)
+        {
+            return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+        }
+
+        static Value select(Mask mask, Value a, Value b)
+        {
+            return _mm256_blendv_ps(b, a, mask);
+        }
+
+        static Value min(Value a, Value b)
+        {
+            return _mm256_min_ps(a, b);
+        }
+
+        static Value max(Value a, Value b)
+        {
+            return _mm256_max_ps(a, b);
+        }
+    };
+#elif defined(MATHLIB_LANES_SSE2)
+    //! Four floats per lane group (SSE2, the x86-64 baseline).
+    struct NativeLanes {
+        using Value = __m128;
+        using Mask = __m128;
+        static constexpr uint32_t WIDTH = 4;
+        static constexpr const char* NAME = "SSE2";
+
+        static Value load(const float* p)
+        {
+            return _mm_loadu_ps(p);
+        }
+
+        static void store(float* p, Value v)
+        {
+            _mm_storeu_ps(p, v);
+        }
+
+        static Value set(float v)
+        {
+            return _mm_set1_ps(v);
+        }
+
+        static Value add(Value a, Value b)
+        {
+            return _mm_add_ps(a, b);
+        }
+
+        static Value sub(Value a, Value b)
+        {
+            return _mm_sub_ps(a, b);
+        }
+
+        static Value mul(Value a, Value b)
+        {
+            return _mm_mul_ps(a, b);
+        }
+
+        static Value div(Value a, Value b)
+        {
+            return _mm_div_ps(a, b);
+        }
+
+        static Value sqrt(Value a)
+        {
+            return _mm_sqrt_ps(a);
+        }
+
+        static Mask greater(Value a, Value b)
+        {
+            return _mm_cmpgt_ps(a, b);
+        }
+
+        //! SSE2 has no blendv; and/andnot/or does the same per bit.
+        static Value select(Mask mask, Value a, Value b)
+        {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+
+        static Value min(Value a, Value b)
+        {
+            return _mm_min_ps(a, b);
+        }
+
+        static Value max(Value a, Value b)
+        {
+            return _mm_max_ps(a, b);
+        }
+    };
+#elif defined(MATHLIB_LANES_NEON)
+    //! Four floats per lane group (AArch64 NEON).
+    struct NativeLanes {
+        using Value = float32x4_t;
+        using Mask = uint32x4_t;
+        static constexpr uint32_t WIDTH = 4;
+        static constexpr const char* NAME = "NEON";
+
+        static Value load(const float* p)
+        {
+            return vld1q_f32(p);
+        }
+
+        static void store(float* p, Value v)
+        {
+            vst1q_f32(p, v);
+        }
+
+        static Value set(float v)
+        {
+            return vdupq_n_f32(v);
+        }
+
+        static Value add(Value a, Value b)
+        {
+            return vaddq_f32(a, b);
+        }
+
+        static Value sub(Value a, Value b)
+        {
+            return vsubq_f32(a, b);
+        }
+
+        static Value mul(Value a, Value b)
+        {
+            return vmulq_f32(a, b);
+        }
+
+        static Value div(Value a, Value b)
+        {
+            return vdivq_f32(a, b);
+        }
+
+        static Value sqrt(Value a)
+        {
+            return vsqrtq_f32(a);
+        }
+
+        static Mask greater(Value a, Value b)
+        {
+            return vcgtq_f32(a, b);
+        }
+
+        static Value select(Mask mask, Value a, Value b)
+        {
+            return vbslq_f32(mask, a, b);
+        }
+
+        //! Unlike minps, NaN in either lane gives NaN; finite values agree with the other kernels.
+        static Value min(Value a, Value b)
+        {
+            return vminq_f32(a, b);
+        }
+
+        static Value max(Value a, Value b)
+        {
+            return vmaxq_f32(a, b);
+        }
+    };
+#else
+    //! No SIMD target in this build: the native kernel is the scalar one.
+    using NativeLanes = ScalarLanes;
+#endif
+
+} // namespace MathLib
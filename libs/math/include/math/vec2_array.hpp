@@ -0,0 +1,329 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include "math/lanes.hpp"
+#include "math/vector.hpp"
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+
+namespace MathLib
+{
+
+    //! Allocator for std::vector storage aligned to Alignment bytes (e.g. a SIMD register width).
+    template <typename T, std::size_t Alignment>
+    struct AlignedAllocator {
+        using value_type = T;
+
+        template <typename U>
+        struct rebind {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() = default;
+
+        template <typename U>
+        constexpr AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept
+        {
+        }
+
+        [[nodiscard]] T* allocate(std::size_t count)
+        {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+        }
+
+        void deallocate(T* pointer, std::size_t) noexcept
+        {
+            ::operator delete(pointer, std::align_val_t{Alignment});
+        }
+
+        template <typename U>
+        [[nodiscard]] constexpr bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept
+        {
+            return true;
+        }
+    };
+
+    /*!
+        Vec2 values stored structure-of-arrays — all x components, then all y components, each
+        array aligned to ALIGNMENT — so the batch kernels below load NativeLanes::WIDTH
+        components per instruction instead of shuffling interleaved pairs.
+
+        The kernels run whole lane groups with L (NativeLanes by default) and the remaining tail
+        with ScalarLanes. Both perform the same IEEE operations in the same order as the Vec2
+        member functions, so built without floating-point contraction (-ffp-contract=off) every
+        kernel is bit-identical to the scalar Vec2 code.
+    */
+    class Vec2Array {
+    public:
+        //! Alignment of the component arrays (bytes): the widest NativeLanes register (AVX).
+        static constexpr std::size_t ALIGNMENT = 32;
+
+        //! Aligned component storage.
+        using Components = std::vector<float, AlignedAllocator<float, ALIGNMENT>>;
+
+        Vec2Array() = default;
+
+        //! count zero vectors.
+        explicit Vec2Array(std::size_t count) :
+            m_x(count, 0.0f),
+            m_y(count, 0.0f)
+        {
+        }
+
+        //! Number of vectors.
+        [[nodiscard]] std::size_t size() const
+        {
+            return m_x.size();
+        }
+
+        [[nodiscard]] bool empty() const
+        {
+            return m_x.empty();
+        }
+
+        //! Resizes to count vectors; new ones are zero.
+        void resize(std::size_t count)
+        {
+            m_x.resize(count, 0.0f);
+            m_y.resize(count, 0.0f);
+        }
+
+        void reserve(std::size_t count)
+        {
+            m_x.reserve(count);
+            m_y.reserve(count);
+        }
+
+        void pushBack(const Vec2& value)
+        {
+            m_x.push_back(value.x);
+            m_y.push_back(value.y);
+        }
+
+        //! Vector index (index < size()).
+        [[nodiscard]] Vec2 get(std::size_t index) const
+        {
+            return {m_x[index], m_y[index]};
+        }
+
+        //! Overwrites vector index (index < size()).
+        void set(std::size_t index, const Vec2& value)
+        {
+            m_x[index] = value.x;
+            m_y[index] = value.y;
+        }
+
+        //! The size() x components (ALIGNMENT-aligned).
+        [[nodiscard]] float* x()
+        {
+            return m_x.data();
+        }
+
+        [[nodiscard]] const float* x() const
+        {
+            return m_x.data();
+        }
+
+        //! The size() y components (ALIGNMENT-aligned).
+        [[nodiscard]] float* y()
+        {
+            return m_y.data();
+        }
+
+        [[nodiscard]] const float* y() const
+        {
+            return m_y.data();
+        }
+
+    private:
+        Components m_x; //!< X components.
+        Components m_y; //!< Y components.
+    };
+
+    //! Component-wise extent of a set of vectors.
+    struct Vec2Bounds {
+        Vec2 min{std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()}; //!< Smallest x and smallest y.
+        Vec2 max{-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()}; //!< Largest x and largest y.
+    };
+
+    namespace Detail
+    {
+
+        //! Calls body.operator()<L>(i) for each whole lane group of [0, count), then
+        //! body.operator()<ScalarLanes>(i) for each index of the tail.
+        template <typename L, typename Body>
+        void forLaneGroups(std::size_t count, Body body)
+        {
+            std::size_t i{0};
+            for (; (i + L::WIDTH) <= count; i += L::WIDTH) {
+                body.template operator()<L>(i);
+            }
+            for (; i < count; ++i) {
+                body.template operator()<ScalarLanes>(i);
+            }
+        }
+
+        //! Smallest lane of v.
+        template <typename L>
+        [[nodiscard]] float reduceMin(typename L::Value v)
+        {
+            std::array<float, L::WIDTH> lanes{};
+            L::store(lanes.data(), v);
+            float result = lanes[0];
+            for (uint32_t lane = 1; lane < L::WIDTH; ++lane) {
+                result = ScalarLanes::min(result, lanes[lane]);
+            }
+            return result;
+        }
+
+        //! Largest lane of v.
+        template <typename L>
+        [[nodiscard]] float reduceMax(typename L::Value v)
+        {
+            std::array<float, L::WIDTH> lanes{};
+            L::store(lanes.data(), v);
+            float result = lanes[0];
+            for (uint32_t lane = 1; lane < L::WIDTH; ++lane) {
+                result = ScalarLanes::max(result, lanes[lane]);
+            }
+            return result;
+        }
+
+    } // namespace Detail
+
+    //! a[i] += b[i] for every i < a.size() (b holds at least as many vectors).
+    template <typename L = NativeLanes>
+    void add(Vec2Array& a, const Vec2Array& b)
+    {
+        Detail::forLaneGroups<L>(a.size(), [&a, &b]<typename K>(std::size_t i) {
+            K::store(a.x() + i, K::add(K::load(a.x() + i), K::load(b.x() + i)));
+            K::store(a.y() + i, K::add(K::load(a.y() + i), K::load(b.y() + i)));
+        });
+    }
+
+    //! a[i] += b[i] * factor for every i < a.size() (b holds at least as many vectors), e.g. an
+    //! Euler step of positions by velocities.
+    template <typename L = NativeLanes>
+    void addScaled(Vec2Array& a, const Vec2Array& b, float factor)
+    {
+        Detail::forLaneGroups<L>(a.size(), [&a, &b, factor]<typename K>(std::size_t i) {
+            typename K::Value k = K::set(factor);
+            K::store(a.x() + i, K::add(K::load(a.x() + i), K::mul(K::load(b.x() + i), k)));
+            K::store(a.y() + i, K::add(K::load(a.y() + i), K::mul(K::load(b.y() + i), k)));
+        });
+    }
+
+    //! a[i] *= factor for every i.
+    template <typename L = NativeLanes>
+    void scale(Vec2Array& a, float factor)
+    {
+        Detail::forLaneGroups<L>(a.size(), [&a, factor]<typename K>(std::size_t i) {
+            typename K::Value k = K::set(factor);
+            K::store(a.x() + i, K::mul(K::load(a.x() + i), k));
+            K::store(a.y() + i, K::mul(K::load(a.y() + i), k));
+        });
+    }
+
+    //! out[i] = a[i].length() for every i (out holds a.size() floats).
+    template <typename L = NativeLanes>
+    void lengths(const Vec2Array& a, float* out)
+    {
+        Detail::forLaneGroups<L>(a.size(), [&a, out]<typename K>(std::size_t i) {
+            typename K::Value x = K::load(a.x() + i);
+            typename K::Value y = K::load(a.y() + i);
+            K::store(out + i, K::sqrt(K::add(K::mul(x, x), K::mul(y, y))));
+        });
+    }
+
+    //! a[i] = a[i].normalised() for every i (zero vectors stay zero).
+    template <typename L = NativeLanes>
+    void normalise(Vec2Array& a)
+    {
+        Detail::forLaneGroups<L>(a.size(), [&a]<typename K>(std::size_t i) {
+            typename K::Value x = K::load(a.x() + i);
+            typename K::Value y = K::load(a.y() + i);
+            typename K::Value length = K::sqrt(K::add(K::mul(x, x), K::mul(y, y)));
+            // Lengths are never negative, so "not zero" is "greater than zero" (NaN stays NaN via inv).
+            typename K::Mask nonzero = K::greater(length, K::set(0.0f));
+            typename K::Value inv = K::div(K::set(1.0f), length);
+            K::store(a.x() + i, K::select(nonzero, K::mul(x, inv), K::set(0.0f)));
+            K::store(a.y() + i, K::select(nonzero, K::mul(y, inv), K::set(0.0f)));
+        });
+    }
+
+    //! Component-wise extent of a (the default, inverted bounds when a is empty).
+    template <typename L = NativeLanes>
+    [[nodiscard]] Vec2Bounds bounds(const Vec2Array& a)
+    {
+        Vec2Bounds result{};
+        std::size_t count = a.size();
+        std::size_t i{0};
+        if (count >= L::WIDTH) {
+            typename L::Value min_x = L::set(result.min.x);
+            typename L::Value min_y = L::set(result.min.y);
+            typename L::Value max_x = L::set(result.max.x);
+            typename L::Value max_y = L::set(result.max.y);
+            for (; (i + L::WIDTH) <= count; i += L::WIDTH) {
+                typename L::Value x = L::load(a.x() + i);
+                typename L::Value y = L::load(a.y() + i);
+                min_x = L::min(min_x, x);
+                min_y = L::min(min_y, y);
+                max_x = L::max(max_x, x);
+                max_y = L::max(max_y, y);
+            }
+            result.min = {Detail::reduceMin<L>(min_x), Detail::reduceMin<L>(min_y)};
+            result.max = {Detail::reduceMax<L>(max_x), Detail::reduceMax<L>(max_y)};
+        }
+        for (; i < count; ++i) {
+            result.min = {ScalarLanes::min(result.min.x, a.x()[i]), ScalarLanes::min(result.min.y, a.y()[i])};
+            result.max = {ScalarLanes::max(result.max.x, a.x()[i]), ScalarLanes::max(result.max.y, a.y()[i])};
+        }
+        return result;
+    }
+
+    /*!
+        Relaxes the distance constraint between a[i] and b[i] towards rest_length for every
+        i < a.size() (b holds at least as many vectors): each end moves half the error along the
+        line joining them. Pairs closer than 1e-6 are left untouched, like the GPU solver. This is
+        one Jacobi pass over independent pairs, e.g. one red or black half of a chain sweep.
+    */
+    template <typename L = NativeLanes>
+    void relaxDistances(Vec2Array& a, Vec2Array& b, float rest_length)
+    {
+        Detail::forLaneGroups<L>(a.size(), [&a, &b, rest_length]<typename K>(std::size_t i) {
+            using V = typename K::Value;
+            V ax = K::load(a.x() + i);
+            V ay = K::load(a.y() + i);
+            V bx = K::load(b.x() + i);
+            V by = K::load(b.y() + i);
+            V dx = K::sub(bx, ax);
+            V dy = K::sub(by, ay);
+            V dist = K::sqrt(K::add(K::mul(dx, dx), K::mul(dy, dy)));
+            typename K::Mask apart = K::greater(dist, K::set(1e-6f));
+            V k = K::mul(K::set(0.5f), K::div(K::sub(dist, K::set(rest_length)), dist));
+            V cx = K::mul(dx, k);
+            V cy = K::mul(dy, k);
+            K::store(a.x() + i, K::select(apart, K::add(ax, cx), ax));
+            K::store(a.y() + i, K::select(apart, K::add(ay, cy), ay));
+            K::store(b.x() + i, K::select(apart, K::sub(bx, cx), bx));
+            K::store(b.y() + i, K::select(apart, K::sub(by, cy), by));
+        });
+    }
+
+} // namespace MathLib
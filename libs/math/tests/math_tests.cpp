@@ -13,10 +13,17 @@
 */
 
 #include "testing/testing.hpp"
+#include <math/vec2_array.hpp>
 #include <math/vector.hpp>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 
+using MathLib::NativeLanes;
+using MathLib::ScalarLanes;
 using MathLib::Vec2;
+using MathLib::Vec2Array;
 using MathLib::Vec3;
 
 // Expected values use named locals rather than inline braced initialisers: a brace-comma
@@ -89,6 +96,185 @@ TEST_CASE(vec3_cross)
     TEST_CHECK(x.cross(y) == expected_z);
 }
 
+//! Vectors in the Vec2Array tests: not a multiple of any lane width, so the scalar tail runs too.
+static constexpr std::size_t ARRAY_SIZE = 37;
+
+//! True when a and b have the same bit pattern (so -0 differs from +0).
+[[nodiscard]] static bool sameBits(float a, float b)
+{
+    uint32_t bits_a{0};
+    uint32_t bits_b{0};
+    std::memcpy(&bits_a, &a, sizeof(a));
+    std::memcpy(&bits_b, &b, sizeof(b));
+    return bits_a == bits_b;
+}
+
+//! True when a and b have the same bit pattern.
+[[nodiscard]] static bool sameBits(const Vec2& a, const Vec2& b)
+{
+    return sameBits(a.x, b.x) && sameBits(a.y, b.y);
+}
+
+//! ARRAY_SIZE varied vectors of mixed sign and magnitude; every seventh one is zero.
+[[nodiscard]] static std::vector<Vec2> makeVectors(float phase)
+{
+    std::vector<Vec2> vectors(ARRAY_SIZE);
+    for (std::size_t i = 0; i < ARRAY_SIZE; ++i) {
+        if ((i % 7) == 3) {
+            continue;
+        }
+        float t = static_cast<float>(i) + phase;
+        vectors[i] = {std::sin(t * 1.7f) * (1.0f + t), std::cos(t * 0.9f) * 0.01f * t};
+    }
+    return vectors;
+}
+
+[[nodiscard]] static Vec2Array toArray(const std::vector<Vec2>& vectors)
+{
+    Vec2Array array;
+    for (const Vec2& v : vectors) {
+        array.pushBack(v);
+    }
+    return array;
+}
+
+//! True when array holds exactly the vectors of expected, bit for bit.
+[[nodiscard]] static bool matches(const Vec2Array& array, const std::vector<Vec2>& expected)
+{
+    if (array.size() != expected.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        if (!sameBits(array.get(i), expected[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//! Runs the elementwise Vec2Array kernels with lanes L and checks each against the Vec2 code.
+template <typename L> static void checkElementwiseKernels()
+{
+    std::vector<Vec2> a = makeVectors(0.0f);
+    std::vector<Vec2> b = makeVectors(0.5f);
+    Vec2Array array_a = toArray(a);
+    Vec2Array array_b = toArray(b);
+
+    MathLib::add<L>(array_a, array_b);
+    for (std::size_t i = 0; i < ARRAY_SIZE; ++i) {
+        a[i] += b[i];
+    }
+    TEST_CHECK(matches(array_a, a));
+
+    MathLib::addScaled<L>(array_a, array_b, 1.0f / 240.0f);
+    for (std::size_t i = 0; i < ARRAY_SIZE; ++i) {
+        a[i] += b[i] * (1.0f / 240.0f);
+    }
+    TEST_CHECK(matches(array_a, a));
+
+    MathLib::scale<L>(array_a, -0.75f);
+    for (Vec2& v : a) {
+        v *= -0.75f;
+    }
+    TEST_CHECK(matches(array_a, a));
+
+    std::vector<float> lengths(ARRAY_SIZE);
+    MathLib::lengths<L>(array_a, lengths.data());
+    bool lengths_match{true};
+    for (std::size_t i = 0; i < ARRAY_SIZE; ++i) {
+        lengths_match = lengths_match && sameBits(lengths[i], a[i].length());
+    }
+    TEST_CHECK(lengths_match);
+
+    MathLib::normalise<L>(array_a);
+    for (Vec2& v : a) {
+        v = v.normalised();
+    }
+    TEST_CHECK(matches(array_a, a));
+}
+
+TEST_CASE(vec2_array_storage_is_aligned)
+{
+    Vec2Array array(ARRAY_SIZE);
+    TEST_CHECK((reinterpret_cast<std::uintptr_t>(array.x()) % Vec2Array::ALIGNMENT) == 0);
+    TEST_CHECK((reinterpret_cast<std::uintptr_t>(array.y()) % Vec2Array::ALIGNMENT) == 0);
+
+    Vec2 value{1.5f, -2.5f};
+    array.set(5, value);
+    TEST_CHECK(array.get(5) == value);
+    TEST_CHECK_EQUAL(array.x()[5], 1.5f);
+    TEST_CHECK_EQUAL(array.y()[5], -2.5f);
+}
+
+TEST_CASE(vec2_array_kernels_match_vec2_bit_for_bit)
+{
+    checkElementwiseKernels<NativeLanes>();
+    checkElementwiseKernels<ScalarLanes>();
+}
+
+TEST_CASE(vec2_array_bounds)
+{
+    std::vector<Vec2> vectors = makeVectors(0.25f);
+    Vec2 expected_min{vectors[0]};
+    Vec2 expected_max{vectors[0]};
+    for (const Vec2& v : vectors) {
+        expected_min = {std::fmin(expected_min.x, v.x), std::fmin(expected_min.y, v.y)};
+        expected_max = {std::fmax(expected_max.x, v.x), std::fmax(expected_max.y, v.y)};
+    }
+
+    // The extreme is in the scalar tail for one array and in a lane group for the other.
+    Vec2Array array = toArray(vectors);
+    Vec2 far{1000.0f, -1000.0f};
+    Vec2Array with_tail_extreme = toArray(vectors);
+    with_tail_extreme.set(ARRAY_SIZE - 1, far);
+
+    MathLib::Vec2Bounds native = MathLib::bounds<NativeLanes>(array);
+    MathLib::Vec2Bounds scalar = MathLib::bounds<ScalarLanes>(array);
+    TEST_CHECK(sameBits(native.min, expected_min) && sameBits(native.max, expected_max));
+    TEST_CHECK(sameBits(scalar.min, expected_min) && sameBits(scalar.max, expected_max));
+
+    MathLib::Vec2Bounds tail = MathLib::bounds(with_tail_extreme);
+    TEST_CHECK_EQUAL(tail.max.x, 1000.0f);
+    TEST_CHECK_EQUAL(tail.min.y, -1000.0f);
+
+    // Empty: inverted infinite bounds, so merging into them is a no-op.
+    MathLib::Vec2Bounds empty = MathLib::bounds(Vec2Array{});
+    TEST_CHECK(std::isinf(empty.min.x) && (empty.min.x > 0.0f));
+    TEST_CHECK(std::isinf(empty.max.y) && (empty.max.y < 0.0f));
+}
+
+TEST_CASE(vec2_array_relax_distances_matches_vec2_bit_for_bit)
+{
+    // Every seventh pair coincides (both zero) and must be left alone.
+    std::vector<Vec2> a = makeVectors(0.0f);
+    std::vector<Vec2> b = makeVectors(0.0f);
+    for (std::size_t i = 0; i < ARRAY_SIZE; ++i) {
+        if ((i % 7) != 3) {
+            b[i] += Vec2{0.3f, -0.2f} * static_cast<float>(i % 5);
+        }
+    }
+    Vec2Array native_a = toArray(a);
+    Vec2Array native_b = toArray(b);
+    Vec2Array scalar_a = toArray(a);
+    Vec2Array scalar_b = toArray(b);
+
+    constexpr float REST_LENGTH = 0.25f;
+    MathLib::relaxDistances<NativeLanes>(native_a, native_b, REST_LENGTH);
+    MathLib::relaxDistances<ScalarLanes>(scalar_a, scalar_b, REST_LENGTH);
+    for (std::size_t i = 0; i < ARRAY_SIZE; ++i) {
+        Vec2 delta = b[i] - a[i];
+        float dist = delta.length();
+        if (dist > 1e-6f) {
+            Vec2 correction = delta * (0.5f * ((dist - REST_LENGTH) / dist));
+            a[i] += correction;
+            b[i] -= correction;
+        }
+    }
+    TEST_CHECK(matches(native_a, a) && matches(native_b, b));
+    TEST_CHECK(matches(scalar_a, a) && matches(scalar_b, b));
+    TEST_CHECK(approx((native_b.get(1) - native_a.get(1)).length(), REST_LENGTH));
+}
+
 int main()
 {
     return static_cast<int>(TestingLib::runAll());
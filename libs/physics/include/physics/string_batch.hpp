@@ -0,0 +1,122 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include <math/vector.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace PhysicsLib
+{
+
+    //! Per-string parameters (the CPU counterpart of the renderer's StringParams).
+    struct StringParams {
+        float anchor_x{0.0f}; //!< Head offset from the cursor, X (NDC).
+        float anchor_y{0.0f}; //!< Head offset from the cursor, Y (NDC).
+        float segment_length{0.0f}; //!< Rest distance between adjacent nodes (NDC).
+        float gravity{0.0f}; //!< Downward acceleration (NDC / s^2; +Y is down).
+        float damping{1.0f}; //!< Velocity damping per substep (0..1).
+    };
+
+    //! What one step() call advances.
+    struct StepParams {
+        float cursor_x{0.0f}; //!< Head target X of an anchor-less string (NDC).
+        float cursor_y{0.0f}; //!< Head target Y of an anchor-less string (NDC).
+        float dt{0.0f}; //!< Fixed substep duration (seconds).
+        uint32_t substeps{1}; //!< Substeps to advance.
+        uint32_t iterations{1}; //!< Constraint relaxation iterations per substep.
+    };
+
+    //! Which lane implementation step() runs.
+    enum class Kernel {
+        Scalar, //!< One string at a time, plain float code.
+        Native //!< The widest SIMD kernel this build targets (AVX, SSE2 or NEON; scalar elsewhere).
+    };
+
+    /*!
+        CPU reference of the GPU string physics: the same Verlet integration and red-black
+        Gauss-Seidel distance constraints as physicsMain in physics.slang (the head gets its half
+        of the first constraint's correction and is re-pinned after every iteration), without the
+        GPU's optional collisions.
+
+        The state is structure-of-arrays and node-major: row i holds node i of every string, so
+        a SIMD lane is a string and every lane does the same arithmetic — no shuffles, no gathers.
+        Rows are padded to a multiple of LANE_PADDING strings, which both keeps every kernel free
+        of tail loops and lets threads split the strings on cache-line boundaries.
+
+        Every kernel performs the same IEEE operations in the same order (no FMA contraction, masked
+        selects rather than adding zero), so results are bit-identical across kernels and thread
+        counts: the library is a deterministic reference to diff GPU output against.
+    */
+    class StringBatch {
+    public:
+        //! Strings per padded row chunk (a 64-byte cache line of floats).
+        static constexpr uint32_t LANE_PADDING = 16;
+
+        //! Creates string_count strings of node_count nodes, all at the origin and at rest.
+        StringBatch(uint32_t string_count, uint32_t node_count);
+
+        [[nodiscard]] uint32_t stringCount() const
+        {
+            return m_string_count;
+        }
+
+        [[nodiscard]] uint32_t nodeCount() const
+        {
+            return m_node_count;
+        }
+
+        //! Sets one string's parameters.
+        void setString(uint32_t string_index, const StringParams& params);
+
+        //! Sets one node's current and previous position (equal values mean zero velocity).
+        void setNode(uint32_t string_index, uint32_t node, MathLib::Vec2 position, MathLib::Vec2 previous);
+
+        //! Current position of one node.
+        [[nodiscard]] MathLib::Vec2 position(uint32_t string_index, uint32_t node) const;
+
+        //! Previous position (Verlet history) of one node.
+        [[nodiscard]] MathLib::Vec2 previous(uint32_t string_index, uint32_t node) const;
+
+        //! Advances every string by params.substeps substeps. With thread_count > 1 the strings
+        //! are split across that many threads (started for this call), in LANE_PADDING chunks.
+        void step(const StepParams& params, Kernel kernel = Kernel::Native, uint32_t thread_count = 1);
+
+        //! Name of the SIMD kernel Kernel::Native runs in this build ("AVX", "SSE2", "NEON" or "scalar").
+        [[nodiscard]] static const char* nativeKernelName();
+
+    private:
+        //! Index of node i of string s in the node-major arrays.
+        [[nodiscard]] size_t index(uint32_t string_index, uint32_t node) const
+        {
+            return static_cast<size_t>(node) * m_row_stride + string_index;
+        }
+
+        uint32_t m_string_count{0}; //!< Strings in the batch.
+        uint32_t m_node_count{0}; //!< Nodes per string.
+        uint32_t m_row_stride{0}; //!< Floats per node row (string count rounded up to LANE_PADDING).
+        std::vector<float> m_x; //!< Current X, node-major.
+        std::vector<float> m_y; //!< Current Y, node-major.
+        std::vector<float> m_prev_x; //!< Previous X, node-major.
+        std::vector<float> m_prev_y; //!< Previous Y, node-major.
+        std::vector<float> m_anchor_x; //!< Per-string head offset X (padded).
+        std::vector<float> m_anchor_y; //!< Per-string head offset Y (padded).
+        std::vector<float> m_segment_length; //!< Per-string rest length (padded).
+        std::vector<float> m_gravity; //!< Per-string gravity (padded).
+        std::vector<float> m_damping; //!< Per-string damping per substep (padded).
+    };
+
+} // namespace PhysicsLib
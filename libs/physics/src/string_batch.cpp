@@ -0,0 +1,215 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "physics/string_batch.hpp"
+#include <math/lanes.hpp>
+#include <thread>
+
+namespace PhysicsLib
+{
+
+    namespace
+    {
+
+        using MathLib::NativeLanes;
+        using MathLib::ScalarLanes;
+
+        //! The state arrays the kernels work on (node-major, row_stride floats per node row).
+        struct BatchView {
+            float* x;
+            float* y;
+            float* prev_x;
+            float* prev_y;
+            const float* anchor_x;
+            const float* anchor_y;
+            const float* segment_length;
+            const float* gravity;
+            const float* damping;
+            uint32_t node_count;
+            uint32_t row_stride;
+        };
+
+        //! Relaxes the distance constraint between rows a and b for the L::WIDTH strings at lane.
+        //! Lanes whose nodes coincide are left untouched, like the dist > 1e-6 test on the GPU.
+        template <typename L> void solvePair(const BatchView& view, size_t a, size_t b, typename L::Value segment_length)
+        {
+            using V = typename L::Value;
+            V ax = L::load(view.x + a);
+            V ay = L::load(view.y + a);
+            V bx = L::load(view.x + b);
+            V by = L::load(view.y + b);
+            V dx = L::sub(bx, ax);
+            V dy = L::sub(by, ay);
+            V dist = L::sqrt(L::add(L::mul(dx, dx), L::mul(dy, dy)));
+            typename L::Mask apart = L::greater(dist, L::set(1e-6f));
+            V diff = L::div(L::sub(dist, segment_length), dist);
+            V k = L::mul(L::set(0.5f), diff);
+            V cx = L::mul(dx, k);
+            V cy = L::mul(dy, k);
+            L::store(view.x + a, L::select(apart, L::add(ax, cx), ax));
+            L::store(view.y + a, L::select(apart, L::add(ay, cy), ay));
+            L::store(view.x + b, L::select(apart, L::sub(bx, cx), bx));
+            L::store(view.y + b, L::select(apart, L::sub(by, cy), by));
+        }
+
+        //! Advances the strings [first, last) (a multiple of L::WIDTH apart) by params.substeps,
+        //! one group of L::WIDTH strings at a time so its rows stay in cache across substeps.
+        template <typename L> void solveStrings(const BatchView& view, const StepParams& params, uint32_t first, uint32_t last)
+        {
+            using V = typename L::Value;
+            V dt_squared = L::set(params.dt * params.dt);
+            for (uint32_t lane = first; lane < last; lane += L::WIDTH) {
+                V head_x = L::add(L::set(params.cursor_x), L::load(view.anchor_x + lane));
+                V head_y = L::add(L::set(params.cursor_y), L::load(view.anchor_y + lane));
+                V segment_length = L::load(view.segment_length + lane);
+                V gravity_term = L::mul(L::load(view.gravity + lane), dt_squared);
+                V damping = L::load(view.damping + lane);
+
+                for (uint32_t step = 0; step < params.substeps; ++step) {
+                    // Verlet integration; the head moves straight to its pin.
+                    for (uint32_t node = 0; node < view.node_count; ++node) {
+                        size_t i = static_cast<size_t>(node) * view.row_stride + lane;
+                        V x = L::load(view.x + i);
+                        V y = L::load(view.y + i);
+                        V next_x = head_x;
+                        V next_y = head_y;
+                        if (node > 0) {
+                            next_x = L::add(x, L::mul(L::sub(x, L::load(view.prev_x + i)), damping));
+                            next_y = L::add(L::add(y, L::mul(L::sub(y, L::load(view.prev_y + i)), damping)), gravity_term);
+                        }
+                        L::store(view.prev_x + i, x);
+                        L::store(view.prev_y + i, y);
+                        L::store(view.x + i, next_x);
+                        L::store(view.y + i, next_y);
+                    }
+
+                    // Red-black Gauss-Seidel: even pairs, then odd pairs, then re-pin the head.
+                    for (uint32_t it = 0; it < params.iterations; ++it) {
+                        for (uint32_t phase = 0; phase < 2; ++phase) {
+                            for (uint32_t node = phase; node + 1 < view.node_count; node += 2) {
+                                size_t a = static_cast<size_t>(node) * view.row_stride + lane;
+                                solvePair<L>(view, a, a + view.row_stride, segment_length);
+                            }
+                        }
+                        L::store(view.x + lane, head_x);
+                        L::store(view.y + lane, head_y);
+                    }
+                }
+            }
+        }
+
+        //! Runs the kernel chosen by kernel over the strings [first, last).
+        void solveRange(const BatchView& view, const StepParams& params, Kernel kernel, uint32_t first, uint32_t last)
+        {
+            if (kernel == Kernel::Native) {
+                solveStrings<NativeLanes>(view, params, first, last);
+            } else {
+                solveStrings<ScalarLanes>(view, params, first, last);
+            }
+        }
+
+    } // namespace
+
+    StringBatch::StringBatch(uint32_t string_count, uint32_t node_count) :
+        m_string_count(string_count),
+        m_node_count(node_count),
+        m_row_stride((string_count + LANE_PADDING - 1) / LANE_PADDING * LANE_PADDING)
+    {
+        size_t state_size = static_cast<size_t>(m_row_stride) * m_node_count;
+        m_x.assign(state_size, 0.0f);
+        m_y.assign(state_size, 0.0f);
+        m_prev_x.assign(state_size, 0.0f);
+        m_prev_y.assign(state_size, 0.0f);
+        // Padding lanes keep all-zero parameters: their nodes coincide, so they never move.
+        m_anchor_x.assign(m_row_stride, 0.0f);
+        m_anchor_y.assign(m_row_stride, 0.0f);
+        m_segment_length.assign(m_row_stride, 0.0f);
+        m_gravity.assign(m_row_stride, 0.0f);
+        m_damping.assign(m_row_stride, 0.0f);
+        for (uint32_t s = 0; s < m_string_count; ++s) {
+            setString(s, StringParams{});
+        }
+    }
+
+    void StringBatch::setString(uint32_t string_index, const StringParams& params)
+    {
+        m_anchor_x[string_index] = params.anchor_x;
+        m_anchor_y[string_index] = params.anchor_y;
+        m_segment_length[string_index] = params.segment_length;
+        m_gravity[string_index] = params.gravity;
+        m_damping[string_index] = params.damping;
+    }
+
+    void StringBatch::setNode(uint32_t string_index, uint32_t node, MathLib::Vec2 position, MathLib::Vec2 previous)
+    {
+        size_t i = index(string_index, node);
+        m_x[i] = position.x;
+        m_y[i] = position.y;
+        m_prev_x[i] = previous.x;
+        m_prev_y[i] = previous.y;
+    }
+
+    MathLib::Vec2 StringBatch::position(uint32_t string_index, uint32_t node) const
+    {
+        size_t i = index(string_index, node);
+        return {m_x[i], m_y[i]};
+    }
+
+    MathLib::Vec2 StringBatch::previous(uint32_t string_index, uint32_t node) const
+    {
+        size_t i = index(string_index, node);
+        return {m_prev_x[i], m_prev_y[i]};
+    }
+
+    void StringBatch::step(const StepParams& params, Kernel kernel, uint32_t thread_count)
+    {
+        BatchView view{m_x.data(), m_y.data(), m_prev_x.data(), m_prev_y.data(), m_anchor_x.data(), m_anchor_y.data(), m_segment_length.data(), m_gravity.data(),
+            m_damping.data(), m_node_count, m_row_stride};
+
+        // Whole LANE_PADDING chunks per thread, so no two threads share a cache line of a row.
+        uint32_t chunk_count = m_row_stride / LANE_PADDING;
+        if (thread_count > chunk_count) {
+            thread_count = chunk_count;
+        }
+        if (thread_count <= 1) {
+            solveRange(view, params, kernel, 0, m_row_stride);
+            return;
+        }
+
+        std::vector<std::jthread> workers;
+        workers.reserve(thread_count - 1);
+        uint32_t first_chunk = 0;
+        for (uint32_t t = 0; t < thread_count; ++t) {
+            // Spread the remainder over the first threads.
+            uint32_t chunks = chunk_count / thread_count + ((t < chunk_count % thread_count) ? 1 : 0);
+            uint32_t first = first_chunk * LANE_PADDING;
+            uint32_t last = (first_chunk + chunks) * LANE_PADDING;
+            first_chunk += chunks;
+            if (t + 1 == thread_count) {
+                solveRange(view, params, kernel, first, last); // the calling thread takes the last range
+            } else {
+                workers.emplace_back([&view, &params, kernel, first, last]() {
+                    solveRange(view, params, kernel, first, last);
+                });
+            }
+        }
+        // std::jthread joins on destruction.
+    }
+
+    const char* StringBatch::nativeKernelName()
+    {
+        return NativeLanes::NAME;
+    }
+
+} // namespace PhysicsLib
@@ -0,0 +1,188 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "testing/testing.hpp"
+#include <physics/string_batch.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+using MathLib::Vec2;
+using PhysicsLib::Kernel;
+using PhysicsLib::StepParams;
+using PhysicsLib::StringBatch;
+using PhysicsLib::StringParams;
+
+//! Approximate float equality.
+[[nodiscard]] static bool approx(float a, float b, float tolerance)
+{
+    return std::fabs(a - b) < tolerance;
+}
+
+//! Bitwise float equality (distinguishes -0.0 from 0.0, and compares NaNs).
+[[nodiscard]] static bool sameBits(float a, float b)
+{
+    uint32_t bits_a{0};
+    uint32_t bits_b{0};
+    std::memcpy(&bits_a, &a, sizeof(a));
+    std::memcpy(&bits_b, &b, sizeof(b));
+    return bits_a == bits_b;
+}
+
+//! A batch of strings that differ in length, gravity and damping, laid out horizontally (so
+//! they swing), with some initial velocity.
+[[nodiscard]] static StringBatch makeSwingingBatch(uint32_t string_count, uint32_t node_count)
+{
+    StringBatch batch{string_count, node_count};
+    for (uint32_t s = 0; s < string_count; ++s) {
+        StringParams params{};
+        params.anchor_x = 0.01f * static_cast<float>(s);
+        params.segment_length = 0.01f + 0.0003f * static_cast<float>(s % 7);
+        params.gravity = 4.0f + 0.1f * static_cast<float>(s % 3);
+        params.damping = 0.99f;
+        batch.setString(s, params);
+        for (uint32_t i = 0; i < node_count; ++i) {
+            Vec2 position{params.anchor_x + params.segment_length * static_cast<float>(i), 0.0f};
+            Vec2 previous{position.x, position.y - 0.0005f * static_cast<float>(s % 5)};
+            batch.setNode(s, i, position, previous);
+        }
+    }
+    return batch;
+}
+
+//! True when both batches hold bit-identical state.
+[[nodiscard]] static bool sameState(const StringBatch& a, const StringBatch& b)
+{
+    for (uint32_t s = 0; s < a.stringCount(); ++s) {
+        for (uint32_t i = 0; i < a.nodeCount(); ++i) {
+            Vec2 pa = a.position(s, i);
+            Vec2 pb = b.position(s, i);
+            Vec2 qa = a.previous(s, i);
+            Vec2 qb = b.previous(s, i);
+            if (!sameBits(pa.x, pb.x) || !sameBits(pa.y, pb.y) || !sameBits(qa.x, qb.x) || !sameBits(qa.y, qb.y)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE(head_is_pinned_to_cursor_plus_anchor)
+{
+    StringBatch batch{2, 8};
+    StringParams params{};
+    params.anchor_x = 0.25f;
+    params.anchor_y = -0.125f;
+    params.segment_length = 0.05f;
+    params.gravity = 4.0f;
+    params.damping = 0.99f;
+    batch.setString(1, params);
+
+    StepParams step{};
+    step.cursor_x = 0.5f;
+    step.cursor_y = 0.5f;
+    step.dt = 1.0f / 240.0f;
+    step.substeps = 4;
+    step.iterations = 6;
+    batch.step(step);
+
+    Vec2 expected_head{0.75f, 0.375f};
+    TEST_CHECK(batch.position(1, 0) == expected_head);
+}
+
+TEST_CASE(constraints_restore_segment_length)
+{
+    // Two nodes twice their rest distance apart, no gravity: relaxation pulls node 1 back.
+    StringBatch batch{1, 2};
+    StringParams params{};
+    params.segment_length = 0.1f;
+    params.damping = 0.0f;
+    batch.setString(0, params);
+    Vec2 head{0.0f, 0.0f};
+    Vec2 tail{0.2f, 0.0f};
+    batch.setNode(0, 0, head, head);
+    batch.setNode(0, 1, tail, tail);
+
+    StepParams step{};
+    step.dt = 1.0f / 240.0f;
+    step.substeps = 8;
+    step.iterations = 6;
+    batch.step(step);
+
+    TEST_CHECK(approx((batch.position(0, 1) - batch.position(0, 0)).length(), 0.1f, 1e-3f));
+}
+
+TEST_CASE(hanging_string_settles_below_its_head)
+{
+    StringBatch batch{1, 16};
+    StringParams params{};
+    params.segment_length = 0.05f;
+    params.gravity = 4.0f;
+    params.damping = 0.98f;
+    batch.setString(0, params);
+    for (uint32_t i = 0; i < 16; ++i) {
+        Vec2 position{0.05f * static_cast<float>(i), 0.0f};
+        batch.setNode(0, i, position, position);
+    }
+
+    StepParams step{};
+    step.dt = 1.0f / 240.0f;
+    step.substeps = 240 * 20;
+    step.iterations = 6;
+    batch.step(step);
+
+    // Straight down from the head (+Y is down) and nearly at rest.
+    Vec2 tail = batch.position(0, 15);
+    TEST_CHECK(approx(tail.x, 0.0f, 0.01f));
+    TEST_CHECK(tail.y > 0.6f);
+    TEST_CHECK((tail - batch.previous(0, 15)).length() < 1e-5f);
+}
+
+TEST_CASE(native_kernel_matches_scalar_bit_for_bit)
+{
+    // 37 strings: not a multiple of any kernel width, so padding lanes are exercised too.
+    StringBatch scalar = makeSwingingBatch(37, 50);
+    StringBatch native = makeSwingingBatch(37, 50);
+
+    StepParams step{};
+    step.cursor_x = 0.1f;
+    step.cursor_y = -0.2f;
+    step.dt = 1.0f / 240.0f;
+    step.substeps = 120;
+    step.iterations = 6;
+    scalar.step(step, Kernel::Scalar);
+    native.step(step, Kernel::Native);
+
+    TEST_CHECK(sameState(scalar, native));
+}
+
+TEST_CASE(threaded_step_matches_single_threaded_bit_for_bit)
+{
+    StringBatch single = makeSwingingBatch(200, 32);
+    StringBatch threaded = makeSwingingBatch(200, 32);
+
+    StepParams step{};
+    step.dt = 1.0f / 240.0f;
+    step.substeps = 60;
+    step.iterations = 6;
+    single.step(step, Kernel::Native, 1);
+    threaded.step(step, Kernel::Native, 5);
+
+    TEST_CHECK(sameState(single, threaded));
+}
+
+int main()
+{
+    return static_cast<int>(TestingLib::runAll());
+}
@@ -0,0 +1,123 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include <signal/ring_signal.hpp>
+#include <signal/signal.hpp>
+#include <testing/benchmark.hpp>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+    //! Producer threads of the contended cases.
+    constexpr uint64_t PRODUCER_COUNT = 4;
+
+    //! Ring size of the bounded cases: the logger's.
+    constexpr std::size_t RING_CAPACITY = 1024;
+
+    //! One thread emits then consumes each message: the uncontended cost of a round trip.
+    template <typename SignalT>
+    void benchRoundTrip(TestingLib::BenchmarkState& state)
+    {
+        SignalT signal;
+        int out{0};
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(static_cast<int>(i));
+            if (signal.consume(out)) {
+                TestingLib::doNotOptimise(out);
+            }
+        }
+    }
+
+    //! producers threads emit iterations() messages in total while this thread drains them. The
+    //! threads are started inside the timed call; with the auto-scaled message count that is noise.
+    template <typename SignalT>
+    void benchStream(TestingLib::BenchmarkState& state, uint64_t producers)
+    {
+        SignalT signal;
+        uint64_t per_producer = (state.iterations() + producers - 1) / producers;
+        std::vector<std::thread> threads;
+        for (uint64_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&signal, per_producer] {
+                for (uint64_t i = 0; i < per_producer; ++i) {
+                    signal.emit(static_cast<int>(i));
+                }
+            });
+        }
+
+        uint64_t consumed{0};
+        int out{0};
+        while (consumed < (per_producer * producers)) {
+            if (signal.consume(out)) {
+                TestingLib::doNotOptimise(out);
+                ++consumed;
+            } else {
+                std::this_thread::yield(); // as a real consumer would sleep; matters on few cores
+            }
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+} // namespace
+
+using SignalsLib::OverflowPolicy;
+
+BENCHMARK_CASE(round_trip_signal)
+{
+    benchRoundTrip<SignalsLib::Signal<int>>(state);
+}
+
+BENCHMARK_CASE(round_trip_spsc_signal)
+{
+    benchRoundTrip<SignalsLib::SpscSignal<int, RING_CAPACITY>>(state);
+}
+
+BENCHMARK_CASE(round_trip_mpsc_signal)
+{
+    benchRoundTrip<SignalsLib::MpscSignal<int, RING_CAPACITY>>(state);
+}
+
+BENCHMARK_CASE(stream_1_producer_signal)
+{
+    benchStream<SignalsLib::Signal<int>>(state, 1);
+}
+
+BENCHMARK_CASE(stream_1_producer_spsc_signal_block)
+{
+    benchStream<SignalsLib::SpscSignal<int, RING_CAPACITY, OverflowPolicy::Block>>(state, 1);
+}
+
+BENCHMARK_CASE(stream_1_producer_mpsc_signal_block)
+{
+    benchStream<SignalsLib::MpscSignal<int, RING_CAPACITY, OverflowPolicy::Block>>(state, 1);
+}
+
+BENCHMARK_CASE(stream_4_producers_signal)
+{
+    benchStream<SignalsLib::Signal<int>>(state, PRODUCER_COUNT);
+}
+
+BENCHMARK_CASE(stream_4_producers_mpsc_signal_block)
+{
+    benchStream<SignalsLib::MpscSignal<int, RING_CAPACITY, OverflowPolicy::Block>>(state, PRODUCER_COUNT);
+}
+
+int main(int argc, char** argv)
+{
+    return TestingLib::benchmarkMain(argc, argv);
+}
@@ -0,0 +1,78 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+
+namespace SignalsLib
+{
+
+    /*!
+        Latest-value mailbox with the emit() / consume() interface of Signal<T>, for state where
+        only the newest value matters (a window size, a cursor position): emit() overwrites, so a
+        burst of emits costs the producer one atomic store each and the consumer a single consume().
+
+        One slot holds the value and a flag says whether it changed since the last consume(). The
+        flag is set after the value is stored and cleared before it is read, so a consume() that
+        races an emit() returns either value, and the flag then stays set, making the next consume()
+        return the newer one again — never an older value than the one that raised the flag.
+
+        Any number of producers and consumers; with several producers the survivor is whichever
+        emit() stored last. T must be trivially copyable and small enough for a lock-free
+        std::atomic<T>.
+    */
+    template <typename T>
+    class LatestSignal {
+        static_assert(std::is_trivially_copyable_v<T>, "LatestSignal values are stored in a std::atomic.");
+        static_assert(std::atomic<T>::is_always_lock_free, "LatestSignal values must fit a lock-free std::atomic.");
+
+    public:
+        LatestSignal() = default;
+
+        LatestSignal(const LatestSignal&) = delete;
+        LatestSignal& operator=(const LatestSignal&) = delete;
+        LatestSignal(LatestSignal&&) = delete;
+        LatestSignal& operator=(LatestSignal&&) = delete;
+
+        //! Replaces the pending value (if any) with data.
+        void emit(const T& data)
+        {
+            m_value.store(data, std::memory_order_relaxed);
+            m_pending.store(true, std::memory_order_release);
+        }
+
+        //! Takes the newest value if one was emitted since the last consume(); returns true if so.
+        [[nodiscard]] bool consume(T& out)
+        {
+            if (!m_pending.exchange(false, std::memory_order_acquire)) {
+                return false;
+            }
+            out = m_value.load(std::memory_order_relaxed);
+            return true;
+        }
+
+        //! Returns true if nothing was emitted since the last consume().
+        [[nodiscard]] bool empty() const
+        {
+            return !m_pending.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::atomic<T> m_value{}; //!< The newest value.
+        std::atomic<bool> m_pending{false}; //!< Set by emit(), cleared by consume().
+    };
+
+} // namespace SignalsLib
@@ -0,0 +1,234 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace SignalsLib
+{
+
+    //! What RingSignal::emit() does when the ring is full.
+    enum class OverflowPolicy {
+        DropNewest, //!< Discard the message being emitted (emit() returns false).
+        DropOldest, //!< Discard the oldest pending message to make room (the newest always gets in).
+        Block //!< Wait until the consumer has made room (never loses a message).
+    };
+
+    //! Whether several threads may emit() into a RingSignal at once.
+    enum class ProducerMode {
+        Single, //!< One producer thread: claiming a slot is a plain store.
+        Multiple //!< Any number of producer threads: claiming a slot is a compare-and-swap.
+    };
+
+    //! Assumed cache line size: the producer and consumer positions live on separate lines so
+    //! the two sides do not invalidate each other's cache. (std::hardware_destructive_interference_size
+    //! is not reliable across the supported compilers.)
+    static constexpr std::size_t RING_CACHE_LINE_SIZE = 64;
+
+    /*!
+        Bounded, allocation-free, lock-free message queue with the emit() / consume() interface
+        of Signal<T>, for hot paths where a mutex and a deque chunk per message cost too much.
+
+        The ring is a fixed std::array of Capacity slots inside the object. Each slot carries a
+        sequence number that says whose turn it is (Vyukov's bounded queue): a producer claims
+        the position whose slot sequence equals it, writes the value and publishes position + 1;
+        the consumer claims the position whose slot reads position + 1, moves the value out and
+        hands the slot to the producer of the next lap (position + Capacity). Nothing is shared
+        between the two sides except the slot being handed over, and no side ever waits for
+        another, except by OverflowPolicy::Block.
+
+        Contract: one consumer thread, and one producer thread unless Producers is
+        ProducerMode::Multiple. Under OverflowPolicy::DropOldest a producer that finds the ring
+        full consumes the oldest message itself, so the consume side is claimed with a
+        compare-and-swap in every mode. T must be default-constructible and move-assignable.
+    */
+    template <typename T, std::size_t Capacity, OverflowPolicy Policy = OverflowPolicy::DropNewest, ProducerMode Producers = ProducerMode::Single>
+    class RingSignal {
+        static_assert((Capacity >= 2) && ((Capacity & (Capacity - 1)) == 0), "RingSignal capacity must be a power of two of at least 2.");
+        static_assert(std::is_default_constructible_v<T> && std::is_move_assignable_v<T>, "RingSignal slots hold default-constructed, move-assigned values.");
+
+    public:
+        RingSignal()
+        {
+            for (std::size_t i = 0; i < Capacity; ++i) {
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        RingSignal(const RingSignal&) = delete;
+        RingSignal& operator=(const RingSignal&) = delete;
+        RingSignal(RingSignal&&) = delete;
+        RingSignal& operator=(RingSignal&&) = delete;
+
+        //! Enqueues a copy of data. Returns false if it was discarded because the ring was full
+        //! (OverflowPolicy::DropNewest only); under DropOldest the discarded message is the oldest
+        //! pending one, and under Block this waits for room. Either way dropped() counts it.
+        bool emit(const T& data)
+        {
+            std::size_t position = m_enqueue_position.load(std::memory_order_relaxed);
+            for (;;) {
+                Slot& slot = m_slots[position & MASK];
+                std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                std::ptrdiff_t lag = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+                if (lag == 0) {
+                    // The slot is free for this lap: claim the position.
+                    if constexpr (Producers == ProducerMode::Single) {
+                        m_enqueue_position.store(position + 1, std::memory_order_relaxed);
+                        break;
+                    } else {
+                        if (m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                            break;
+                        }
+                    }
+                } else if (lag < 0) {
+                    // Full: the slot still holds the message of the previous lap.
+                    if constexpr (Policy == OverflowPolicy::DropNewest) {
+                        m_dropped.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    } else if constexpr (Policy == OverflowPolicy::DropOldest) {
+                        T discarded{};
+                        if (consume(discarded)) {
+                            m_dropped.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    } else {
+                        waitForRoom(slot, sequence);
+                    }
+                    position = m_enqueue_position.load(std::memory_order_relaxed);
+                } else {
+                    // Another producer claimed this position first.
+                    position = m_enqueue_position.load(std::memory_order_relaxed);
+                }
+            }
+
+            Slot& slot = m_slots[position & MASK];
+            slot.value = data;
+            slot.sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! Dequeues the oldest message; returns true if a value was consumed.
+        [[nodiscard]] bool consume(T& out)
+        {
+            std::size_t position = m_dequeue_position.load(std::memory_order_relaxed);
+            for (;;) {
+                Slot& slot = m_slots[position & MASK];
+                std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                std::ptrdiff_t lag = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+                if (lag == 0) {
+                    if (m_dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (lag < 0) {
+                    return false; // empty: the slot has not been written this lap.
+                } else {
+                    position = m_dequeue_position.load(std::memory_order_relaxed);
+                }
+            }
+
+            Slot& slot = m_slots[position & MASK];
+            out = std::move(slot.value);
+            if constexpr (Policy == OverflowPolicy::Block) {
+                // Sequentially consistent with waitForRoom()'s registration, so either the producer
+                // sees the free slot or this sees the producer (no lost wake-up); the system call is
+                // only paid while someone is actually parked.
+                slot.sequence.store(position + Capacity, std::memory_order_seq_cst);
+                if (m_blocked_producers.load(std::memory_order_seq_cst) > 0) {
+                    slot.sequence.notify_all();
+                }
+            } else {
+                slot.sequence.store(position + Capacity, std::memory_order_release);
+            }
+            return true;
+        }
+
+        //! Returns true if no message is pending (a snapshot; producers may be mid-emit).
+        [[nodiscard]] bool empty() const
+        {
+            return size() == 0;
+        }
+
+        //! Returns the number of pending messages (a snapshot, at most Capacity).
+        [[nodiscard]] std::size_t size() const
+        {
+            std::size_t dequeued = m_dequeue_position.load(std::memory_order_acquire);
+            std::size_t enqueued = m_enqueue_position.load(std::memory_order_acquire);
+            if (enqueued <= dequeued) {
+                return 0;
+            }
+            return ((enqueued - dequeued) > Capacity) ? Capacity : (enqueued - dequeued);
+        }
+
+        //! Messages discarded by the overflow policy since construction.
+        [[nodiscard]] std::uint64_t dropped() const
+        {
+            return m_dropped.load(std::memory_order_relaxed);
+        }
+
+        //! Slots in the ring.
+        [[nodiscard]] static constexpr std::size_t capacity()
+        {
+            return Capacity;
+        }
+
+    private:
+        static constexpr std::size_t MASK = Capacity - 1;
+
+        //! Times a producer rechecks a full slot, yielding in between, before parking on it.
+        static constexpr int BLOCK_SPIN_COUNT = 64;
+
+        //! One message and the position (lap) it belongs to.
+        struct Slot {
+            std::atomic<std::size_t> sequence{0}; //!< position: free for the producer; position + 1: holds that position's message.
+            T value{}; //!< The message (meaningful only while the sequence marks it written).
+        };
+
+        //! OverflowPolicy::Block: waits until slot's sequence is no longer full_sequence (the consumer
+        //! has freed it, or another producer has taken the position). Spins first, since the consumer
+        //! usually frees a slot within microseconds; then parks on the sequence.
+        void waitForRoom(Slot& slot, std::size_t full_sequence)
+        {
+            for (int i = 0; i < BLOCK_SPIN_COUNT; ++i) {
+                if (slot.sequence.load(std::memory_order_acquire) != full_sequence) {
+                    return;
+                }
+                std::this_thread::yield();
+            }
+            m_blocked_producers.fetch_add(1, std::memory_order_seq_cst);
+            slot.sequence.wait(full_sequence, std::memory_order_seq_cst);
+            m_blocked_producers.fetch_sub(1, std::memory_order_seq_cst);
+        }
+
+        alignas(RING_CACHE_LINE_SIZE) std::atomic<std::size_t> m_enqueue_position{0}; //!< Next position a producer claims.
+        alignas(RING_CACHE_LINE_SIZE) std::atomic<std::size_t> m_dequeue_position{0}; //!< Next position the consumer claims.
+        alignas(RING_CACHE_LINE_SIZE) std::atomic<std::uint64_t> m_dropped{0}; //!< See dropped().
+        std::atomic<int> m_blocked_producers{0}; //!< Producers parked in waitForRoom() (OverflowPolicy::Block).
+        alignas(RING_CACHE_LINE_SIZE) std::array<Slot, Capacity> m_slots{}; //!< The ring.
+    };
+
+    //! Single-producer / single-consumer ring (e.g. window callback → render thread).
+    template <typename T, std::size_t Capacity, OverflowPolicy Policy = OverflowPolicy::DropNewest>
+    using SpscSignal = RingSignal<T, Capacity, Policy, ProducerMode::Single>;
+
+    //! Multi-producer / single-consumer ring (e.g. any thread → the logger worker).
+    template <typename T, std::size_t Capacity, OverflowPolicy Policy = OverflowPolicy::DropNewest>
+    using MpscSignal = RingSignal<T, Capacity, Policy, ProducerMode::Multiple>;
+
+} // namespace SignalsLib
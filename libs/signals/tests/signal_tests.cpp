@@ -13,8 +13,12 @@
 */
 
 #include "testing/testing.hpp"
+#include <signal/latest_signal.hpp>
+#include <signal/ring_signal.hpp>
 #include <signal/signal.hpp>
+#include <array>
 #include <thread>
+#include <vector>
 
 TEST_CASE(signal_emit_and_consume)
 {
@@ -81,6 +85,224 @@ TEST_CASE(signal_thread_safety)
     TEST_CHECK(signal.empty());
 }
 
+TEST_CASE(ring_signal_emit_and_consume)
+{
+    SignalsLib::SpscSignal<int, 4> signal;
+    TEST_CHECK(signal.empty());
+
+    TEST_CHECK(signal.emit(42));
+    TEST_CHECK(!signal.empty());
+    TEST_CHECK_EQUAL(signal.size(), static_cast<std::size_t>(1));
+
+    int out{0};
+    TEST_CHECK(signal.consume(out));
+    TEST_CHECK_EQUAL(out, 42);
+    TEST_CHECK(signal.empty());
+    TEST_CHECK(!signal.consume(out));
+}
+
+TEST_CASE(ring_signal_fifo_order_across_laps)
+{
+    SignalsLib::SpscSignal<int, 4> signal;
+    int out{0};
+    for (int lap{0}; lap < 3; ++lap) {
+        for (int i{0}; i < 4; ++i) {
+            TEST_CHECK(signal.emit((lap * 4) + i));
+        }
+        TEST_CHECK_EQUAL(signal.size(), static_cast<std::size_t>(4));
+        for (int i{0}; i < 4; ++i) {
+            TEST_CHECK(signal.consume(out));
+            TEST_CHECK_EQUAL(out, (lap * 4) + i);
+        }
+    }
+    TEST_CHECK(signal.empty());
+}
+
+TEST_CASE(ring_signal_drop_newest_when_full)
+{
+    SignalsLib::SpscSignal<int, 4, SignalsLib::OverflowPolicy::DropNewest> signal;
+    for (int i{0}; i < 4; ++i) {
+        TEST_CHECK(signal.emit(i));
+    }
+    TEST_CHECK(!signal.emit(4));
+    TEST_CHECK(!signal.emit(5));
+    TEST_CHECK_EQUAL(signal.dropped(), static_cast<std::uint64_t>(2));
+
+    int out{0};
+    for (int i{0}; i < 4; ++i) {
+        TEST_CHECK(signal.consume(out));
+        TEST_CHECK_EQUAL(out, i);
+    }
+    TEST_CHECK(!signal.consume(out));
+}
+
+TEST_CASE(ring_signal_drop_oldest_when_full)
+{
+    SignalsLib::SpscSignal<int, 4, SignalsLib::OverflowPolicy::DropOldest> signal;
+    for (int i{0}; i < 6; ++i) {
+        TEST_CHECK(signal.emit(i));
+    }
+    TEST_CHECK_EQUAL(signal.dropped(), static_cast<std::uint64_t>(2));
+    TEST_CHECK_EQUAL(signal.size(), static_cast<std::size_t>(4));
+
+    int out{0};
+    for (int i{2}; i < 6; ++i) {
+        TEST_CHECK(signal.consume(out));
+        TEST_CHECK_EQUAL(out, i);
+    }
+    TEST_CHECK(!signal.consume(out));
+}
+
+TEST_CASE(ring_signal_block_waits_for_room)
+{
+    SignalsLib::SpscSignal<int, 2, SignalsLib::OverflowPolicy::Block> signal;
+    constexpr int count{1000};
+
+    std::thread producer([&] {
+        for (int i{0}; i < count; ++i) {
+            signal.emit(i);
+        }
+    });
+
+    // Every message arrives, in order, however far the producer runs ahead.
+    int expected{0};
+    bool ordered{true};
+    int out{0};
+    while (expected < count) {
+        if (signal.consume(out)) {
+            ordered = ordered && (out == expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    TEST_CHECK(ordered);
+    TEST_CHECK_EQUAL(signal.dropped(), static_cast<std::uint64_t>(0));
+    TEST_CHECK(signal.empty());
+}
+
+TEST_CASE(ring_signal_spsc_thread_safety)
+{
+    SignalsLib::SpscSignal<int, 64, SignalsLib::OverflowPolicy::DropOldest> signal;
+    constexpr int count{20000};
+
+    std::thread producer([&] {
+        for (int i{0}; i < count; ++i) {
+            signal.emit(i);
+        }
+    });
+
+    // Drops are allowed, reordering is not: what arrives is strictly increasing.
+    int consumed{0};
+    int last{-1};
+    bool increasing{true};
+    std::thread consumer([&] {
+        int out{0};
+        while (last < (count - 1)) {
+            if (signal.consume(out)) {
+                increasing = increasing && (out > last);
+                last = out;
+                ++consumed;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    producer.join();
+    consumer.join();
+    TEST_CHECK(increasing);
+    TEST_CHECK_EQUAL(static_cast<std::uint64_t>(consumed) + signal.dropped(), static_cast<std::uint64_t>(count));
+    TEST_CHECK(signal.empty());
+}
+
+TEST_CASE(ring_signal_mpsc_thread_safety)
+{
+    constexpr int producer_count{4};
+    constexpr int per_producer{5000};
+    SignalsLib::MpscSignal<int, 128, SignalsLib::OverflowPolicy::Block> signal;
+
+    std::vector<std::thread> producers;
+    for (int p{0}; p < producer_count; ++p) {
+        producers.emplace_back([&signal, p] {
+            for (int i{0}; i < per_producer; ++i) {
+                signal.emit((p * per_producer) + i);
+            }
+        });
+    }
+
+    // Each producer's messages arrive in its own order, none lost.
+    std::array<int, producer_count> next{};
+    bool ordered{true};
+    int consumed{0};
+    int out{0};
+    while (consumed < (producer_count * per_producer)) {
+        if (signal.consume(out)) {
+            int p = out / per_producer;
+            ordered = ordered && ((out % per_producer) == next[static_cast<std::size_t>(p)]);
+            ++next[static_cast<std::size_t>(p)];
+            ++consumed;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    TEST_CHECK(ordered);
+    TEST_CHECK_EQUAL(signal.dropped(), static_cast<std::uint64_t>(0));
+    TEST_CHECK(signal.empty());
+}
+
+TEST_CASE(latest_signal_keeps_only_the_newest)
+{
+    SignalsLib::LatestSignal<int> signal;
+    int out{-1};
+    TEST_CHECK(signal.empty());
+    TEST_CHECK(!signal.consume(out));
+
+    signal.emit(1);
+    signal.emit(2);
+    signal.emit(3);
+    TEST_CHECK(!signal.empty());
+    TEST_CHECK(signal.consume(out));
+    TEST_CHECK_EQUAL(out, 3);
+    TEST_CHECK(signal.empty());
+    TEST_CHECK(!signal.consume(out));
+}
+
+TEST_CASE(latest_signal_thread_safety)
+{
+    SignalsLib::LatestSignal<int> signal;
+    constexpr int count{20000};
+
+    std::thread producer([&] {
+        for (int i{1}; i <= count; ++i) {
+            signal.emit(i);
+        }
+    });
+
+    // Values only ever move forwards, and the last one always arrives.
+    int last{0};
+    bool increasing{true};
+    int out{0};
+    while (last < count) {
+        if (signal.consume(out)) {
+            increasing = increasing && (out >= last);
+            last = out;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    TEST_CHECK(increasing);
+    TEST_CHECK_EQUAL(last, count);
+}
+
 int main()
 {
     return static_cast<int>(TestingLib::runAll());
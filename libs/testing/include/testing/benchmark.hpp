@@ -0,0 +1,152 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace TestingLib
+{
+
+    //! Handed to a benchmark body, which runs the measured operation iterations() times per call.
+    class BenchmarkState {
+    public:
+        explicit BenchmarkState(uint64_t iterations) :
+            m_iterations{iterations}
+        {
+        }
+
+        //! Times to run the measured operation in this call.
+        [[nodiscard]] uint64_t iterations() const
+        {
+            return m_iterations;
+        }
+
+        //! Items (messages, vectors, ...) one iteration processes, for the throughput figure (default 1).
+        void setItemsPerIteration(uint64_t items)
+        {
+            m_items_per_iteration = items;
+        }
+
+        //! See setItemsPerIteration().
+        [[nodiscard]] uint64_t itemsPerIteration() const
+        {
+            return m_items_per_iteration;
+        }
+
+    private:
+        uint64_t m_iterations; //!< See iterations().
+        uint64_t m_items_per_iteration{1}; //!< See setItemsPerIteration().
+    };
+
+    //! A registered benchmark with a name and callable body.
+    struct BenchmarkCase {
+        std::string_view name; //!< Benchmark name.
+        std::function<void(BenchmarkState&)> fn; //!< Benchmark body.
+    };
+
+    //! Returns the global list of registered benchmarks.
+    std::vector<BenchmarkCase>& benchmarkRegistry();
+
+    //! Registers a benchmark; called automatically by BENCHMARK_CASE macro.
+    void registerBenchmark(std::string_view name, std::function<void(BenchmarkState&)> fn);
+
+    //! Robust statistics of a benchmark's per-iteration times.
+    struct BenchmarkStats {
+        double median_ns{0.0}; //!< Median sample.
+        double mad_ns{0.0}; //!< Median absolute deviation from the median (spread that ignores outliers).
+        double min_ns{0.0}; //!< Fastest sample (the least disturbed run).
+        std::size_t samples{0}; //!< Samples the statistics cover.
+    };
+
+    //! Median, MAD and minimum of samples_ns (all 0 for no samples).
+    [[nodiscard]] BenchmarkStats computeBenchmarkStats(std::vector<double> samples_ns);
+
+    //! How runAllBenchmarks() measures.
+    struct BenchmarkOptions {
+        //! A sample is one call of the body; its iteration count is doubled (or scaled up from the
+        //! last time) until one call takes at least this long, so timer resolution and call
+        //! overhead do not matter.
+        std::chrono::nanoseconds min_sample_time{std::chrono::milliseconds{10}};
+        //! Calls at the scaled iteration count, unmeasured, before sampling: caches, branch
+        //! predictors and the CPU clock settle.
+        std::chrono::nanoseconds warmup_time{std::chrono::milliseconds{100}};
+        //! Measured calls per benchmark.
+        uint32_t sample_count{15};
+        //! Run only benchmarks whose name contains this (empty: all).
+        std::string filter;
+        //! Also write the results to this JSON file (empty: none).
+        std::string json_path;
+    };
+
+    //! Parses "--filter <text>", "--json <path>", "--samples <count>" and "--quick" (one short
+    //! sample each, no warmup: a smoke run) into out_options. Returns false and fills
+    //! out_error_message on anything else.
+    [[nodiscard]] bool parseBenchmarkArguments(int argc, char** argv, BenchmarkOptions& out_options, std::string& out_error_message);
+
+    //! Runs all registered benchmarks that match the filter, printing a line per benchmark, and
+    //! writes the JSON file if asked; returns true if anything failed (the body threw or the
+    //! JSON file could not be written), false otherwise.
+    [[nodiscard]] bool runAllBenchmarks(const BenchmarkOptions& options = {});
+
+    //! Entry point for a benchmark executable: parseBenchmarkArguments() then runAllBenchmarks();
+    //! returns the process exit code.
+    [[nodiscard]] int benchmarkMain(int argc, char** argv);
+
+    //! Hands the address to code the compiler cannot see (out of line), so it must assume the
+    //! pointee is read and written there.
+    void escapePointer(const volatile void* pointer);
+
+    //! Keeps value (and the computation producing it) alive outside the compiler's view, without
+    //! storing it anywhere, so a benchmark body cannot be optimised away.
+    template <typename T> inline void doNotOptimise(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        escapePointer(&value);
+#endif
+    }
+
+    //! Makes the compiler assume all memory is read and written here, so stores before it are not
+    //! elided nor sunk past it.
+    inline void clobberMemory()
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : : "memory");
+#else
+        escapePointer(nullptr);
+#endif
+    }
+
+} // namespace TestingLib
+
+//! Defines and auto-registers a benchmark; the body takes `::TestingLib::BenchmarkState& state`.
+#define BENCHMARK_CASE(bench_name)                                            \
+    static void bench_name(::TestingLib::BenchmarkState& state);              \
+    namespace                                                                 \
+    {                                                                         \
+        struct bench_name##_registrar {                                       \
+            bench_name##_registrar()                                          \
+            {                                                                 \
+                ::TestingLib::registerBenchmark(#bench_name, bench_name);     \
+            }                                                                 \
+        } bench_name##_instance;                                              \
+    }                                                                         \
+    static void bench_name(::TestingLib::BenchmarkState& state)
@@ -0,0 +1,228 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "testing/benchmark.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+
+namespace TestingLib
+{
+
+    //! A call's iteration count grows at most this much per scaling step, so one far-off
+    //! measurement cannot overshoot wildly.
+    static constexpr double MAX_SCALE_FACTOR = 100.0;
+
+    //! Target a little past min_sample_time when scaling, so the next call is not just short of it.
+    static constexpr double SCALE_MARGIN = 1.2;
+
+    //! Measured result of one benchmark.
+    struct BenchmarkResult {
+        std::string_view name; //!< Benchmark name.
+        uint64_t iterations{0}; //!< Iterations per sample.
+        uint64_t items_per_iteration{1}; //!< From BenchmarkState::setItemsPerIteration().
+        BenchmarkStats stats{}; //!< Per-iteration times.
+    };
+
+    std::vector<BenchmarkCase>& benchmarkRegistry()
+    {
+        static std::vector<BenchmarkCase> cases;
+        return cases;
+    }
+
+    void registerBenchmark(std::string_view name, std::function<void(BenchmarkState&)> fn)
+    {
+        benchmarkRegistry().push_back({name, std::move(fn)});
+    }
+
+    //! Median of sorted (which must not be empty).
+    [[nodiscard]] static double sortedMedian(const std::vector<double>& sorted)
+    {
+        std::size_t middle = sorted.size() / 2;
+        return ((sorted.size() % 2) == 1) ? sorted[middle] : ((sorted[middle - 1] + sorted[middle]) / 2.0);
+    }
+
+    BenchmarkStats computeBenchmarkStats(std::vector<double> samples_ns)
+    {
+        BenchmarkStats stats{};
+        stats.samples = samples_ns.size();
+        if (samples_ns.empty()) {
+            return stats;
+        }
+
+        std::sort(samples_ns.begin(), samples_ns.end());
+        stats.min_ns = samples_ns.front();
+        stats.median_ns = sortedMedian(samples_ns);
+        for (double& sample : samples_ns) {
+            sample = std::abs(sample - stats.median_ns);
+        }
+        std::sort(samples_ns.begin(), samples_ns.end());
+        stats.mad_ns = sortedMedian(samples_ns);
+        return stats;
+    }
+
+    bool parseBenchmarkArguments(int argc, char** argv, BenchmarkOptions& out_options, std::string& out_error_message)
+    {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg{argv[i]};
+            if ((arg == "--filter") && (i + 1 < argc)) {
+                out_options.filter = argv[++i];
+            } else if ((arg == "--json") && (i + 1 < argc)) {
+                out_options.json_path = argv[++i];
+            } else if ((arg == "--samples") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                const char* end = value.data() + value.size();
+                std::from_chars_result result = std::from_chars(value.data(), end, out_options.sample_count);
+                if ((result.ec != std::errc{}) || (result.ptr != end) || (out_options.sample_count == 0)) {
+                    out_error_message = "Invalid sample count \"" + std::string(value) + "\".";
+                    return false;
+                }
+            } else if (arg == "--quick") {
+                out_options.min_sample_time = std::chrono::milliseconds{1};
+                out_options.warmup_time = std::chrono::nanoseconds::zero();
+                out_options.sample_count = 1;
+            } else {
+                out_error_message = "Unknown argument \"" + std::string(arg) + "\". Usage: [--filter <text>] [--json <path>] [--samples <count>] [--quick]";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! Calls the body once with iterations iterations and returns how long it took.
+    [[nodiscard]] static std::chrono::nanoseconds timeCall(const BenchmarkCase& bench, uint64_t iterations, uint64_t& out_items_per_iteration)
+    {
+        BenchmarkState state{iterations};
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bench.fn(state);
+        std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+        out_items_per_iteration = state.itemsPerIteration();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+    }
+
+    //! Scales the iteration count until one call takes min_sample_time, warms up, and samples.
+    [[nodiscard]] static BenchmarkResult measure(const BenchmarkCase& bench, const BenchmarkOptions& options)
+    {
+        BenchmarkResult result{};
+        result.name = bench.name;
+
+        uint64_t iterations{1};
+        std::chrono::nanoseconds elapsed = timeCall(bench, iterations, result.items_per_iteration);
+        while (elapsed < options.min_sample_time) {
+            // Scale from the measurement when it is meaningful, else just double.
+            double factor = 2.0;
+            if (elapsed.count() > 0) {
+                factor = std::clamp(SCALE_MARGIN * static_cast<double>(options.min_sample_time.count()) / static_cast<double>(elapsed.count()), 2.0, MAX_SCALE_FACTOR);
+            }
+            iterations = static_cast<uint64_t>(std::ceil(static_cast<double>(iterations) * factor));
+            elapsed = timeCall(bench, iterations, result.items_per_iteration);
+        }
+        result.iterations = iterations;
+
+        std::chrono::nanoseconds warmed{0};
+        while (warmed < options.warmup_time) {
+            warmed += timeCall(bench, iterations, result.items_per_iteration);
+        }
+
+        std::vector<double> samples_ns;
+        samples_ns.reserve(options.sample_count);
+        for (uint32_t sample = 0; sample < options.sample_count; ++sample) {
+            elapsed = timeCall(bench, iterations, result.items_per_iteration);
+            samples_ns.push_back(static_cast<double>(elapsed.count()) / static_cast<double>(iterations));
+        }
+        result.stats = computeBenchmarkStats(std::move(samples_ns));
+        return result;
+    }
+
+    //! Items per second at the median time.
+    [[nodiscard]] static double itemsPerSecond(const BenchmarkResult& result)
+    {
+        return (result.stats.median_ns > 0.0) ? (static_cast<double>(result.items_per_iteration) * 1e9 / result.stats.median_ns) : 0.0;
+    }
+
+    //! Writes results as a JSON array of one object per benchmark.
+    [[nodiscard]] static bool writeJson(const std::string& path, const std::vector<BenchmarkResult>& results)
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.precision(6);
+        file << "[\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const BenchmarkResult& result = results[i];
+            file << "  {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations << ", \"samples\": " << result.stats.samples
+                 << ", \"median_ns\": " << result.stats.median_ns << ", \"mad_ns\": " << result.stats.mad_ns << ", \"min_ns\": " << result.stats.min_ns
+                 << ", \"items_per_iteration\": " << result.items_per_iteration << ", \"items_per_second\": " << itemsPerSecond(result) << "}"
+                 << (((i + 1) < results.size()) ? ",\n" : "\n");
+        }
+        file << "]\n";
+        file.flush();
+        return file.good();
+    }
+
+    bool runAllBenchmarks(const BenchmarkOptions& options)
+    {
+        std::vector<BenchmarkResult> results;
+        std::size_t failed{0};
+
+        std::printf("  %-44s %12s %10s %12s %14s\n", "benchmark", "median ns", "MAD ns", "min ns", "items/s");
+        for (const BenchmarkCase& bench : benchmarkRegistry()) {
+            if (!options.filter.empty() && (bench.name.find(options.filter) == std::string_view::npos)) {
+                continue;
+            }
+            try {
+                BenchmarkResult result = measure(bench, options);
+                std::printf("  %-44.*s %12.2f %10.2f %12.2f %14.4g\n", static_cast<int>(result.name.size()), result.name.data(), result.stats.median_ns,
+                    result.stats.mad_ns, result.stats.min_ns, itemsPerSecond(result));
+                std::fflush(stdout);
+                results.push_back(result);
+            } catch (const std::exception& e) {
+                std::printf("  FAIL  %.*s (unhandled exception)\n", static_cast<int>(bench.name.size()), bench.name.data());
+                std::printf("        %s\n", e.what());
+                ++failed;
+            }
+        }
+
+        if (!options.json_path.empty() && !writeJson(options.json_path, results)) {
+            std::printf("Failed to write \"%s\".\n", options.json_path.c_str());
+            ++failed;
+        }
+        std::printf("\n%zu measured, %zu failed\n", results.size(), failed);
+        return failed > 0;
+    }
+
+    int benchmarkMain(int argc, char** argv)
+    {
+        BenchmarkOptions options{};
+        std::string error_message;
+        if (!parseBenchmarkArguments(argc, argv, options, error_message)) {
+            std::printf("%s\n", error_message.c_str());
+            return 1;
+        }
+        return static_cast<int>(runAllBenchmarks(options));
+    }
+
+    //! Where escapePointer() stores: a volatile write the compiler must perform.
+    static const volatile void* volatile escape_sink{nullptr};
+
+    void escapePointer(const volatile void* pointer)
+    {
+        escape_sink = pointer;
+    }
+
+} // namespace TestingLib
@@ -12,6 +12,7 @@
     GNU General Public License for more details.
 */
 
+#include "testing/benchmark.hpp"
 #include "testing/testing.hpp"
 #include <stdexcept>
 
@@ -32,6 +33,65 @@ TEST_CASE(check_throws_detects_throw)
     TEST_CHECK_THROWS(throw std::runtime_error("boom"));
 }
 
+TEST_CASE(benchmark_stats_are_robust)
+{
+    // Median 3, deviations {2, 1, 0, 2, 97}: MAD 2, unmoved by the outlier.
+    TestingLib::BenchmarkStats stats = TestingLib::computeBenchmarkStats({5.0, 1.0, 3.0, 100.0, 2.0});
+    TEST_CHECK_EQUAL(stats.samples, std::size_t{5});
+    TEST_CHECK_EQUAL(stats.median_ns, 3.0);
+    TEST_CHECK_EQUAL(stats.mad_ns, 2.0);
+    TEST_CHECK_EQUAL(stats.min_ns, 1.0);
+
+    // An even count takes the mean of the middle two.
+    TestingLib::BenchmarkStats even = TestingLib::computeBenchmarkStats({4.0, 1.0, 2.0, 3.0});
+    TEST_CHECK_EQUAL(even.median_ns, 2.5);
+    TEST_CHECK_EQUAL(even.mad_ns, 1.0);
+
+    TestingLib::BenchmarkStats none = TestingLib::computeBenchmarkStats({});
+    TEST_CHECK_EQUAL(none.samples, std::size_t{0});
+    TEST_CHECK_EQUAL(none.median_ns, 0.0);
+}
+
+TEST_CASE(benchmark_arguments_parse)
+{
+    char program[] = "bench";
+    char quick[] = "--quick";
+    char json[] = "--json";
+    char path[] = "out.json";
+    char* args[] = {program, quick, json, path};
+    TestingLib::BenchmarkOptions options{};
+    std::string error;
+    TEST_CHECK(TestingLib::parseBenchmarkArguments(4, args, options, error));
+    TEST_CHECK_EQUAL(options.sample_count, 1u);
+    TEST_CHECK_EQUAL(options.json_path, std::string("out.json"));
+
+    char unknown[] = "--fast";
+    char* bad_args[] = {program, unknown};
+    TEST_CHECK(!TestingLib::parseBenchmarkArguments(2, bad_args, options, error));
+    TEST_CHECK(!error.empty());
+}
+
+//! Registered here (never run by runAll()) so the scaling is exercised in benchmark_scales_iterations.
+BENCHMARK_CASE(self_test_spin)
+{
+    uint64_t sum{0};
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        sum += i;
+        TestingLib::doNotOptimise(sum);
+    }
+}
+
+TEST_CASE(benchmark_scales_iterations)
+{
+    TestingLib::BenchmarkOptions options{};
+    options.min_sample_time = std::chrono::milliseconds{1};
+    options.warmup_time = std::chrono::nanoseconds::zero();
+    options.sample_count = 3;
+    options.filter = "self_test_spin";
+    TEST_CHECK(!TestingLib::runAllBenchmarks(options));
+    TEST_CHECK_EQUAL(TestingLib::benchmarkRegistry().size(), std::size_t{1});
+}
+
 int main()
 {
     return static_cast<int>(TestingLib::runAll());
@@ -0,0 +1,138 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//! Whether TRACE_ZONE scopes are compiled in (1) or compile to nothing (0). Set by the build
+//! (TRACING_ENABLED, on by default).
+#ifndef TRACINGLIB_ENABLED
+#define TRACINGLIB_ENABLED 1
+#endif
+
+namespace TracingLib
+{
+
+    /*!
+        Process-wide scoped tracing. A TRACE_ZONE("name") at the top of a scope records when the
+        scope was entered and left, on the calling thread; writeChromeTrace() exports every
+        thread's zones as Chrome trace-event JSON (one complete "X" event per zone, named threads)
+        for chrome://tracing or Perfetto.
+
+        Each thread appends to a buffer of its own, EVENTS_PER_THREAD events allocated on its
+        first zone: the append is a store and a release of the count, without atomics shared with
+        other threads or locks. Only creating a thread's buffer takes the registry mutex. Buffers
+        live until the process exits, so a thread may end before the export. When its buffer is
+        full a thread drops further zones and counts them (eventsDropped()).
+
+        Zones are recorded only while tracing is enabled (setEnabled()); otherwise one costs a
+        relaxed load. With TRACINGLIB_ENABLED 0 they compile to nothing.
+    */
+
+    //! Whether TRACE_ZONE scopes are compiled in.
+    static constexpr bool TRACING_COMPILED = (TRACINGLIB_ENABLED != 0);
+
+    //! Zones a thread records before it drops the rest (1.5 MiB of events, allocated the first
+    //! time the thread records one).
+    static constexpr std::size_t EVENTS_PER_THREAD = std::size_t{1} << 16;
+
+    //! One finished zone, as recorded on its thread.
+    struct TraceEvent {
+        const char* name; //!< Zone name: a string literal, kept by pointer.
+        uint64_t begin_ns; //!< When the zone was entered (steady clock, ns).
+        uint64_t end_ns; //!< When it was left.
+    };
+
+    namespace Detail
+    {
+        //! See setEnabled().
+        inline std::atomic<bool> enabled_flag{false};
+    } // namespace Detail
+
+    //! Starts (true) or stops recording zones, for every thread. The first start sets the trace's
+    //! time origin.
+    void setEnabled(bool enabled);
+
+    //! True while zones are recorded.
+    [[nodiscard]] inline bool enabled()
+    {
+        return Detail::enabled_flag.load(std::memory_order_relaxed);
+    }
+
+    //! Names the calling thread in the trace (a string literal, kept by pointer). Unnamed threads
+    //! are exported as "thread N". While tracing is disabled only the name is kept: the thread's
+    //! buffer is created when it records its first zone.
+    void setThreadName(const char* name);
+
+    //! The steady clock in nanoseconds.
+    [[nodiscard]] uint64_t nowNanoseconds();
+
+    //! Appends a zone to the calling thread's buffer (whether or not tracing is enabled).
+    void record(const char* name, uint64_t begin_ns, uint64_t end_ns);
+
+    //! Zones recorded so far, across every thread.
+    [[nodiscard]] uint64_t eventsRecorded();
+
+    //! Zones dropped so far because their thread's buffer was full.
+    [[nodiscard]] uint64_t eventsDropped();
+
+    //! Writes every zone recorded so far to path as Chrome trace-event JSON. Threads still
+    //! recording may add zones meanwhile; those after the first look are left out. Returns false
+    //! and fills out_error_message on failure.
+    [[nodiscard]] bool writeChromeTrace(const std::string& path, std::string& out_error_message);
+
+    //! Records the enclosing scope as a zone while tracing is enabled (see TRACE_ZONE).
+    class TraceZone {
+    public:
+        explicit TraceZone(const char* name) :
+            m_name{name},
+            m_active{enabled()},
+            m_begin_ns{m_active ? nowNanoseconds() : 0}
+        {
+        }
+
+        ~TraceZone()
+        {
+            if (m_active) {
+                record(m_name, m_begin_ns, nowNanoseconds());
+            }
+        }
+
+        TraceZone(const TraceZone&) = delete;
+        TraceZone& operator=(const TraceZone&) = delete;
+        TraceZone(TraceZone&&) = delete;
+        TraceZone& operator=(TraceZone&&) = delete;
+
+    private:
+        const char* m_name; //!< Zone name (a string literal).
+        bool m_active; //!< Tracing was enabled on entry.
+        uint64_t m_begin_ns; //!< When the scope was entered.
+    };
+
+} // namespace TracingLib
+
+#define TRACINGLIB_CONCAT_INNER(a, b) a##b
+#define TRACINGLIB_CONCAT(a, b) TRACINGLIB_CONCAT_INNER(a, b)
+
+//! Records the rest of the enclosing scope as a zone named name (a string literal) when tracing is
+//! compiled in; otherwise nothing.
+#if TRACINGLIB_ENABLED
+#define TRACE_ZONE(name) const TracingLib::TraceZone TRACINGLIB_CONCAT(trace_zone_, __LINE__){name}
+#else
+#define TRACE_ZONE(name) static_assert(true)
+#endif
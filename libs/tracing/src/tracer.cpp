@@ -0,0 +1,220 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "trace/tracer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace TracingLib
+{
+
+    //! Process id every exported event carries (one process per trace).
+    static constexpr uint32_t TRACE_PROCESS_ID = 1;
+
+    //! Bytes reserved in the exported JSON per event.
+    static constexpr std::size_t JSON_BYTES_PER_EVENT = 96;
+
+    namespace
+    {
+
+        //! One thread's zones: written by that thread only, read by the exporter up to count.
+        struct ThreadBuffer {
+            uint32_t thread_id{0}; //!< Exported tid: 1, 2, ... in the order the threads first recorded or were named.
+            std::atomic<const char*> name{nullptr}; //!< See setThreadName() (null: unnamed).
+            std::unique_ptr<TraceEvent[]> events; //!< EVENTS_PER_THREAD slots, allocated on the first zone.
+            std::atomic<std::size_t> count{0}; //!< Events written; the release store publishes them.
+            std::atomic<uint64_t> dropped{0}; //!< Zones that found the buffer full.
+        };
+
+        //! Every thread's buffer and the trace's time origin.
+        struct Registry {
+            std::mutex mutex; //!< Guards buffers (the list, not the buffers' contents).
+            std::vector<std::unique_ptr<ThreadBuffer>> buffers; //!< In creation order; never removed.
+            std::atomic<uint64_t> origin_ns{0}; //!< Time of the first setEnabled(true) (0: none yet).
+        };
+
+        //! The process's registry, created on first use.
+        [[nodiscard]] Registry& registry()
+        {
+            static Registry instance;
+            return instance;
+        }
+
+        thread_local ThreadBuffer* thread_buffer{nullptr}; //!< The calling thread's buffer (null: none yet).
+        thread_local const char* thread_name{nullptr}; //!< The calling thread's setThreadName().
+
+        //! The calling thread's buffer, registered on first use.
+        [[nodiscard]] ThreadBuffer& threadBuffer()
+        {
+            if (thread_buffer == nullptr) {
+                Registry& traces = registry();
+                std::lock_guard<std::mutex> lock(traces.mutex);
+                traces.buffers.push_back(std::make_unique<ThreadBuffer>());
+                thread_buffer = traces.buffers.back().get();
+                thread_buffer->thread_id = static_cast<uint32_t>(traces.buffers.size());
+                thread_buffer->name.store(thread_name, std::memory_order_release);
+            }
+            return *thread_buffer;
+        }
+
+        //! Appends text to out as a JSON string literal.
+        void appendJsonString(std::string& out, const char* text)
+        {
+            static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+            out += '"';
+            for (const char* c = text; *c != '\0'; ++c) {
+                unsigned char byte = static_cast<unsigned char>(*c);
+                if ((byte == '"') || (byte == '\\')) {
+                    out += '\\';
+                    out += *c;
+                } else if (byte < 0x20) {
+                    out += "\\u00";
+                    out += HEX_DIGITS[byte >> 4];
+                    out += HEX_DIGITS[byte & 0xF];
+                } else {
+                    out += *c;
+                }
+            }
+            out += '"';
+        }
+
+        //! Appends a nanosecond count to out in microseconds, with three decimals (exact).
+        void appendMicroseconds(std::string& out, uint64_t ns)
+        {
+            out += std::to_string(ns / 1000);
+            std::string fraction = std::to_string(ns % 1000);
+            out += '.';
+            out.append(3 - fraction.size(), '0');
+            out += fraction;
+        }
+
+    } // namespace
+
+    void setEnabled(bool enabled)
+    {
+        if (enabled) {
+            uint64_t unset{0};
+            (void)registry().origin_ns.compare_exchange_strong(unset, nowNanoseconds(), std::memory_order_relaxed);
+        }
+        Detail::enabled_flag.store(enabled, std::memory_order_relaxed);
+    }
+
+    void setThreadName(const char* name)
+    {
+        thread_name = name;
+        // Untraced threads never register a buffer; threadBuffer() picks the name up later.
+        if ((thread_buffer != nullptr) || enabled()) {
+            threadBuffer().name.store(name, std::memory_order_release);
+        }
+    }
+
+    uint64_t nowNanoseconds()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void record(const char* name, uint64_t begin_ns, uint64_t end_ns)
+    {
+        ThreadBuffer& buffer = threadBuffer();
+        std::size_t index = buffer.count.load(std::memory_order_relaxed);
+        if (index >= EVENTS_PER_THREAD) {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (buffer.events == nullptr) {
+            // Published to the exporter by the count's release store below.
+            buffer.events = std::make_unique<TraceEvent[]>(EVENTS_PER_THREAD);
+        }
+        buffer.events[index] = TraceEvent{name, begin_ns, end_ns};
+        buffer.count.store(index + 1, std::memory_order_release);
+    }
+
+    uint64_t eventsRecorded()
+    {
+        Registry& traces = registry();
+        std::lock_guard<std::mutex> lock(traces.mutex);
+        uint64_t total{0};
+        for (const std::unique_ptr<ThreadBuffer>& buffer : traces.buffers) {
+            total += buffer->count.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    uint64_t eventsDropped()
+    {
+        Registry& traces = registry();
+        std::lock_guard<std::mutex> lock(traces.mutex);
+        uint64_t total{0};
+        for (const std::unique_ptr<ThreadBuffer>& buffer : traces.buffers) {
+            total += buffer->dropped.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    bool writeChromeTrace(const std::string& path, std::string& out_error_message)
+    {
+        Registry& traces = registry();
+        std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        {
+            std::lock_guard<std::mutex> lock(traces.mutex);
+            uint64_t origin_ns = traces.origin_ns.load(std::memory_order_relaxed);
+            bool first = true;
+            for (const std::unique_ptr<ThreadBuffer>& buffer : traces.buffers) {
+                std::string tid = std::to_string(buffer->thread_id);
+                std::string head = "{\"pid\":" + std::to_string(TRACE_PROCESS_ID) + ",\"tid\":" + tid + ",";
+                const char* name = buffer->name.load(std::memory_order_acquire);
+                std::string unnamed = "thread " + tid;
+                json += first ? "\n" : ",\n";
+                first = false;
+                json += head + "\"ph\":\"M\",\"name\":\"thread_name\",\"args\":{\"name\":";
+                appendJsonString(json, (name != nullptr) ? name : unnamed.c_str());
+                json += "}}";
+
+                // Acquire: the events below the count are complete.
+                std::size_t count = buffer->count.load(std::memory_order_acquire);
+                json.reserve(json.size() + count * JSON_BYTES_PER_EVENT);
+                for (std::size_t i = 0; i < count; ++i) {
+                    const TraceEvent& event = buffer->events[i];
+                    uint64_t begin_ns = std::max(event.begin_ns, origin_ns);
+                    json += ",\n" + head + "\"ph\":\"X\",\"name\":";
+                    appendJsonString(json, event.name);
+                    json += ",\"ts\":";
+                    appendMicroseconds(json, begin_ns - origin_ns);
+                    json += ",\"dur\":";
+                    appendMicroseconds(json, std::max(event.end_ns, begin_ns) - begin_ns);
+                    json += '}';
+                }
+            }
+        }
+        json += "\n]}\n";
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            out_error_message = "Cannot open \"" + path + "\" for writing.";
+            return false;
+        }
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+        file.flush();
+        if (!file.good()) {
+            out_error_message = "Failed to write the trace \"" + path + "\".";
+            return false;
+        }
+        return true;
+    }
+
+} // namespace TracingLib
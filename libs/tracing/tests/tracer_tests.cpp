@@ -0,0 +1,149 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "testing/testing.hpp"
+#include <trace/tracer.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+    //! Writes the trace to a temporary file and returns its text (empty on failure).
+    std::string exportedTrace()
+    {
+        std::string path = (std::filesystem::temp_directory_path() / "tracer_tests.json").string();
+        std::string error_message;
+        if (!TracingLib::writeChromeTrace(path, error_message)) {
+            return {};
+        }
+        std::ifstream file(path, std::ios::binary);
+        std::string text{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        file.close();
+        std::filesystem::remove(path);
+        return text;
+    }
+
+} // namespace
+
+TEST_CASE(tracer_records_only_while_enabled)
+{
+    TracingLib::setEnabled(false);
+    uint64_t before = TracingLib::eventsRecorded();
+    {
+        TracingLib::TraceZone zone{"disabled zone"};
+    }
+    TEST_CHECK_EQUAL(TracingLib::eventsRecorded(), before);
+
+    TracingLib::setEnabled(true);
+    {
+        TracingLib::TraceZone zone{"enabled zone"};
+    }
+    TracingLib::setEnabled(false);
+    TEST_CHECK_EQUAL(TracingLib::eventsRecorded(), before + 1);
+}
+
+TEST_CASE(tracer_macro_follows_the_compile_switch)
+{
+    TracingLib::setEnabled(true);
+    uint64_t before = TracingLib::eventsRecorded();
+    {
+        TRACE_ZONE("macro zone");
+    }
+    TracingLib::setEnabled(false);
+    TEST_CHECK_EQUAL(TracingLib::eventsRecorded(), before + (TracingLib::TRACING_COMPILED ? 1 : 0));
+}
+
+TEST_CASE(tracer_threads_record_into_their_own_buffers)
+{
+    static constexpr uint32_t THREADS = 4;
+    static constexpr uint32_t ZONES = 1000;
+    TracingLib::setEnabled(true);
+    uint64_t before = TracingLib::eventsRecorded();
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < THREADS; ++t) {
+        threads.emplace_back([]() {
+            TracingLib::setThreadName("tracer worker");
+            for (uint32_t i = 0; i < ZONES; ++i) {
+                TracingLib::TraceZone zone{"worker zone"};
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    TracingLib::setEnabled(false);
+    TEST_CHECK_EQUAL(TracingLib::eventsRecorded(), before + static_cast<uint64_t>(THREADS) * ZONES);
+}
+
+TEST_CASE(tracer_drops_zones_past_the_buffer)
+{
+    uint64_t dropped = TracingLib::eventsDropped();
+    std::thread worker([]() {
+        for (std::size_t i = 0; i < TracingLib::EVENTS_PER_THREAD + 5; ++i) {
+            TracingLib::record("filler", 1, 2);
+        }
+    });
+    worker.join();
+    TEST_CHECK_EQUAL(TracingLib::eventsDropped(), dropped + 5);
+}
+
+TEST_CASE(tracer_exports_chrome_trace_events)
+{
+    TracingLib::setThreadName("tracer \"main\"");
+    TracingLib::setEnabled(true);
+    uint64_t begin_ns = TracingLib::nowNanoseconds();
+    TracingLib::record("exported zone", begin_ns, begin_ns + 1500);
+    TracingLib::setEnabled(false);
+
+    std::string trace = exportedTrace();
+    TEST_CHECK(trace.starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    TEST_CHECK(trace.ends_with("]}\n"));
+    TEST_CHECK(trace.find("\"ph\":\"M\",\"name\":\"thread_name\",\"args\":{\"name\":\"tracer \\\"main\\\"\"}") != std::string::npos);
+    TEST_CHECK(trace.find("\"name\":\"tracer worker\"") != std::string::npos);
+    TEST_CHECK(trace.find("\"ph\":\"X\",\"name\":\"exported zone\"") != std::string::npos);
+    TEST_CHECK(trace.find("\"dur\":1.500}") != std::string::npos);
+}
+
+TEST_CASE(tracer_names_threads_lazily_while_disabled)
+{
+    TracingLib::setEnabled(false);
+    std::thread idle([]() {
+        TracingLib::setThreadName("idle worker");
+    });
+    idle.join();
+    std::thread late([]() {
+        TracingLib::setThreadName("late worker");
+        TracingLib::setEnabled(true);
+        {
+            TracingLib::TraceZone zone{"late zone"};
+        }
+        TracingLib::setEnabled(false);
+    });
+    late.join();
+
+    std::string trace = exportedTrace();
+    TEST_CHECK(trace.find("\"name\":\"idle worker\"") == std::string::npos);
+    TEST_CHECK(trace.find("\"name\":\"late worker\"") != std::string::npos);
+}
+
+int main()
+{
+    return static_cast<int>(TestingLib::runAll());
+}
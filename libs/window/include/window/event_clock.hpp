@@ -0,0 +1,50 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace WindowLib
+{
+
+    /*!
+        Maps platform event timestamps — 32-bit millisecond counters such as the X server time or
+        Win32 GetMessageTime() — onto std::chrono::steady_clock microseconds, so consumers can
+        place events on the same clock as their frames (WindowEvent::MouseMoveData::time_us).
+
+        The platform clock's offset is estimated from arrivals: an event is never received before
+        it happened, so the smallest (received - timestamp) seen so far bounds the offset most
+        tightly, and each event is placed relative to that bound. An arrival more than RESYNC_US
+        later than the bound predicts (the 32-bit counter wrapping, a server clock change) starts
+        the estimate again.
+    */
+    class EventClock {
+    public:
+        //! How much later than the current estimate an event may arrive before the estimate restarts.
+        static constexpr int64_t RESYNC_US = 1000000;
+
+        //! Current std::chrono::steady_clock time in microseconds.
+        [[nodiscard]] static uint64_t now();
+
+        //! Converts a platform timestamp into steady-clock microseconds, given when the event was
+        //! received (normally now()). The result is never later than received_us.
+        [[nodiscard]] uint64_t toSteady(uint32_t platform_ms, uint64_t received_us);
+
+    private:
+        int64_t m_offset_us{0}; //!< Estimated steady-clock time of platform time 0, in microseconds.
+        bool m_synced{false}; //!< True once m_offset_us holds an estimate.
+    };
+
+} // namespace WindowLib
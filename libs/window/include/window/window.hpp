@@ -16,6 +16,7 @@
 
 #include "window_event.hpp"
 #include <log/logger.hpp>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <queue>
@@ -50,6 +51,10 @@ namespace WindowLib
         //! Blocks until at least one platform event arrives, then drains all pending events.
         virtual void waitEvents() = 0;
 
+        //! Like waitEvents(), but returns after timeout if no event arrives first (at once for a zero
+        //! or negative timeout), so a caller can wait for input and a frame deadline together.
+        virtual void waitEvents(std::chrono::microseconds timeout) = 0;
+
         //! Captures or releases the mouse cursor for FPS-style look.
         //! When captured: cursor is hidden, locked to the window, and deltas are computed from centre.
         //! Must be called from the main (event) thread.
@@ -67,6 +72,11 @@ namespace WindowLib
         //! Returns the platform-native display/instance (HINSTANCE on Win32, xcb_connection_t* on XCB).
         [[nodiscard]] virtual void* nativeDisplay() const = 0;
 
+        //! Returns the file descriptor that becomes readable when events arrive (the X server
+        //! connection on XCB), for callers multiplexing it with their own; -1 where there is none
+        //! (Win32, whose modal loops need the threaded model anyway).
+        [[nodiscard]] virtual int nativeEventFd() const = 0;
+
         //! Polls the next event from the queue (returns false if empty).
         [[nodiscard]] bool pollEvent(WindowEvent& out)
         {
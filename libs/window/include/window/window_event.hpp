@@ -57,6 +57,7 @@ namespace WindowLib
             int32_t y; //!< Cursor y position.
             int32_t dx; //!< Horizontal delta since last event.
             int32_t dy; //!< Vertical delta since last event.
+            uint64_t time_us; //!< When the move happened (not when it was received): std::chrono::steady_clock microseconds.
         };
 
         //! Mouse button event data.
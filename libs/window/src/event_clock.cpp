@@ -0,0 +1,37 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "window/event_clock.hpp"
+#include <chrono>
+
+namespace WindowLib
+{
+
+    uint64_t EventClock::now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    uint64_t EventClock::toSteady(uint32_t platform_ms, uint64_t received_us)
+    {
+        int64_t platform_us = static_cast<int64_t>(platform_ms) * 1000;
+        int64_t offset = static_cast<int64_t>(received_us) - platform_us;
+        if (!m_synced || (offset < m_offset_us) || (offset > (m_offset_us + RESYNC_US))) {
+            m_offset_us = offset;
+            m_synced = true;
+        }
+        return static_cast<uint64_t>(platform_us + m_offset_us);
+    }
+
+} // namespace WindowLib
@@ -15,6 +15,8 @@
 #ifdef _WIN32
 
 #include "win32_window.hpp"
+#include <trace/tracer.hpp>
+#include <array>
 #include <cstdlib>
 
 namespace WindowLib
@@ -112,6 +114,7 @@ namespace WindowLib
 
     void Win32Window::pumpEvents()
     {
+        TRACE_ZONE("window pump");
         MSG msg;
         while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
             TranslateMessage(&msg);
@@ -121,7 +124,21 @@ namespace WindowLib
 
     void Win32Window::waitEvents()
     {
-        WaitMessage();
+        {
+            TRACE_ZONE("window wait");
+            WaitMessage();
+        }
+        pumpEvents();
+    }
+
+    void Win32Window::waitEvents(std::chrono::microseconds timeout)
+    {
+        if (timeout.count() > 0) {
+            // Rounded up, so a short wait still sleeps rather than spinning.
+            DWORD timeout_ms = static_cast<DWORD>((timeout.count() + 999) / 1000);
+            TRACE_ZONE("window wait");
+            MsgWaitForMultipleObjectsEx(0, nullptr, timeout_ms, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+        }
         pumpEvents();
     }
 
@@ -169,6 +186,11 @@ namespace WindowLib
         return static_cast<void*>(m_hinstance);
     }
 
+    int Win32Window::nativeEventFd() const
+    {
+        return -1;
+    }
+
     LRESULT CALLBACK Win32Window::wndProcStatic(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam)
     {
         Win32Window* self{nullptr};
@@ -191,6 +213,7 @@ namespace WindowLib
 
     LRESULT Win32Window::wndProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam)
     {
+        TRACE_ZONE("window message");
         switch (msg) {
         case WM_CLOSE: {
             WindowEvent ev{WindowEvent::Type::Close};
@@ -262,6 +285,7 @@ namespace WindowLib
         case WM_MOUSEMOVE: {
             int32_t x{static_cast<int16_t>(LOWORD(lparam))};
             int32_t y{static_cast<int16_t>(HIWORD(lparam))};
+            uint32_t time_ms{static_cast<uint32_t>(GetMessageTime())};
 
             // Filter the synthetic recentre event. After SetCursorPos in the previous
             // WM_MOUSEMOVE branch (or in setCursorCaptured), the OS dispatches a follow-up
@@ -273,10 +297,19 @@ namespace WindowLib
                 m_warp_pending = false;
                 m_last_mouse_x = x;
                 m_last_mouse_y = y;
+                m_last_move_time_ms = time_ms;
                 m_mouse_tracked = true;
                 return 0;
             }
 
+            // WM_MOUSEMOVE is coalesced: a 1000 Hz mouse leaves only the newest position in the
+            // queue, so a flick between two messages would arrive as one jump. Replay the moves in
+            // between first. Not while captured: those deltas are measured from the recentred
+            // cursor, and the history is of the real one.
+            if (!m_cursor_captured && m_mouse_tracked) {
+                pushCoalescedMoves(hwnd, x, y, time_ms);
+            }
+
             int32_t dx{m_mouse_tracked ? (x - m_last_mouse_x) : 0};
             int32_t dy{m_mouse_tracked ? (y - m_last_mouse_y) : 0};
 
@@ -301,8 +334,10 @@ namespace WindowLib
             ev.mouse_move.y = y;
             ev.mouse_move.dx = dx;
             ev.mouse_move.dy = dy;
+            ev.mouse_move.time_us = m_event_clock.toSteady(time_ms, EventClock::now());
             pushEvent(ev);
 
+            m_last_move_time_ms = time_ms;
             m_mouse_tracked = true;
             return 0;
         }
@@ -345,6 +380,53 @@ namespace WindowLib
         return DefWindowProcW(hwnd, msg, wparam, lparam);
     }
 
+    void Win32Window::pushCoalescedMoves(HWND hwnd, int32_t x, int32_t y, uint32_t time_ms)
+    {
+        // The history is looked up by the current move, in screen coordinates (low 16 bits).
+        POINT screen{x, y};
+        ClientToScreen(hwnd, &screen);
+        MOUSEMOVEPOINT current{};
+        current.x = screen.x & 0xFFFF;
+        current.y = screen.y & 0xFFFF;
+        current.time = time_ms;
+
+        std::array<MOUSEMOVEPOINT, MOUSE_HISTORY_LENGTH> history{};
+        int count = GetMouseMovePointsEx(sizeof(MOUSEMOVEPOINT), &current, history.data(), MOUSE_HISTORY_LENGTH, GMMP_USE_DISPLAY_POINTS);
+        if (count <= 1) {
+            return; // nothing in between, or the move is not in the history (-1)
+        }
+
+        // history[0] is the current move and the rest run newest first: skip back past every
+        // point newer than the last move pushed (same-millisecond points count as pushed).
+        int oldest = 1;
+        while ((oldest < count) && (static_cast<int32_t>(static_cast<uint32_t>(history[oldest].time) - m_last_move_time_ms) > 0)) {
+            ++oldest;
+        }
+
+        uint64_t received_us = EventClock::now();
+        for (int i = oldest - 1; i >= 1; --i) {
+            POINT point{history[i].x, history[i].y};
+            // Display points of monitors left of or above the primary come back as 16-bit wraps.
+            if (point.x > 32767) {
+                point.x -= 65536;
+            }
+            if (point.y > 32767) {
+                point.y -= 65536;
+            }
+            ScreenToClient(hwnd, &point);
+
+            WindowEvent ev{WindowEvent::Type::MouseMove};
+            ev.mouse_move.x = static_cast<int32_t>(point.x);
+            ev.mouse_move.y = static_cast<int32_t>(point.y);
+            ev.mouse_move.dx = ev.mouse_move.x - m_last_mouse_x;
+            ev.mouse_move.dy = ev.mouse_move.y - m_last_mouse_y;
+            ev.mouse_move.time_us = m_event_clock.toSteady(static_cast<uint32_t>(history[i].time), received_us);
+            m_last_mouse_x = ev.mouse_move.x;
+            m_last_mouse_y = ev.mouse_move.y;
+            pushEvent(ev);
+        }
+    }
+
 } // namespace WindowLib
 
 #endif // _WIN32
@@ -15,6 +15,7 @@
 #pragma once
 
 #ifdef _WIN32
+#include "window/event_clock.hpp"
 #include "window/window.hpp"
 // Lean and mean Windows
 #ifndef WIN32_LEAN_AND_MEAN
@@ -43,6 +44,10 @@ namespace WindowLib
         //! Blocks until at least one Win32 message arrives, then drains all pending messages.
         void waitEvents() override;
 
+        //! Waits for a Win32 message for at most timeout (millisecond resolution), then drains all
+        //! pending messages.
+        void waitEvents(std::chrono::microseconds timeout) override;
+
         //! Captures or releases the mouse cursor.
         void setCursorCaptured(bool captured) override;
 
@@ -52,6 +57,9 @@ namespace WindowLib
         //! Returns the HINSTANCE as a void pointer.
         [[nodiscard]] void* nativeDisplay() const override;
 
+        //! Returns -1: Win32 messages arrive on the thread's message queue, not a descriptor.
+        [[nodiscard]] int nativeEventFd() const override;
+
     private:
         //! Static window procedure thunk that forwards to the instance method.
         static LRESULT CALLBACK wndProcStatic(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam);
@@ -59,12 +67,22 @@ namespace WindowLib
         //! Instance window procedure handling Win32 messages.
         LRESULT wndProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam);
 
+        //! Pushes the moves that Windows coalesced away before the WM_MOUSEMOVE at client (x, y),
+        //! time_ms: the system's mouse history (GetMouseMovePointsEx) since the last move pushed,
+        //! oldest first, each with its own timestamp.
+        void pushCoalescedMoves(HWND hwnd, int32_t x, int32_t y, uint32_t time_ms);
+
+        //! Most history points GetMouseMovePointsEx returns.
+        static constexpr int MOUSE_HISTORY_LENGTH = 64;
+
         HWND m_hwnd{nullptr}; //!< Native window handle.
         HINSTANCE m_hinstance{nullptr}; //!< Application instance handle.
 
         int32_t m_last_mouse_x{0}; //!< Last known mouse x for delta computation.
         int32_t m_last_mouse_y{0}; //!< Last known mouse y for delta computation.
         bool m_mouse_tracked{false}; //!< True after the first mouse event has been received.
+        uint32_t m_last_move_time_ms{0}; //!< Message time of the last move pushed (GetTickCount() milliseconds).
+        EventClock m_event_clock; //!< Maps message times onto the steady clock.
         bool m_warp_pending{
             false}; //!< True after a SetCursorPos warp; the next WM_MOUSEMOVE is the synthetic recentre and is consumed without emitting a duplicate event.
 
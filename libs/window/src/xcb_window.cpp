@@ -15,8 +15,11 @@
 #ifdef __linux__
 
 #include "xcb_window.hpp"
+#include <trace/tracer.hpp>
+#include <poll.h>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <string>
 
 //! Looks up or creates an X11 atom by name.
@@ -162,6 +165,7 @@ namespace WindowLib
 
     void XcbWindow::pumpEvents()
     {
+        TRACE_ZONE("window pump");
         xcb_generic_event_t* event;
         while ((event = xcb_poll_for_event(m_connection))) {
             handleEvent(event);
@@ -177,7 +181,11 @@ namespace WindowLib
     void XcbWindow::waitEvents()
     {
         // Block until at least one event arrives
-        xcb_generic_event_t* event{xcb_wait_for_event(m_connection)};
+        xcb_generic_event_t* event{nullptr};
+        {
+            TRACE_ZONE("window wait");
+            event = xcb_wait_for_event(m_connection);
+        }
         if (event) {
             handleEvent(event);
             free(event);
@@ -187,6 +195,30 @@ namespace WindowLib
         pumpEvents();
     }
 
+    void XcbWindow::waitEvents(std::chrono::microseconds timeout)
+    {
+        // Events XCB has already read off the socket would not make the fd readable, so take
+        // those first; and flush, so requests (a pointer warp) are not held back while we sleep.
+        xcb_generic_event_t* event{xcb_poll_for_event(m_connection)};
+        if (!event && (timeout.count() > 0)) {
+            xcb_flush(m_connection);
+            pollfd fd{xcb_get_file_descriptor(m_connection), POLLIN, 0};
+            std::chrono::seconds seconds{std::chrono::duration_cast<std::chrono::seconds>(timeout)};
+            timespec wait{static_cast<time_t>(seconds.count()), static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - seconds).count())};
+            // ppoll() rather than poll(): a frame deadline wants better than millisecond resolution.
+            TRACE_ZONE("window wait");
+            if (ppoll(&fd, 1, &wait, nullptr) > 0) {
+                event = xcb_poll_for_event(m_connection);
+            }
+        }
+        if (event) {
+            handleEvent(event);
+            free(event);
+        }
+
+        pumpEvents();
+    }
+
     void XcbWindow::setCursorCaptured(bool captured)
     {
         // Idempotent guard — repeated calls with the same value are no-ops. Without this,
@@ -268,6 +300,7 @@ namespace WindowLib
 
     void XcbWindow::handleEvent(xcb_generic_event_t* event)
     {
+        TRACE_ZONE("window event");
         uint8_t event_type{static_cast<uint8_t>(event->response_type & 0x7F)};
 
         switch (event_type) {
@@ -357,11 +390,14 @@ namespace WindowLib
                 m_last_mouse_y = y;
             }
 
+            // The server stamps each motion when it happens, and core motion events are not
+            // coalesced, so a batch read late still carries the real spacing of the moves.
             WindowEvent ev{WindowEvent::Type::MouseMove};
             ev.mouse_move.x = x;
             ev.mouse_move.y = y;
             ev.mouse_move.dx = dx;
             ev.mouse_move.dy = dy;
+            ev.mouse_move.time_us = m_event_clock.toSteady(mn->time, EventClock::now());
             pushEvent(ev);
 
             m_mouse_tracked = true;
@@ -418,6 +454,11 @@ namespace WindowLib
         return static_cast<void*>(m_connection);
     }
 
+    int XcbWindow::nativeEventFd() const
+    {
+        return xcb_get_file_descriptor(m_connection);
+    }
+
 } // namespace WindowLib
 
 #endif // __linux__
@@ -16,6 +16,7 @@
 
 #ifdef __linux__
 
+#include "window/event_clock.hpp"
 #include "window/window.hpp"
 #include <xcb/xcb.h>
 
@@ -37,6 +38,9 @@ namespace WindowLib
         //! Blocks until at least one XCB event arrives, then drains all pending events.
         void waitEvents() override;
 
+        //! Waits on the connection fd for at most timeout, then drains all pending events.
+        void waitEvents(std::chrono::microseconds timeout) override;
+
         //! Captures or releases the mouse cursor.
         void setCursorCaptured(bool captured) override;
 
@@ -46,6 +50,9 @@ namespace WindowLib
         //! Returns the xcb_connection_t* as a void pointer.
         [[nodiscard]] void* nativeDisplay() const override;
 
+        //! Returns the X server connection's file descriptor.
+        [[nodiscard]] int nativeEventFd() const override;
+
     private:
         //! Dispatches a single XCB event into the event queue.
         void handleEvent(xcb_generic_event_t* event);
@@ -63,6 +70,8 @@ namespace WindowLib
         bool m_warp_pending{
             false}; //!< True after an xcb_warp_pointer; the next XCB_MOTION_NOTIFY is the synthetic recentre and is consumed without emitting a duplicate event.
 
+        EventClock m_event_clock; //!< Maps X server timestamps (milliseconds) onto the steady clock.
+
         xcb_cursor_t m_invisible_cursor{
             0}; //!< Invisible cursor used during pointer capture; lives for the duration of the grab so the X server can dereference it on demand.
     };
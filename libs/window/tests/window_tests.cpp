@@ -12,10 +12,11 @@
     GNU General Public License for more details.
 */
 
-// Tests exercise only the platform-neutral WindowEvent POD — no live window or display
-// connection is created, so these run headless in CI.
+// Tests exercise only the platform-neutral WindowEvent POD and EventClock — no live window or
+// display connection is created, so these run headless in CI.
 
 #include "testing/testing.hpp"
+#include <window/event_clock.hpp>
 #include <window/window_event.hpp>
 
 using WindowLib::WindowEvent;
@@ -48,10 +49,44 @@ TEST_CASE(event_mouse_move_data)
     ev.mouse_move.y = 20;
     ev.mouse_move.dx = -3;
     ev.mouse_move.dy = 4;
+    ev.mouse_move.time_us = 123456;
     TEST_CHECK_EQUAL(ev.mouse_move.x, 10);
     TEST_CHECK_EQUAL(ev.mouse_move.y, 20);
     TEST_CHECK_EQUAL(ev.mouse_move.dx, -3);
     TEST_CHECK_EQUAL(ev.mouse_move.dy, 4);
+    TEST_CHECK_EQUAL(ev.mouse_move.time_us, static_cast<uint64_t>(123456));
+}
+
+TEST_CASE(event_clock_keeps_platform_spacing)
+{
+    // After one prompt arrival, three moves 1 ms apart read together 3 ms late keep their spacing
+    // and their real times.
+    WindowLib::EventClock clock;
+    TEST_CHECK_EQUAL(clock.toSteady(999, 9'999'500), static_cast<uint64_t>(9'999'500));
+    uint64_t a = clock.toSteady(1000, 10'005'000);
+    uint64_t b = clock.toSteady(1001, 10'005'000);
+    uint64_t c = clock.toSteady(1002, 10'005'000);
+    TEST_CHECK_EQUAL(a, static_cast<uint64_t>(10'000'500));
+    TEST_CHECK_EQUAL(b - a, static_cast<uint64_t>(1000));
+    TEST_CHECK_EQUAL(c - b, static_cast<uint64_t>(1000));
+}
+
+TEST_CASE(event_clock_tightens_on_a_faster_arrival)
+{
+    WindowLib::EventClock clock;
+    TEST_CHECK_EQUAL(clock.toSteady(1000, 10'008'000), static_cast<uint64_t>(10'008'000));
+    // This one arrived only 1 ms after it happened, so the first had waited 7 ms longer.
+    TEST_CHECK_EQUAL(clock.toSteady(1010, 10'011'000), static_cast<uint64_t>(10'011'000));
+    TEST_CHECK_EQUAL(clock.toSteady(1000, 10'012'000), static_cast<uint64_t>(10'001'000));
+}
+
+TEST_CASE(event_clock_resyncs_after_a_wrap)
+{
+    WindowLib::EventClock clock;
+    TEST_CHECK_EQUAL(clock.toSteady(0xFFFFFFF0u, 50'000'000), static_cast<uint64_t>(50'000'000));
+    // The 32-bit counter wraps 16 ms later: far off the estimate, so it starts again.
+    TEST_CHECK_EQUAL(clock.toSteady(0, 50'016'000), static_cast<uint64_t>(50'016'000));
+    TEST_CHECK_EQUAL(clock.toSteady(4, 50'021'000), static_cast<uint64_t>(50'020'000));
 }
 
 int main()
@@ -13,21 +13,207 @@
 */
 
 #include "allocator.hpp"
+#include <trace/tracer.hpp>
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <sstream>
 
 namespace Engine
 {
 
+    //! The legacy PCI BAR window: host-visible device-local heaps this small (or smaller) are not
+    //! treated as ReBAR — they are too scarce to hold the simulation state.
+    static constexpr VkDeviceSize LEGACY_BAR_SIZE = 256ull * 1024ull * 1024ull;
+
+    //! Scans the memory types for a host-visible device-local type on a heap larger than the
+    //! legacy BAR window (resizable BAR), or a device whose every device-local heap is
+    //! host-visible (UMA / integrated).
+    [[nodiscard]] static bool detectHostVisibleDeviceLocal(const VkPhysicalDeviceMemoryProperties& properties)
+    {
+        VkMemoryPropertyFlags wanted = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+        for (uint32_t i = 0; i < properties.memoryTypeCount; ++i) {
+            const VkMemoryType& type = properties.memoryTypes[i];
+            if (((type.propertyFlags & wanted) == wanted) && (properties.memoryHeaps[type.heapIndex].size > LEGACY_BAR_SIZE)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //! Shares a buffer concurrently between the given queue families (more than one), or leaves
+    //! it exclusive.
+    static void setSharing(VkBufferCreateInfo& buffer_info, std::span<const uint32_t> queue_families)
+    {
+        if (queue_families.size() > 1) {
+            buffer_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            buffer_info.queueFamilyIndexCount = static_cast<uint32_t>(queue_families.size());
+            buffer_info.pQueueFamilyIndices = queue_families.data();
+        } else {
+            buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        }
+    }
+
+    HeapBudget MemoryBudget::deviceLocal() const
+    {
+        HeapBudget total{};
+        bool any_device_local{false};
+        for (uint32_t i = 0; i < heap_count; ++i) {
+            any_device_local = any_device_local || heaps[i].device_local;
+        }
+        for (uint32_t i = 0; i < heap_count; ++i) {
+            const HeapBudget& heap = heaps[i];
+            if (heap.device_local || !any_device_local) {
+                total.usage += heap.usage;
+                total.budget += heap.budget;
+                total.allocation_bytes += heap.allocation_bytes;
+                total.block_bytes += heap.block_bytes;
+                total.allocation_count += heap.allocation_count;
+                total.block_count += heap.block_count;
+            }
+        }
+        total.device_local = any_device_local;
+        return total;
+    }
+
+    std::string MemoryBudget::summary() const
+    {
+        std::ostringstream out;
+        out.setf(std::ios::fixed);
+        out.precision(1);
+        out << "Memory budget (" << (from_extension ? "VK_EXT_memory_budget" : "estimated, no VK_EXT_memory_budget") << "):";
+        for (uint32_t i = 0; i < heap_count; ++i) {
+            const HeapBudget& heap = heaps[i];
+            out << "\n  heap " << i << " (" << (heap.device_local ? "device-local" : "host") << "): " << (static_cast<double>(heap.usage) / BYTES_PER_MIB) << " / "
+                << (static_cast<double>(heap.budget) / BYTES_PER_MIB) << " MiB used, " << (static_cast<double>(heap.block_bytes) / BYTES_PER_MIB) << " MiB in "
+                << heap.block_count << " blocks, " << heap.allocation_count << " allocations";
+        }
+        return out.str();
+    }
+
+    bool ArenaRegions::reset(VkDeviceSize bytes_per_frame, uint32_t frame_count)
+    {
+        clear();
+        if (frame_count == 0) {
+            return false;
+        }
+        m_region_size = alignUp(bytes_per_frame, REGION_ALIGNMENT);
+        m_frame_count = frame_count;
+        return true;
+    }
+
+    void ArenaRegions::clear()
+    {
+        m_region_size = 0;
+        m_region_start = 0;
+        m_head = 0;
+        m_peak = 0;
+        m_frame_count = 0;
+    }
+
+    void ArenaRegions::beginFrame(uint32_t frame)
+    {
+        if (m_frame_count == 0) {
+            return;
+        }
+        m_region_start = static_cast<VkDeviceSize>(frame % m_frame_count) * m_region_size;
+        m_head = 0;
+    }
+
+    bool ArenaRegions::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& out_offset)
+    {
+        VkDeviceSize offset = alignUp(m_head, alignment);
+        // Compared as a remainder so a huge size cannot wrap the sum around.
+        if ((offset > m_region_size) || (size > (m_region_size - offset))) {
+            return false;
+        }
+        m_head = offset + size;
+        m_peak = std::max(m_peak, m_head);
+        out_offset = m_region_start + offset;
+        return true;
+    }
+
+    bool FrameArena::create(const Allocator& allocator, VkDeviceSize bytes_per_frame, uint32_t frame_count, VkBufferUsageFlags buffer_usage, Direction direction,
+        std::span<const uint32_t> queue_families)
+    {
+        destroy();
+        if (!m_regions.reset(bytes_per_frame, frame_count)) {
+            return false;
+        }
+        m_allocator = &allocator;
+
+        // Write-combined memory for uploads; readbacks need host-cached memory, or every read
+        // of the results crosses the bus uncached.
+        VmaAllocationCreateFlags alloc_flags = VMA_ALLOCATION_CREATE_MAPPED_BIT
+            | ((direction == Direction::Upload) ? VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT : VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT);
+        m_buffer = allocator.createBuffer(m_regions.totalBytes(), buffer_usage, alloc_flags, VMA_MEMORY_USAGE_AUTO, queue_families);
+        m_mapped = static_cast<uint8_t*>(m_buffer.allocationInfo().pMappedData);
+        return true;
+    }
+
+    void FrameArena::destroy()
+    {
+        m_buffer = AllocatedBuffer();
+        m_mapped = nullptr;
+        m_allocator = nullptr;
+        m_regions.clear();
+    }
+
+    ArenaAllocation FrameArena::allocate(VkDeviceSize size, VkDeviceSize alignment)
+    {
+        ArenaAllocation allocation{};
+        VkDeviceSize offset{0};
+        if ((m_mapped == nullptr) || !m_regions.allocate(size, alignment, offset)) {
+            return allocation;
+        }
+        allocation.buffer = m_buffer.buffer();
+        allocation.offset = offset;
+        allocation.size = size;
+        allocation.mapped = m_mapped + offset;
+        return allocation;
+    }
+
+    void FrameArena::flush() const
+    {
+        syncRange(true, m_regions.regionStart(), m_regions.usedBytes());
+    }
+
+    void FrameArena::invalidate() const
+    {
+        syncRange(false, m_regions.regionStart(), m_regions.usedBytes());
+    }
+
+    void FrameArena::invalidate(const ArenaAllocation& allocation) const
+    {
+        syncRange(false, allocation.offset, allocation.size);
+    }
+
+    void FrameArena::syncRange(bool flush, VkDeviceSize offset, VkDeviceSize size) const
+    {
+        if ((size == 0) || (m_allocator == nullptr)) {
+            return;
+        }
+        VkResult result = flush ? vmaFlushAllocation(m_allocator->handle(), m_buffer.allocation(), offset, size)
+                                : vmaInvalidateAllocation(m_allocator->handle(), m_buffer.allocation(), offset, size);
+        if (result != VK_SUCCESS) {
+            m_allocator->reportMappedError(flush ? "flush" : "invalidate", result);
+        }
+    }
+
     Allocator::~Allocator()
     {
         destroy();
     }
 
-    bool Allocator::init(VkInstance instance, VkPhysicalDevice physical_device, VkDevice device, LoggingLib::Logger& logger, std::string& out_error_message)
+    bool Allocator::init(VkInstance instance, VkPhysicalDevice physical_device, VkDevice device, bool memory_budget, LoggingLib::Logger& logger,
+        std::string& out_error_message)
     {
+        TRACE_ZONE("Allocator::init");
         m_logger = &logger;
+        m_memory_budget = memory_budget;
 
         VmaAllocatorCreateInfo alloc_info{};
+        alloc_info.flags = memory_budget ? VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT : 0;
         alloc_info.instance = instance;
         alloc_info.physicalDevice = physical_device;
         alloc_info.device = device;
@@ -49,7 +235,12 @@ namespace Engine
             return false;
         }
 
-        m_logger->logInfo("VMA allocator created.");
+        const VkPhysicalDeviceMemoryProperties* memory_properties{nullptr};
+        vmaGetMemoryProperties(m_allocator, &memory_properties);
+        m_host_visible_device_local = detectHostVisibleDeviceLocal(*memory_properties);
+
+        m_logger->logInfo(m_host_visible_device_local ? "VMA allocator created (host-visible device-local memory available: ReBAR/UMA, direct mapping)."
+                                                      : "VMA allocator created (no ReBAR/UMA: device-local buffers are seeded through staging).");
         return true;
     }
 
@@ -64,13 +255,14 @@ namespace Engine
         }
     }
 
-    AllocatedBuffer Allocator::createBuffer(VkDeviceSize size, VkBufferUsageFlags buffer_usage, VmaAllocationCreateFlags alloc_flags, VmaMemoryUsage memory_usage) const
+    AllocatedBuffer Allocator::createBuffer(VkDeviceSize size, VkBufferUsageFlags buffer_usage, VmaAllocationCreateFlags alloc_flags, VmaMemoryUsage memory_usage,
+        std::span<const uint32_t> queue_families) const
     {
         VkBufferCreateInfo buffer_info{};
         buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         buffer_info.size = size;
         buffer_info.usage = buffer_usage;
-        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        setSharing(buffer_info, queue_families);
 
         VmaAllocationCreateInfo alloc_create_info{};
         alloc_create_info.usage = memory_usage;
@@ -90,6 +282,207 @@ namespace Engine
         return AllocatedBuffer(m_allocator, buffer, allocation);
     }
 
+    AllocatedBuffer Allocator::createDeviceLocalBuffer(VkDeviceSize size, VkBufferUsageFlags buffer_usage, std::span<const uint32_t> queue_families) const
+    {
+        if (m_host_visible_device_local) {
+            VkBufferCreateInfo buffer_info{};
+            buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            buffer_info.size = size;
+            buffer_info.usage = buffer_usage;
+            setSharing(buffer_info, queue_families);
+
+            // Require DEVICE_LOCAL so VMA cannot fall back to plain system memory, and
+            // HOST_VISIBLE so the mapping is direct (no staging).
+            VmaAllocationCreateInfo alloc_create_info{};
+            alloc_create_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+            alloc_create_info.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+            alloc_create_info.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+            VkBuffer buffer{VK_NULL_HANDLE};
+            VmaAllocation allocation{VK_NULL_HANDLE};
+            VkResult result = vmaCreateBuffer(m_allocator, &buffer_info, &alloc_create_info, &buffer, &allocation, nullptr);
+            if (result == VK_SUCCESS) {
+                return AllocatedBuffer(m_allocator, buffer, allocation);
+            }
+            // The ReBAR heap can still run out; fall through to the GPU-only path.
+        }
+
+        return createBuffer(size, buffer_usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, 0, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, queue_families);
+    }
+
+    AllocatedBuffer Allocator::createCoherentBuffer(VkDeviceSize size, VkBufferUsageFlags buffer_usage, std::span<const uint32_t> queue_families) const
+    {
+        VkBufferCreateInfo buffer_info{};
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = size;
+        buffer_info.usage = buffer_usage;
+        setSharing(buffer_info, queue_families);
+
+        // Every implementation has a HOST_VISIBLE | HOST_COHERENT memory type, so this only fails
+        // when memory runs out.
+        VmaAllocationCreateInfo alloc_create_info{};
+        alloc_create_info.usage = VMA_MEMORY_USAGE_AUTO;
+        alloc_create_info.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+        alloc_create_info.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+        VkBuffer buffer{VK_NULL_HANDLE};
+        VmaAllocation allocation{VK_NULL_HANDLE};
+        VkResult result = vmaCreateBuffer(m_allocator, &buffer_info, &alloc_create_info, &buffer, &allocation, nullptr);
+        if (result != VK_SUCCESS) {
+            if (m_logger) {
+                m_logger->logFatal("Failed to create coherent VMA buffer. VK error:" + std::to_string(result) + ".");
+            }
+            std::abort();
+        }
+
+        return AllocatedBuffer(m_allocator, buffer, allocation);
+    }
+
+    void Allocator::setCurrentFrame(uint64_t frame)
+    {
+        if (m_allocator != VK_NULL_HANDLE) {
+            vmaSetCurrentFrameIndex(m_allocator, static_cast<uint32_t>(frame));
+        }
+    }
+
+    AllocatedPool Allocator::createBufferPool(VkDeviceSize block_size, VkBufferUsageFlags buffer_usage, VmaAllocationCreateFlags alloc_flags,
+        VmaMemoryUsage memory_usage, std::span<const uint32_t> queue_families, std::size_t max_block_count) const
+    {
+        // The memory type a representative buffer of this kind would get; the size does not matter.
+        VkBufferCreateInfo buffer_info{};
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = 1024;
+        buffer_info.usage = buffer_usage;
+        setSharing(buffer_info, queue_families);
+
+        VmaAllocationCreateInfo alloc_create_info{};
+        alloc_create_info.usage = memory_usage;
+        alloc_create_info.flags = alloc_flags;
+
+        VmaPoolCreateInfo pool_info{};
+        VkResult result = vmaFindMemoryTypeIndexForBufferInfo(m_allocator, &buffer_info, &alloc_create_info, &pool_info.memoryTypeIndex);
+        if (result == VK_SUCCESS) {
+            pool_info.blockSize = block_size;
+            pool_info.maxBlockCount = max_block_count;
+            VmaPool pool{VK_NULL_HANDLE};
+            result = vmaCreatePool(m_allocator, &pool_info, &pool);
+            if (result == VK_SUCCESS) {
+                return AllocatedPool(m_allocator, pool, buffer_usage, alloc_flags, queue_families);
+            }
+        }
+        if (m_logger) {
+            m_logger->logFatal("Failed to create VMA buffer pool. VK error:" + std::to_string(result) + ".");
+        }
+        std::abort();
+    }
+
+    AllocatedBuffer Allocator::createPooledBuffer(const AllocatedPool& pool, VkDeviceSize size) const
+    {
+        VkBufferCreateInfo buffer_info{};
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = size;
+        buffer_info.usage = pool.bufferUsage();
+        setSharing(buffer_info, pool.queueFamilies());
+
+        // The pool fixes the memory type (VMA ignores usage and the memory flags with a pool).
+        VmaAllocationCreateInfo alloc_create_info{};
+        alloc_create_info.flags = pool.allocationFlags();
+        alloc_create_info.pool = pool.pool();
+
+        VkBuffer buffer{VK_NULL_HANDLE};
+        VmaAllocation allocation{VK_NULL_HANDLE};
+        VkResult result = vmaCreateBuffer(m_allocator, &buffer_info, &alloc_create_info, &buffer, &allocation, nullptr);
+        if (result != VK_SUCCESS) {
+            if (m_logger) {
+                m_logger->logFatal("Failed to create pooled VMA buffer. VK error:" + std::to_string(result) + ".");
+            }
+            std::abort();
+        }
+
+        return AllocatedBuffer(m_allocator, buffer, allocation);
+    }
+
+    MemoryBudget Allocator::memoryBudget() const
+    {
+        MemoryBudget result{};
+        if (m_allocator == VK_NULL_HANDLE) {
+            return result;
+        }
+        const VkPhysicalDeviceMemoryProperties* memory_properties{nullptr};
+        vmaGetMemoryProperties(m_allocator, &memory_properties);
+        std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+        vmaGetHeapBudgets(m_allocator, budgets.data());
+
+        result.heap_count = memory_properties->memoryHeapCount;
+        result.from_extension = m_memory_budget;
+        for (uint32_t i = 0; i < result.heap_count; ++i) {
+            HeapBudget& heap = result.heaps[i];
+            heap.usage = budgets[i].usage;
+            heap.budget = budgets[i].budget;
+            heap.allocation_bytes = budgets[i].statistics.allocationBytes;
+            heap.block_bytes = budgets[i].statistics.blockBytes;
+            heap.allocation_count = budgets[i].statistics.allocationCount;
+            heap.block_count = budgets[i].statistics.blockCount;
+            heap.device_local = (memory_properties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        }
+        return result;
+    }
+
+    void Allocator::reportMappedError(const char* operation, VkResult result) const
+    {
+        if (m_logger) {
+            LOG_THROTTLED(*m_logger, Error, "Failed to {} a mapped VMA allocation. VK error:{}.", operation, result);
+        }
+    }
+
+    void Allocator::writeMapped(const AllocatedBuffer& buffer, const void* data, VkDeviceSize size) const
+    {
+        std::memcpy(buffer.allocationInfo().pMappedData, data, static_cast<size_t>(size));
+        // A no-op on HOST_COHERENT memory; required on the rest.
+        VkResult result = vmaFlushAllocation(m_allocator, buffer.allocation(), 0, size);
+        if (result != VK_SUCCESS) {
+            reportMappedError("flush", result);
+        }
+    }
+
+    void Allocator::invalidateMapped(const AllocatedBuffer& buffer, VkDeviceSize size) const
+    {
+        // A no-op on HOST_COHERENT memory; required on the rest.
+        VkResult result = vmaInvalidateAllocation(m_allocator, buffer.allocation(), 0, size);
+        if (result != VK_SUCCESS) {
+            reportMappedError("invalidate", result);
+        }
+    }
+
+    void Allocator::readMapped(const AllocatedBuffer& buffer, void* out_data, VkDeviceSize size) const
+    {
+        invalidateMapped(buffer, size);
+        std::memcpy(out_data, buffer.allocationInfo().pMappedData, static_cast<size_t>(size));
+    }
+
+    std::string Allocator::describeMemory(const AllocatedBuffer& buffer) const
+    {
+        const VkPhysicalDeviceMemoryProperties* memory_properties{nullptr};
+        vmaGetMemoryProperties(m_allocator, &memory_properties);
+        uint32_t type_index = buffer.allocationInfo().memoryType;
+        const VkMemoryType& type = memory_properties->memoryTypes[type_index];
+
+        std::string flags;
+        auto append = [&flags, &type](VkMemoryPropertyFlagBits bit, const char* name) {
+            if (type.propertyFlags & bit) {
+                flags += (flags.empty() ? "" : " | ");
+                flags += name;
+            }
+        };
+        append(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, "DEVICE_LOCAL");
+        append(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, "HOST_VISIBLE");
+        append(VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, "HOST_COHERENT");
+        append(VK_MEMORY_PROPERTY_HOST_CACHED_BIT, "HOST_CACHED");
+        append(VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, "LAZILY_ALLOCATED");
+
+        return "memory type " + std::to_string(type_index) + " (" + (flags.empty() ? "no flags" : flags) + "), heap " + std::to_string(type.heapIndex);
+    }
+
     AllocatedImage Allocator::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, VkSampleCountFlagBits sample_count,
         uint32_t mip_levels) const
     {
@@ -44,8 +44,11 @@
 #endif
 
 #include <log/logger.hpp>
+#include <array>
 #include <cstdint>
+#include <span>
 #include <string>
+#include <vector>
 
 namespace Engine
 {
@@ -188,6 +191,284 @@ namespace Engine
         VmaAllocation m_allocation{VK_NULL_HANDLE}; //!< Owned allocation handle.
     };
 
+    //! RAII wrapper for a custom VMA pool (move-only): a set of memory blocks of one memory type
+    //! that buffers of one kind are sub-allocated from (see Allocator::createBufferPool()).
+    class AllocatedPool {
+    public:
+        //! Constructs an empty (null) pool — usable as a default-initialised member.
+        AllocatedPool() = default;
+
+        //! Takes ownership of a VMA pool whose buffers get this usage, allocation flags and
+        //! sharing (as for Allocator::createBuffer()).
+        AllocatedPool(VmaAllocator allocator, VmaPool pool, VkBufferUsageFlags buffer_usage, VmaAllocationCreateFlags alloc_flags, std::span<const uint32_t> queue_families) :
+            m_allocator(allocator),
+            m_pool(pool),
+            m_buffer_usage(buffer_usage),
+            m_alloc_flags(alloc_flags),
+            m_queue_families(queue_families.begin(), queue_families.end())
+        {
+        }
+
+        ~AllocatedPool()
+        {
+            if (m_pool != VK_NULL_HANDLE) {
+                vmaDestroyPool(m_allocator, m_pool);
+            }
+        }
+
+        AllocatedPool(const AllocatedPool&) = delete;
+        AllocatedPool& operator=(const AllocatedPool&) = delete;
+
+        AllocatedPool(AllocatedPool&& other) noexcept :
+            m_allocator(other.m_allocator),
+            m_pool(other.m_pool),
+            m_buffer_usage(other.m_buffer_usage),
+            m_alloc_flags(other.m_alloc_flags),
+            m_queue_families(std::move(other.m_queue_families))
+        {
+            other.m_allocator = VK_NULL_HANDLE;
+            other.m_pool = VK_NULL_HANDLE;
+        }
+
+        AllocatedPool& operator=(AllocatedPool&& other) noexcept
+        {
+            if (this != &other) {
+                if (m_pool != VK_NULL_HANDLE) {
+                    vmaDestroyPool(m_allocator, m_pool);
+                }
+                m_allocator = other.m_allocator;
+                m_pool = other.m_pool;
+                m_buffer_usage = other.m_buffer_usage;
+                m_alloc_flags = other.m_alloc_flags;
+                m_queue_families = std::move(other.m_queue_families);
+                other.m_allocator = VK_NULL_HANDLE;
+                other.m_pool = VK_NULL_HANDLE;
+            }
+            return *this;
+        }
+
+        //! Raw VmaPool handle.
+        [[nodiscard]] VmaPool pool() const
+        {
+            return m_pool;
+        }
+
+        //! Usage of the pool's buffers.
+        [[nodiscard]] VkBufferUsageFlags bufferUsage() const
+        {
+            return m_buffer_usage;
+        }
+
+        //! Allocation flags of the pool's buffers.
+        [[nodiscard]] VmaAllocationCreateFlags allocationFlags() const
+        {
+            return m_alloc_flags;
+        }
+
+        //! Queue families the pool's buffers are shared between (empty or one: exclusive).
+        [[nodiscard]] std::span<const uint32_t> queueFamilies() const
+        {
+            return m_queue_families;
+        }
+
+    private:
+        VmaAllocator m_allocator{VK_NULL_HANDLE}; //!< Non-owning reference to the parent allocator.
+        VmaPool m_pool{VK_NULL_HANDLE}; //!< Owned pool handle.
+        VkBufferUsageFlags m_buffer_usage{0}; //!< See bufferUsage().
+        VmaAllocationCreateFlags m_alloc_flags{0}; //!< See allocationFlags().
+        std::vector<uint32_t> m_queue_families; //!< See queueFamilies().
+    };
+
+    //! One memory heap's share of the device memory, as Allocator::memoryBudget() reports it.
+    struct HeapBudget {
+        VkDeviceSize usage{0}; //!< Bytes the process uses on the heap (estimated from block_bytes without VK_EXT_memory_budget).
+        VkDeviceSize budget{0}; //!< Bytes the process can use before allocations may fail or thrash (80 % of the heap without the extension).
+        VkDeviceSize allocation_bytes{0}; //!< Bytes in live VMA allocations.
+        VkDeviceSize block_bytes{0}; //!< Bytes in VMA's device memory blocks (allocations plus free ranges).
+        uint32_t allocation_count{0}; //!< Live VMA allocations.
+        uint32_t block_count{0}; //!< Device memory blocks (vkAllocateMemory calls) VMA holds.
+        bool device_local{false}; //!< The heap is VK_MEMORY_HEAP_DEVICE_LOCAL_BIT (video memory).
+    };
+
+    //! Per-heap usage and budget of the device memory, a snapshot (see Allocator::memoryBudget()).
+    struct MemoryBudget {
+        //! Bytes in a mebibyte, the unit the budget is logged in.
+        static constexpr double BYTES_PER_MIB = 1024.0 * 1024.0;
+
+        std::array<HeapBudget, VK_MAX_MEMORY_HEAPS> heaps{}; //!< The first heap_count are meaningful.
+        uint32_t heap_count{0}; //!< Memory heaps of the device.
+        bool from_extension{false}; //!< usage and budget come from VK_EXT_memory_budget (the driver), not VMA's estimate.
+
+        //! Usage and budget summed over the device-local heaps (all heaps when none is).
+        [[nodiscard]] HeapBudget deviceLocal() const;
+
+        //! One line per heap, e.g. "heap 0 (device-local): 112.0 / 6553.6 MiB used, 96.0 MiB in 3 blocks, 10 allocations".
+        [[nodiscard]] std::string summary() const;
+    };
+
+    class Allocator;
+
+    /*!
+        The bookkeeping behind FrameArena, apart from any device memory: frame_count regions of
+        one aligned size laid end to end, the current one carved front to back. Its offsets are
+        relative to the start of the first region.
+    */
+    class ArenaRegions {
+    public:
+        //! Regions start on this boundary: the largest minimum offset alignment (uniform,
+        //! storage, texel) Vulkan allows, so any sub-allocation alignment up to it holds.
+        static constexpr VkDeviceSize REGION_ALIGNMENT = 256;
+
+        //! Rounds value up to a multiple of alignment (a power of two).
+        [[nodiscard]] static constexpr VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        //! Lays out frame_count regions of bytes_per_frame (rounded up to REGION_ALIGNMENT) and
+        //! starts on the first. Returns false, leaving no regions, when frame_count is 0.
+        [[nodiscard]] bool reset(VkDeviceSize bytes_per_frame, uint32_t frame_count);
+
+        //! Drops the regions: beginFrame() is then a no-op and allocate() fails.
+        void clear();
+
+        //! Starts carving region frame % frameCount() from its start (a no-op without regions).
+        void beginFrame(uint32_t frame);
+
+        //! Carves size bytes at alignment (a power of two) from the current region into
+        //! out_offset. Returns false, leaving the region as it was, when they do not fit.
+        [[nodiscard]] bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& out_offset);
+
+        //! Offset of the current region.
+        [[nodiscard]] VkDeviceSize regionStart() const
+        {
+            return m_region_start;
+        }
+
+        //! Bytes carved from the current region so far (padding included); the range
+        //! [regionStart(), regionStart() + usedBytes()) is what a flush or invalidate covers.
+        [[nodiscard]] VkDeviceSize usedBytes() const
+        {
+            return m_head;
+        }
+
+        //! Bytes per region.
+        [[nodiscard]] VkDeviceSize capacity() const
+        {
+            return m_region_size;
+        }
+
+        //! Most bytes any region has had carved from it since reset().
+        [[nodiscard]] VkDeviceSize peakBytes() const
+        {
+            return m_peak;
+        }
+
+        //! Regions laid out (0 before reset() and after clear()).
+        [[nodiscard]] uint32_t frameCount() const
+        {
+            return m_frame_count;
+        }
+
+        //! Bytes all regions span.
+        [[nodiscard]] VkDeviceSize totalBytes() const
+        {
+            return m_region_size * m_frame_count;
+        }
+
+    private:
+        VkDeviceSize m_region_size{0}; //!< See capacity().
+        VkDeviceSize m_region_start{0}; //!< See regionStart().
+        VkDeviceSize m_head{0}; //!< See usedBytes().
+        VkDeviceSize m_peak{0}; //!< See peakBytes().
+        uint32_t m_frame_count{0}; //!< See frameCount().
+    };
+
+    //! Where FrameArena::allocate() placed a sub-allocation: mapped is null when the frame's
+    //! region had no room left.
+    struct ArenaAllocation {
+        VkBuffer buffer{VK_NULL_HANDLE}; //!< The arena's buffer.
+        VkDeviceSize offset{0}; //!< Offset of the sub-allocation in buffer (bytes).
+        VkDeviceSize size{0}; //!< Bytes requested.
+        void* mapped{nullptr}; //!< Host pointer to the sub-allocation.
+    };
+
+    /*!
+        A linear allocator for the transient uploads and readbacks of frames in flight: one
+        persistently mapped buffer split into a region per frame in flight, each carved front to
+        back by allocate() and reset by beginFrame() once the GPU is done with that frame (its
+        fence has signalled). Allocation is a bump of an offset — no VMA call, no lock — so it
+        suits data written fresh every frame; the caller owns the threading (one thread carves an
+        arena, though any may invalidate an allocation the GPU is done with).
+    */
+    class FrameArena {
+    public:
+        //! What the arena's memory is optimised for.
+        enum class Direction {
+            Upload, //!< Host writes, GPU reads (write-combined; flush() after writing).
+            Readback //!< GPU writes, host reads (host-cached; invalidate() before reading).
+        };
+
+        FrameArena() = default;
+
+        //! Creates the buffer: bytes_per_frame for each of frame_count frames, with buffer_usage
+        //! (fatal on failure). Returns false, creating nothing, when frame_count is 0.
+        [[nodiscard]] bool create(const Allocator& allocator, VkDeviceSize bytes_per_frame, uint32_t frame_count, VkBufferUsageFlags buffer_usage,
+            Direction direction, std::span<const uint32_t> queue_families = {});
+
+        //! Frees the buffer. Safe to call repeatedly.
+        void destroy();
+
+        //! Starts carving frame's region (frame modulo the frame count) from its start; whatever
+        //! was allocated in it before must no longer be in use by the GPU. A no-op before
+        //! create() and after destroy().
+        void beginFrame(uint32_t frame)
+        {
+            m_regions.beginFrame(frame);
+        }
+
+        //! Sub-allocates size bytes at alignment (a power of two, at least the buffer usage's
+        //! offset alignment) from the current frame's region.
+        [[nodiscard]] ArenaAllocation allocate(VkDeviceSize size, VkDeviceSize alignment);
+
+        //! Flushes what the current frame has allocated so far, for the GPU (a no-op on HOST_COHERENT memory).
+        void flush() const;
+
+        //! Invalidates what the current frame has allocated so far, for the host to read what the
+        //! GPU wrote (a no-op on HOST_COHERENT memory).
+        void invalidate() const;
+
+        //! Invalidates one allocation (from any frame's region) for the host to read.
+        void invalidate(const ArenaAllocation& allocation) const;
+
+        //! Bytes per frame region.
+        [[nodiscard]] VkDeviceSize capacity() const
+        {
+            return m_regions.capacity();
+        }
+
+        //! Most bytes any frame has allocated (padding included), to size capacity() by.
+        [[nodiscard]] VkDeviceSize peakBytes() const
+        {
+            return m_regions.peakBytes();
+        }
+
+        //! The arena's buffer.
+        [[nodiscard]] const AllocatedBuffer& buffer() const
+        {
+            return m_buffer;
+        }
+
+    private:
+        //! Flushes or invalidates [offset, offset + size) of the buffer.
+        void syncRange(bool flush, VkDeviceSize offset, VkDeviceSize size) const;
+
+        const Allocator* m_allocator{nullptr}; //!< Set in create().
+        AllocatedBuffer m_buffer; //!< The regions' memory.
+        uint8_t* m_mapped{nullptr}; //!< Start of the mapped buffer.
+        ArenaRegions m_regions; //!< Where each frame's allocations go.
+    };
+
     //! Owns the VmaAllocator. Built from Volk function pointers after the device exists.
     class Allocator {
     public:
@@ -199,16 +480,78 @@ namespace Engine
         Allocator(Allocator&&) = delete;
         Allocator& operator=(Allocator&&) = delete;
 
-        //! Creates the VMA allocator using Volk function pointers. Returns false and fills
-        //! out_error_message on failure. The logger must outlive this Allocator.
-        [[nodiscard]] bool init(VkInstance instance, VkPhysicalDevice physical_device, VkDevice device, LoggingLib::Logger& logger, std::string& out_error_message);
+        //! Creates the VMA allocator using Volk function pointers. memory_budget: the device has
+        //! VK_EXT_memory_budget enabled (Device::supportsMemoryBudget()), so memoryBudget() asks
+        //! the driver. Returns false and fills out_error_message on failure. The logger must
+        //! outlive this Allocator.
+        [[nodiscard]] bool init(VkInstance instance, VkPhysicalDevice physical_device, VkDevice device, bool memory_budget, LoggingLib::Logger& logger,
+            std::string& out_error_message);
 
         //! Destroys the allocator. Safe to call repeatedly.
         void destroy();
 
-        //! Creates a GPU buffer with a VMA allocation (fatal on failure).
+        //! Creates a GPU buffer with a VMA allocation (fatal on failure). With more than one queue
+        //! family in queue_families the buffer is shared concurrently between them; otherwise it
+        //! is exclusive to one family at a time.
         [[nodiscard]] AllocatedBuffer createBuffer(VkDeviceSize size, VkBufferUsageFlags buffer_usage, VmaAllocationCreateFlags alloc_flags,
-            VmaMemoryUsage memory_usage) const;
+            VmaMemoryUsage memory_usage, std::span<const uint32_t> queue_families = {}) const;
+
+        //! Creates a buffer in device-local memory for data the GPU reads and writes every frame
+        //! (fatal on failure). Where host-visible device-local memory is available (ReBAR/UMA)
+        //! the buffer is persistently mapped and can be filled directly; otherwise it is
+        //! GPU-only, gets TRANSFER_DST usage and must be seeded with a staging copy. isMapped()
+        //! tells which. queue_families is as for createBuffer().
+        [[nodiscard]] AllocatedBuffer createDeviceLocalBuffer(VkDeviceSize size, VkBufferUsageFlags buffer_usage, std::span<const uint32_t> queue_families = {}) const;
+
+        //! Creates a persistently mapped buffer in HOST_COHERENT memory (fatal on failure), so host
+        //! stores reach the GPU without a flush — for values the CPU keeps updating while the GPU
+        //! may be reading them. queue_families is as for createBuffer().
+        [[nodiscard]] AllocatedBuffer createCoherentBuffer(VkDeviceSize size, VkBufferUsageFlags buffer_usage, std::span<const uint32_t> queue_families = {}) const;
+
+        //! Creates a custom pool for buffers of one kind (fatal on failure), each block_size bytes
+        //! (0: VMA's default), at most max_block_count of them (0: no limit). Its memory type is
+        //! chosen as createBuffer() would for a buffer of this kind; createPooledBuffer() then
+        //! sub-allocates from the pool's blocks, so many small buffers share a few device memory
+        //! allocations and their usage is reported apart in the VMA statistics.
+        [[nodiscard]] AllocatedPool createBufferPool(VkDeviceSize block_size, VkBufferUsageFlags buffer_usage, VmaAllocationCreateFlags alloc_flags,
+            VmaMemoryUsage memory_usage, std::span<const uint32_t> queue_families = {}, std::size_t max_block_count = 0) const;
+
+        //! Creates a buffer of size bytes sub-allocated from pool (fatal on failure, including
+        //! the pool reaching its max_block_count).
+        [[nodiscard]] AllocatedBuffer createPooledBuffer(const AllocatedPool& pool, VkDeviceSize size) const;
+
+        //! Per-heap usage and budget right now. Thread-safe and cheap (VMA caches the driver's
+        //! figures and refreshes them after enough allocations, and on each setCurrentFrame()).
+        [[nodiscard]] MemoryBudget memoryBudget() const;
+
+        //! Tells VMA a new frame has started (vmaSetCurrentFrameIndex()), which refreshes the
+        //! driver's budget figures. Call from the render thread once per frame.
+        void setCurrentFrame(uint64_t frame);
+
+        //! Copies size bytes into a mapped buffer (from offset 0) and flushes them for the GPU.
+        void writeMapped(const AllocatedBuffer& buffer, const void* data, VkDeviceSize size) const;
+
+        //! Invalidates the first size bytes of a mapped buffer, so host reads see what the GPU wrote.
+        void invalidateMapped(const AllocatedBuffer& buffer, VkDeviceSize size) const;
+
+        //! Invalidates the first size bytes of a mapped buffer and copies them out (GPU readback).
+        void readMapped(const AllocatedBuffer& buffer, void* out_data, VkDeviceSize size) const;
+
+        //! True when a device-local memory type is also host-visible and large enough to hold more
+        //! than the legacy 256 MiB BAR window (resizable BAR, or a UMA/integrated GPU).
+        [[nodiscard]] bool hasHostVisibleDeviceLocal() const
+        {
+            return m_host_visible_device_local;
+        }
+
+        //! True when the buffer's memory is persistently mapped.
+        [[nodiscard]] static bool isMapped(const AllocatedBuffer& buffer)
+        {
+            return buffer.allocationInfo().pMappedData != nullptr;
+        }
+
+        //! Describes the memory type backing a buffer, e.g. "memory type 1 (DEVICE_LOCAL | HOST_VISIBLE), heap 0".
+        [[nodiscard]] std::string describeMemory(const AllocatedBuffer& buffer) const;
 
         //! Creates a 2D GPU image with a VMA allocation (fatal on failure).
         [[nodiscard]] AllocatedImage createImage(uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage,
@@ -221,8 +564,15 @@ namespace Engine
         }
 
     private:
+        friend class FrameArena;
+
+        //! Logs (throttled) a failed flush or invalidate of mapped memory.
+        void reportMappedError(const char* operation, VkResult result) const;
+
         LoggingLib::Logger* m_logger{nullptr}; //!< Logger reference (non-owning), set in init().
         VmaAllocator m_allocator{VK_NULL_HANDLE}; //!< Owned VMA allocator handle.
+        bool m_host_visible_device_local{false}; //!< See hasHostVisibleDeviceLocal().
+        bool m_memory_budget{false}; //!< VK_EXT_memory_budget is enabled (MemoryBudget::from_extension).
     };
 
 } // namespace Engine
@@ -0,0 +1,498 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "cli_args.hpp"
+#include "input_recording.hpp"
+#include "renderer.hpp"
+#include <log/logger.hpp>
+#include <math/vector.hpp>
+#include <physics/string_batch.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+    //! Every combination of these is one benchmark case (the largest stays within
+    //! Renderer::MAX_TOTAL_NODES). 64 and 128 nodes use the workgroup solver, longer strings the tiled one.
+    constexpr std::array<uint32_t, 4> NODE_COUNTS{64, 128, 1024, 16384};
+    constexpr std::array<uint32_t, 3> STRING_COUNTS{1, 64, 256};
+    constexpr std::array<uint32_t, 2> ITERATION_COUNTS{6, 24};
+
+    //! Offscreen target size (pixels).
+    constexpr uint32_t TARGET_WIDTH = 1280;
+    constexpr uint32_t TARGET_HEIGHT = 720;
+
+    //! Simulated frame time: four physics substeps per frame, whatever the real frame rate.
+    constexpr float FRAME_DT = 1.0f / 60.0f;
+
+    //! Frames run before measuring, so pipelines, caches and clocks have warmed up.
+    constexpr uint32_t WARMUP_FRAMES = 120;
+
+    //! Default number of measured frames per case.
+    constexpr uint32_t DEFAULT_FRAMES = 600;
+
+    //! The --score-gpus case: the tiled solver over a mid-sized batch, so both the physics and
+    //! the ribbon passes weigh in.
+    constexpr uint32_t SCORE_NODE_COUNT = 1024;
+    constexpr uint32_t SCORE_STRING_COUNT = 64;
+    constexpr uint32_t SCORE_ITERATIONS = 6;
+
+    //! --verify cursor sample time (steady clock, µs). Every frame passes it as its trail time, so
+    //! each substep lands at or after this only sample and the heads follow exactly that point.
+    constexpr uint64_t VERIFY_TRAIL_TIME_US = 1000000;
+
+    //! text as a quoted JSON string: quotes and backslashes escaped, control characters as \u00XX.
+    [[nodiscard]] std::string jsonString(std::string_view text)
+    {
+        static constexpr std::string_view HEX_DIGITS{"0123456789abcdef"};
+        std::string json = "\"";
+        for (char c : text) {
+            unsigned char byte = static_cast<unsigned char>(c);
+            if ((byte == '"') || (byte == '\\')) {
+                json += '\\';
+                json += c;
+            } else if (byte < 0x20) {
+                json += "\\u00";
+                json += HEX_DIGITS[byte >> 4];
+                json += HEX_DIGITS[byte & 0xFu];
+            } else {
+                json += c;
+            }
+        }
+        json += '"';
+        return json;
+    }
+
+    //! Command-line usage, appended to argument errors.
+    const std::string USAGE = std::string("Usage: stringwiggler_bench [--frames <count>] ") + std::string(Engine::RENDERER_OPTIONS_USAGE)
+        + " [--output <file>] [--replay <recording> [--replay-speed recorded|max]] [--score-gpus] [--verify <ticks>]";
+
+    //! Benchmark options.
+    struct BenchConfig {
+        uint32_t frames{DEFAULT_FRAMES}; //!< Measured frames per case.
+        Engine::RendererConfig renderer{}; //!< The renderer options every case shares (see Engine::parseRendererOption()).
+        std::string output{"stringwiggler_bench.jsonl"}; //!< JSON Lines results file (one object per case).
+        std::string replay; //!< Input recording to run as the only case instead of the matrix (empty: the matrix).
+        Engine::ReplaySpeed replay_speed{Engine::ReplaySpeed::Max}; //!< How fast replay plays.
+        bool score_gpus{false}; //!< Score every suitable GPU into the GpuScores file instead of running cases.
+        uint32_t verify_ticks{0}; //!< Above 0: check each case's GPU physics against the CPU reference after this many substeps instead of timing it.
+    };
+
+    //! Averages of one case over its measured frames.
+    struct CaseResult {
+        uint32_t frames{0}; //!< Frames whose timings were read back.
+        double cpu_record_ms{0.0}; //!< Mean FrameTimings::cpu_record_ms.
+        double gpu_physics_ms{0.0}; //!< Mean FrameTimings::gpu_physics_ms.
+        double gpu_frame_ms{0.0}; //!< Mean FrameTimings::gpu_frame_ms.
+        double fps{0.0}; //!< Measured frames over the wall-clock time they took.
+    };
+
+    //! Applies the command-line options. Returns false and fills out_error_message on an unknown
+    //! option or a malformed value.
+    [[nodiscard]] bool parseArguments(int argc, char** argv, BenchConfig& config, std::string& out_error_message)
+    {
+        for (int i = 1; i < argc; ++i) {
+            Engine::OptionMatch match = Engine::parseRendererOption(argc, argv, i, config.renderer, USAGE, out_error_message);
+            if (match == Engine::OptionMatch::Invalid) {
+                return false;
+            }
+            if (match == Engine::OptionMatch::Parsed) {
+                continue;
+            }
+            std::string_view arg{argv[i]};
+            if ((arg == "--frames") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (!Engine::parseUint32(value, config.frames) || (config.frames == 0)) {
+                    out_error_message = Engine::invalidValue("frame count", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--output") && (i + 1 < argc)) {
+                config.output = argv[++i];
+            } else if (arg == "--score-gpus") {
+                config.score_gpus = true;
+            } else if ((arg == "--verify") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (!Engine::parseUint32(value, config.verify_ticks) || (config.verify_ticks == 0)) {
+                    out_error_message = Engine::invalidValue("verify tick count", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--replay") && (i + 1 < argc)) {
+                config.replay = argv[++i];
+            } else if ((arg == "--replay-speed") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (!Engine::parseReplaySpeed(value, config.replay_speed)) {
+                    out_error_message = Engine::invalidValue("replay speed", value, USAGE);
+                    return false;
+                }
+            } else {
+                out_error_message = Engine::unknownOption(arg, USAGE);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! Scripted cursor: a Lissajous figure over the middle of the target, fast enough to keep
+    //! every string swinging (so no case measures a string at rest).
+    void cursorAt(uint32_t frame, int32_t& out_x, int32_t& out_y)
+    {
+        constexpr float TWO_PI = 6.2831853f;
+        float t = static_cast<float>(frame) * FRAME_DT;
+        float x = 0.5f + 0.35f * std::sin(TWO_PI * 0.5f * t);
+        float y = 0.4f + 0.25f * std::sin(TWO_PI * 0.75f * t);
+        out_x = static_cast<int32_t>(x * static_cast<float>(TARGET_WIDTH));
+        out_y = static_cast<int32_t>(y * static_cast<float>(TARGET_HEIGHT));
+    }
+
+    //! Sums each frame's timings once as they are read back, for frames submitted from first_measured on.
+    struct TimingAccumulator {
+        uint64_t first_measured{1}; //!< First frame serial that counts.
+        uint64_t last_collected{0}; //!< Serial of the frame whose timings were summed last.
+        CaseResult result{}; //!< Sums until finish(), then means.
+
+        //! Adds the renderer's newest timings if they are of a frame not yet counted.
+        void collect(const Engine::Renderer& renderer)
+        {
+            uint64_t timed = renderer.timingsFrame();
+            if ((timed >= first_measured) && (timed != last_collected)) {
+                const Engine::FrameTimings& timings = renderer.timings();
+                result.cpu_record_ms += timings.cpu_record_ms;
+                result.gpu_physics_ms += timings.gpu_physics_ms;
+                result.gpu_frame_ms += timings.gpu_frame_ms;
+                ++result.frames;
+                last_collected = timed;
+            }
+        }
+
+        //! Turns the sums into means and sets the frame rate of frames drawn in seconds.
+        void finish(uint32_t frames, double seconds)
+        {
+            if (result.frames > 0) {
+                result.cpu_record_ms /= result.frames;
+                result.gpu_physics_ms /= result.frames;
+                result.gpu_frame_ms /= result.frames;
+            }
+            result.fps = (seconds > 0.0) ? (static_cast<double>(frames) / seconds) : 0.0;
+        }
+    };
+
+    //! Runs one case on a fresh headless renderer. Returns false and fills out_error_message if
+    //! the renderer cannot be initialised.
+    [[nodiscard]] bool runCase(LoggingLib::Logger& logger, const Engine::RendererConfig& renderer_config, uint32_t frames, CaseResult& out_result,
+        std::string& out_error_message)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        Engine::Renderer renderer;
+        if (!renderer.init(logger, Engine::NativeWindowHandle{}, TARGET_WIDTH, TARGET_HEIGHT, renderer_config, out_error_message)) {
+            return false;
+        }
+
+        int32_t cursor_x = 0;
+        int32_t cursor_y = 0;
+        for (uint32_t frame = 0; frame < WARMUP_FRAMES; ++frame) {
+            cursorAt(frame, cursor_x, cursor_y);
+            renderer.latchCursor(TARGET_WIDTH, TARGET_HEIGHT, cursor_x, cursor_y, Engine::Renderer::nowMicroseconds());
+            renderer.drawFrame(TARGET_WIDTH, TARGET_HEIGHT, FRAME_DT);
+        }
+
+        // Timings arrive once a frame's fence is waited on; accumulate each frame's once, and only
+        // for frames submitted after the warm-up.
+        TimingAccumulator accumulator{};
+        accumulator.first_measured = renderer.frameSerial() + 1;
+        Clock::time_point start = Clock::now();
+        for (uint32_t frame = 0; frame < frames; ++frame) {
+            cursorAt(WARMUP_FRAMES + frame, cursor_x, cursor_y);
+            renderer.latchCursor(TARGET_WIDTH, TARGET_HEIGHT, cursor_x, cursor_y, Engine::Renderer::nowMicroseconds());
+            renderer.drawFrame(TARGET_WIDTH, TARGET_HEIGHT, FRAME_DT);
+            accumulator.collect(renderer);
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        renderer.destroy();
+
+        accumulator.finish(frames, seconds);
+        out_result = accumulator.result;
+        return true;
+    }
+
+    //! Runs ticks physics substeps of one case on a fresh headless renderer (one substep per frame,
+    //! the cursor held at the target centre) and the same on PhysicsLib::StringBatch from the same
+    //! seed, and sets out_max_deviation to the largest distance between a GPU node and its CPU
+    //! counterpart (NDC). Returns false and fills out_error_message if the renderer fails or a
+    //! deviation is not finite.
+    [[nodiscard]] bool verifyCase(LoggingLib::Logger& logger, const Engine::RendererConfig& renderer_config, uint32_t ticks, float& out_max_deviation,
+        std::string& out_error_message)
+    {
+        std::vector<MathLib::Vec2> gpu_positions;
+        {
+            Engine::Renderer renderer;
+            if (!renderer.init(logger, Engine::NativeWindowHandle{}, TARGET_WIDTH, TARGET_HEIGHT, renderer_config, out_error_message)) {
+                return false;
+            }
+            // The centre of the target is NDC (0, 0) exactly.
+            renderer.latchCursor(TARGET_WIDTH, TARGET_HEIGHT, TARGET_WIDTH / 2, TARGET_HEIGHT / 2, VERIFY_TRAIL_TIME_US);
+            for (uint32_t tick = 0; tick < ticks; ++tick) {
+                renderer.drawFrame(TARGET_WIDTH, TARGET_HEIGHT, Engine::Renderer::FIXED_TIMESTEP, VERIFY_TRAIL_TIME_US);
+            }
+            bool read = renderer.readPositions(gpu_positions, out_error_message);
+            renderer.destroy();
+            if (!read) {
+                return false;
+            }
+        }
+
+        uint32_t node_count = renderer_config.node_count;
+        uint32_t string_count = renderer_config.string_count;
+        std::vector<Engine::StringParams> strings = Engine::Renderer::initialStringParams(string_count, node_count);
+        std::vector<MathLib::Vec2> seed = Engine::Renderer::initialPositions(strings, node_count);
+        PhysicsLib::StringBatch batch(string_count, node_count);
+        for (uint32_t s = 0; s < string_count; ++s) {
+            const Engine::StringParams& params = strings[s];
+            batch.setString(s, PhysicsLib::StringParams{params.anchor_x, params.anchor_y, params.segment_length, params.gravity, params.damping});
+            for (uint32_t i = 0; i < node_count; ++i) {
+                MathLib::Vec2 position = seed[static_cast<size_t>(s) * node_count + i];
+                batch.setNode(s, i, position, position);
+            }
+        }
+        PhysicsLib::StepParams step{0.0f, 0.0f, Engine::Renderer::FIXED_TIMESTEP, ticks, renderer_config.constraint_iterations};
+        batch.step(step, PhysicsLib::Kernel::Native, std::max(1u, std::thread::hardware_concurrency()));
+
+        out_max_deviation = 0.0f;
+        for (uint32_t s = 0; s < string_count; ++s) {
+            for (uint32_t i = 0; i < node_count; ++i) {
+                float deviation = (gpu_positions[static_cast<size_t>(s) * node_count + i] - batch.position(s, i)).length();
+                if (!std::isfinite(deviation)) {
+                    out_error_message = "Node " + std::to_string(i) + " of string " + std::to_string(s) + " is not finite on the GPU or the CPU after "
+                        + std::to_string(ticks) + " ticks.";
+                    return false;
+                }
+                out_max_deviation = std::max(out_max_deviation, deviation);
+            }
+        }
+        return true;
+    }
+
+    //! Plays a recording on a fresh headless renderer of the recorded size, measuring every frame:
+    //! there is no warm-up, which would change the state the recording starts from. Returns false
+    //! and fills out_error_message if the renderer cannot be initialised.
+    [[nodiscard]] bool runReplay(LoggingLib::Logger& logger, const Engine::RendererConfig& renderer_config, const Engine::InputRecording& recording,
+        Engine::ReplaySpeed speed, CaseResult& out_result, std::string& out_error_message)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        Engine::Renderer renderer;
+        if (!renderer.init(logger, Engine::NativeWindowHandle{}, recording.width, recording.height, renderer_config, out_error_message)) {
+            return false;
+        }
+
+        TimingAccumulator accumulator{};
+        Engine::InputReplayer replayer{recording, speed};
+        Clock::time_point start = Clock::now();
+        while (!replayer.done()) {
+            replayer.step(renderer, recording.width, recording.height);
+            accumulator.collect(renderer);
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        renderer.destroy();
+
+        accumulator.finish(replayer.framesPlayed(), seconds);
+        out_result = accumulator.result;
+        return true;
+    }
+
+    //! Runs the scoring case on every suitable GPU and merges the mean GPU frame times into the
+    //! GpuScores file in the per-user cache directory, writing one JSON line per GPU to output.
+    //! Returns false and fills out_error_message on failure.
+    [[nodiscard]] bool scoreGpus(LoggingLib::Logger& logger, const BenchConfig& config, std::ofstream& output, std::string& out_error_message)
+    {
+        std::string cache_directory = Engine::userCacheDirectory();
+        if (cache_directory.empty()) {
+            out_error_message = "No per-user cache directory to keep the GPU scores in.";
+            return false;
+        }
+        std::string scores_path = cache_directory + Engine::Renderer::GPU_SCORES_FILE_NAME;
+        Engine::GpuScores scores{};
+        if (!scores.load(scores_path, out_error_message)) {
+            return false;
+        }
+
+        std::vector<Engine::GpuCandidate> candidates;
+        {
+            Engine::Instance instance;
+            if (!instance.init(logger, true, out_error_message) || !Engine::Device::listGpus(instance, vk::raii::SurfaceKHR{nullptr}, candidates, out_error_message)) {
+                return false;
+            }
+        }
+
+        for (const Engine::GpuCandidate& candidate : candidates) {
+            if (!candidate.suitable) {
+                LOG_INFO(logger, "Skipping unsuitable GPU \"{}\".", candidate.name);
+                continue;
+            }
+            // The same case on every GPU: only the frames in flight are taken from the options.
+            Engine::RendererConfig renderer_config{};
+            renderer_config.node_count = SCORE_NODE_COUNT;
+            renderer_config.string_count = SCORE_STRING_COUNT;
+            renderer_config.constraint_iterations = SCORE_ITERATIONS;
+            renderer_config.frames_in_flight = config.renderer.frames_in_flight;
+            renderer_config.headless = true;
+            renderer_config.gpu.device = candidate.uuid;
+
+            CaseResult result{};
+            if (!runCase(logger, renderer_config, config.frames, result, out_error_message)) {
+                return false;
+            }
+            if (!(result.gpu_frame_ms > 0.0)) {
+                LOG_WARNING(logger, "GPU \"{}\" reported no frame timings; not scored.", candidate.name);
+                continue;
+            }
+            scores.set(candidate.uuid, candidate.name, result.gpu_frame_ms);
+            std::ostringstream line;
+            line.setf(std::ios::fixed);
+            line.precision(4);
+            line << "{\"gpu\":" << jsonString(candidate.name) << ",\"uuid\":" << jsonString(candidate.uuid) << ",\"gpu_frame_ms\":" << result.gpu_frame_ms << "}";
+            output << line.str() << "\n";
+            LOG_INFO(logger, line.str());
+        }
+
+        if (!scores.save(scores_path, out_error_message)) {
+            return false;
+        }
+        LOG_INFO(logger, "GPU scores written to \"{}\".", scores_path);
+        return true;
+    }
+
+    //! One JSON object (a single line) describing a case and its result.
+    [[nodiscard]] std::string toJson(const Engine::RendererConfig& config, const CaseResult& result)
+    {
+        std::ostringstream json;
+        json.setf(std::ios::fixed);
+        json.precision(4);
+        json << "{\"nodes\":" << config.node_count << ",\"strings\":" << config.string_count << ",\"iterations\":" << config.constraint_iterations
+             << ",\"frames_in_flight\":" << config.frames_in_flight << ",\"async_compute\":" << (config.async_compute ? "true" : "false")
+             << ",\"prerecorded\":" << (config.prerecorded ? "true" : "false") << ",\"partial_redraw\":" << (config.partial_redraw ? "true" : "false")
+             << ",\"frames\":" << result.frames << ",\"cpu_record_ms\":" << result.cpu_record_ms << ",\"gpu_physics_ms\":" << result.gpu_physics_ms
+             << ",\"gpu_frame_ms\":" << result.gpu_frame_ms << ",\"fps\":" << result.fps << "}";
+        return json.str();
+    }
+
+    //! One JSON object (a single line) describing a --verify case and its deviation.
+    [[nodiscard]] std::string verifyJson(const Engine::RendererConfig& config, uint32_t ticks, float max_deviation)
+    {
+        std::ostringstream json;
+        json << "{\"nodes\":" << config.node_count << ",\"strings\":" << config.string_count << ",\"iterations\":" << config.constraint_iterations
+             << ",\"ticks\":" << ticks << ",\"max_deviation\":" << max_deviation << "}";
+        return json.str();
+    }
+
+} // namespace
+
+//! Headless benchmark: renders every case of the node x string x iteration matrix offscreen with
+//! a scripted cursor — or, with --replay, just the recorded run — and writes one JSON line of
+//! averaged timings per case. With --score-gpus it instead scores every GPU for device selection;
+//! with --verify it checks each case's GPU physics against the CPU reference.
+int main(int argc, char** argv)
+{
+    LoggingLib::Logger logger;
+
+    BenchConfig config{};
+    std::string error_message;
+    if (!parseArguments(argc, argv, config, error_message)) {
+        LOG_ERROR(logger, error_message);
+        return EXIT_FAILURE;
+    }
+
+    std::ofstream output(config.output);
+    if (!output) {
+        LOG_ERROR(logger, "Cannot open \"{}\" for writing.", config.output);
+        return EXIT_FAILURE;
+    }
+
+    if (config.score_gpus) {
+        if (!scoreGpus(logger, config, output, error_message)) {
+            LOG_ERROR(logger, error_message);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (!config.replay.empty()) {
+        Engine::InputRecording recording{};
+        if (!recording.load(config.replay, error_message)) {
+            LOG_ERROR(logger, error_message);
+            return EXIT_FAILURE;
+        }
+        Engine::RendererConfig renderer_config = config.renderer;
+        renderer_config.node_count = recording.node_count;
+        renderer_config.string_count = recording.string_count;
+        renderer_config.constraint_iterations = recording.constraint_iterations;
+        renderer_config.headless = true;
+
+        CaseResult result{};
+        if (!runReplay(logger, renderer_config, recording, config.replay_speed, result, error_message)) {
+            LOG_ERROR(logger, error_message);
+            return EXIT_FAILURE;
+        }
+        std::string line = toJson(renderer_config, result);
+        output << line << "\n";
+        LOG_INFO(logger, line);
+        LOG_INFO(logger, "Replay results written to \"{}\".", config.output);
+        return EXIT_SUCCESS;
+    }
+
+    for (uint32_t node_count : NODE_COUNTS) {
+        for (uint32_t string_count : STRING_COUNTS) {
+            for (uint32_t iterations : ITERATION_COUNTS) {
+                Engine::RendererConfig renderer_config = config.renderer;
+                renderer_config.node_count = node_count;
+                renderer_config.string_count = string_count;
+                renderer_config.constraint_iterations = iterations;
+                renderer_config.headless = true;
+
+                std::string line;
+                if (config.verify_ticks > 0) {
+                    float max_deviation = 0.0f;
+                    if (!verifyCase(logger, renderer_config, config.verify_ticks, max_deviation, error_message)) {
+                        LOG_ERROR(logger, error_message);
+                        return EXIT_FAILURE;
+                    }
+                    line = verifyJson(renderer_config, config.verify_ticks, max_deviation);
+                } else {
+                    CaseResult result{};
+                    if (!runCase(logger, renderer_config, config.frames, result, error_message)) {
+                        LOG_ERROR(logger, error_message);
+                        return EXIT_FAILURE;
+                    }
+                    line = toJson(renderer_config, result);
+                }
+                output << line << "\n";
+                LOG_INFO(logger, line);
+            }
+        }
+    }
+
+    LOG_INFO(logger, "Benchmark results written to \"{}\".", config.output);
+    return EXIT_SUCCESS;
+}
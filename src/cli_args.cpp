@@ -0,0 +1,142 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "cli_args.hpp"
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <system_error>
+
+namespace Engine
+{
+
+    bool parseUint32(std::string_view text, uint32_t& out_value)
+    {
+        const char* end = text.data() + text.size();
+        std::from_chars_result result = std::from_chars(text.data(), end, out_value);
+        return (result.ec == std::errc{}) && (result.ptr == end);
+    }
+
+    bool parseNonNegativeFloat(std::string_view text, float& out_value)
+    {
+        const char* end = text.data() + text.size();
+        std::from_chars_result result = std::from_chars(text.data(), end, out_value);
+        return (result.ec == std::errc{}) && (result.ptr == end) && (out_value >= 0.0f);
+    }
+
+    bool parseReplaySpeed(std::string_view text, ReplaySpeed& out_speed)
+    {
+        if (text == "recorded") {
+            out_speed = ReplaySpeed::Recorded;
+        } else if (text == "max") {
+            out_speed = ReplaySpeed::Max;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    bool parseObstacle(std::string_view text, Obstacle& out_obstacle)
+    {
+        std::size_t colon = text.find(':');
+        if (colon == std::string_view::npos) {
+            return false;
+        }
+        std::string_view shape = text.substr(0, colon);
+        std::array<float, 4> values{};
+        std::size_t value_count = (shape == "circle") ? 3 : ((shape == "rect") ? 4 : 0);
+        if (value_count == 0) {
+            return false;
+        }
+
+        const char* cursor = text.data() + colon + 1;
+        const char* end = text.data() + text.size();
+        for (std::size_t i = 0; i < value_count; ++i) {
+            if (i > 0) {
+                if ((cursor == end) || (*cursor != ',')) {
+                    return false;
+                }
+                ++cursor;
+            }
+            std::from_chars_result result = std::from_chars(cursor, end, values[i]);
+            if (result.ec != std::errc{}) {
+                return false;
+            }
+            cursor = result.ptr;
+        }
+        if (cursor != end) {
+            return false;
+        }
+
+        if (value_count == 3) {
+            out_obstacle = Obstacle{values[0], values[1], values[2], 0.0f, ObstacleShape::Circle};
+        } else {
+            out_obstacle = Obstacle{(values[0] + values[2]) / 2.0f, (values[1] + values[3]) / 2.0f, std::abs(values[2] - values[0]) / 2.0f,
+                std::abs(values[3] - values[1]) / 2.0f, ObstacleShape::Rectangle};
+        }
+        return true;
+    }
+
+    OptionMatch parseRendererOption(int argc, char** argv, int& index, RendererConfig& config, std::string_view usage, std::string& out_error_message)
+    {
+        std::string_view arg{argv[index]};
+        bool has_value = (index + 1) < argc;
+        if ((arg == "--frames-in-flight") && has_value) {
+            std::string_view value{argv[++index]};
+            if (!parseUint32(value, config.frames_in_flight)) {
+                out_error_message = invalidValue("frames-in-flight count", value, usage);
+                return OptionMatch::Invalid;
+            }
+        } else if (arg == "--async-compute") {
+            config.async_compute = true;
+        } else if (arg == "--prerecord") {
+            config.prerecorded = true;
+        } else if (arg == "--full-redraw") {
+            config.partial_redraw = false;
+        } else if ((arg == "--gpu") && has_value) {
+            config.gpu.device = argv[++index];
+        } else {
+            return OptionMatch::None;
+        }
+        return OptionMatch::Parsed;
+    }
+
+    std::string invalidValue(std::string_view what, std::string_view value, std::string_view usage, std::string_view range)
+    {
+        std::string message = "Invalid ";
+        message += what;
+        message += " \"";
+        message += value;
+        message += '"';
+        if (!range.empty()) {
+            message += " (";
+            message += range;
+            message += ')';
+        }
+        message += ". ";
+        message += usage;
+        return message;
+    }
+
+    std::string unknownOption(std::string_view option, std::string_view usage)
+    {
+        std::string message = "Unknown option \"";
+        message += option;
+        message += "\". ";
+        message += usage;
+        return message;
+    }
+
+} // namespace Engine
@@ -0,0 +1,63 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include "compute_pipeline.hpp"
+#include "input_recording.hpp"
+#include "renderer.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Engine
+{
+
+    //! Usage of the renderer options parseRendererOption() applies, for an executable's usage text.
+    inline constexpr std::string_view RENDERER_OPTIONS_USAGE =
+        "[--frames-in-flight <count>] [--async-compute] [--prerecord] [--full-redraw] [--gpu <index|uuid|name>]";
+
+    //! What parseRendererOption() made of an argument.
+    enum class OptionMatch {
+        None, //!< Not one of its options: the caller handles it.
+        Parsed, //!< Applied to the configuration.
+        Invalid //!< Its value is malformed; out_error_message says how.
+    };
+
+    //! Parses a whole unsigned decimal number (a command-line value of the application or the
+    //! benchmark). Returns false if text is anything else.
+    [[nodiscard]] bool parseUint32(std::string_view text, uint32_t& out_value);
+
+    //! Parses a whole non-negative decimal number. Returns false if text is anything else.
+    [[nodiscard]] bool parseNonNegativeFloat(std::string_view text, float& out_value);
+
+    //! Parses a --replay-speed value, "recorded" or "max". Returns false if text is anything else.
+    [[nodiscard]] bool parseReplaySpeed(std::string_view text, ReplaySpeed& out_speed);
+
+    //! Parses an obstacle, "circle:x,y,r" or "rect:x0,y0,x1,y1" in NDC (+Y down; the rectangle's
+    //! corners in either order). Returns false if text is anything else.
+    [[nodiscard]] bool parseObstacle(std::string_view text, Obstacle& out_obstacle);
+
+    //! Applies argv[index] to config if it is one of the renderer options every executable takes
+    //! (RENDERER_OPTIONS_USAGE), advancing index past its value; usage is appended to errors.
+    [[nodiscard]] OptionMatch parseRendererOption(int argc, char** argv, int& index, RendererConfig& config, std::string_view usage, std::string& out_error_message);
+
+    //! The error for a malformed option value, e.g. `Invalid node count "x". <usage>`, with the
+    //! accepted range in parentheses after the value when one is given.
+    [[nodiscard]] std::string invalidValue(std::string_view what, std::string_view value, std::string_view usage, std::string_view range = {});
+
+    //! The error for an option that is not recognised (or lacks its value): `Unknown option "x". <usage>`.
+    [[nodiscard]] std::string unknownOption(std::string_view option, std::string_view usage);
+
+} // namespace Engine
@@ -13,31 +13,32 @@
 */
 
 #include "compute_pipeline.hpp"
-#include "shader_loader.hpp"
+#include "physics_spv.hpp"
+#include <trace/tracer.hpp>
 #include <array>
-#include <vector>
+#include <cstddef>
 
 namespace Engine
 {
 
-    bool ComputePipeline::init(const Device& device, std::string& out_error_message)
+    bool ComputePipeline::init(const Device& device, const vk::raii::PipelineCache& cache, const PhysicsSpecialisation& specialisation,
+        std::string& out_error_message)
     {
-        std::vector<uint32_t> spirv;
-        if (!loadSpirv(executableDirectory() + "physics.spv", spirv, out_error_message)) {
-            return false;
-        }
-
+        TRACE_ZONE("ComputePipeline::init");
+        m_specialisation = specialisation;
         try {
-            // Descriptor set layout: binding 0 = positions, binding 1 = previous positions.
-            std::array<vk::DescriptorSetLayoutBinding, 2> bindings{};
-            bindings[0].binding = 0;
-            bindings[0].descriptorType = vk::DescriptorType::eStorageBuffer;
-            bindings[0].descriptorCount = 1;
-            bindings[0].stageFlags = vk::ShaderStageFlagBits::eCompute;
-            bindings[1].binding = 1;
-            bindings[1].descriptorType = vk::DescriptorType::eStorageBuffer;
-            bindings[1].descriptorCount = 1;
-            bindings[1].stageFlags = vk::ShaderStageFlagBits::eCompute;
+            // Descriptor set layout: binding 0 = positions, binding 1 = previous positions (both
+            // written), binding 2 = per-string parameters, bindings 3 + 4 = the input slot's
+            // positions + previous positions, bindings 5 + 6 = motion partials + result, binding
+            // 7 = frame parameters, binding 8 = the late-written cursor trail, binding 9 = the
+            // obstacles, bindings 10 - 12 = the hash grid's cells, node cells and sorted entries.
+            std::array<vk::DescriptorSetLayoutBinding, PHYSICS_BINDING_COUNT> bindings{};
+            for (uint32_t i = 0; i < bindings.size(); ++i) {
+                bindings[i].binding = i;
+                bindings[i].descriptorType = vk::DescriptorType::eStorageBuffer;
+                bindings[i].descriptorCount = 1;
+                bindings[i].stageFlags = vk::ShaderStageFlagBits::eCompute;
+            }
 
             vk::DescriptorSetLayoutCreateInfo layout_info{};
             layout_info.setBindings(bindings);
@@ -54,18 +55,46 @@ namespace Engine
             m_layout = vk::raii::PipelineLayout(device.get(), pipeline_layout_info);
 
             vk::ShaderModuleCreateInfo module_info{};
-            module_info.setCode(spirv);
+            module_info.codeSize = sizeof(PHYSICS_SPV);
+            module_info.pCode = PHYSICS_SPV;
             vk::raii::ShaderModule module{device.get(), module_info};
 
-            vk::PipelineShaderStageCreateInfo stage{};
-            stage.stage = vk::ShaderStageFlagBits::eCompute;
-            stage.module = *module;
-            stage.setPName("physicsMain");
+            // Every entry point gets the same constants; those it does not use are ignored.
+            std::array<vk::SpecializationMapEntry, 4> spec_entries{
+                {{PHYSICS_SPEC_NODE_COUNT, offsetof(PhysicsSpecialisation, node_count), sizeof(uint32_t)},
+                    {PHYSICS_SPEC_ITERATIONS, offsetof(PhysicsSpecialisation, iterations), sizeof(uint32_t)},
+                    {PHYSICS_SPEC_COLLISION, offsetof(PhysicsSpecialisation, collision), sizeof(uint32_t)},
+                    {PHYSICS_SPEC_OBSTACLE_COUNT, offsetof(PhysicsSpecialisation, obstacle_count), sizeof(uint32_t)}}};
+            vk::SpecializationInfo spec_info{};
+            spec_info.setMapEntries(spec_entries);
+            spec_info.dataSize = sizeof(PhysicsSpecialisation);
+            spec_info.pData = &m_specialisation;
+
+            // One module, one pipeline per entry point used on this device.
+            auto createPipeline = [&device, &module, &cache, &spec_info, this](const char* entry_point) {
+                vk::PipelineShaderStageCreateInfo stage{};
+                stage.stage = vk::ShaderStageFlagBits::eCompute;
+                stage.module = *module;
+                stage.setPName(entry_point);
+                stage.pSpecializationInfo = &spec_info;
+
+                vk::ComputePipelineCreateInfo pipeline_info{};
+                pipeline_info.stage = stage;
+                pipeline_info.layout = *m_layout;
+                return vk::raii::Pipeline(device.get(), cache, pipeline_info);
+            };
 
-            vk::ComputePipelineCreateInfo pipeline_info{};
-            pipeline_info.stage = stage;
-            pipeline_info.layout = *m_layout;
-            m_pipeline = vk::raii::Pipeline(device.get(), nullptr, pipeline_info);
+            m_uses_subgroups = device.supportsSubgroupShuffle();
+            m_workgroup = createPipeline(m_uses_subgroups ? "physicsWaveMain" : "physicsMain");
+            m_integrate = createPipeline("integrateMain");
+            m_constrain = createPipeline("constrainMain");
+            m_grid_count = createPipeline("gridCountMain");
+            m_grid_scan = createPipeline("gridScanMain");
+            m_grid_totals = createPipeline("gridTotalsMain");
+            m_grid_scatter = createPipeline("gridScatterMain");
+            m_collide = createPipeline("collideMain");
+            m_motion = createPipeline("motionMain");
+            m_motion_reduce = createPipeline("motionReduceMain");
         } catch (const vk::SystemError& e) {
             out_error_message = std::string("Vulkan error creating compute pipeline: ") + e.what();
             return false;
@@ -79,7 +108,16 @@ namespace Engine
 
     void ComputePipeline::destroy()
     {
-        m_pipeline = nullptr;
+        m_motion_reduce = nullptr;
+        m_motion = nullptr;
+        m_collide = nullptr;
+        m_grid_scatter = nullptr;
+        m_grid_totals = nullptr;
+        m_grid_scan = nullptr;
+        m_grid_count = nullptr;
+        m_constrain = nullptr;
+        m_integrate = nullptr;
+        m_workgroup = nullptr;
         m_layout = nullptr;
         m_descriptor_set_layout = nullptr;
     }
@@ -21,28 +21,159 @@
 #include <volk/volk.h>
 #endif
 #include <vulkan/vulkan_raii.hpp>
+#include <array>
 #include <cstdint>
 #include <string>
 
 namespace Engine
 {
 
-    //! Push constants for the physics compute shader. Must match the PhysicsPush struct in
-    //! physics.slang (scalar/packed layout — all members are 4-byte aligned).
+    //! Threads per physics workgroup. Must match WORKGROUP_SIZE in physics.slang. 128 is the
+    //! Vulkan-guaranteed minimum for maxComputeWorkGroupSize[0] and maxComputeWorkGroupInvocations.
+    static constexpr uint32_t PHYSICS_WORKGROUP_SIZE = 128;
+
+    //! Storage-buffer bindings of the physics descriptor set (see ComputePipeline).
+    static constexpr uint32_t PHYSICS_BINDING_COUNT = 13;
+
+    //! Most substeps one frame may run.
+    static constexpr uint32_t PHYSICS_MAX_SUBSTEPS = 12;
+
+    //! Cursor samples the trail keeps (a power of two). Must match CURSOR_TRAIL_LENGTH in
+    //! physics.slang. 64 covers the longest frame (PHYSICS_MAX_SUBSTEPS substeps, 50 ms) of a
+    //! 1000 Hz mouse with room to spare.
+    static constexpr uint32_t CURSOR_TRAIL_LENGTH = 64;
+
+    //! PhysicsPush::collision bit: keep the nodes inside the window edges. Must match COLLIDE_EDGES in physics.slang.
+    static constexpr uint32_t PHYSICS_COLLIDE_EDGES = 1;
+
+    //! PhysicsPush::collision bit: push apart the nodes of a string that overlap. Must match COLLIDE_SELF in physics.slang.
+    static constexpr uint32_t PHYSICS_COLLIDE_SELF = 2;
+
+    //! Most static obstacles a batch may have (each node tests every one, every iteration).
+    static constexpr uint32_t PHYSICS_MAX_OBSTACLES = 64;
+
+    //! Hash-grid cells one gridScanMain workgroup scans. Must match GRID_SCAN_BLOCK in physics.slang.
+    static constexpr uint32_t PHYSICS_GRID_SCAN_BLOCK = PHYSICS_WORKGROUP_SIZE * 8;
+
+    //! Specialisation constant IDs of physics.slang. Must match its vk::constant_id values.
+    static constexpr uint32_t PHYSICS_SPEC_NODE_COUNT = 0;
+    static constexpr uint32_t PHYSICS_SPEC_ITERATIONS = 1;
+    static constexpr uint32_t PHYSICS_SPEC_COLLISION = 2;
+    static constexpr uint32_t PHYSICS_SPEC_OBSTACLE_COUNT = 3;
+
+    //! The batch constants every physics pipeline is specialised for. The driver compiles them in:
+    //! the node count becomes a constant divisor and loop bound, the constraint and obstacle loops
+    //! can be unrolled, and collision code the batch does not use is removed. The pipeline cache
+    //! keys its entries by these values too, so each configuration compiles once per cache.
+    struct PhysicsSpecialisation {
+        uint32_t node_count{2}; //!< Nodes per string.
+        uint32_t iterations{1}; //!< Constraint relaxation iterations per substep.
+        uint32_t collision{0}; //!< PHYSICS_COLLIDE_* bits.
+        uint32_t obstacle_count{0}; //!< Obstacles in the obstacle buffer (binding 9).
+
+        [[nodiscard]] bool operator==(const PhysicsSpecialisation&) const = default;
+    };
+
+    //! Push constants for the physics compute shader: what the pipelines are not specialised for,
+    //! plus the pass of a tiled dispatch. Must match the PhysicsPush struct in physics.slang
+    //! (scalar/packed layout — all members are 4-byte aligned).
     struct PhysicsPush {
-        float cursor_x; //!< Head target X (NDC).
-        float cursor_y; //!< Head target Y (NDC).
-        float dt; //!< Frame delta time (seconds, clamped).
-        float gravity; //!< Downward acceleration (NDC / s^2; +Y is down).
+        uint32_t string_count; //!< Strings in the batch.
+        uint32_t phase; //!< Red-black colour of a tiled constraint dispatch (0 = even, 1 = odd).
+        uint32_t substep; //!< Substep of a tiled integrate dispatch (0 reads the input slot, later ones the output).
+        float collision_radius; //!< Radius of a node for every collision (NDC).
+        uint32_t grid_cells; //!< Cells of the tiled solver's hash grid (a power of two, a multiple of PHYSICS_GRID_SCAN_BLOCK).
+    };
+
+    //! Per-frame physics parameters, in a persistently mapped buffer per state slot (binding 7),
+    //! written by the CPU before the frame is submitted. The first two members must match the
+    //! FrameParams struct in physics.slang; the dispatch arguments after them are only read by
+    //! dispatchIndirect, when pre-recorded command buffers run the tiled solver. The cursor is not
+    //! here but in the late-written trail (binding 8; see Renderer::latchCursor()).
+    struct FrameParams {
+        float dt; //!< Fixed substep duration (seconds).
+        uint32_t substeps; //!< Substeps this frame advances.
+        uint32_t time_us; //!< Time the last substep reaches (steady-clock microseconds, low 32 bits); substep k is (substeps - 1 - k) * dt before it.
+        std::array<vk::DispatchIndirectCommand, PHYSICS_MAX_SUBSTEPS> integrate_groups; //!< Tiled integrate dispatch of each substep (zero past substeps).
+        std::array<vk::DispatchIndirectCommand, PHYSICS_MAX_SUBSTEPS> constrain_groups; //!< Tiled constraint dispatches of each substep (zero past substeps).
+        std::array<vk::DispatchIndirectCommand, PHYSICS_MAX_SUBSTEPS> grid_scan_groups; //!< Tiled self-collision: gridScanMain of each substep (zero past substeps).
+        std::array<vk::DispatchIndirectCommand, PHYSICS_MAX_SUBSTEPS> grid_total_groups; //!< Tiled self-collision: gridTotalsMain of each substep (zero past substeps).
+    };
+
+    //! Per-string physics parameters, one array element per string in the string-parameter
+    //! storage buffer. Must match the StringParams struct in physics.slang (24-byte stride).
+    struct StringParams {
+        float anchor_x; //!< Head offset from the cursor, X (NDC).
+        float anchor_y; //!< Head offset from the cursor, Y (NDC).
         float segment_length; //!< Rest distance between adjacent nodes (NDC).
-        float damping; //!< Velocity damping per step (0..1) so the string loses energy and settles.
-        uint32_t node_count; //!< Active node count.
-        uint32_t iterations; //!< Constraint relaxation iterations.
+        float gravity; //!< Downward acceleration (NDC / s^2; +Y is down).
+        float damping; //!< Velocity damping per substep (0..1) so the string loses energy and settles.
+        float padding; //!< Keeps the array stride at 24 bytes on both sides.
+    };
+
+    //! One cursor position and when it was there. Must match CursorSample in physics.slang.
+    struct CursorSample {
+        uint64_t position; //!< Cursor (NDC float2): the bits of X in the low word, Y in the high, so it is written in one store.
+        uint32_t time_us; //!< When the cursor was there (steady-clock microseconds, low 32 bits).
+        uint32_t padding; //!< Keeps the stride at 16 bytes on both sides.
+    };
+
+    //! Recent cursor samples, a ring the CPU keeps appending to (binding 8). The physics
+    //! interpolates each substep's head target along it. Must match CursorTrail in physics.slang.
+    struct CursorTrail {
+        uint32_t newest; //!< Index (unwrapped) of the newest sample; samples[newest % CURSOR_TRAIL_LENGTH].
+        std::array<uint32_t, 3> padding; //!< Aligns the samples to 16 bytes.
+        std::array<CursorSample, CURSOR_TRAIL_LENGTH> samples; //!< The ring.
+    };
+
+    //! Shape of an Obstacle. Must match the OBSTACLE_* values in physics.slang.
+    enum class ObstacleShape : uint32_t {
+        Circle = 0, //!< extent_x is the radius.
+        Rectangle = 1 //!< extent_x and extent_y are the half width and half height.
     };
 
-    //! Compute pipeline that runs the string physics (physics.slang -> physics.spv). Owns its
-    //! descriptor-set layout (two storage buffers: positions + previous positions) and pipeline
-    //! layout (with the PhysicsPush push-constant range).
+    //! A static obstacle the strings collide with, one array element per obstacle in the obstacle
+    //! storage buffer (binding 9). Must match the Obstacle struct in physics.slang (24-byte stride).
+    //! Like the rest of the simulation it lives in NDC, so a circle is drawn out to an ellipse by
+    //! a window that is not square.
+    struct Obstacle {
+        float centre_x{0.0f}; //!< Centre, X (NDC).
+        float centre_y{0.0f}; //!< Centre, Y (NDC; +Y is down).
+        float extent_x{0.0f}; //!< Circle: radius; rectangle: half width (NDC).
+        float extent_y{0.0f}; //!< Rectangle: half height (NDC); unused by a circle.
+        ObstacleShape shape{ObstacleShape::Circle}; //!< How the extents are read.
+        uint32_t padding{0}; //!< Keeps the array stride at 24 bytes on both sides.
+    };
+
+    //! One node in the tiled solver's sorted hash grid (binding 12). Must match GridEntry in physics.slang.
+    struct GridEntry {
+        float position_x; //!< The node's position when it was sorted (NDC).
+        float position_y;
+        uint32_t node; //!< Index of the node in the batch.
+        uint32_t padding; //!< Keeps the stride at 16 bytes on both sides.
+    };
+
+    //! Batch motion read back after each simulating frame. Must match the float2 written by
+    //! motionReduceMain in physics.slang.
+    struct MotionStats {
+        float kinetic_energy; //!< Sum over all nodes of 0.5 * |v|^2 (unit node mass; NDC^2 / s^2).
+        float max_speed; //!< Fastest node speed (NDC / s).
+    };
+
+    //! Compute pipelines that run the string physics (physics.slang -> physics.spv). Owns the
+    //! descriptor-set layout (thirteen storage buffers: the output state slot's positions and
+    //! previous positions, the per-string parameters, the input slot's positions and previous
+    //! positions, the motion partials and result, the frame parameters, the cursor trail, the
+    //! obstacles, and the hash grid's cells, node cells and sorted entries) and pipeline layout
+    //! (with the PhysicsPush push-constant range) shared by all of them:
+    //! - workgroup(): one workgroup per string (up to PHYSICS_WORKGROUP_SIZE nodes) — physicsWaveMain
+    //!   (subgroup shuffles) where the device supports them, otherwise physicsMain (shared memory).
+    //! - integrate() + constrain(): the tiled solver for longer strings, one dispatch per pass.
+    //! - gridCount(), gridScan(), gridTotals(), gridScatter() + collide(): the tiled solver's
+    //!   self-collision, a counting sort of the nodes into the hash grid and the narrow phase.
+    //! - motion() + motionReduce(): the two-stage kinetic-energy / max-speed reduction.
+    //! Every pipeline is specialised for one PhysicsSpecialisation. The workgroup size is not a
+    //! specialisation constant: it sizes the shader's shared arrays, so it is compiled in already.
     class ComputePipeline {
     public:
         ComputePipeline() = default;
@@ -53,15 +184,74 @@ namespace Engine
         ComputePipeline(ComputePipeline&&) = delete;
         ComputePipeline& operator=(ComputePipeline&&) = delete;
 
-        //! Builds the compute pipeline. Returns false and fills out_error_message on failure.
-        [[nodiscard]] bool init(const Device& device, std::string& out_error_message);
+        //! Builds the compute pipelines, specialised for specialisation, through cache. Returns false
+        //! and fills out_error_message on failure.
+        [[nodiscard]] bool init(const Device& device, const vk::raii::PipelineCache& cache, const PhysicsSpecialisation& specialisation,
+            std::string& out_error_message);
 
-        //! Releases the pipeline + layouts. Safe to call repeatedly.
+        //! Releases the pipelines + layouts. Safe to call repeatedly.
         void destroy();
 
-        [[nodiscard]] const vk::raii::Pipeline& get() const
+        [[nodiscard]] const vk::raii::Pipeline& workgroup() const
+        {
+            return m_workgroup;
+        }
+
+        //! What the pipelines are specialised for (set by init()).
+        [[nodiscard]] const PhysicsSpecialisation& specialisation() const
+        {
+            return m_specialisation;
+        }
+
+        //! True when workgroup() is the subgroup-shuffle solver (physicsWaveMain).
+        [[nodiscard]] bool usesSubgroups() const
+        {
+            return m_uses_subgroups;
+        }
+
+        [[nodiscard]] const vk::raii::Pipeline& integrate() const
+        {
+            return m_integrate;
+        }
+
+        [[nodiscard]] const vk::raii::Pipeline& constrain() const
+        {
+            return m_constrain;
+        }
+
+        [[nodiscard]] const vk::raii::Pipeline& gridCount() const
+        {
+            return m_grid_count;
+        }
+
+        [[nodiscard]] const vk::raii::Pipeline& gridScan() const
+        {
+            return m_grid_scan;
+        }
+
+        [[nodiscard]] const vk::raii::Pipeline& gridTotals() const
+        {
+            return m_grid_totals;
+        }
+
+        [[nodiscard]] const vk::raii::Pipeline& gridScatter() const
+        {
+            return m_grid_scatter;
+        }
+
+        [[nodiscard]] const vk::raii::Pipeline& collide() const
+        {
+            return m_collide;
+        }
+
+        [[nodiscard]] const vk::raii::Pipeline& motion() const
+        {
+            return m_motion;
+        }
+
+        [[nodiscard]] const vk::raii::Pipeline& motionReduce() const
         {
-            return m_pipeline;
+            return m_motion_reduce;
         }
 
         [[nodiscard]] const vk::raii::PipelineLayout& layout() const
@@ -75,9 +265,20 @@ namespace Engine
         }
 
     private:
-        vk::raii::DescriptorSetLayout m_descriptor_set_layout{nullptr}; //!< Two storage buffers.
+        vk::raii::DescriptorSetLayout m_descriptor_set_layout{nullptr}; //!< PHYSICS_BINDING_COUNT storage buffers.
         vk::raii::PipelineLayout m_layout{nullptr}; //!< Set layout + PhysicsPush range.
-        vk::raii::Pipeline m_pipeline{nullptr}; //!< The compute pipeline.
+        vk::raii::Pipeline m_workgroup{nullptr}; //!< Single-workgroup solver (physicsWaveMain or physicsMain).
+        vk::raii::Pipeline m_integrate{nullptr}; //!< Tiled solver: Verlet step (integrateMain).
+        vk::raii::Pipeline m_constrain{nullptr}; //!< Tiled solver: one red-black half-pass (constrainMain).
+        vk::raii::Pipeline m_grid_count{nullptr}; //!< Tiled self-collision: nodes counted into cells (gridCountMain).
+        vk::raii::Pipeline m_grid_scan{nullptr}; //!< Tiled self-collision: cell starts per scan block (gridScanMain).
+        vk::raii::Pipeline m_grid_totals{nullptr}; //!< Tiled self-collision: scan block starts (gridTotalsMain).
+        vk::raii::Pipeline m_grid_scatter{nullptr}; //!< Tiled self-collision: nodes sorted by cell (gridScatterMain).
+        vk::raii::Pipeline m_collide{nullptr}; //!< Tiled self-collision: narrow phase (collideMain).
+        vk::raii::Pipeline m_motion{nullptr}; //!< Motion reduction stage 1: per-workgroup partials (motionMain).
+        vk::raii::Pipeline m_motion_reduce{nullptr}; //!< Motion reduction stage 2: partials to one result (motionReduceMain).
+        PhysicsSpecialisation m_specialisation{}; //!< See specialisation().
+        bool m_uses_subgroups{false}; //!< See usesSubgroups().
     };
 
 } // namespace Engine
@@ -14,13 +14,16 @@
 
 #include "device.hpp"
 #include "vulkan_helpers.hpp"
+#include <trace/tracer.hpp>
+#include <algorithm>
 #include <set>
+#include <string_view>
 #include <vector>
 
 namespace Engine
 {
 
-    //! Device extensions every supported GPU must provide.
+    //! Device extensions every supported GPU must provide to present.
     static const std::vector<const char*> REQUIRED_DEVICE_EXTENSIONS{VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
     Device::~Device()
@@ -28,6 +31,20 @@ namespace Engine
         destroy();
     }
 
+    //! UUID of physical_device (VkPhysicalDeviceIDProperties, core since 1.1) as 32 lower-case hex digits.
+    [[nodiscard]] static std::string deviceUuid(const vk::raii::PhysicalDevice& physical_device)
+    {
+        static constexpr std::string_view HEX_DIGITS{"0123456789abcdef"};
+        vk::StructureChain<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceIDProperties> properties_chain =
+            physical_device.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceIDProperties>();
+        std::string uuid;
+        for (uint8_t byte : properties_chain.get<vk::PhysicalDeviceIDProperties>().deviceUUID) {
+            uuid.push_back(HEX_DIGITS[byte >> 4]);
+            uuid.push_back(HEX_DIGITS[byte & 0xFu]);
+        }
+        return uuid;
+    }
+
     QueueFamilyIndices Device::findQueueFamilies(const vk::raii::PhysicalDevice& physical_device, const vk::raii::SurfaceKHR& surface)
     {
         QueueFamilyIndices indices{};
@@ -41,7 +58,11 @@ namespace Engine
                 indices.has_graphics = true;
             }
 
-            if (physical_device.getSurfaceSupportKHR(i, *surface)) {
+            // Headless (no surface): nothing is presented, so the graphics family stands in.
+            if (!*surface) {
+                indices.present = indices.graphics;
+                indices.has_present = indices.has_graphics;
+            } else if (physical_device.getSurfaceSupportKHR(i, *surface)) {
                 indices.present = i;
                 indices.has_present = true;
             }
@@ -51,10 +72,20 @@ namespace Engine
             }
         }
 
+        // A compute family without graphics is a separate hardware queue on the GPUs that have
+        // one (AMD, NVIDIA), so work submitted there can overlap the graphics queue.
+        for (uint32_t i = 0; i < families.size(); ++i) {
+            if ((families[i].queueFlags & vk::QueueFlagBits::eCompute) && !(families[i].queueFlags & vk::QueueFlagBits::eGraphics)) {
+                indices.compute = i;
+                indices.has_compute = true;
+                break;
+            }
+        }
+
         return indices;
     }
 
-    int Device::rateDevice(const vk::raii::PhysicalDevice& physical_device, const vk::raii::SurfaceKHR& surface)
+    int Device::rateDevice(const vk::raii::PhysicalDevice& physical_device, const vk::raii::SurfaceKHR& surface, GpuPreference preference)
     {
         QueueFamilyIndices indices = findQueueFamilies(physical_device, surface);
         if (!indices.isComplete()) {
@@ -62,7 +93,7 @@ namespace Engine
         }
 
         std::vector<vk::ExtensionProperties> available = physical_device.enumerateDeviceExtensionProperties();
-        for (const char* extension : REQUIRED_DEVICE_EXTENSIONS) {
+        for (const char* extension : requiredExtensions(surface)) {
             if (!isExtensionAvailable(available, extension)) {
                 return -1;
             }
@@ -75,10 +106,11 @@ namespace Engine
             return -1;
         }
         int score = 0;
+        bool low_power = (preference == GpuPreference::LowPower);
         if (properties.deviceType == vk::PhysicalDeviceType::eDiscreteGpu) {
-            score += 1000;
+            score += low_power ? 100 : 1000;
         } else if (properties.deviceType == vk::PhysicalDeviceType::eIntegratedGpu) {
-            score += 100;
+            score += low_power ? 1000 : 100;
         }
         // Prefer a single family handling both graphics and present (simpler sharing mode).
         if (indices.graphics == indices.present) {
@@ -87,8 +119,33 @@ namespace Engine
         return score;
     }
 
-    bool Device::init(const Instance& instance, const vk::raii::SurfaceKHR& surface, std::string& out_error_message)
+    std::vector<const char*> Device::requiredExtensions(const vk::raii::SurfaceKHR& surface)
+    {
+        return *surface ? REQUIRED_DEVICE_EXTENSIONS : std::vector<const char*>{};
+    }
+
+    bool Device::listGpus(const Instance& instance, const vk::raii::SurfaceKHR& surface, std::vector<GpuCandidate>& out_candidates, std::string& out_error_message)
+    {
+        try {
+            out_candidates.clear();
+            std::vector<vk::raii::PhysicalDevice> physical_devices = instance.get().enumeratePhysicalDevices();
+            for (size_t i = 0; i < physical_devices.size(); ++i) {
+                vk::PhysicalDeviceProperties properties = physical_devices[i].getProperties();
+                int rating = rateDevice(physical_devices[i], surface, GpuPreference::HighPerformance);
+                out_candidates.push_back(
+                    GpuCandidate{static_cast<uint32_t>(i), properties.deviceName.data(), deviceUuid(physical_devices[i]), properties.deviceType, rating >= 0, rating});
+            }
+        } catch (const vk::SystemError& e) {
+            out_error_message = std::string("Vulkan error listing GPUs: ") + e.what();
+            return false;
+        }
+        return true;
+    }
+
+    bool Device::init(const Instance& instance, const vk::raii::SurfaceKHR& surface, const GpuSelection& selection, const GpuScores& scores,
+        std::string& out_error_message)
     {
+        TRACE_ZONE("Device::init");
         try {
             std::vector<vk::raii::PhysicalDevice> physical_devices = instance.get().enumeratePhysicalDevices();
             if (physical_devices.empty()) {
@@ -96,30 +153,109 @@ namespace Engine
                 return false;
             }
 
-            int best_score = -1;
-            int best_index = -1;
+            std::vector<GpuCandidate> candidates;
             for (size_t i = 0; i < physical_devices.size(); ++i) {
-                int score = rateDevice(physical_devices[i], surface);
-                if (score > best_score) {
-                    best_score = score;
-                    best_index = static_cast<int>(i);
-                }
+                vk::PhysicalDeviceProperties candidate_properties = physical_devices[i].getProperties();
+                int rating = rateDevice(physical_devices[i], surface, selection.preference);
+                candidates.push_back(GpuCandidate{static_cast<uint32_t>(i), candidate_properties.deviceName.data(), deviceUuid(physical_devices[i]),
+                    candidate_properties.deviceType, rating >= 0, rating});
+            }
+            if (std::none_of(candidates.begin(), candidates.end(), [](const GpuCandidate& candidate) {
+                    return candidate.suitable;
+                })) {
+                out_error_message = *surface ? "No supported Vulkan physical device found (need graphics + present queues and swapchain support)."
+                                             : "No supported Vulkan physical device found (need a graphics queue).";
+                return false;
             }
 
-            if ((best_index < 0) || (best_score < 0)) {
-                out_error_message = "No supported Vulkan physical device found (need graphics + present queues and swapchain support).";
+            int selected = selectGpu(candidates, selection, scores, m_selection_reason, out_error_message);
+            if (selected < 0) {
                 return false;
             }
 
-            m_physical_device = std::move(physical_devices[static_cast<size_t>(best_index)]);
+            m_physical_device = std::move(physical_devices[static_cast<size_t>(selected)]);
 
             vk::PhysicalDeviceProperties properties = m_physical_device.getProperties();
             m_device_name = properties.deviceName.data();
+            m_uuid = candidates[static_cast<size_t>(selected)].uuid;
+
+            // Subgroup (wave) capabilities, core since 1.1: pick the shuffle-based physics solver
+            // where compute shaders can exchange values between lanes.
+            vk::StructureChain<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceSubgroupProperties> properties_chain =
+                m_physical_device.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceSubgroupProperties>();
+            const vk::PhysicalDeviceSubgroupProperties& subgroup = properties_chain.get<vk::PhysicalDeviceSubgroupProperties>();
+            vk::SubgroupFeatureFlags wanted_operations = vk::SubgroupFeatureFlagBits::eBasic | vk::SubgroupFeatureFlagBits::eShuffle;
+            m_subgroup_size = subgroup.subgroupSize;
+            m_subgroup_shuffle = (subgroup.supportedStages & vk::ShaderStageFlagBits::eCompute)
+                && ((subgroup.supportedOperations & wanted_operations) == wanted_operations);
 
             m_queue_families = findQueueFamilies(m_physical_device, surface);
 
+            // Timestamps for GPU frame timing: every queue the renderer submits timed work to must
+            // support them, the compute queue only when physics runs on it.
+            std::vector<vk::QueueFamilyProperties> families = m_physical_device.getQueueFamilyProperties();
+            m_timestamp_period = properties.limits.timestampPeriod;
+            m_timestamps = families[m_queue_families.graphics].timestampValidBits > 0;
+            m_compute_timestamps = m_queue_families.has_compute && (families[m_queue_families.compute].timestampValidBits > 0);
+
+            // Optional present pacing: presentId tags each present, presentWait blocks until one has
+            // reached the display. Only meaningful with a surface.
+            std::vector<const char*> extensions = requiredExtensions(surface);
+            m_present_wait = false;
+            vk::PhysicalDevicePresentIdFeaturesKHR present_id_features{};
+            vk::PhysicalDevicePresentWaitFeaturesKHR present_wait_features{};
+            if (*surface) {
+                std::vector<vk::ExtensionProperties> available = m_physical_device.enumerateDeviceExtensionProperties();
+                if (isExtensionAvailable(available, VK_KHR_PRESENT_ID_EXTENSION_NAME) && isExtensionAvailable(available, VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+                    vk::StructureChain<vk::PhysicalDeviceFeatures2, vk::PhysicalDevicePresentIdFeaturesKHR, vk::PhysicalDevicePresentWaitFeaturesKHR> features_chain =
+                        m_physical_device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDevicePresentIdFeaturesKHR, vk::PhysicalDevicePresentWaitFeaturesKHR>();
+                    m_present_wait = features_chain.get<vk::PhysicalDevicePresentIdFeaturesKHR>().presentId
+                        && features_chain.get<vk::PhysicalDevicePresentWaitFeaturesKHR>().presentWait;
+                }
+            }
+
+            // Optional swapchain maintenance: present fences, so a retired swapchain can be
+            // destroyed once its last presents are done with it rather than after a device idle.
+            m_swapchain_maintenance = false;
+            vk::PhysicalDeviceSwapchainMaintenance1FeaturesEXT swapchain_maintenance_features{};
+            if (*surface && instance.supportsSurfaceMaintenance()) {
+                std::vector<vk::ExtensionProperties> available = m_physical_device.enumerateDeviceExtensionProperties();
+                if (isExtensionAvailable(available, VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME)) {
+                    vk::StructureChain<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceSwapchainMaintenance1FeaturesEXT> features_chain =
+                        m_physical_device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceSwapchainMaintenance1FeaturesEXT>();
+                    m_swapchain_maintenance = features_chain.get<vk::PhysicalDeviceSwapchainMaintenance1FeaturesEXT>().swapchainMaintenance1;
+                }
+            }
+
+            // Optional memory budget: the driver's own per-heap usage and budget, including other
+            // processes' allocations, for the allocator's statistics. No feature struct.
+            m_memory_budget = isExtensionAvailable(m_physical_device.enumerateDeviceExtensionProperties(), VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+            if (m_memory_budget) {
+                extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+            }
+
+            // Chain the optional feature structs, last first, below the Vulkan 1.2 features.
+            void* optional_features = nullptr;
+            if (m_swapchain_maintenance) {
+                extensions.push_back(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+                swapchain_maintenance_features.swapchainMaintenance1 = vk::True;
+                optional_features = &swapchain_maintenance_features;
+            }
+            if (m_present_wait) {
+                extensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+                extensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+                present_id_features.presentId = vk::True;
+                present_wait_features.presentWait = vk::True;
+                present_wait_features.pNext = optional_features;
+                present_id_features.setPNext(&present_wait_features);
+                optional_features = &present_id_features;
+            }
+
             // Deduplicate queue family indices so each family is requested once.
             std::set<uint32_t> unique_families{m_queue_families.graphics, m_queue_families.present};
+            if (m_queue_families.has_compute) {
+                unique_families.insert(m_queue_families.compute);
+            }
             float queue_priority = 1.0f;
             std::vector<vk::DeviceQueueCreateInfo> queue_create_infos;
             for (uint32_t family : unique_families) {
@@ -130,17 +266,36 @@ namespace Engine
                 queue_create_infos.push_back(queue_create_info);
             }
 
+            // Optional: multiDrawIndirect lets one drawIndirect call draw every string, and
+            // drawIndirectCount one drawIndirectCount call only the strings the GPU has kept.
             vk::PhysicalDeviceFeatures enabled_features{};
+            m_draw_indirect_count = false;
+            if (m_physical_device.getFeatures().multiDrawIndirect) {
+                enabled_features.multiDrawIndirect = vk::True;
+                m_max_draw_indirect_count = properties.limits.maxDrawIndirectCount;
+                vk::StructureChain<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features> features_chain =
+                    m_physical_device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+                m_draw_indirect_count = features_chain.get<vk::PhysicalDeviceVulkan12Features>().drawIndirectCount;
+            } else {
+                m_max_draw_indirect_count = 1;
+            }
 
             // Vulkan 1.3 core features the renderer relies on: dynamic rendering (no render
             // pass / framebuffers) and synchronization2 (the pipelineBarrier2 / submit2 API).
+            // Timeline semaphores (core and mandatory since 1.2) hand the physics from the compute
+            // queue to the graphics queue.
+            vk::PhysicalDeviceVulkan12Features features12{};
+            features12.timelineSemaphore = vk::True;
+            features12.drawIndirectCount = m_draw_indirect_count ? vk::True : vk::False;
+            features12.pNext = optional_features;
             vk::PhysicalDeviceVulkan13Features features13{};
             features13.dynamicRendering = vk::True;
             features13.synchronization2 = vk::True;
+            features13.setPNext(&features12);
 
             vk::DeviceCreateInfo device_create_info{};
             device_create_info.setQueueCreateInfos(queue_create_infos);
-            device_create_info.setPEnabledExtensionNames(REQUIRED_DEVICE_EXTENSIONS);
+            device_create_info.setPEnabledExtensionNames(extensions);
             device_create_info.setPEnabledFeatures(&enabled_features);
             device_create_info.setPNext(&features13);
 
@@ -151,6 +306,9 @@ namespace Engine
 
             m_graphics_queue = m_device.getQueue(m_queue_families.graphics, 0);
             m_present_queue = m_device.getQueue(m_queue_families.present, 0);
+            if (m_queue_families.has_compute) {
+                m_compute_queue = m_device.getQueue(m_queue_families.compute, 0);
+            }
         } catch (const vk::SystemError& e) {
             out_error_message = std::string("Vulkan error during device creation: ") + e.what();
             return false;
@@ -166,6 +324,7 @@ namespace Engine
     {
         // Assigning nullptr to a vk::raii handle destroys it (queues are non-owning, but
         // resetting keeps state consistent). Logical device last.
+        m_compute_queue = nullptr;
         m_present_queue = nullptr;
         m_graphics_queue = nullptr;
         m_device = nullptr;
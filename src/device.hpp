@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include "gpu_scores.hpp"
+#include "gpu_selection.hpp"
 #include "instance.hpp"
 #ifdef _WIN32
 #include <Volk/volk.h>
@@ -23,16 +25,19 @@
 #include <vulkan/vulkan_raii.hpp>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace Engine
 {
 
-    //! Graphics and present queue family indices for a physical device.
+    //! Graphics, present and (optional) dedicated compute queue family indices for a physical device.
     struct QueueFamilyIndices {
         uint32_t graphics{0}; //!< Graphics-capable queue family index.
         uint32_t present{0}; //!< Presentation-capable queue family index.
+        uint32_t compute{0}; //!< Compute-only (no graphics) queue family index, for async compute.
         bool has_graphics{false}; //!< True once a graphics family has been found.
         bool has_present{false}; //!< True once a present family has been found.
+        bool has_compute{false}; //!< True when the device exposes a compute-only family.
 
         //! Returns true when both a graphics and a present family are available.
         [[nodiscard]] bool isComplete() const
@@ -42,8 +47,9 @@ namespace Engine
     };
 
     //! Selects a suitable physical device and owns the logical device + queue handles.
-    //! Requires graphics + present queues and the VK_KHR_swapchain extension; discrete GPUs
-    //! are preferred. vk::raii exceptions are caught in init() and translated to bool.
+    //! Requires graphics + present queues and the VK_KHR_swapchain extension (only a graphics
+    //! queue when headless); which suitable device is used follows a GpuSelection. vk::raii
+    //! exceptions are caught in init() and translated to bool.
     class Device {
     public:
         Device() = default;
@@ -54,9 +60,17 @@ namespace Engine
         Device(Device&&) = delete;
         Device& operator=(Device&&) = delete;
 
-        //! Picks a physical device and creates the logical device + queues. Returns false and
-        //! fills out_error_message on failure.
-        [[nodiscard]] bool init(const Instance& instance, const vk::raii::SurfaceKHR& surface, std::string& out_error_message);
+        //! Picks a physical device by selection (with scores informing GpuPreference::HighPerformance)
+        //! and creates the logical device + queues. With a null surface the device is headless:
+        //! no present queue (presentQueue() is the graphics queue) and no VK_KHR_swapchain. Returns
+        //! false and fills out_error_message on failure.
+        [[nodiscard]] bool init(const Instance& instance, const vk::raii::SurfaceKHR& surface, const GpuSelection& selection, const GpuScores& scores,
+            std::string& out_error_message);
+
+        //! Lists every physical device, marking those usable with surface (null: headless).
+        //! Returns false and fills out_error_message on failure.
+        [[nodiscard]] static bool listGpus(const Instance& instance, const vk::raii::SurfaceKHR& surface, std::vector<GpuCandidate>& out_candidates,
+            std::string& out_error_message);
 
         //! Destroys the logical device. Safe to call repeatedly.
         void destroy();
@@ -81,6 +95,19 @@ namespace Engine
             return m_present_queue;
         }
 
+        //! Queue of the dedicated compute family; null unless hasAsyncCompute().
+        [[nodiscard]] const vk::raii::Queue& computeQueue() const
+        {
+            return m_compute_queue;
+        }
+
+        //! True when a compute-only queue family exists, so compute work can run on its own queue
+        //! alongside the graphics queue.
+        [[nodiscard]] bool hasAsyncCompute() const
+        {
+            return m_queue_families.has_compute;
+        }
+
         [[nodiscard]] const QueueFamilyIndices& queueFamilies() const
         {
             return m_queue_families;
@@ -91,19 +118,108 @@ namespace Engine
             return m_device_name;
         }
 
+        //! Device UUID as 32 lower-case hex digits (the key of GpuScores).
+        [[nodiscard]] const std::string& uuid() const
+        {
+            return m_uuid;
+        }
+
+        //! Why init() picked this device, for the log (e.g. "named by the GPU selection").
+        [[nodiscard]] const std::string& selectionReason() const
+        {
+            return m_selection_reason;
+        }
+
+        //! Most draws one drawIndirect call may issue: 1 unless the multiDrawIndirect feature is
+        //! available (it is enabled whenever it is), otherwise the device's maxDrawIndirectCount.
+        [[nodiscard]] uint32_t maxDrawIndirectCount() const
+        {
+            return m_max_draw_indirect_count;
+        }
+
+        //! True when drawIndirectCount is enabled (core 1.2, optional; only alongside
+        //! multiDrawIndirect), so the GPU can write how many of the indirect draws to issue.
+        [[nodiscard]] bool supportsDrawIndirectCount() const
+        {
+            return m_draw_indirect_count;
+        }
+
+        //! Invocations per subgroup on this device (VkPhysicalDeviceSubgroupProperties::subgroupSize).
+        [[nodiscard]] uint32_t subgroupSize() const
+        {
+            return m_subgroup_size;
+        }
+
+        //! True when compute shaders may use subgroup shuffles (basic + shuffle operations).
+        [[nodiscard]] bool supportsSubgroupShuffle() const
+        {
+            return m_subgroup_shuffle;
+        }
+
+        //! True when the graphics queue, and the compute queue too if compute_queue (the renderer
+        //! submits work to it), can write timestamps.
+        [[nodiscard]] bool supportsTimestamps(bool compute_queue) const
+        {
+            return m_timestamps && (!compute_queue || m_compute_timestamps);
+        }
+
+        //! True when VK_KHR_present_id and VK_KHR_present_wait are enabled (a surface and a device
+        //! offering both), so presents can carry an id the CPU can wait for.
+        [[nodiscard]] bool supportsPresentWait() const
+        {
+            return m_present_wait;
+        }
+
+        //! True when VK_EXT_swapchain_maintenance1 is enabled (a surface, an instance with surface
+        //! maintenance and a device offering it), so presents can signal a fence.
+        [[nodiscard]] bool supportsSwapchainMaintenance() const
+        {
+            return m_swapchain_maintenance;
+        }
+
+        //! True when VK_EXT_memory_budget is enabled (the device offers it), so heap usage and
+        //! budget come from the driver rather than an estimate.
+        [[nodiscard]] bool supportsMemoryBudget() const
+        {
+            return m_memory_budget;
+        }
+
+        //! Nanoseconds per timestamp tick (VkPhysicalDeviceLimits::timestampPeriod).
+        [[nodiscard]] float timestampPeriod() const
+        {
+            return m_timestamp_period;
+        }
+
     private:
-        //! Finds graphics + present queue families for a physical device against a surface.
+        //! Finds graphics + present queue families for a physical device against a surface, and a
+        //! compute-only family if there is one.
         [[nodiscard]] static QueueFamilyIndices findQueueFamilies(const vk::raii::PhysicalDevice& physical_device, const vk::raii::SurfaceKHR& surface);
 
-        //! Scores a physical device for suitability; returns a negative value when unusable.
-        [[nodiscard]] static int rateDevice(const vk::raii::PhysicalDevice& physical_device, const vk::raii::SurfaceKHR& surface);
+        //! Scores a physical device for suitability under preference; returns a negative value when unusable.
+        [[nodiscard]] static int rateDevice(const vk::raii::PhysicalDevice& physical_device, const vk::raii::SurfaceKHR& surface, GpuPreference preference);
+
+        //! Device extensions required with or without a surface.
+        [[nodiscard]] static std::vector<const char*> requiredExtensions(const vk::raii::SurfaceKHR& surface);
 
         vk::raii::PhysicalDevice m_physical_device{nullptr}; //!< Chosen physical device.
         vk::raii::Device m_device{nullptr}; //!< Logical device handle.
         vk::raii::Queue m_graphics_queue{nullptr}; //!< Graphics queue handle.
         vk::raii::Queue m_present_queue{nullptr}; //!< Present queue handle.
+        vk::raii::Queue m_compute_queue{nullptr}; //!< Dedicated compute queue handle (null without one).
         QueueFamilyIndices m_queue_families{}; //!< Selected queue family indices.
         std::string m_device_name; //!< Human-readable name of the chosen device.
+        std::string m_uuid; //!< See uuid().
+        std::string m_selection_reason; //!< See selectionReason().
+        uint32_t m_max_draw_indirect_count{1}; //!< See maxDrawIndirectCount().
+        bool m_draw_indirect_count{false}; //!< See supportsDrawIndirectCount().
+        uint32_t m_subgroup_size{1}; //!< See subgroupSize().
+        bool m_subgroup_shuffle{false}; //!< See supportsSubgroupShuffle().
+        bool m_timestamps{false}; //!< The graphics queue can write timestamps (see supportsTimestamps()).
+        bool m_compute_timestamps{false}; //!< The compute queue exists and can write timestamps (see supportsTimestamps()).
+        bool m_present_wait{false}; //!< See supportsPresentWait().
+        bool m_swapchain_maintenance{false}; //!< See supportsSwapchainMaintenance().
+        bool m_memory_budget{false}; //!< See supportsMemoryBudget().
+        float m_timestamp_period{1.0f}; //!< See timestampPeriod().
     };
 
 } // namespace Engine
@@ -0,0 +1,47 @@
+# Embeds a SPIR-V binary in a C++ header as a constexpr uint32_t array, so the executables carry
+# their shaders instead of loading .spv files at run time. Run in script mode:
+#   cmake -DSPIRV_FILE=<in.spv> -DHEADER_FILE=<out.hpp> -DARRAY_NAME=<NAME> -P embed_spirv.cmake
+# SPIR-V is a stream of little-endian 32-bit words (the byte order of every supported target).
+
+foreach(variable SPIRV_FILE HEADER_FILE ARRAY_NAME)
+    if(NOT DEFINED ${variable})
+        message(FATAL_ERROR "embed_spirv.cmake: ${variable} is not set.")
+    endif()
+endforeach()
+
+file(READ "${SPIRV_FILE}" spirv_hex HEX)
+string(LENGTH "${spirv_hex}" hex_length)
+math(EXPR word_remainder "${hex_length} % 8")
+if((hex_length EQUAL 0) OR (NOT word_remainder EQUAL 0))
+    message(FATAL_ERROR "embed_spirv.cmake: ${SPIRV_FILE} is not a whole number of 32-bit words.")
+endif()
+string(SUBSTRING "${spirv_hex}" 0 8 magic)
+if(NOT magic STREQUAL "03022307")
+    message(FATAL_ERROR "embed_spirv.cmake: ${SPIRV_FILE} does not start with the little-endian SPIR-V magic number.")
+endif()
+
+# Bytes -> words, then eight words per line.
+string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1u," spirv_words "${spirv_hex}")
+string(REPEAT "0x[0-9a-f]+u," 8 line_pattern)
+string(REGEX REPLACE "(${line_pattern})" "\\1\n        " spirv_words "${spirv_words}")
+string(REPLACE ",0x" ", 0x" spirv_words "${spirv_words}")
+string(STRIP "${spirv_words}" spirv_words)
+get_filename_component(spirv_name "${SPIRV_FILE}" NAME)
+
+file(WRITE "${HEADER_FILE}"
+"// Generated from ${spirv_name} by embed_spirv.cmake. Do not edit.
+
+#pragma once
+
+#include <cstdint>
+
+namespace Engine
+{
+
+    //! SPIR-V words of ${spirv_name}.
+    inline constexpr uint32_t ${ARRAY_NAME}[] = {
+        ${spirv_words}
+    };
+
+} // namespace Engine
+")
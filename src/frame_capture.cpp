@@ -0,0 +1,262 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "frame_capture.hpp"
+#include <trace/tracer.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <csignal>
+#endif
+
+namespace Engine
+{
+
+    //! Bytes per captured pixel.
+    static constexpr std::size_t CAPTURE_PIXEL_SIZE = 4;
+
+    //! Prefix of an open() target that names a command to pipe to.
+    static constexpr char PIPE_PREFIX = '|';
+
+    //! Opens command for writing to its standard input.
+    [[nodiscard]] static std::FILE* openPipe(const std::string& command)
+    {
+#ifdef _WIN32
+        return _popen(command.c_str(), "wb");
+#else
+        // An encoder that exits early must fail the writes, not kill the process.
+        (void)std::signal(SIGPIPE, SIG_IGN);
+        return popen(command.c_str(), "w");
+#endif
+    }
+
+    //! Closes a pipe from openPipe(); returns false if the command failed.
+    [[nodiscard]] static bool closePipe(std::FILE* pipe)
+    {
+#ifdef _WIN32
+        return _pclose(pipe) == 0;
+#else
+        return pclose(pipe) == 0;
+#endif
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        std::string error_message;
+        (void)close(error_message);
+    }
+
+    bool FrameCapture::open(const std::string& target, CaptureFormat format, CapturePixelOrder order, uint32_t width, uint32_t height, uint32_t frame_rate,
+        const std::vector<const uint8_t*>& slots, std::string& out_error_message)
+    {
+        if (isOpen()) {
+            out_error_message = "The frame capture is already open.";
+            return false;
+        }
+        if (slots.empty() || (slots.size() > MAX_SLOTS) || (width == 0) || (height == 0)) {
+            out_error_message = "A frame capture needs 1 to " + std::to_string(MAX_SLOTS) + " slots and a non-zero size.";
+            return false;
+        }
+        if ((frame_rate == 0) || (frame_rate > MAX_FRAME_RATE)) {
+            out_error_message = "Capture frame rate " + std::to_string(frame_rate) + " is outside the supported range [1, " + std::to_string(MAX_FRAME_RATE) + "].";
+            return false;
+        }
+
+        m_pipe = !target.empty() && (target.front() == PIPE_PREFIX);
+        m_file = m_pipe ? openPipe(target.substr(1)) : std::fopen(target.c_str(), "wb");
+        if (m_file == nullptr) {
+            out_error_message = (m_pipe ? "Cannot start the capture command \"" + target.substr(1) : "Cannot open the capture file \"" + target) + "\": "
+                + std::strerror(errno) + ".";
+            return false;
+        }
+
+        m_format = format;
+        m_order = order;
+        m_frame_rate = frame_rate;
+        m_width = width;
+        m_height = height;
+        m_slots = slots;
+        for (std::atomic<bool>& busy : m_busy) {
+            busy.store(false, std::memory_order_relaxed);
+        }
+        m_next_slot = 0;
+        m_stopping.store(false, std::memory_order_relaxed);
+        m_failed = false;
+        m_holding = false;
+        m_first_output_us = 0;
+        m_output_index = 0;
+        m_last_time_us = 0;
+        m_written.store(0, std::memory_order_relaxed);
+        m_dropped.store(0, std::memory_order_relaxed);
+
+        m_held.resize(static_cast<std::size_t>(width) * height * ((m_format == CaptureFormat::Y4m) ? 3 : CAPTURE_PIXEL_SIZE));
+        if (m_format == CaptureFormat::Y4m) {
+            std::string header = "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) + " F" + std::to_string(frame_rate) + ":1 Ip A1:1 C444\n";
+            if (std::fwrite(header.data(), 1, header.size(), m_file) != header.size()) {
+                out_error_message = "Failed to write to the capture target \"" + target + "\".";
+                std::string close_error;
+                (void)close(close_error);
+                return false;
+            }
+        }
+        m_worker = std::thread([this]() {
+            run();
+        });
+        return true;
+    }
+
+    bool FrameCapture::acquire(uint64_t time_us, uint32_t& out_slot)
+    {
+        uint32_t slot_count = static_cast<uint32_t>(m_slots.size());
+        for (uint32_t i = 0; i < slot_count; ++i) {
+            uint32_t slot = (m_next_slot + i) % slot_count;
+            // Acquire: the writer's reads of the slot happen before the GPU overwrites it.
+            if (!m_busy[slot].load(std::memory_order_acquire)) {
+                m_busy[slot].store(true, std::memory_order_relaxed);
+                m_slot_time_us[slot] = time_us;
+                m_next_slot = (slot + 1) % slot_count;
+                out_slot = slot;
+                return true;
+            }
+        }
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void FrameCapture::submit(uint32_t slot)
+    {
+        (void)m_ready.emit(slot);
+        m_wake.fetch_add(1, std::memory_order_release);
+        m_wake.notify_one();
+    }
+
+    bool FrameCapture::close(std::string& out_error_message)
+    {
+        if (!isOpen()) {
+            return true;
+        }
+        if (m_worker.joinable()) {
+            m_stopping.store(true, std::memory_order_release);
+            m_wake.fetch_add(1, std::memory_order_release);
+            m_wake.notify_one();
+            m_worker.join();
+        }
+
+        bool ok = !m_failed;
+        if (m_pipe ? !closePipe(m_file) : (std::fclose(m_file) != 0)) {
+            ok = false;
+        }
+        m_file = nullptr;
+        m_slots.clear();
+        m_held.clear();
+        if (!ok) {
+            out_error_message = m_pipe ? "The capture command failed or exited early." : "Failed to write the capture file.";
+        }
+        return ok;
+    }
+
+    void FrameCapture::run()
+    {
+        TracingLib::setThreadName("capture");
+        for (;;) {
+            uint32_t wake = m_wake.load(std::memory_order_acquire);
+            drain();
+            // Every submit() precedes the stop, so a drain after seeing it finds them all.
+            if (m_stopping.load(std::memory_order_acquire)) {
+                drain();
+                // The last frame is on for one output frame.
+                if (m_holding && !m_failed) {
+                    if (writeHeld()) {
+                        m_written.fetch_add(1, std::memory_order_relaxed);
+                    } else {
+                        m_failed = true;
+                    }
+                }
+                return;
+            }
+            m_wake.wait(wake, std::memory_order_acquire);
+        }
+    }
+
+    void FrameCapture::drain()
+    {
+        uint32_t slot{0};
+        while (m_ready.consume(slot)) {
+            if (m_failed) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                hold(m_slots[slot], m_slot_time_us[slot]);
+            }
+            m_busy[slot].store(false, std::memory_order_release);
+        }
+    }
+
+    void FrameCapture::hold(const uint8_t* pixels, uint64_t time_us)
+    {
+        TRACE_ZONE("capture write");
+        time_us = std::max(time_us, m_last_time_us);
+        if (!m_holding) {
+            m_first_output_us = time_us;
+            m_output_index = 0;
+        }
+        // The held frame covers the output frames up to this one's time.
+        while (m_holding && (outputTimeUs(m_output_index) < time_us)) {
+            if (!writeHeld()) {
+                m_failed = true;
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            m_written.fetch_add(1, std::memory_order_relaxed);
+            ++m_output_index;
+        }
+        m_last_time_us = time_us;
+        m_holding = true;
+
+        std::size_t pixel_count = static_cast<std::size_t>(m_width) * m_height;
+        if (m_format == CaptureFormat::Raw) {
+            std::memcpy(m_held.data(), pixels, pixel_count * CAPTURE_PIXEL_SIZE);
+            return;
+        }
+
+        // BT.601 limited range in 8-bit fixed point, one plane after another.
+        std::size_t red = (m_order == CapturePixelOrder::Bgra) ? 2 : 0;
+        std::size_t blue = 2 - red;
+        uint8_t* y_plane = m_held.data();
+        uint8_t* u_plane = y_plane + pixel_count;
+        uint8_t* v_plane = u_plane + pixel_count;
+        for (std::size_t i = 0; i < pixel_count; ++i) {
+            const uint8_t* pixel = pixels + i * CAPTURE_PIXEL_SIZE;
+            int32_t r = pixel[red];
+            int32_t g = pixel[1];
+            int32_t b = pixel[blue];
+            y_plane[i] = static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+            u_plane[i] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            v_plane[i] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+
+    bool FrameCapture::writeHeld()
+    {
+        if (m_format == CaptureFormat::Y4m) {
+            static constexpr char FRAME_HEADER[] = "FRAME\n";
+            if (std::fwrite(FRAME_HEADER, 1, sizeof(FRAME_HEADER) - 1, m_file) != (sizeof(FRAME_HEADER) - 1)) {
+                return false;
+            }
+        }
+        return std::fwrite(m_held.data(), 1, m_held.size(), m_file) == m_held.size();
+    }
+
+} // namespace Engine
@@ -0,0 +1,173 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include <signal/ring_signal.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Engine
+{
+
+    //! How FrameCapture writes frames.
+    enum class CaptureFormat {
+        Raw, //!< The 8-bit pixels as drawn (4 bytes each, CapturePixelOrder), frame after frame, no header.
+        Y4m //!< YUV4MPEG2, 4:4:4 BT.601 limited range (what encoders such as ffmpeg read from a pipe).
+    };
+
+    //! Byte order of a captured pixel (the colour format of the captured image).
+    enum class CapturePixelOrder {
+        Bgra, //!< B8G8R8A8.
+        Rgba //!< R8G8B8A8.
+    };
+
+    /*!
+        Writes captured frames to a file, or to the standard input of a command, on a worker
+        thread. The frames arrive in a ring of slots the caller owns (host-visible readback
+        memory): the render thread acquire()s a free slot for a frame, has the GPU copy the frame
+        into it, and submit()s it once the frame's fence has signalled; the worker writes it out
+        and frees the slot. Neither call blocks — when the writer has fallen behind and holds
+        every slot, acquire() fails and the frame is counted as dropped instead.
+
+        Frames are drawn on demand, at whatever pace the frame loop picks and not at all while
+        idle, so the writer resamples them onto a fixed frame rate: each output frame is the
+        newest drawn at or before its time. A frame stays on for every output frame until the
+        next one is drawn — across idle stretches, slow frames and dropped ones — and a frame
+        replaced before its time came is never written. The capture plays back as it happened.
+    */
+    class FrameCapture {
+    public:
+        //! Most slots in the ring.
+        static constexpr uint32_t MAX_SLOTS = 8;
+        //! Output frame rate unless open() is given another.
+        static constexpr uint32_t DEFAULT_FRAME_RATE = 60;
+        //! Highest output frame rate.
+        static constexpr uint32_t MAX_FRAME_RATE = 240;
+
+        FrameCapture() = default;
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+        FrameCapture(FrameCapture&&) = delete;
+        FrameCapture& operator=(FrameCapture&&) = delete;
+
+        //! Opens target — a file path, or "|command" to pipe to the command's standard input —
+        //! and starts the writer for width x height frames read from slots (one pointer per
+        //! slot, up to MAX_SLOTS, to width * height * 4 bytes of tightly packed rows; valid until
+        //! close()), written at frame_rate frames a second (1 to MAX_FRAME_RATE). Returns false
+        //! and fills out_error_message on failure.
+        [[nodiscard]] bool open(const std::string& target, CaptureFormat format, CapturePixelOrder order, uint32_t width, uint32_t height, uint32_t frame_rate,
+            const std::vector<const uint8_t*>& slots, std::string& out_error_message);
+
+        //! True between a successful open() and close().
+        [[nodiscard]] bool isOpen() const
+        {
+            return m_file != nullptr;
+        }
+
+        //! Render thread: claims a free slot for the next frame, which shows time_us (steady
+        //! clock, µs; not before the previous frame's). Returns false, counting the frame as
+        //! dropped, when the writer holds every slot.
+        [[nodiscard]] bool acquire(uint64_t time_us, uint32_t& out_slot);
+
+        //! Render thread: hands an acquire()d slot, which the GPU has finished writing, to the writer.
+        void submit(uint32_t slot);
+
+        //! Render thread: counts a frame that was not captured for another reason.
+        void drop()
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        //! Writes every submitted frame, stops the writer and closes the target. Returns false and
+        //! fills out_error_message if a write failed (the frames from then on were dropped).
+        [[nodiscard]] bool close(std::string& out_error_message);
+
+        //! Output frames written so far (a frame held across several counts once for each).
+        [[nodiscard]] uint64_t framesWritten() const
+        {
+            return m_written.load(std::memory_order_relaxed);
+        }
+
+        //! Frames dropped so far (no free slot, drop(), or after a failed write).
+        [[nodiscard]] uint64_t framesDropped() const
+        {
+            return m_dropped.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] uint32_t width() const
+        {
+            return m_width;
+        }
+
+        [[nodiscard]] uint32_t height() const
+        {
+            return m_height;
+        }
+
+    private:
+        //! Worker: writes submitted slots until close().
+        void run();
+
+        //! Worker: takes every slot submitted so far and frees it.
+        void drain();
+
+        //! Worker: writes the held frame for each output frame due before time_us, then holds
+        //! pixels (shown from time_us) in its place.
+        void hold(const uint8_t* pixels, uint64_t time_us);
+
+        //! Worker: time of output frame index (µs), counted from the first frame held. Computed
+        //! from the index rather than summed from a period, so a rate that does not divide a
+        //! second does not drift.
+        [[nodiscard]] uint64_t outputTimeUs(uint64_t index) const
+        {
+            return m_first_output_us + index * 1000000 / m_frame_rate;
+        }
+
+        //! Worker: writes the held frame once. Returns false on a write error.
+        [[nodiscard]] bool writeHeld();
+
+        std::FILE* m_file{nullptr}; //!< Output file or pipe (null: closed).
+        bool m_pipe{false}; //!< m_file came from popen().
+        CaptureFormat m_format{CaptureFormat::Y4m}; //!< See open().
+        CapturePixelOrder m_order{CapturePixelOrder::Bgra}; //!< See open().
+        uint32_t m_frame_rate{DEFAULT_FRAME_RATE}; //!< Output frames per second.
+        uint32_t m_width{0}; //!< Frame size (pixels).
+        uint32_t m_height{0};
+        std::vector<const uint8_t*> m_slots; //!< Slot memory (caller-owned).
+        std::array<std::atomic<bool>, MAX_SLOTS> m_busy{}; //!< Per slot: acquired and not yet written.
+        std::array<uint64_t, MAX_SLOTS> m_slot_time_us{}; //!< Per slot: what acquire() was given (published by submit()).
+        uint32_t m_next_slot{0}; //!< Render thread: where acquire() starts looking.
+        SignalsLib::SpscSignal<uint32_t, MAX_SLOTS> m_ready; //!< Submitted slots, oldest first (never full: a slot is in it at most once).
+        std::atomic<uint32_t> m_wake{0}; //!< Bumped and notified on each submit() and by close().
+        std::atomic<bool> m_stopping{false}; //!< close() has been called.
+        std::vector<uint8_t> m_held; //!< Worker: the newest frame, ready to write (raw pixels, or three Y4M planes).
+        bool m_holding{false}; //!< Worker: m_held holds a frame.
+        uint64_t m_first_output_us{0}; //!< Worker: time of the first output frame (that of the first frame held).
+        uint64_t m_output_index{0}; //!< Worker: index of the next output frame.
+        uint64_t m_last_time_us{0}; //!< Worker: time of the held frame.
+        bool m_failed{false}; //!< Worker: a write failed (read by close() after the join).
+        std::atomic<uint64_t> m_written{0}; //!< See framesWritten().
+        std::atomic<uint64_t> m_dropped{0}; //!< See framesDropped().
+        std::thread m_worker; //!< Runs run().
+    };
+
+} // namespace Engine
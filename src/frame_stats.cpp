@@ -0,0 +1,219 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "frame_stats.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace Engine
+{
+
+    //! Log and CSV names of the counters, in FrameCounter order.
+    static constexpr std::array<const char*, FRAME_COUNTER_COUNT> COUNTER_NAMES{"frames", "input_events", "swapchain_recreations", "frame_failures", "active_us",
+        "idle_us", "capture_drops", "physics_ticks"};
+
+    //! Log and CSV names of the histograms, in FrameHistogram order.
+    static constexpr std::array<const char*, FRAME_HISTOGRAM_COUNT> HISTOGRAM_NAMES{"interval", "fence_wait", "cpu_record", "gpu_frame", "physics_tick"};
+
+    //! Buckets per octave above bucket 0.
+    static constexpr uint32_t BUCKETS_PER_OCTAVE = 8;
+
+    //! Bit width of FIRST_BUCKET_US: a sample of that width is in the first octave.
+    static constexpr int FIRST_OCTAVE_WIDTH = std::bit_width(HistogramSnapshot::FIRST_BUCKET_US);
+
+    //! A first-octave sample shifted right by this is in [BUCKETS_PER_OCTAVE, 2 * BUCKETS_PER_OCTAVE).
+    static constexpr uint32_t OCTAVE_SHIFT = static_cast<uint32_t>(std::countr_zero(HistogramSnapshot::FIRST_BUCKET_US) - std::countr_zero(BUCKETS_PER_OCTAVE));
+
+    uint32_t HistogramSnapshot::bucketOf(uint64_t us)
+    {
+        if (us < FIRST_BUCKET_US) {
+            return 0;
+        }
+        // The octave is the bit width past the first one; the bits below its leading one pick the sub-bucket.
+        uint32_t octave = static_cast<uint32_t>(std::bit_width(us) - FIRST_OCTAVE_WIDTH);
+        uint32_t sub_bucket = static_cast<uint32_t>((us >> (octave + OCTAVE_SHIFT)) & (BUCKETS_PER_OCTAVE - 1));
+        return std::min(1 + (octave * BUCKETS_PER_OCTAVE) + sub_bucket, BUCKET_COUNT - 1);
+    }
+
+    uint64_t HistogramSnapshot::bucketLowerUs(uint32_t bucket)
+    {
+        if (bucket == 0) {
+            return 0;
+        }
+        uint32_t octave = (bucket - 1) / BUCKETS_PER_OCTAVE;
+        uint32_t sub_bucket = (bucket - 1) % BUCKETS_PER_OCTAVE;
+        return static_cast<uint64_t>(BUCKETS_PER_OCTAVE + sub_bucket) << (octave + OCTAVE_SHIFT);
+    }
+
+    uint64_t HistogramSnapshot::bucketUpperUs(uint32_t bucket)
+    {
+        return ((bucket + 1) < BUCKET_COUNT) ? bucketLowerUs(bucket + 1) : UINT64_MAX;
+    }
+
+    double HistogramSnapshot::meanUs() const
+    {
+        return (count > 0) ? (static_cast<double>(sum_us) / static_cast<double>(count)) : 0.0;
+    }
+
+    uint64_t HistogramSnapshot::quantileUs(double fraction) const
+    {
+        // Bucket counts rather than count: they may be a sample apart in a live snapshot.
+        uint64_t total{0};
+        for (uint64_t bucket_count : buckets) {
+            total += bucket_count;
+        }
+        if (total == 0) {
+            return 0;
+        }
+
+        // Nearest rank: the smallest sample at or above fraction of them.
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(total))));
+        uint64_t seen{0};
+        for (uint32_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+            seen += buckets[bucket];
+            if (seen >= rank) {
+                return ((bucket + 1) < BUCKET_COUNT) ? bucketUpperUs(bucket) : bucketLowerUs(bucket);
+            }
+        }
+        return bucketLowerUs(BUCKET_COUNT - 1);
+    }
+
+    HistogramSnapshot HistogramSnapshot::since(const HistogramSnapshot& earlier) const
+    {
+        HistogramSnapshot delta{};
+        for (uint32_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+            delta.buckets[bucket] = buckets[bucket] - earlier.buckets[bucket];
+        }
+        delta.count = count - earlier.count;
+        delta.sum_us = sum_us - earlier.sum_us;
+        return delta;
+    }
+
+    FrameStatsSnapshot FrameStatsSnapshot::since(const FrameStatsSnapshot& earlier) const
+    {
+        FrameStatsSnapshot delta{};
+        for (uint32_t counter = 0; counter < FRAME_COUNTER_COUNT; ++counter) {
+            delta.counters[counter] = counters[counter] - earlier.counters[counter];
+        }
+        for (uint32_t histogram = 0; histogram < FRAME_HISTOGRAM_COUNT; ++histogram) {
+            delta.histograms[histogram] = histograms[histogram].since(earlier.histograms[histogram]);
+        }
+        return delta;
+    }
+
+    std::string FrameStatsSnapshot::summary() const
+    {
+        uint64_t frames = counter(FrameCounter::Frames);
+        uint64_t inputs = counter(FrameCounter::InputEvents);
+        std::ostringstream text;
+        text.setf(std::ios::fixed);
+        text.precision(2);
+        text << "Frame stats: " << frames << " frames, " << inputs << " input events";
+        if (inputs > 0) {
+            text << " (" << (static_cast<double>(frames) / static_cast<double>(inputs)) << " frames/event)";
+        }
+        text << ", active " << (static_cast<double>(counter(FrameCounter::ActiveMicroseconds)) * 1e-6) << " s, idle "
+             << (static_cast<double>(counter(FrameCounter::IdleMicroseconds)) * 1e-6) << " s, " << counter(FrameCounter::SwapchainRecreations)
+             << " swapchain recreations, " << counter(FrameCounter::FrameFailures) << " failed frames";
+        if (counter(FrameCounter::CaptureDrops) > 0) {
+            text << ", " << counter(FrameCounter::CaptureDrops) << " dropped captures";
+        }
+        if (counter(FrameCounter::PhysicsTicks) > 0) {
+            text << ", " << counter(FrameCounter::PhysicsTicks) << " physics ticks";
+        }
+        text << "; ms (avg/p50/p99/max):";
+        for (uint32_t histogram = 0; histogram < FRAME_HISTOGRAM_COUNT; ++histogram) {
+            const HistogramSnapshot& samples = histograms[histogram];
+            if (samples.count == 0) {
+                continue;
+            }
+            text << " " << HISTOGRAM_NAMES[histogram] << " " << (samples.meanUs() * 1e-3) << "/" << (static_cast<double>(samples.quantileUs(0.5)) * 1e-3) << "/"
+                 << (static_cast<double>(samples.quantileUs(0.99)) * 1e-3) << "/" << (static_cast<double>(samples.quantileUs(1.0)) * 1e-3);
+        }
+        return text.str();
+    }
+
+    bool FrameStatsSnapshot::writeCsv(const std::string& path, std::string& out_error_message) const
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            out_error_message = "Cannot open \"" + path + "\" for writing.";
+            return false;
+        }
+
+        file << "kind,name,bucket_upper_us,value\n";
+        for (uint32_t counter = 0; counter < FRAME_COUNTER_COUNT; ++counter) {
+            file << "counter," << COUNTER_NAMES[counter] << ",," << counters[counter] << "\n";
+        }
+        for (uint32_t histogram = 0; histogram < FRAME_HISTOGRAM_COUNT; ++histogram) {
+            const HistogramSnapshot& samples = histograms[histogram];
+            file << "count," << HISTOGRAM_NAMES[histogram] << ",," << samples.count << "\n";
+            file << "sum_us," << HISTOGRAM_NAMES[histogram] << ",," << samples.sum_us << "\n";
+            for (uint32_t bucket = 0; bucket < HistogramSnapshot::BUCKET_COUNT; ++bucket) {
+                if (samples.buckets[bucket] == 0) {
+                    continue;
+                }
+                file << "bucket," << HISTOGRAM_NAMES[histogram] << ",";
+                if ((bucket + 1) < HistogramSnapshot::BUCKET_COUNT) {
+                    file << HistogramSnapshot::bucketUpperUs(bucket);
+                } else {
+                    file << "inf";
+                }
+                file << "," << samples.buckets[bucket] << "\n";
+            }
+        }
+
+        file.flush();
+        if (!file.good()) {
+            out_error_message = "Failed to write the frame statistics file \"" + path + "\".";
+            return false;
+        }
+        return true;
+    }
+
+    void FrameStats::record(FrameHistogram id, uint64_t us)
+    {
+        LiveHistogram& histogram = m_histograms[static_cast<uint32_t>(id)];
+        histogram.buckets[HistogramSnapshot::bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+        histogram.count.fetch_add(1, std::memory_order_relaxed);
+        histogram.sum_us.fetch_add(us, std::memory_order_relaxed);
+    }
+
+    void FrameStats::recordMs(FrameHistogram id, float ms)
+    {
+        record(id, (ms > 0.0f) ? static_cast<uint64_t>(ms * 1000.0f) : 0);
+    }
+
+    FrameStatsSnapshot FrameStats::snapshot() const
+    {
+        FrameStatsSnapshot snapshot{};
+        for (uint32_t counter = 0; counter < FRAME_COUNTER_COUNT; ++counter) {
+            snapshot.counters[counter] = m_counters[counter].load(std::memory_order_relaxed);
+        }
+        for (uint32_t histogram = 0; histogram < FRAME_HISTOGRAM_COUNT; ++histogram) {
+            const LiveHistogram& live = m_histograms[histogram];
+            HistogramSnapshot& samples = snapshot.histograms[histogram];
+            for (uint32_t bucket = 0; bucket < HistogramSnapshot::BUCKET_COUNT; ++bucket) {
+                samples.buckets[bucket] = live.buckets[bucket].load(std::memory_order_relaxed);
+            }
+            samples.count = live.count.load(std::memory_order_relaxed);
+            samples.sum_us = live.sum_us.load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+} // namespace Engine
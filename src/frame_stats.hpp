@@ -0,0 +1,161 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace Engine
+{
+
+    //! Event counts and accumulated times kept by FrameStats.
+    enum class FrameCounter : uint32_t {
+        Frames, //!< Frames submitted.
+        InputEvents, //!< Window events the frame loop woke for (cursor moves, resizes, exposes, moves).
+        SwapchainRecreations, //!< Swapchain rebuilds (resize, out of date, suboptimal).
+        FrameFailures, //!< Frames drawFrame() gave up on after a Vulkan error.
+        ActiveMicroseconds, //!< Time the frame loop spent wanting frames.
+        IdleMicroseconds, //!< Time the frame loop spent asleep, settled or minimised.
+        CaptureDrops, //!< Frames the frame capture skipped (its writer held every readback slot, or the size changed).
+        PhysicsTicks, //!< Simulation ticks the physics thread submitted (RendererConfig::physics_thread).
+        Count //!< Number of counters (not a counter).
+    };
+
+    //! Number of FrameCounter values.
+    static constexpr uint32_t FRAME_COUNTER_COUNT = static_cast<uint32_t>(FrameCounter::Count);
+
+    //! Per-frame durations kept by FrameStats as histograms.
+    enum class FrameHistogram : uint32_t {
+        Interval, //!< Time between frames (the dt handed to drawFrame()).
+        FenceWait, //!< drawFrame() blocked on the frame-in-flight fence.
+        CpuRecord, //!< CPU time from the fence wait to the graphics submit (recording + submits).
+        GpuFrame, //!< GPU frame time (FrameTimings::gpu_frame_ms; only with timestamp support).
+        PhysicsTick, //!< Physics thread tick from recording to the GPU finishing it (only with the physics thread).
+        Count //!< Number of histograms (not a histogram).
+    };
+
+    //! Number of FrameHistogram values.
+    static constexpr uint32_t FRAME_HISTOGRAM_COUNT = static_cast<uint32_t>(FrameHistogram::Count);
+
+    //! Counts of one duration histogram at some moment. Buckets are fixed: bucket 0 holds samples
+    //! under FIRST_BUCKET_US, then each octave is split into 8 buckets (a bucket spans at most 12.5%
+    //! of its lower bound), and the last bucket holds everything from about 229 ms up.
+    struct HistogramSnapshot {
+        //! Buckets per histogram.
+        static constexpr uint32_t BUCKET_COUNT = 96;
+        //! Upper bound of bucket 0 (µs).
+        static constexpr uint64_t FIRST_BUCKET_US = 64;
+
+        std::array<uint64_t, BUCKET_COUNT> buckets{}; //!< Samples per bucket.
+        uint64_t count{0}; //!< Samples in all buckets.
+        uint64_t sum_us{0}; //!< Sum of the samples (µs).
+
+        //! Bucket a sample of us microseconds falls into.
+        [[nodiscard]] static uint32_t bucketOf(uint64_t us);
+
+        //! Smallest sample bucket holds (µs).
+        [[nodiscard]] static uint64_t bucketLowerUs(uint32_t bucket);
+
+        //! First sample past bucket (µs; UINT64_MAX for the last bucket).
+        [[nodiscard]] static uint64_t bucketUpperUs(uint32_t bucket);
+
+        //! Mean sample (µs; 0 without samples).
+        [[nodiscard]] double meanUs() const;
+
+        //! Upper bound of the bucket holding the nearest-rank fraction-quantile (fraction in
+        //! [0, 1]): an estimate no lower than the true value and at most 12.5% above it, except in
+        //! the last bucket where it is its lower bound. 0 without samples.
+        [[nodiscard]] uint64_t quantileUs(double fraction) const;
+
+        //! The samples recorded after earlier (a snapshot of the same histogram taken before this one).
+        [[nodiscard]] HistogramSnapshot since(const HistogramSnapshot& earlier) const;
+    };
+
+    //! Every counter and histogram of a FrameStats at some moment.
+    struct FrameStatsSnapshot {
+        std::array<uint64_t, FRAME_COUNTER_COUNT> counters{}; //!< Per FrameCounter.
+        std::array<HistogramSnapshot, FRAME_HISTOGRAM_COUNT> histograms{}; //!< Per FrameHistogram.
+
+        //! Value of one counter.
+        [[nodiscard]] uint64_t counter(FrameCounter id) const
+        {
+            return counters[static_cast<uint32_t>(id)];
+        }
+
+        //! One histogram.
+        [[nodiscard]] const HistogramSnapshot& histogram(FrameHistogram id) const
+        {
+            return histograms[static_cast<uint32_t>(id)];
+        }
+
+        //! What happened after earlier (a snapshot taken before this one), e.g. for a periodic summary.
+        [[nodiscard]] FrameStatsSnapshot since(const FrameStatsSnapshot& earlier) const;
+
+        //! One-line summary, e.g. for a periodic log line.
+        [[nodiscard]] std::string summary() const;
+
+        //! Writes every counter and every non-empty histogram bucket as CSV ("kind,name,bucket_upper_us,value"),
+        //! so runs on different machines or builds can be compared. Returns false and fills
+        //! out_error_message if the file cannot be written.
+        [[nodiscard]] bool writeCsv(const std::string& path, std::string& out_error_message) const;
+    };
+
+    /*!
+        Field telemetry of the frame loop: counters and fixed-bucket duration histograms, updated
+        as frames are drawn and queryable from any thread at any time. Every update is a relaxed
+        atomic add on a preallocated slot — no lock, no allocation — so the render thread pays a
+        few uncontended atomics per frame and a reader never blocks it. A snapshot() reads each
+        value exactly, but the values are not one atomic cut: a frame recorded meanwhile may show
+        in one histogram and not yet in another.
+    */
+    class FrameStats {
+    public:
+        FrameStats() = default;
+
+        FrameStats(const FrameStats&) = delete;
+        FrameStats& operator=(const FrameStats&) = delete;
+        FrameStats(FrameStats&&) = delete;
+        FrameStats& operator=(FrameStats&&) = delete;
+
+        //! Adds amount to one counter.
+        void add(FrameCounter id, uint64_t amount = 1)
+        {
+            m_counters[static_cast<uint32_t>(id)].fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        //! Records one sample of us microseconds into a histogram.
+        void record(FrameHistogram id, uint64_t us);
+
+        //! Records one sample of ms milliseconds (negative counts as 0) into a histogram.
+        void recordMs(FrameHistogram id, float ms);
+
+        //! Current value of every counter and histogram.
+        [[nodiscard]] FrameStatsSnapshot snapshot() const;
+
+    private:
+        //! One histogram's live counts.
+        struct LiveHistogram {
+            std::array<std::atomic<uint64_t>, HistogramSnapshot::BUCKET_COUNT> buckets{}; //!< Samples per bucket.
+            std::atomic<uint64_t> count{0}; //!< Samples in all buckets.
+            std::atomic<uint64_t> sum_us{0}; //!< Sum of the samples (µs).
+        };
+
+        std::array<std::atomic<uint64_t>, FRAME_COUNTER_COUNT> m_counters{}; //!< Per FrameCounter.
+        std::array<LiveHistogram, FRAME_HISTOGRAM_COUNT> m_histograms{}; //!< Per FrameHistogram.
+    };
+
+} // namespace Engine
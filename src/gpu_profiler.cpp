@@ -0,0 +1,178 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "gpu_profiler.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace Engine
+{
+
+    //! Log names of the phases, in GpuPhase order.
+    static constexpr std::array<const char*, GPU_PHASE_COUNT> PHASE_NAMES{"physics", "transitions", "draw", "upscale", "capture"};
+
+    bool GpuProfiler::init(const Device& device, uint32_t frames_in_flight, bool compute_queue, std::string& out_error_message)
+    {
+        m_frames.assign(frames_in_flight, FrameScopes{});
+        for (FrameScopes& frame : m_frames) {
+            frame.open.fill(MAX_SCOPES_PER_FRAME);
+        }
+        m_history = {};
+        m_ms_per_tick = device.timestampPeriod() * 1e-6f;
+        if (!device.supportsTimestamps(compute_queue)) {
+            return true;
+        }
+
+        try {
+            vk::QueryPoolCreateInfo query_info{};
+            query_info.queryType = vk::QueryType::eTimestamp;
+            query_info.queryCount = 2 * MAX_SCOPES_PER_FRAME * frames_in_flight;
+            m_pool = vk::raii::QueryPool(device.get(), query_info);
+        } catch (const vk::SystemError& e) {
+            out_error_message = std::string("Vulkan error creating the timestamp query pool: ") + e.what();
+            return false;
+        }
+        return true;
+    }
+
+    void GpuProfiler::destroy()
+    {
+        m_pool = nullptr;
+        m_frames.clear();
+    }
+
+    void GpuProfiler::beginFrame(uint32_t frame)
+    {
+        FrameScopes& scopes = m_frames[frame];
+        scopes.count = 0;
+        scopes.open.fill(MAX_SCOPES_PER_FRAME);
+    }
+
+    void GpuProfiler::rewind(uint32_t frame, uint32_t scope_count)
+    {
+        FrameScopes& scopes = m_frames[frame];
+        scopes.count = std::min(scopes.count, scope_count);
+        scopes.open.fill(MAX_SCOPES_PER_FRAME);
+    }
+
+    void GpuProfiler::begin(const vk::raii::CommandBuffer& cmd, uint32_t frame, GpuPhase phase)
+    {
+        FrameScopes& scopes = m_frames[frame];
+        if (!*m_pool || (scopes.count == MAX_SCOPES_PER_FRAME)) {
+            return;
+        }
+        uint32_t scope = scopes.count++;
+        uint32_t query = 2 * (frame * MAX_SCOPES_PER_FRAME + scope);
+        scopes.phases[scope] = phase;
+        scopes.open[static_cast<uint32_t>(phase)] = scope;
+        cmd.resetQueryPool(*m_pool, query, 2);
+        cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eTopOfPipe, *m_pool, query);
+    }
+
+    void GpuProfiler::end(const vk::raii::CommandBuffer& cmd, uint32_t frame, GpuPhase phase)
+    {
+        FrameScopes& scopes = m_frames[frame];
+        uint32_t scope = scopes.open[static_cast<uint32_t>(phase)];
+        if (!*m_pool || (scope == MAX_SCOPES_PER_FRAME)) {
+            return;
+        }
+        scopes.open[static_cast<uint32_t>(phase)] = MAX_SCOPES_PER_FRAME;
+        cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eAllCommands, *m_pool, 2 * (frame * MAX_SCOPES_PER_FRAME + scope) + 1);
+    }
+
+    bool GpuProfiler::collect(uint32_t frame, GpuFrameProfile& out_profile)
+    {
+        const FrameScopes& scopes = m_frames[frame];
+        if (!*m_pool || (scopes.count == 0)) {
+            return false;
+        }
+
+        // Value + availability per query, so a late frame is skipped rather than waited for.
+        uint32_t query_count = 2 * scopes.count;
+        uint32_t first_query = 2 * frame * MAX_SCOPES_PER_FRAME;
+        vk::QueryResultFlags flags = vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability;
+        std::vector<uint64_t> results = m_pool.getResults<uint64_t>(first_query, query_count, query_count * 2 * sizeof(uint64_t), 2 * sizeof(uint64_t), flags).second;
+        for (uint32_t i = 0; i < query_count; ++i) {
+            if (results[2 * i + 1] == 0) {
+                return false;
+            }
+        }
+
+        GpuFrameProfile profile{};
+        uint64_t first = UINT64_MAX;
+        uint64_t last = 0;
+        for (uint32_t scope = 0; scope < scopes.count; ++scope) {
+            uint64_t begin = results[4 * scope];
+            uint64_t end = results[4 * scope + 2];
+            uint32_t phase = static_cast<uint32_t>(scopes.phases[scope]);
+            profile.phase_ms[phase] += static_cast<float>(end - begin) * m_ms_per_tick;
+            profile.ran[phase] = true;
+            first = std::min(first, begin);
+            last = std::max(last, end);
+        }
+        profile.frame_ms = static_cast<float>(last - first) * m_ms_per_tick;
+
+        for (uint32_t phase = 0; phase < GPU_PHASE_COUNT; ++phase) {
+            if (!profile.ran[phase]) {
+                continue;
+            }
+            PhaseHistory& history = m_history[phase];
+            history.samples_ms[history.next] = profile.phase_ms[phase];
+            history.next = (history.next + 1) % HISTORY_SIZE;
+            history.count = std::min(history.count + 1, HISTORY_SIZE);
+        }
+        out_profile = profile;
+        return true;
+    }
+
+    GpuPhaseStats GpuProfiler::stats(GpuPhase phase) const
+    {
+        const PhaseHistory& history = m_history[static_cast<uint32_t>(phase)];
+        GpuPhaseStats stats{};
+        stats.samples = history.count;
+        if (history.count == 0) {
+            return stats;
+        }
+
+        std::array<float, HISTORY_SIZE> sorted = history.samples_ms;
+        std::sort(sorted.begin(), sorted.begin() + history.count);
+        float sum = 0.0f;
+        for (uint32_t i = 0; i < history.count; ++i) {
+            sum += sorted[i];
+        }
+        // Nearest-rank percentile: the smallest sample at or above 99% of the window.
+        uint32_t p99_rank = (history.count * 99 + 99) / 100;
+        stats.min_ms = sorted[0];
+        stats.avg_ms = sum / static_cast<float>(history.count);
+        stats.p99_ms = sorted[p99_rank - 1];
+        return stats;
+    }
+
+    std::string GpuProfiler::summary() const
+    {
+        std::ostringstream text;
+        text.setf(std::ios::fixed);
+        text.precision(3);
+        text << "GPU ms (min/avg/p99):";
+        for (uint32_t phase = 0; phase < GPU_PHASE_COUNT; ++phase) {
+            GpuPhaseStats phase_stats = stats(static_cast<GpuPhase>(phase));
+            if (phase_stats.samples == 0) {
+                continue;
+            }
+            text << " " << PHASE_NAMES[phase] << " " << phase_stats.min_ms << "/" << phase_stats.avg_ms << "/" << phase_stats.p99_ms;
+        }
+        return text.str();
+    }
+
+} // namespace Engine
@@ -0,0 +1,147 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include "device.hpp"
+#ifdef _WIN32
+#include <Volk/volk.h>
+#else
+#include <volk/volk.h>
+#endif
+#include <vulkan/vulkan_raii.hpp>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+
+    //! GPU phases of a frame timed by the GpuProfiler.
+    enum class GpuPhase : uint32_t {
+        Physics, //!< Physics solver + motion reduction (on the compute queue with async compute).
+        Transitions, //!< Image layout transitions around the draw (to attachment, to present).
+        Draw, //!< Ribbon expansion and dynamic rendering of the strings (clear + triangle strips).
+        Upscale, //!< Blit of the reduced-scale target up to the swapchain image (render scale below 1).
+        Capture, //!< Copy of the finished frame into a frame capture readback buffer.
+        Count //!< Number of phases (not a phase).
+    };
+
+    //! Number of GpuPhase values.
+    static constexpr uint32_t GPU_PHASE_COUNT = static_cast<uint32_t>(GpuPhase::Count);
+
+    //! Rolling statistics of one phase over its last GpuProfiler::HISTORY_SIZE samples.
+    struct GpuPhaseStats {
+        uint32_t samples{0}; //!< Samples in the window (0: the phase has not been timed yet).
+        float min_ms{0.0f}; //!< Fastest sample.
+        float avg_ms{0.0f}; //!< Mean sample.
+        float p99_ms{0.0f}; //!< 99th-percentile sample.
+    };
+
+    //! GPU times of one frame, resolved by GpuProfiler::collect().
+    struct GpuFrameProfile {
+        std::array<float, GPU_PHASE_COUNT> phase_ms{}; //!< Summed scope time per phase (0 where the phase did not run).
+        std::array<bool, GPU_PHASE_COUNT> ran{}; //!< The frame recorded at least one scope of the phase.
+        float frame_ms{0.0f}; //!< From the earliest scope begin to the latest scope end.
+    };
+
+    //! Timestamp-query profiler for the per-frame GPU phases. Each frame in flight owns a range of
+    //! MAX_SCOPES_PER_FRAME begin/end query pairs; begin() and end() bracket one scope of a phase
+    //! on a command buffer (a phase may have several scopes a frame, summed). Each scope resets its
+    //! own pair just before writing it, so the queries never need a host reset. collect() reads a
+    //! frame's pairs once its fence has been waited on — a frame later, without blocking — and
+    //! feeds a rolling window per phase. Inactive (every call a no-op) where the device lacks
+    //! timestamp support.
+    class GpuProfiler {
+    public:
+        GpuProfiler() = default;
+        ~GpuProfiler() = default;
+
+        GpuProfiler(const GpuProfiler&) = delete;
+        GpuProfiler& operator=(const GpuProfiler&) = delete;
+        GpuProfiler(GpuProfiler&&) = delete;
+        GpuProfiler& operator=(GpuProfiler&&) = delete;
+
+        //! Scopes one frame may record.
+        static constexpr uint32_t MAX_SCOPES_PER_FRAME = 8;
+        //! Samples the rolling statistics cover, per phase.
+        static constexpr uint32_t HISTORY_SIZE = 256;
+
+        //! Creates the query pool for frames_in_flight frames; compute_queue: scopes are also
+        //! written on the compute queue. Returns false and fills out_error_message on failure;
+        //! succeeds, inactive, without timestamp support on those queues.
+        [[nodiscard]] bool init(const Device& device, uint32_t frames_in_flight, bool compute_queue, std::string& out_error_message);
+
+        //! Releases the query pool. Safe to call repeatedly.
+        void destroy();
+
+        //! True when timestamps are being written.
+        [[nodiscard]] bool active() const
+        {
+            return *m_pool;
+        }
+
+        //! Forgets frame's scopes, ready to record it again (after collect()).
+        void beginFrame(uint32_t frame);
+
+        //! Scopes frame has begun so far.
+        [[nodiscard]] uint32_t scopeCount(uint32_t frame) const
+        {
+            return m_frames[frame].count;
+        }
+
+        //! Drops frame's scopes past scope_count, so alternative command buffers recorded for the
+        //! same frame slot (only one of them submitted) reuse the same queries.
+        void rewind(uint32_t frame, uint32_t scope_count);
+
+        //! Opens a scope of phase on cmd (outside a render pass). Ignored once the frame is full.
+        void begin(const vk::raii::CommandBuffer& cmd, uint32_t frame, GpuPhase phase);
+
+        //! Closes the open scope of phase on cmd (the command buffer that opened it or one
+        //! submitted after it).
+        void end(const vk::raii::CommandBuffer& cmd, uint32_t frame, GpuPhase phase);
+
+        //! Resolves frame's scopes into out_profile and the rolling statistics. Returns false when
+        //! the frame recorded nothing or its queries are not available yet (never waits).
+        [[nodiscard]] bool collect(uint32_t frame, GpuFrameProfile& out_profile);
+
+        //! Rolling min / avg / p99 of phase.
+        [[nodiscard]] GpuPhaseStats stats(GpuPhase phase) const;
+
+        //! One-line summary of every timed phase, e.g. for a periodic log line.
+        [[nodiscard]] std::string summary() const;
+
+    private:
+        //! One frame's recorded scopes, in query-pair order.
+        struct FrameScopes {
+            std::array<GpuPhase, MAX_SCOPES_PER_FRAME> phases{}; //!< Phase of each scope.
+            std::array<uint32_t, GPU_PHASE_COUNT> open{}; //!< Scope a phase's end() closes (MAX_SCOPES_PER_FRAME: none).
+            uint32_t count{0}; //!< Scopes begun.
+        };
+
+        //! Rolling window of one phase's samples.
+        struct PhaseHistory {
+            std::array<float, HISTORY_SIZE> samples_ms{}; //!< Ring of samples.
+            uint32_t count{0}; //!< Valid samples (up to HISTORY_SIZE).
+            uint32_t next{0}; //!< Ring position of the next sample.
+        };
+
+        vk::raii::QueryPool m_pool{nullptr}; //!< 2 * MAX_SCOPES_PER_FRAME timestamps per frame in flight (null when inactive).
+        std::vector<FrameScopes> m_frames; //!< Per frame in flight.
+        std::array<PhaseHistory, GPU_PHASE_COUNT> m_history{}; //!< Per phase.
+        float m_ms_per_tick{0.0f}; //!< Timestamp period in milliseconds.
+    };
+
+} // namespace Engine
@@ -0,0 +1,103 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "gpu_scores.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+namespace Engine
+{
+
+    bool GpuScores::load(const std::string& path, std::string& out_error_message)
+    {
+        m_scores.clear();
+        std::ifstream file(path);
+        if (!file) {
+            return true;
+        }
+
+        std::string line;
+        uint32_t line_number{0};
+        while (std::getline(file, line)) {
+            ++line_number;
+            if (line.empty() || (line.front() == '#')) {
+                continue;
+            }
+            std::istringstream fields(line);
+            std::string uuid;
+            Score score{};
+            if (!(fields >> uuid >> score.frame_ms) || !(score.frame_ms > 0.0)) {
+                m_scores.clear();
+                out_error_message = "Line " + std::to_string(line_number) + " of the GPU scores \"" + path + "\" is not \"<uuid> <frame ms> <name>\".";
+                return false;
+            }
+            std::getline(fields >> std::ws, score.name);
+            m_scores[uuid] = score;
+        }
+        return true;
+    }
+
+    bool GpuScores::save(const std::string& path, std::string& out_error_message) const
+    {
+        std::error_code error;
+        std::filesystem::path file_path{path};
+        if (file_path.has_parent_path()) {
+            std::filesystem::create_directories(file_path.parent_path(), error);
+            if (error) {
+                out_error_message = "Failed to create the GPU scores directory " + file_path.parent_path().string() + ": " + error.message() + ".";
+                return false;
+            }
+        }
+
+        std::filesystem::path temporary_path{path + ".tmp"};
+        {
+            std::ofstream file(temporary_path, std::ios::trunc);
+            file.setf(std::ios::fixed);
+            file.precision(4);
+            file << "# StringWiggler GPU scores: device UUID, mean GPU frame time (ms), device name.\n";
+            for (const std::pair<const std::string, Score>& entry : m_scores) {
+                file << entry.first << " " << entry.second.frame_ms << " " << entry.second.name << "\n";
+            }
+            file.flush();
+            if (!file.good()) {
+                out_error_message = "Failed to write the GPU scores file " + temporary_path.string() + ".";
+                return false;
+            }
+        }
+        std::filesystem::rename(temporary_path, file_path, error);
+        if (error) {
+            out_error_message = "Failed to replace the GPU scores file " + path + ": " + error.message() + ".";
+            return false;
+        }
+        return true;
+    }
+
+    std::optional<double> GpuScores::frameMs(const std::string& uuid) const
+    {
+        std::map<std::string, Score>::const_iterator found = m_scores.find(uuid);
+        if (found == m_scores.end()) {
+            return std::nullopt;
+        }
+        return found->second.frame_ms;
+    }
+
+    void GpuScores::set(const std::string& uuid, const std::string& name, double frame_ms)
+    {
+        m_scores[uuid] = Score{frame_ms, name};
+    }
+
+} // namespace Engine
@@ -0,0 +1,62 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include <map>
+#include <optional>
+#include <string>
+
+namespace Engine
+{
+
+    /*!
+        Micro-benchmark results per GPU, keyed by device UUID (Device::uuid()), which device
+        selection prefers to the device type (see GpuPreference). Stored as a text file in the
+        per-user cache directory, one device per line: the UUID, the mean GPU frame time of the
+        scoring run (ms), then the device name for a human reader. `stringwiggler_bench
+        --score-gpus` writes it; nothing else does, so a machine without scores selects by type.
+    */
+    class GpuScores {
+    public:
+        //! Replaces the scores with those in path. A missing file is no scores, not an error;
+        //! returns false and fills out_error_message when the file cannot be parsed.
+        [[nodiscard]] bool load(const std::string& path, std::string& out_error_message);
+
+        //! Writes the scores to path (through a temporary file), creating the directory if
+        //! needed. Returns false and fills out_error_message on failure.
+        [[nodiscard]] bool save(const std::string& path, std::string& out_error_message) const;
+
+        //! Mean GPU frame time measured on the device with uuid (ms), if it has been scored.
+        [[nodiscard]] std::optional<double> frameMs(const std::string& uuid) const;
+
+        //! Records (or replaces) the score of the device with uuid and name.
+        void set(const std::string& uuid, const std::string& name, double frame_ms);
+
+        [[nodiscard]] bool empty() const
+        {
+            return m_scores.empty();
+        }
+
+    private:
+        //! One device's score.
+        struct Score {
+            double frame_ms{0.0}; //!< Mean GPU frame time of the scoring run (ms).
+            std::string name; //!< Device name when it was scored.
+        };
+
+        std::map<std::string, Score> m_scores; //!< By device UUID.
+    };
+
+} // namespace Engine
@@ -0,0 +1,129 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "gpu_selection.hpp"
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+namespace Engine
+{
+
+    //! text in lower case, without dashes when strip_dashes (so a UUID compares as written anywhere).
+    [[nodiscard]] static std::string lowerCase(std::string_view text, bool strip_dashes)
+    {
+        std::string lower;
+        for (char c : text) {
+            if (!strip_dashes || (c != '-')) {
+                lower.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+            }
+        }
+        return lower;
+    }
+
+    //! Short name of a device type for the log.
+    [[nodiscard]] static const char* deviceTypeName(vk::PhysicalDeviceType type)
+    {
+        switch (type) {
+        case vk::PhysicalDeviceType::eDiscreteGpu:
+            return "discrete";
+        case vk::PhysicalDeviceType::eIntegratedGpu:
+            return "integrated";
+        case vk::PhysicalDeviceType::eVirtualGpu:
+            return "virtual";
+        case vk::PhysicalDeviceType::eCpu:
+            return "CPU";
+        default:
+            return "other";
+        }
+    }
+
+    //! The devices of candidates, one per line, for an error message.
+    [[nodiscard]] static std::string describeGpus(const std::vector<GpuCandidate>& candidates)
+    {
+        std::string list;
+        for (const GpuCandidate& candidate : candidates) {
+            list += "\n  " + std::to_string(candidate.index) + ": \"" + candidate.name + "\" (" + deviceTypeName(candidate.type) + ", " + candidate.uuid + ")"
+                + (candidate.suitable ? "" : " - unsuitable");
+        }
+        return list;
+    }
+
+    int selectGpu(const std::vector<GpuCandidate>& candidates, const GpuSelection& selection, const GpuScores& scores, std::string& out_reason,
+        std::string& out_error_message)
+    {
+        if (!selection.device.empty()) {
+            // An index, else a UUID, else part of a name; the first suitable match wins.
+            std::string wanted = lowerCase(selection.device, false);
+            std::string wanted_uuid = lowerCase(selection.device, true);
+            bool is_index = std::all_of(wanted.begin(), wanted.end(), [](char c) {
+                return std::isdigit(static_cast<unsigned char>(c)) != 0;
+            });
+            int unsuitable_match = -1;
+            for (size_t i = 0; i < candidates.size(); ++i) {
+                const GpuCandidate& candidate = candidates[i];
+                bool matches = is_index ? (wanted == std::to_string(candidate.index))
+                                        : ((wanted_uuid == candidate.uuid) || (lowerCase(candidate.name, false).find(wanted) != std::string::npos));
+                if (matches && candidate.suitable) {
+                    out_reason = "named by the GPU selection \"" + selection.device + "\"";
+                    return static_cast<int>(i);
+                }
+                if (matches && (unsuitable_match < 0)) {
+                    unsuitable_match = static_cast<int>(i);
+                }
+            }
+            out_error_message = (unsuitable_match >= 0)
+                ? ("GPU \"" + candidates[static_cast<size_t>(unsuitable_match)].name + "\" (selected by \"" + selection.device + "\") lacks what the renderer needs.")
+                : ("No GPU matches \"" + selection.device + "\" (an index, a UUID or part of a name).");
+            out_error_message += " Devices:" + describeGpus(candidates);
+            return -1;
+        }
+
+        // Measured speed beats the device type, but only when it can rank every candidate.
+        std::vector<size_t> suitable;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (candidates[i].suitable) {
+                suitable.push_back(i);
+            }
+        }
+        bool all_scored = (suitable.size() > 1) && std::all_of(suitable.begin(), suitable.end(), [&candidates, &scores](size_t i) {
+            return scores.frameMs(candidates[i].uuid).has_value();
+        });
+        if ((selection.preference == GpuPreference::HighPerformance) && all_scored) {
+            size_t fastest = *std::min_element(suitable.begin(), suitable.end(), [&candidates, &scores](size_t a, size_t b) {
+                return *scores.frameMs(candidates[a].uuid) < *scores.frameMs(candidates[b].uuid);
+            });
+            out_reason = "fastest by GPU score (" + std::to_string(*scores.frameMs(candidates[fastest].uuid)) + " ms per frame)";
+            return static_cast<int>(fastest);
+        }
+
+        int best_rating = -1;
+        int best_index = -1;
+        for (size_t i : suitable) {
+            if (candidates[i].rating > best_rating) {
+                best_rating = candidates[i].rating;
+                best_index = static_cast<int>(i);
+            }
+        }
+        if (best_index < 0) {
+            out_error_message = "No supported Vulkan physical device found.";
+            return -1;
+        }
+        out_reason = (suitable.size() == 1) ? "the only suitable device"
+                                            : (std::string((selection.preference == GpuPreference::LowPower) ? "low-power" : "high-performance") + " preference, "
+                                                  + deviceTypeName(candidates[static_cast<size_t>(best_index)].type));
+        return best_index;
+    }
+
+} // namespace Engine
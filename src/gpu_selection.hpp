@@ -0,0 +1,63 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include "gpu_scores.hpp"
+#ifdef _WIN32
+#include <Volk/volk.h>
+#else
+#include <volk/volk.h>
+#endif
+#include <vulkan/vulkan.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+
+    //! Which kind of GPU automatic device selection favours.
+    enum class GpuPreference {
+        HighPerformance, //!< The fastest: by GpuScores when every candidate is scored, else discrete before integrated.
+        LowPower //!< Integrated before discrete (on a hybrid laptop, the GPU that is already awake and drives the panel).
+    };
+
+    //! How Device::init() picks the physical device.
+    struct GpuSelection {
+        //! Empty picks automatically by preference. Otherwise the device to use: its index in the
+        //! Vulkan enumeration order, its UUID (32 hex digits, dashes ignored), or a case-insensitive
+        //! part of its name. Selection fails when the named device is missing or unsuitable.
+        std::string device;
+        GpuPreference preference{GpuPreference::HighPerformance}; //!< See GpuPreference.
+    };
+
+    //! A physical device as device selection sees it (see Device::listGpus()).
+    struct GpuCandidate {
+        uint32_t index{0}; //!< Position in the Vulkan enumeration order.
+        std::string name; //!< VkPhysicalDeviceProperties::deviceName.
+        std::string uuid; //!< VkPhysicalDeviceIDProperties::deviceUUID as 32 lower-case hex digits.
+        vk::PhysicalDeviceType type{vk::PhysicalDeviceType::eOther}; //!< Discrete, integrated, ...
+        bool suitable{false}; //!< Has what the renderer needs (see Device).
+        int rating{0}; //!< Rank under the selection's GpuPreference, higher first (see Device); only read when suitable.
+    };
+
+    //! Index into candidates of the device selection picks, or -1 (filling out_error_message).
+    //! A named device must match and be suitable; otherwise the fastest by scores when
+    //! GpuPreference::HighPerformance and every suitable candidate is scored, else the highest
+    //! rating. out_reason says why, for the log.
+    [[nodiscard]] int selectGpu(const std::vector<GpuCandidate>& candidates, const GpuSelection& selection, const GpuScores& scores, std::string& out_reason,
+        std::string& out_error_message);
+
+} // namespace Engine
@@ -0,0 +1,266 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "input_recording.hpp"
+#include "renderer.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+namespace Engine
+{
+
+    //! First four bytes of a recording file.
+    static constexpr std::array<uint8_t, 4> RECORDING_MAGIC{'S', 'W', 'I', 'R'};
+
+    //! Header bytes: the magic, then VERSION and six words of InputRecording fields.
+    static constexpr std::size_t HEADER_SIZE = 28;
+
+    //! Record bytes after the type byte and the time delta.
+    static constexpr std::size_t CURSOR_PAYLOAD_SIZE = 12;
+    static constexpr std::size_t FRAME_PAYLOAD_SIZE = 8;
+
+    //! The steady clock in microseconds (the clock of Renderer::latchCursor() samples).
+    [[nodiscard]] static uint64_t steadyMicroseconds()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    //! Appends the low bytes bytes of value, least significant first.
+    static void putLittleEndian(std::vector<uint8_t>& out, uint32_t value, std::size_t bytes)
+    {
+        for (std::size_t i = 0; i < bytes; ++i) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    //! Reads bytes bytes, least significant first, from data at offset (which must fit).
+    [[nodiscard]] static uint32_t getLittleEndian(const std::vector<uint8_t>& data, std::size_t offset, std::size_t bytes)
+    {
+        uint32_t value{0};
+        for (std::size_t i = 0; i < bytes; ++i) {
+            value |= static_cast<uint32_t>(data[offset + i]) << (8 * i);
+        }
+        return value;
+    }
+
+    uint32_t InputRecording::frameCount() const
+    {
+        return static_cast<uint32_t>(std::count_if(records.begin(), records.end(), [](const InputRecord& record) {
+            return record.type == InputRecord::Type::Frame;
+        }));
+    }
+
+    bool InputRecording::save(const std::string& path, std::string& out_error_message) const
+    {
+        std::vector<uint8_t> bytes(RECORDING_MAGIC.begin(), RECORDING_MAGIC.end());
+        for (uint32_t word : {VERSION, width, height, node_count, string_count, constraint_iterations}) {
+            putLittleEndian(bytes, word, 4);
+        }
+        uint64_t previous_us{0};
+        for (const InputRecord& record : records) {
+            bytes.push_back(static_cast<uint8_t>(record.type));
+            putLittleEndian(bytes, static_cast<uint32_t>(std::min<uint64_t>(record.time_us - previous_us, UINT32_MAX)), 4);
+            previous_us = record.time_us;
+            if (record.type == InputRecord::Type::Cursor) {
+                putLittleEndian(bytes, std::min<uint32_t>(record.width, UINT16_MAX), 2);
+                putLittleEndian(bytes, std::min<uint32_t>(record.height, UINT16_MAX), 2);
+                putLittleEndian(bytes, static_cast<uint32_t>(record.cursor_x), 4);
+                putLittleEndian(bytes, static_cast<uint32_t>(record.cursor_y), 4);
+            } else {
+                putLittleEndian(bytes, std::bit_cast<uint32_t>(record.dt), 4);
+                putLittleEndian(bytes, static_cast<uint32_t>(record.trail_offset_us), 4);
+            }
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            out_error_message = "Cannot open \"" + path + "\" for writing.";
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        file.flush();
+        if (!file.good()) {
+            out_error_message = "Failed to write the input recording \"" + path + "\".";
+            return false;
+        }
+        return true;
+    }
+
+    bool InputRecording::load(const std::string& path, std::string& out_error_message)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            out_error_message = "Cannot open the input recording \"" + path + "\".";
+            return false;
+        }
+        std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+        if ((bytes.size() < HEADER_SIZE) || !std::equal(RECORDING_MAGIC.begin(), RECORDING_MAGIC.end(), bytes.begin())) {
+            out_error_message = "\"" + path + "\" is not an input recording.";
+            return false;
+        }
+        uint32_t version = getLittleEndian(bytes, 4, 4);
+        if (version != VERSION) {
+            out_error_message = "\"" + path + "\" is an input recording of version " + std::to_string(version) + "; this build reads version " + std::to_string(VERSION) + ".";
+            return false;
+        }
+
+        InputRecording recording{};
+        recording.width = getLittleEndian(bytes, 8, 4);
+        recording.height = getLittleEndian(bytes, 12, 4);
+        recording.node_count = getLittleEndian(bytes, 16, 4);
+        recording.string_count = getLittleEndian(bytes, 20, 4);
+        recording.constraint_iterations = getLittleEndian(bytes, 24, 4);
+
+        std::size_t offset = HEADER_SIZE;
+        uint64_t time_us{0};
+        while (offset < bytes.size()) {
+            InputRecord record{};
+            uint8_t type = bytes[offset];
+            std::size_t payload_size = (type == static_cast<uint8_t>(InputRecord::Type::Cursor)) ? CURSOR_PAYLOAD_SIZE : FRAME_PAYLOAD_SIZE;
+            if ((type > static_cast<uint8_t>(InputRecord::Type::Frame)) || ((offset + 5 + payload_size) > bytes.size())) {
+                out_error_message = "The input recording \"" + path + "\" is corrupt or cut short at byte " + std::to_string(offset) + ".";
+                return false;
+            }
+            record.type = static_cast<InputRecord::Type>(type);
+            time_us += getLittleEndian(bytes, offset + 1, 4);
+            record.time_us = time_us;
+            offset += 5;
+            if (record.type == InputRecord::Type::Cursor) {
+                record.width = getLittleEndian(bytes, offset, 2);
+                record.height = getLittleEndian(bytes, offset + 2, 2);
+                record.cursor_x = static_cast<int32_t>(getLittleEndian(bytes, offset + 4, 4));
+                record.cursor_y = static_cast<int32_t>(getLittleEndian(bytes, offset + 8, 4));
+            } else {
+                record.dt = std::bit_cast<float>(getLittleEndian(bytes, offset, 4));
+                record.trail_offset_us = static_cast<int32_t>(getLittleEndian(bytes, offset + 4, 4));
+            }
+            offset += payload_size;
+            recording.records.push_back(record);
+        }
+
+        *this = std::move(recording);
+        return true;
+    }
+
+    InputRecorder::InputRecorder(uint32_t width, uint32_t height, uint32_t node_count, uint32_t string_count, uint32_t constraint_iterations) :
+        m_start_us{steadyMicroseconds()}
+    {
+        m_recording.width = width;
+        m_recording.height = height;
+        m_recording.node_count = node_count;
+        m_recording.string_count = string_count;
+        m_recording.constraint_iterations = constraint_iterations;
+    }
+
+    void InputRecorder::recordCursor(uint32_t width, uint32_t height, int32_t cursor_x, int32_t cursor_y, uint64_t time_us)
+    {
+        InputRecord record{};
+        record.type = InputRecord::Type::Cursor;
+        record.width = width;
+        record.height = height;
+        record.cursor_x = cursor_x;
+        record.cursor_y = cursor_y;
+        append(record, time_us);
+    }
+
+    void InputRecorder::recordFrame(float dt, uint64_t trail_time_us)
+    {
+        InputRecord record{};
+        record.type = InputRecord::Type::Frame;
+        record.dt = dt;
+        // Relative to the recording's start for now; append() makes it relative to time_us.
+        record.trail_offset_us = static_cast<int32_t>(static_cast<int64_t>(trail_time_us) - static_cast<int64_t>(m_start_us));
+        append(record, steadyMicroseconds());
+    }
+
+    bool InputRecorder::save(const std::string& path, std::string& out_error_message) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_recording.save(path, out_error_message);
+    }
+
+    void InputRecorder::append(InputRecord record, uint64_t time_us)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // A sample stamped by the window system may predate the recording, or the frame appended
+        // just before it by the other thread.
+        uint64_t previous_us = m_recording.records.empty() ? 0 : m_recording.records.back().time_us;
+        record.time_us = std::max((time_us > m_start_us) ? (time_us - m_start_us) : 0, previous_us);
+        if (record.type == InputRecord::Type::Frame) {
+            record.trail_offset_us -= static_cast<int32_t>(record.time_us);
+        }
+        m_recording.records.push_back(record);
+    }
+
+    InputReplayer::InputReplayer(const InputRecording& recording, ReplaySpeed speed) :
+        m_recording{recording},
+        m_speed{speed}
+    {
+    }
+
+    void InputReplayer::step(Renderer& renderer, uint32_t width, uint32_t height)
+    {
+        if (!m_started) {
+            m_origin = std::chrono::steady_clock::now();
+            m_origin_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(m_origin.time_since_epoch()).count());
+            m_started = true;
+        }
+
+        const std::vector<InputRecord>& records = m_recording.records;
+        while (m_next < records.size()) {
+            const InputRecord& record = records[m_next];
+            if (m_speed == ReplaySpeed::Recorded) {
+                std::this_thread::sleep_until(m_origin + std::chrono::microseconds{record.time_us});
+            }
+            ++m_next;
+            if (record.type == InputRecord::Type::Cursor) {
+                if (m_next > m_latched) {
+                    latch(renderer, record);
+                    m_latched = m_next;
+                }
+                continue;
+            }
+
+            // The frame reads the trail up to its trail time: latch the samples up to the first
+            // one past it, so what it interpolates between is fixed before it is drawn.
+            int64_t trail_us = static_cast<int64_t>(record.time_us) + record.trail_offset_us;
+            for (m_latched = std::max(m_latched, m_next); m_latched < records.size(); ++m_latched) {
+                const InputRecord& ahead = records[m_latched];
+                if (ahead.type != InputRecord::Type::Cursor) {
+                    continue;
+                }
+                latch(renderer, ahead);
+                if (static_cast<int64_t>(ahead.time_us) > trail_us) {
+                    ++m_latched;
+                    break;
+                }
+            }
+            renderer.drawFrame(width, height, record.dt, static_cast<uint64_t>(static_cast<int64_t>(m_origin_us) + trail_us));
+            ++m_frames_played;
+            return;
+        }
+    }
+
+    void InputReplayer::latch(Renderer& renderer, const InputRecord& record)
+    {
+        renderer.latchCursor(record.width, record.height, record.cursor_x, record.cursor_y, m_origin_us + record.time_us);
+        renderer.stats().add(FrameCounter::InputEvents);
+    }
+
+} // namespace Engine
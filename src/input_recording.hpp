@@ -0,0 +1,166 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+
+    class Renderer;
+
+    //! One input to the simulation: a cursor sample the renderer latched, or a frame it drew.
+    struct InputRecord {
+        //! Which fields are meaningful.
+        enum class Type : uint8_t {
+            Cursor, //!< width, height, cursor_x, cursor_y (a Renderer::latchCursor() call).
+            Frame //!< dt, trail_offset_us (a Renderer::drawFrame() call that got past the size checks).
+        };
+
+        Type type{Type::Frame}; //!< Discriminator.
+        uint64_t time_us{0}; //!< When it happened, since the recording started (non-decreasing).
+        uint32_t width{0}; //!< Type::Cursor: client size the cursor is mapped against.
+        uint32_t height{0};
+        int32_t cursor_x{0}; //!< Type::Cursor: cursor position (client pixels).
+        int32_t cursor_y{0};
+        float dt{0.0f}; //!< Type::Frame: the frame's delta time (seconds, before the renderer's clamp).
+        int32_t trail_offset_us{0}; //!< Type::Frame: its trail time (where its last substep lands on the cursor trail) minus time_us.
+    };
+
+    /*!
+        Everything that drove one run's simulation: the batch it simulated, the initial client
+        size, and the cursor samples and frame times in order. Stored as a compact binary file —
+        a 28-byte header ("SWIR", VERSION, then width, height, node_count, string_count,
+        constraint_iterations as 32-bit little-endian words), then one record after another: a
+        type byte and the 32-bit time since the previous record (µs), followed for a cursor
+        sample by 16-bit width and height and 32-bit x and y (17 bytes in all), and for a frame
+        by its 32-bit float dt and 32-bit signed trail offset (13 bytes).
+    */
+    struct InputRecording {
+        //! File format version; load() rejects any other.
+        static constexpr uint32_t VERSION = 2;
+
+        uint32_t width{0}; //!< Initial client size.
+        uint32_t height{0};
+        uint32_t node_count{0}; //!< RendererConfig::node_count of the run.
+        uint32_t string_count{0}; //!< RendererConfig::string_count of the run.
+        uint32_t constraint_iterations{0}; //!< RendererConfig::constraint_iterations of the run.
+        std::vector<InputRecord> records; //!< In time order.
+
+        //! Number of Type::Frame records.
+        [[nodiscard]] uint32_t frameCount() const;
+
+        //! Writes the recording to path. Returns false and fills out_error_message on failure.
+        [[nodiscard]] bool save(const std::string& path, std::string& out_error_message) const;
+
+        //! Replaces this recording with the one in path. Returns false and fills out_error_message
+        //! if it cannot be read or is not a recording of this VERSION.
+        [[nodiscard]] bool load(const std::string& path, std::string& out_error_message);
+    };
+
+    /*!
+        Collects an InputRecording as the renderer is driven (see Renderer::setInputRecorder()).
+        Cursor samples come from the window event thread and frames from the render thread, so
+        appends take a mutex: uncontended, for a few records per frame. Records are kept in
+        memory until save().
+    */
+    class InputRecorder {
+    public:
+        //! Starts recording now, for a run of this initial client size and batch.
+        InputRecorder(uint32_t width, uint32_t height, uint32_t node_count, uint32_t string_count, uint32_t constraint_iterations);
+
+        InputRecorder(const InputRecorder&) = delete;
+        InputRecorder& operator=(const InputRecorder&) = delete;
+        InputRecorder(InputRecorder&&) = delete;
+        InputRecorder& operator=(InputRecorder&&) = delete;
+
+        //! Appends a cursor sample latched at time_us (steady clock, as Renderer::latchCursor()).
+        void recordCursor(uint32_t width, uint32_t height, int32_t cursor_x, int32_t cursor_y, uint64_t time_us);
+
+        //! Appends a frame drawn now with delta time dt, whose last substep lands on the cursor
+        //! trail at trail_time_us (steady clock).
+        void recordFrame(float dt, uint64_t trail_time_us);
+
+        //! Writes what has been recorded so far (see InputRecording::save()).
+        [[nodiscard]] bool save(const std::string& path, std::string& out_error_message) const;
+
+    private:
+        //! Appends record at time_us (steady clock), kept no earlier than the previous one.
+        void append(InputRecord record, uint64_t time_us);
+
+        mutable std::mutex m_mutex; //!< Guards m_recording.
+        InputRecording m_recording; //!< What has been recorded.
+        uint64_t m_start_us; //!< Steady-clock time the recording started (µs).
+    };
+
+    //! How fast InputReplayer plays a recording.
+    enum class ReplaySpeed {
+        Recorded, //!< Each record at its recorded time after the replay started.
+        Max //!< Frames back to back, as fast as the renderer draws them.
+    };
+
+    /*!
+        Plays an InputRecording into a renderer: the same cursor samples, frame delta times and
+        trail times, so the simulation does the same work (substeps, constraint passes, cursor
+        path) as in the recorded run, and every replay of it the same. Samples and trail times
+        are mapped onto the steady clock at their recorded offset from the replay's start, never
+        read off it, so at ReplaySpeed::Max the cursor path keeps its recorded timing. Before a
+        frame it also latches the first sample past the frame's trail time: the physics reads the
+        trail when it executes, and would otherwise interpolate towards whichever later samples
+        had been latched by then.
+    */
+    class InputReplayer {
+    public:
+        //! Replays recording, which must outlive the replayer.
+        InputReplayer(const InputRecording& recording, ReplaySpeed speed);
+
+        //! True once every record has been played.
+        [[nodiscard]] bool done() const
+        {
+            return m_next >= m_recording.records.size();
+        }
+
+        //! Frames drawn so far.
+        [[nodiscard]] uint32_t framesPlayed() const
+        {
+            return m_frames_played;
+        }
+
+        //! Plays the records up to and including the next frame: latches the cursor samples before
+        //! it and the first one past its trail time (counting them as input events in the
+        //! renderer's stats) and draws the frame at width x height with its recorded dt and trail
+        //! time. At ReplaySpeed::Recorded, first waits for each record's time. Does nothing once done().
+        void step(Renderer& renderer, uint32_t width, uint32_t height);
+
+    private:
+        //! Latches the cursor sample record at its recorded time on the replay clock.
+        void latch(Renderer& renderer, const InputRecord& record);
+
+        const InputRecording& m_recording; //!< What is played.
+        ReplaySpeed m_speed; //!< See ReplaySpeed.
+        std::size_t m_next{0}; //!< Next record to play.
+        std::size_t m_latched{0}; //!< Records before this index are latched if they are cursor samples (look-ahead).
+        uint32_t m_frames_played{0}; //!< See framesPlayed().
+        bool m_started{false}; //!< m_origin is set.
+        std::chrono::steady_clock::time_point m_origin{}; //!< Replay time of the recording's time zero.
+        uint64_t m_origin_us{0}; //!< m_origin in steady-clock microseconds.
+    };
+
+} // namespace Engine
@@ -15,6 +15,7 @@
 #include "instance.hpp"
 #include "surface.hpp"
 #include "vulkan_helpers.hpp"
+#include <trace/tracer.hpp>
 #include <string>
 #include <vector>
 
@@ -73,8 +74,9 @@ namespace Engine
 
     // logger is only referenced when DEBUG is defined (it backs the validation messenger),
     // so mark it [[maybe_unused]] to keep Release (no DEBUG) warning-clean under -Werror.
-    bool Instance::init([[maybe_unused]] LoggingLib::Logger& logger, std::string& out_error_message)
+    bool Instance::init([[maybe_unused]] LoggingLib::Logger& logger, bool headless, std::string& out_error_message)
     {
+        TRACE_ZONE("Instance::init");
         // Step 1: Volk finds the Vulkan loader, then feed its vkGetInstanceProcAddr to the
         // vulkan-hpp default dispatcher (used by the free enumerate* functions below).
         if (volkInitialize() != VK_SUCCESS) {
@@ -92,8 +94,12 @@ namespace Engine
                 return false;
             }
 
-            // Step 3: required instance extensions (surface WSI + debug utils in debug builds).
-            std::vector<const char*> extensions = requiredSurfaceExtensions();
+            // Step 3: required instance extensions (surface WSI unless headless + debug utils in
+            // debug builds).
+            std::vector<const char*> extensions;
+            if (!headless) {
+                extensions = requiredSurfaceExtensions();
+            }
 #ifdef DEBUG
             extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 #endif
@@ -105,6 +111,16 @@ namespace Engine
                 }
             }
 
+            // Optional: surface maintenance (with the capabilities2 queries it extends) lets the
+            // device enable VK_EXT_swapchain_maintenance1, whose present fences tell when an old
+            // swapchain may be destroyed.
+            m_surface_maintenance = !headless && isExtensionAvailable(available_extensions, VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME)
+                && isExtensionAvailable(available_extensions, VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME);
+            if (m_surface_maintenance) {
+                extensions.push_back(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME);
+                extensions.push_back(VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME);
+            }
+
             // Step 4: validation layer (debug builds only).
             std::vector<const char*> layers;
 #ifdef DEBUG
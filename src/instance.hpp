@@ -42,9 +42,10 @@ namespace Engine
         Instance& operator=(Instance&&) = delete;
 
         //! Initialises Volk + the vulkan-hpp dispatcher, then creates the instance and (in
-        //! debug builds) a validation messenger routed to the logger. Returns false and fills
-        //! out_error_message on failure. The logger must outlive this Instance.
-        [[nodiscard]] bool init(LoggingLib::Logger& logger, std::string& out_error_message);
+        //! debug builds) a validation messenger routed to the logger. A headless instance does
+        //! not enable the surface (WSI) extensions. Returns false and fills out_error_message on
+        //! failure. The logger must outlive this Instance.
+        [[nodiscard]] bool init(LoggingLib::Logger& logger, bool headless, std::string& out_error_message);
 
         //! Destroys the messenger and instance. Safe to call repeatedly.
         void destroy();
@@ -61,9 +62,17 @@ namespace Engine
             return m_instance;
         }
 
+        //! True when VK_EXT_surface_maintenance1 (and VK_KHR_get_surface_capabilities2) are
+        //! enabled: never when headless.
+        [[nodiscard]] bool supportsSurfaceMaintenance() const
+        {
+            return m_surface_maintenance;
+        }
+
     private:
         vk::raii::Context m_context; //!< Vulkan loader bootstrap.
         vk::raii::Instance m_instance{nullptr}; //!< Vulkan instance handle.
+        bool m_surface_maintenance{false}; //!< See supportsSurfaceMaintenance().
 #ifdef DEBUG
         vk::raii::DebugUtilsMessengerEXT m_debug_messenger{nullptr}; //!< Validation messenger (debug builds only).
 #endif
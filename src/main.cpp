@@ -12,10 +12,17 @@
     GNU General Public License for more details.
 */
 
+#include "cli_args.hpp"
+#include "input_recording.hpp"
 #include "renderer.hpp"
 #include <log/logger.hpp>
-#include <signal/signal.hpp>
+#include <signal/latest_signal.hpp>
+#include <signal/ring_signal.hpp>
+#include <trace/tracer.hpp>
+#include <window/event_clock.hpp>
 #include <window/window.hpp>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
@@ -23,124 +30,640 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
 
 namespace
 {
 
-    //! Keep rendering this long after the last input so the (damped) string settles to rest
-    //! before the render thread goes idle.
-    constexpr float SETTLE_SECONDS = 6.0f;
+    //! The render thread goes idle once every node of the batch is slower than this (NDC / s;
+    //! 0.005 is about 2 px/s in an 800 px wide window), as measured on the GPU.
+    constexpr float DEFAULT_SETTLE_SPEED = 0.005f;
 
-    //! Cross-thread render command. The main thread (window events) emits these; the render
-    //! thread consumes them.
+    //! Lowest rate the frame scheduler slows to while the string settles (Hz). Input always draws
+    //! at once, and fast motion at the full present rate.
+    constexpr float DEFAULT_MIN_FRAME_RATE = 25.0f;
+
+    //! The frame scheduler spaces frames so the fastest node moves at most this far between two
+    //! (NDC; about 1.6 px in an 800 px wide window): slower motion is just as smooth at fewer frames.
+    constexpr float MAX_FRAME_TRAVEL = 0.004f;
+
+    //! While the frame loop stays active or idle, it adds the time to the renderer's stats at
+    //! least this often, so a periodic summary sees a long active stretch.
+    constexpr std::chrono::milliseconds STATS_ACCOUNT_INTERVAL{250};
+
+    //! Command-line usage, appended to argument errors.
+    const std::string USAGE = std::string("Usage: StringWiggler [--nodes <count>] [--strings <count>] [--iterations <count>] ") + std::string(Engine::RENDERER_OPTIONS_USAGE)
+        + " [--latency vsync|paced|low] [--present-thread] [--physics-thread [--physics-rate <hz>]] [--no-pipeline-cache] [--ribbon-subdivisions <1-8>|auto] [--render-scale <0.25-1|auto>] "
+        "[--gpu-budget <ms>] [--settle-speed <ndc-per-second>] [--min-frame-rate <hz>|0] [--event-loop threaded|single] [--profile <log-every-n-frames>] "
+        "[--stats <log-every-n-seconds>] [--stats-csv <path>] [--trace <path>] [--record <path> | --replay <path> [--replay-speed recorded|max]] "
+        "[--collide-edges] [--self-collision] [--collision-radius <ndc>] [--obstacle circle:<x>,<y>,<r> | rect:<x0>,<y0>,<x1>,<y1>]... "
+        "[--gpu-preference performance|power] [--capture <path>|\"|<command>\" [--capture-format y4m|raw] [--capture-fps <1-240>]]";
+
+    //! Environment variable naming the GPU to use when --gpu does not (see Engine::GpuSelection::device).
+    constexpr const char* GPU_ENVIRONMENT_VARIABLE = "STRINGWIGGLER_GPU";
+
+    //! How window events reach the frame loop.
+    enum class EventLoop {
+        Threaded, //!< Main thread pumps events, a render thread draws (works everywhere, incl. Win32 modal loops).
+        Single //!< One thread waits on the window's event fd with the frame deadline as timeout (needs nativeEventFd()).
+    };
+
+    //! Start-up options that belong to the application rather than the renderer.
+    struct AppConfig {
+        float settle_speed{DEFAULT_SETTLE_SPEED}; //!< See DEFAULT_SETTLE_SPEED.
+        float min_frame_rate{DEFAULT_MIN_FRAME_RATE}; //!< See DEFAULT_MIN_FRAME_RATE; 0 always draws at the full rate.
+        EventLoop event_loop{EventLoop::Threaded}; //!< See EventLoop.
+        std::string stats_csv; //!< Where to write the frame statistics on exit (empty: nowhere).
+        std::string record_path; //!< Where to write an input recording of the run on exit (empty: no recording).
+        std::string trace_path; //!< Where to write a Chrome trace of the run's zones on exit (empty: not traced).
+        std::string replay_path; //!< Input recording to play instead of taking the window's input (empty: none).
+        Engine::ReplaySpeed replay_speed{Engine::ReplaySpeed::Recorded}; //!< How fast replay_path plays.
+    };
+
+    //! Applies the command-line options to the renderer and application configurations. Returns
+    //! false and fills out_error_message on an unknown option or a malformed value.
+    [[nodiscard]] bool parseArguments(int argc, char** argv, Engine::RendererConfig& config, AppConfig& app_config, std::string& out_error_message)
+    {
+        for (int i = 1; i < argc; ++i) {
+            Engine::OptionMatch match = Engine::parseRendererOption(argc, argv, i, config, USAGE, out_error_message);
+            if (match == Engine::OptionMatch::Invalid) {
+                return false;
+            }
+            if (match == Engine::OptionMatch::Parsed) {
+                continue;
+            }
+            std::string_view arg{argv[i]};
+            if ((arg == "--nodes") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (!Engine::parseUint32(value, config.node_count)) {
+                    out_error_message = Engine::invalidValue("node count", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--strings") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (!Engine::parseUint32(value, config.string_count)) {
+                    out_error_message = Engine::invalidValue("string count", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--iterations") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (!Engine::parseUint32(value, config.constraint_iterations)) {
+                    out_error_message = Engine::invalidValue("iteration count", value, USAGE);
+                    return false;
+                }
+            } else if (arg == "--present-thread") {
+                config.present_thread = true;
+            } else if (arg == "--physics-thread") {
+                config.physics_thread = true;
+            } else if ((arg == "--physics-rate") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (!Engine::parseNonNegativeFloat(value, config.physics_rate_hz) || (config.physics_rate_hz < Engine::Renderer::MIN_PHYSICS_RATE)
+                    || (config.physics_rate_hz > Engine::Renderer::MAX_PHYSICS_RATE)) {
+                    out_error_message = Engine::invalidValue("physics rate", value, USAGE, "20-240 Hz");
+                    return false;
+                }
+            } else if (arg == "--no-pipeline-cache") {
+                config.pipeline_cache = false;
+            } else if ((arg == "--ribbon-subdivisions") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (value == "auto") {
+                    config.ribbon_subdivisions = Engine::Renderer::RIBBON_SUBDIVISIONS_AUTO;
+                } else if (!Engine::parseUint32(value, config.ribbon_subdivisions) || (config.ribbon_subdivisions == Engine::Renderer::RIBBON_SUBDIVISIONS_AUTO)) {
+                    out_error_message = Engine::invalidValue("ribbon subdivision count", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--render-scale") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (value == "auto") {
+                    config.render_scale = Engine::Renderer::RENDER_SCALE_AUTO;
+                } else if (!Engine::parseNonNegativeFloat(value, config.render_scale)) {
+                    out_error_message = Engine::invalidValue("render scale", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--gpu-budget") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (!Engine::parseNonNegativeFloat(value, config.gpu_budget_ms)) {
+                    out_error_message = Engine::invalidValue("GPU budget", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--latency") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (value == "vsync") {
+                    config.latency = Engine::PresentLatency::Vsync;
+                } else if (value == "paced") {
+                    config.latency = Engine::PresentLatency::Paced;
+                } else if (value == "low") {
+                    config.latency = Engine::PresentLatency::Low;
+                } else {
+                    out_error_message = Engine::invalidValue("latency mode", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--profile") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (!Engine::parseUint32(value, config.profile_log_interval)) {
+                    out_error_message = Engine::invalidValue("profile interval", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--stats") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (!Engine::parseNonNegativeFloat(value, config.stats_log_interval_s)) {
+                    out_error_message = Engine::invalidValue("statistics interval", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--stats-csv") && (i + 1 < argc)) {
+                app_config.stats_csv = argv[++i];
+            } else if ((arg == "--trace") && (i + 1 < argc)) {
+                app_config.trace_path = argv[++i];
+            } else if ((arg == "--record") && (i + 1 < argc)) {
+                app_config.record_path = argv[++i];
+            } else if ((arg == "--replay") && (i + 1 < argc)) {
+                app_config.replay_path = argv[++i];
+            } else if ((arg == "--replay-speed") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (!Engine::parseReplaySpeed(value, app_config.replay_speed)) {
+                    out_error_message = Engine::invalidValue("replay speed", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--min-frame-rate") && (i + 1 < argc)) {
+                // Frames further apart than the renderer's dt clamp would slow the simulation down.
+                std::string_view value{argv[++i]};
+                if (!Engine::parseNonNegativeFloat(value, app_config.min_frame_rate)
+                    || ((app_config.min_frame_rate > 0.0f) && (app_config.min_frame_rate < (1.0f / Engine::Renderer::MAX_FRAME_DELTA)))) {
+                    out_error_message = Engine::invalidValue("minimum frame rate", value, USAGE, "0, or at least 20 Hz");
+                    return false;
+                }
+            } else if ((arg == "--event-loop") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (value == "threaded") {
+                    app_config.event_loop = EventLoop::Threaded;
+                } else if (value == "single") {
+                    app_config.event_loop = EventLoop::Single;
+                } else {
+                    out_error_message = Engine::invalidValue("event loop", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--settle-speed") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (!Engine::parseNonNegativeFloat(value, app_config.settle_speed)) {
+                    out_error_message = Engine::invalidValue("settle speed", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--gpu-preference") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (value == "performance") {
+                    config.gpu.preference = Engine::GpuPreference::HighPerformance;
+                } else if (value == "power") {
+                    config.gpu.preference = Engine::GpuPreference::LowPower;
+                } else {
+                    out_error_message = Engine::invalidValue("GPU preference", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--capture") && (i + 1 < argc)) {
+                config.capture_path = argv[++i];
+            } else if ((arg == "--capture-format") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (value == "y4m") {
+                    config.capture_format = Engine::CaptureFormat::Y4m;
+                } else if (value == "raw") {
+                    config.capture_format = Engine::CaptureFormat::Raw;
+                } else {
+                    out_error_message = Engine::invalidValue("capture format", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--capture-fps") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (!Engine::parseUint32(value, config.capture_frame_rate) || (config.capture_frame_rate == 0)
+                    || (config.capture_frame_rate > Engine::FrameCapture::MAX_FRAME_RATE)) {
+                    out_error_message = Engine::invalidValue("capture frame rate", value, USAGE, "1-240");
+                    return false;
+                }
+            } else if (arg == "--collide-edges") {
+                config.collide_edges = true;
+            } else if (arg == "--self-collision") {
+                config.self_collision = true;
+            } else if ((arg == "--collision-radius") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                if (!Engine::parseNonNegativeFloat(value, config.collision_radius)) {
+                    out_error_message = Engine::invalidValue("collision radius", value, USAGE);
+                    return false;
+                }
+            } else if ((arg == "--obstacle") && (i + 1 < argc)) {
+                std::string_view value{argv[++i]};
+                Engine::Obstacle obstacle{};
+                if (!Engine::parseObstacle(value, obstacle)) {
+                    out_error_message = Engine::invalidValue("obstacle", value, USAGE);
+                    return false;
+                }
+                config.obstacles.push_back(obstacle);
+            } else {
+                out_error_message = Engine::unknownOption(arg, USAGE);
+                return false;
+            }
+        }
+        if (!app_config.record_path.empty() && !app_config.replay_path.empty()) {
+            out_error_message = std::string("A run either records its input or replays a recording, not both. ") + USAGE;
+            return false;
+        }
+        // Ticks follow the wall clock, not the frames a recording holds.
+        if (config.physics_thread && (!app_config.record_path.empty() || !app_config.replay_path.empty())) {
+            out_error_message = std::string("The physics thread cannot record or replay input. ") + USAGE;
+            return false;
+        }
+        config.physics_settle_speed = app_config.settle_speed;
+        return true;
+    }
+
+    //! Discrete cross-thread render command: one the render thread must see, not just the newest
+    //! of. The main thread emits these; the render thread consumes them. Continuous input (cursor,
+    //! size) goes through RenderMailbox instead.
     struct RenderEvent {
         enum class Type {
-            Render, //!< Redraw (expose / move).
-            Resize, //!< Window resized — width/height carry the new size.
-            MouseMove, //!< Cursor moved — x/y carry the position (client pixels).
             Stop //!< Shut the render thread down.
         };
 
-        Type type{Type::Render};
+        Type type{Type::Stop};
+    };
+
+    //! Main thread → render thread queue of discrete commands. Lock-free and allocation-free; it
+    //! only carries the odd command, so a few slots suffice, and a full ring waits rather than drops.
+    using RenderSignal = SignalsLib::SpscSignal<RenderEvent, 8, SignalsLib::OverflowPolicy::Block>;
+
+    //! Client size, packed so the mailbox holds it in one lock-free atomic.
+    struct WindowSize {
         uint32_t width{0};
         uint32_t height{0};
-        int32_t x{0};
-        int32_t y{0};
     };
 
+    //! Main thread → render thread continuous input, coalesced: a 1000 Hz mouse or a modal resize
+    //! drag costs the callback an atomic store or two per event and the render thread one read per
+    //! frame, however many events arrived. (The cursor itself goes straight to the renderer's late
+    //! latch, so only the fact that it moved is carried here.)
+    struct RenderMailbox {
+        SignalsLib::LatestSignal<WindowSize> size; //!< Newest client size, if it changed.
+        std::atomic<bool> input{false}; //!< Set by any event (move, resize, expose) since the render thread last looked.
+    };
+
+    //! Where the cursor is, in client pixels, and the client size it is mapped against.
+    struct CursorLatch {
+        uint32_t width; //!< Client size.
+        uint32_t height;
+        int32_t cursor_x; //!< Last cursor position (client pixels), re-latched on resize.
+        int32_t cursor_y;
+    };
+
+    //! Latches the cursor from a window event straight into the renderer (late latching: every
+    //! sample, stamped with when the window system saw it, goes onto the GPU-visible trail, so even
+    //! a frame already submitted follows the moves up to its own time). Returns true, and counts it
+    //! in the renderer's stats, if the event is input the frame loop should wake for (resize, mouse
+    //! move, expose, move).
+    [[nodiscard]] bool latchEvent(const WindowLib::WindowEvent& ev, CursorLatch& latch, Engine::Renderer& renderer)
+    {
+        switch (ev.type) {
+        case WindowLib::WindowEvent::Type::Resize:
+            latch.width = ev.resize.width;
+            latch.height = ev.resize.height;
+            // The same cursor maps to a new NDC position: a sample of its own, stamped now.
+            renderer.latchCursor(latch.width, latch.height, latch.cursor_x, latch.cursor_y, WindowLib::EventClock::now());
+            break;
+        case WindowLib::WindowEvent::Type::MouseMove:
+            latch.cursor_x = ev.mouse_move.x;
+            latch.cursor_y = ev.mouse_move.y;
+            renderer.latchCursor(latch.width, latch.height, latch.cursor_x, latch.cursor_y, ev.mouse_move.time_us);
+            break;
+        case WindowLib::WindowEvent::Type::Expose:
+        case WindowLib::WindowEvent::Type::Move:
+            break;
+        default:
+            return false; // Close is handled by the main loop; ignore keys/focus/etc.
+        }
+        renderer.stats().add(Engine::FrameCounter::InputEvents);
+        return true;
+    }
+
     //! Context for the immediate window event callback (runs on the main/UI thread, including
-    //! during Win32 modal resize/move loops). Forwards events to the render thread.
+    //! during Win32 modal resize/move loops). Latches the cursor into the renderer and posts
+    //! events to the render thread's mailbox.
     struct CallbackContext {
-        SignalsLib::Signal<RenderEvent>* signal;
+        RenderMailbox* mailbox;
         std::mutex* mutex;
         std::condition_variable* cv;
+        Engine::Renderer* renderer; //!< Only latchCursor() and stats() (thread-safe) are called from the callback.
+        CursorLatch latch; //!< Main thread only.
     };
 
-    //! The render thread: owns the frame loop. Renders while the string is in motion (a settle
-    //! window after the last event), otherwise sleeps on the condition variable. Because it is
-    //! woken by the immediate event callback — which fires even during Win32 modal resize/move
-    //! loops — the window keeps redrawing live, yet costs nothing when idle and settled.
-    void renderThread(Engine::Renderer& renderer, uint32_t init_width, uint32_t init_height, SignalsLib::Signal<RenderEvent>& signal, std::mutex& mutex,
-        std::condition_variable& cv)
-    {
+    /*!
+        Render on demand with an adaptive frame rate, for either event loop. Frames are wanted
+        while the string is in motion — until the GPU-measured speed of every node, in a frame
+        drawn after the last input, is below settle_speed — and none otherwise, so the loop may
+        sleep until the next event.
+
+        While frames are wanted, the scheduler spaces them by the fastest node's speed, so it
+        moves at most MAX_FRAME_TRAVEL per frame: a fast whip draws at the full present rate, a
+        slow settling swing at down to min_frame_rate. The loop sleeps until nextFrameDue() rather
+        than blocking in the swapchain, and the renderer's fixed-step substepping advances the
+        simulation by the real time between frames, so its motion does not depend on the rate.
+        Input makes the next frame due at once.
+    */
+    class FrameLoop {
+    public:
         using Clock = std::chrono::steady_clock;
-        const Clock::duration settle = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(SETTLE_SECONDS));
 
-        uint32_t width = init_width;
-        uint32_t height = init_height;
-        int32_t cursor_x = static_cast<int32_t>(init_width / 2);
-        int32_t cursor_y = static_cast<int32_t>(init_height / 2);
+        FrameLoop(uint32_t width, uint32_t height, float settle_speed, float min_frame_rate) :
+            m_width{width},
+            m_height{height},
+            m_settle_speed{settle_speed},
+            m_max_interval_s{(min_frame_rate > 0.0f) ? (1.0f / min_frame_rate) : 0.0f}
+        {
+        }
+
+        //! True if frames are wanted rather than sleeping until an event. A minimised / zero-size
+        //! window wants none: drawFrame() would return at once there, so a loop that kept asking
+        //! would spin — it sleeps until a real resize instead.
+        [[nodiscard]] bool wantsFrame() const
+        {
+            return m_active && (m_width > 0) && (m_height > 0);
+        }
+
+        //! When the next frame is due: the previous frame plus the scheduled interval (already
+        //! past while input is pending) while wantsFrame(), never otherwise.
+        [[nodiscard]] Clock::time_point nextFrameDue() const
+        {
+            if (!wantsFrame()) {
+                return Clock::time_point::max();
+            }
+            if (m_input_pending || (m_max_interval_s <= 0.0f) || (m_speed <= 0.0f)) {
+                return m_last_frame;
+            }
+            float interval_s = std::min(MAX_FRAME_TRAVEL / m_speed, m_max_interval_s);
+            return m_last_frame + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(interval_s));
+        }
+
+        //! Takes the newest client size.
+        void resize(uint32_t width, uint32_t height)
+        {
+            m_width = width;
+            m_height = height;
+        }
+
+        //! Notes input since the last frame: frames are wanted until one drawn after it settles,
+        //! and the next one is due at once.
+        void noteInput(const Engine::Renderer& renderer)
+        {
+            m_active = true;
+            m_input_pending = true;
+            m_input_frame = renderer.frameSerial();
+        }
+
+        //! Restarts the frame clock after sleeping idle, so the next frame does not take a huge dt.
+        void wake()
+        {
+            m_last_time = Clock::now();
+        }
+
+        //! Draws a frame if one is wanted and due, and stops wanting them once the string has
+        //! settled.
+        void step(Engine::Renderer& renderer)
+        {
+            Clock::time_point now = Clock::now();
+            accountTime(renderer, now);
+            if (!wantsFrame()) {
+                m_last_time = now;
+                return;
+            }
+            if (now < nextFrameDue()) {
+                return;
+            }
+            float dt = std::chrono::duration<float>(now - m_last_time).count();
+            m_last_time = now;
+            m_last_frame = now;
+            m_input_pending = false;
+            renderer.drawFrame(m_width, m_height, dt);
 
-        Clock::time_point last_time = Clock::now();
-        Clock::time_point active_until = last_time + settle; // render the initial settle from gravity
+            // Settled once a measurement taken after the last event shows no node moving.
+            m_speed = renderer.motion().max_speed;
+            if ((renderer.motionFrame() > m_input_frame) && (m_speed < m_settle_speed)) {
+                m_active = false;
+            }
+            accountTime(renderer, now);
+        }
+
+        //! Adds the active / idle time not yet in the renderer's stats, when the loop ends.
+        void finish(Engine::Renderer& renderer)
+        {
+            addTime(renderer, Clock::now());
+        }
+
+    private:
+        //! addTime() if the loop started or stopped wanting frames, or STATS_ACCOUNT_INTERVAL has
+        //! passed, since the time was last added.
+        void accountTime(Engine::Renderer& renderer, Clock::time_point now)
+        {
+            if ((wantsFrame() != m_accounted_active) || (now >= (m_accounted_until + STATS_ACCOUNT_INTERVAL))) {
+                addTime(renderer, now);
+            }
+        }
+
+        //! Adds the time up to now to the renderer's active or idle counter.
+        void addTime(Engine::Renderer& renderer, Clock::time_point now)
+        {
+            uint64_t elapsed_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - m_accounted_until).count());
+            renderer.stats().add(m_accounted_active ? Engine::FrameCounter::ActiveMicroseconds : Engine::FrameCounter::IdleMicroseconds, elapsed_us);
+            m_accounted_active = wantsFrame();
+            m_accounted_until = now;
+        }
+
+        uint32_t m_width; //!< Client size frames are drawn at.
+        uint32_t m_height;
+        float m_settle_speed; //!< See DEFAULT_SETTLE_SPEED.
+        float m_max_interval_s; //!< Longest scheduled gap between frames (seconds); 0 never waits.
+        Clock::time_point m_last_time{Clock::now()}; //!< When the previous frame (or wake-up) happened: the next frame's dt.
+        Clock::time_point m_last_frame{}; //!< When the previous frame was drawn: the schedule's origin.
+        float m_speed{0.0f}; //!< Fastest node speed in the newest motion measurement (NDC / s).
+        bool m_active{true}; //!< Render the initial settle from gravity.
+        bool m_input_pending{false}; //!< Input arrived since the previous frame.
+        uint64_t m_input_frame{0}; //!< Newest frame submitted before the last input.
+        bool m_accounted_active{true}; //!< Whether the time since m_accounted_until counts as active.
+        Clock::time_point m_accounted_until{Clock::now()}; //!< Active / idle time is in the stats up to here.
+    };
+
+    //! The render thread (EventLoop::Threaded): owns the frame loop and sleeps on the condition
+    //! variable while it wants no frames. Because it is woken by the immediate event callback —
+    //! which fires even during Win32 modal resize/move loops — the window keeps redrawing live,
+    //! yet costs nothing when idle and settled.
+    void renderThread(Engine::Renderer& renderer, uint32_t init_width, uint32_t init_height, const AppConfig& app_config, RenderSignal& signal,
+        RenderMailbox& mailbox, std::mutex& mutex, std::condition_variable& cv)
+    {
+        TracingLib::setThreadName("render");
+        FrameLoop loop{init_width, init_height, app_config.settle_speed, app_config.min_frame_rate};
         bool running = true;
 
         while (running) {
-            // Block until the main thread signals an event when settled, or when the window is
-            // minimised / zero-size (drawFrame would return immediately there, so the active loop
-            // must not spin — treat zero-size as settled and sleep until a real resize wakes us).
-            if ((Clock::now() >= active_until) || (width == 0) || (height == 0)) {
+            // Block until the main thread signals an event when no frame is wanted, and until the
+            // next frame is due (or an event comes first) when one is scheduled for later.
+            FrameLoop::Clock::time_point due = loop.nextFrameDue();
+            if (due > FrameLoop::Clock::now()) {
+                TRACE_ZONE("wait for frame");
                 std::unique_lock<std::mutex> lock(mutex);
-                cv.wait(lock, [&signal]() {
-                    return !signal.empty();
-                });
-                last_time = Clock::now(); // avoid a huge dt after sleeping
+                auto woken = [&signal, &mailbox]() {
+                    return !signal.empty() || mailbox.input.load(std::memory_order_acquire);
+                };
+                if (due == FrameLoop::Clock::time_point::max()) {
+                    cv.wait(lock, woken);
+                    loop.wake();
+                } else {
+                    (void)cv.wait_until(lock, due, woken);
+                }
             }
 
-            // Drain all pending render events.
-            bool got_input = false;
+            // Paced presents: wait for the previous frame to reach the display before taking the
+            // input, so the frame drawn from it is not queued behind others.
+            if (loop.wantsFrame()) {
+                renderer.paceFrame();
+            }
+
+            // Drain the discrete commands, then take the coalesced input: however many events
+            // arrived since the last frame, this is one exchange and (after a resize) one load.
             RenderEvent ev;
             while (signal.consume(ev)) {
                 switch (ev.type) {
                 case RenderEvent::Type::Stop:
                     running = false;
                     break;
-                case RenderEvent::Type::Resize:
-                    width = ev.width;
-                    height = ev.height;
-                    got_input = true;
-                    break;
-                case RenderEvent::Type::MouseMove:
-                    cursor_x = ev.x;
-                    cursor_y = ev.y;
-                    got_input = true;
-                    break;
-                case RenderEvent::Type::Render:
-                    got_input = true;
-                    break;
                 }
             }
             if (!running) {
                 break;
             }
-
-            Clock::time_point now = Clock::now();
+            bool got_input = mailbox.input.exchange(false, std::memory_order_acquire);
+            WindowSize size;
+            if (mailbox.size.consume(size)) {
+                // Only the newest size of a modal drag reaches drawFrame(), which rebuilds the
+                // swapchain once for it.
+                loop.resize(size.width, size.height);
+            }
             if (got_input) {
-                active_until = now + settle;
+                loop.noteInput(renderer);
             }
-            if ((now < active_until) && (width > 0) && (height > 0)) {
-                float dt = std::chrono::duration<float>(now - last_time).count();
-                last_time = now;
-                renderer.drawFrame(width, height, cursor_x, cursor_y, dt);
+            loop.step(renderer);
+        }
+        loop.finish(renderer);
+    }
+
+    //! EventLoop::Single: the main thread both handles events and draws. Between frames it waits
+    //! on the window's event fd with the next frame's deadline as timeout — forever while settled —
+    //! so an event is latched and acted on by the thread that draws, without a cross-thread
+    //! hand-off or wake-up. Returns once the window is closed.
+    void singleThreadLoop(WindowLib::Window& window, Engine::Renderer& renderer, const AppConfig& app_config)
+    {
+        FrameLoop loop{window.width(), window.height(), app_config.settle_speed, app_config.min_frame_rate};
+        CursorLatch latch{window.width(), window.height(), static_cast<int32_t>(window.width() / 2), static_cast<int32_t>(window.height() / 2)};
+
+        while (!window.shouldClose()) {
+            FrameLoop::Clock::time_point due = loop.nextFrameDue();
+            if (due == FrameLoop::Clock::time_point::max()) {
+                window.waitEvents();
+                loop.wake();
             } else {
-                last_time = now;
+                window.waitEvents(std::chrono::duration_cast<std::chrono::microseconds>(due - FrameLoop::Clock::now()));
+            }
+
+            // As on the render thread: pace first, then take everything that arrived meanwhile.
+            if (loop.wantsFrame()) {
+                renderer.paceFrame();
+                window.pumpEvents();
+            }
+
+            bool got_input = false;
+            WindowLib::WindowEvent event;
+            while (window.pollEvent(event)) {
+                if (event.type == WindowLib::WindowEvent::Type::Close) {
+                    window.requestClose();
+                } else if (latchEvent(event, latch, renderer)) {
+                    got_input = true;
+                }
+            }
+            if (window.shouldClose()) {
+                break;
+            }
+            loop.resize(latch.width, latch.height);
+            if (got_input) {
+                loop.noteInput(renderer);
+            }
+            loop.step(renderer);
+        }
+        loop.finish(renderer);
+    }
+
+    //! Replay mode: plays the recording into the window's renderer from the main thread, with
+    //! the window's own input ignored, until it ends or the window is closed. The recording
+    //! stands in for both the input and the frame scheduler — its frames are the ones the
+    //! recorded run drew, with their dt — so neither event loop runs.
+    void replayLoop(WindowLib::Window& window, Engine::Renderer& renderer, const Engine::InputRecording& recording, Engine::ReplaySpeed speed)
+    {
+        Engine::InputReplayer replayer{recording, speed};
+        while (!window.shouldClose() && !replayer.done()) {
+            window.pumpEvents();
+            WindowLib::WindowEvent event;
+            while (window.pollEvent(event)) {
+                if (event.type == WindowLib::WindowEvent::Type::Close) {
+                    window.requestClose();
+                }
             }
+            renderer.paceFrame();
+            replayer.step(renderer, window.width(), window.height());
         }
     }
 
 } // namespace
 
 //! Composition root — wires together the logger, the window and the Vulkan renderer.
-int main()
+int main(int argc, char** argv)
 {
     LoggingLib::Logger logger;
-    logger.logInfo("StringWiggler starting.");
+    LOG_INFO(logger, "StringWiggler starting.");
+
+    Engine::RendererConfig renderer_config{};
+    const char* gpu_from_environment = std::getenv(GPU_ENVIRONMENT_VARIABLE);
+    if (gpu_from_environment != nullptr) {
+        renderer_config.gpu.device = gpu_from_environment;
+    }
+    AppConfig app_config{};
+    std::string error_message;
+    if (!parseArguments(argc, argv, renderer_config, app_config, error_message)) {
+        LOG_ERROR(logger, error_message);
+        return EXIT_FAILURE;
+    }
+    // Traced from here, so the renderer's start-up phases are in the trace.
+    TracingLib::setThreadName("main");
+    if (!app_config.trace_path.empty()) {
+        if (!TracingLib::TRACING_COMPILED) {
+            LOG_WARNING(logger, "This build has tracing compiled out (TRACING_ENABLED=OFF); the trace will hold no zones.");
+        }
+        TracingLib::setEnabled(true);
+    }
 
     WindowLib::WindowConfig config{};
     config.title = "StringWiggler";
     config.width = 800;
     config.height = 600;
+
+    // A replay simulates the recorded batch in a window of the recorded size, so the workload is
+    // the recorded one whatever the other options say.
+    Engine::InputRecording recording{};
+    if (!app_config.replay_path.empty()) {
+        if (!recording.load(app_config.replay_path, error_message)) {
+            LOG_ERROR(logger, error_message);
+            return EXIT_FAILURE;
+        }
+        renderer_config.node_count = recording.node_count;
+        renderer_config.string_count = recording.string_count;
+        renderer_config.constraint_iterations = recording.constraint_iterations;
+        config.width = recording.width;
+        config.height = recording.height;
+        LOG_INFO(logger, "Replaying \"" + app_config.replay_path + "\": " + std::to_string(recording.frameCount()) + " frames of " + std::to_string(recording.string_count)
+            + " x " + std::to_string(recording.node_count) + " nodes.");
+    }
     std::unique_ptr<WindowLib::Window> window{WindowLib::create(config, logger)};
 
     Engine::NativeWindowHandle window_handle{};
@@ -148,83 +671,125 @@ int main()
     window_handle.window = window->nativeHandle();
 
     Engine::Renderer renderer;
-    std::string error_message;
-    if (!renderer.init(logger, window_handle, window->width(), window->height(), error_message)) {
-        logger.logError(error_message);
+    if (!renderer.init(logger, window_handle, window->width(), window->height(), renderer_config, error_message)) {
+        LOG_ERROR(logger, error_message);
         return EXIT_FAILURE;
     }
 
-    // Render on a dedicated thread, woken by the window's immediate event callback. The callback
-    // fires from the platform event handler even during Win32 modal resize/move loops, so the
-    // window keeps redrawing live; the render thread sleeps once the string has settled.
-    SignalsLib::Signal<RenderEvent> render_signal;
-    std::mutex render_mutex;
-    std::condition_variable render_cv;
-
-    std::thread render_worker(renderThread, std::ref(renderer), window->width(), window->height(), std::ref(render_signal), std::ref(render_mutex), std::ref(render_cv));
-
-    CallbackContext cb_ctx{&render_signal, &render_mutex, &render_cv};
-    window->setEventCallback(
-        [](const WindowLib::WindowEvent& ev, void* user_data) {
-            auto* ctx = static_cast<CallbackContext*>(user_data);
-            RenderEvent re{};
-            switch (ev.type) {
-            case WindowLib::WindowEvent::Type::Resize:
-                re.type = RenderEvent::Type::Resize;
-                re.width = ev.resize.width;
-                re.height = ev.resize.height;
-                break;
-            case WindowLib::WindowEvent::Type::MouseMove:
-                re.type = RenderEvent::Type::MouseMove;
-                re.x = ev.mouse_move.x;
-                re.y = ev.mouse_move.y;
-                break;
-            case WindowLib::WindowEvent::Type::Expose:
-            case WindowLib::WindowEvent::Type::Move:
-                re.type = RenderEvent::Type::Render;
-                break;
-            default:
-                return; // Close is handled by the main loop; ignore keys/focus/etc.
-            }
-            // Emit under the mutex so the render thread cannot miss the wake-up (it checks the
-            // queue under the same mutex inside cv.wait).
-            {
-                std::lock_guard<std::mutex> lock(*ctx->mutex);
-                ctx->signal->emit(re);
-            }
-            ctx->cv->notify_one();
-        },
-        &cb_ctx);
+    if ((app_config.event_loop == EventLoop::Single) && (window->nativeEventFd() < 0)) {
+        LOG_INFO(logger, "This window system has no event descriptor to wait on; using the threaded event loop.");
+        app_config.event_loop = EventLoop::Threaded;
+    }
+
+    std::unique_ptr<Engine::InputRecorder> recorder;
+    if (!app_config.record_path.empty()) {
+        recorder = std::make_unique<Engine::InputRecorder>(window->width(), window->height(), renderer_config.node_count, renderer_config.string_count,
+            renderer_config.constraint_iterations);
+        renderer.setInputRecorder(recorder.get());
+    }
+
+    if (!app_config.replay_path.empty()) {
+        replayLoop(*window, renderer, recording, app_config.replay_speed);
+    } else if (app_config.event_loop == EventLoop::Single) {
+        LOG_INFO(logger, "Single-threaded event loop: events and frames share the main thread.");
+        singleThreadLoop(*window, renderer, app_config);
+    } else {
+        // Render on a dedicated thread, woken by the window's immediate event callback. The callback
+        // fires from the platform event handler even during Win32 modal resize/move loops, so the
+        // window keeps redrawing live; the render thread sleeps once the string has settled.
+        RenderSignal render_signal;
+        RenderMailbox render_mailbox;
+        std::mutex render_mutex;
+        std::condition_variable render_cv;
+
+        std::thread render_worker(renderThread, std::ref(renderer), window->width(), window->height(), std::cref(app_config), std::ref(render_signal),
+            std::ref(render_mailbox), std::ref(render_mutex), std::ref(render_cv));
+
+        CallbackContext cb_ctx{&render_mailbox, &render_mutex, &render_cv, &renderer,
+            CursorLatch{window->width(), window->height(), static_cast<int32_t>(window->width() / 2), static_cast<int32_t>(window->height() / 2)}};
+        window->setEventCallback(
+            [](const WindowLib::WindowEvent& ev, void* user_data) {
+                TRACE_ZONE("event callback");
+                auto* ctx = static_cast<CallbackContext*>(user_data);
+                if (!latchEvent(ev, ctx->latch, *ctx->renderer)) {
+                    return;
+                }
+                if (ev.type == WindowLib::WindowEvent::Type::Resize) {
+                    ctx->mailbox->size.emit(WindowSize{ev.resize.width, ev.resize.height});
+                }
+                // Raise the input flag. Only the event that raises it wakes the render thread: until the
+                // render thread clears the flag it has a wake-up pending (or has not slept), so the rest
+                // of a burst is just this exchange. The waker passes through the mutex before notifying,
+                // so the render thread, which checks the flag under that mutex inside cv.wait, has
+                // either seen it or is already waiting.
+                if (!ctx->mailbox->input.exchange(true, std::memory_order_release)) {
+                    {
+                        TRACE_ZONE("render_mutex");
+                        std::lock_guard<std::mutex> lock(*ctx->mutex);
+                    }
+                    ctx->cv->notify_one();
+                }
+            },
+            &cb_ctx);
 
-    // Main loop — pump window events (blocking when idle). All rendering happens on the render
-    // thread via the callback above; here we only watch for the close request.
-    while (!window->shouldClose()) {
-        window->waitEvents();
+        // Main loop — pump window events (blocking when idle). All rendering happens on the render
+        // thread via the callback above; here we only watch for the close request.
+        while (!window->shouldClose()) {
+            window->waitEvents();
 
-        WindowLib::WindowEvent event;
-        while (window->pollEvent(event)) {
-            if (event.type == WindowLib::WindowEvent::Type::Close) {
-                window->requestClose();
+            WindowLib::WindowEvent event;
+            while (window->pollEvent(event)) {
+                if (event.type == WindowLib::WindowEvent::Type::Close) {
+                    window->requestClose();
+                }
             }
         }
-    }
 
-    // Stop the render thread and wait for it (renderer was created here, on the main thread, so
-    // it is torn down here too — after the render thread has stopped using it).
-    {
-        std::lock_guard<std::mutex> lock(render_mutex);
+        // Stop the render thread and wait for it (renderer was created here, on the main thread, so
+        // it is torn down here too — after the render thread has stopped using it).
         RenderEvent stop{};
         stop.type = RenderEvent::Type::Stop;
         render_signal.emit(stop);
+        {
+            std::lock_guard<std::mutex> lock(render_mutex);
+        }
+        render_cv.notify_one();
+        render_worker.join();
+
+        // Clear the callback before cb_ctx / the mailbox go out of scope, so a late event during
+        // window destruction cannot invoke a dangling pointer.
+        window->setEventCallback(nullptr, nullptr);
     }
-    render_cv.notify_one();
-    render_worker.join();
 
-    // Clear the callback before cb_ctx / the signal go out of scope, so a late event during
-    // window destruction cannot invoke a dangling pointer.
-    window->setEventCallback(nullptr, nullptr);
+    if (recorder != nullptr) {
+        renderer.setInputRecorder(nullptr);
+        if (recorder->save(app_config.record_path, error_message)) {
+            LOG_INFO(logger, "Input recording written to \"" + app_config.record_path + "\".");
+        } else {
+            LOG_WARNING(logger, error_message);
+        }
+    }
+
+    // Whole-run telemetry, logged and optionally dumped for comparing machines and builds.
+    Engine::FrameStatsSnapshot stats = renderer.stats().snapshot();
+    LOG_INFO(logger, stats.summary());
+    if (!app_config.stats_csv.empty()) {
+        if (stats.writeCsv(app_config.stats_csv, error_message)) {
+            LOG_INFO(logger, "Frame statistics written to \"" + app_config.stats_csv + "\".");
+        } else {
+            LOG_WARNING(logger, error_message);
+        }
+    }
 
     renderer.destroy();
-    logger.logInfo("StringWiggler shutting down.");
+    if (!app_config.trace_path.empty()) {
+        TracingLib::setEnabled(false);
+        if (TracingLib::writeChromeTrace(app_config.trace_path, error_message)) {
+            LOG_INFO(logger, "Trace of {} zones written to \"{}\" ({} dropped).", TracingLib::eventsRecorded(), app_config.trace_path, TracingLib::eventsDropped());
+        } else {
+            LOG_WARNING(logger, error_message);
+        }
+    }
+    LOG_INFO(logger, "StringWiggler shutting down.");
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,101 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "physics_thread.hpp"
+#include <trace/tracer.hpp>
+#include <algorithm>
+
+namespace Engine
+{
+
+    PhysicsThread::~PhysicsThread()
+    {
+        stop();
+    }
+
+    void PhysicsThread::start(float rate_hz, PhysicsTickFunction tick, void* user_data)
+    {
+        if (running()) {
+            return;
+        }
+        m_period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(1.0f / rate_hz));
+        m_tick = tick;
+        m_user_data = user_data;
+        m_woken = false;
+        m_stopping = false;
+        m_worker = std::thread([this]() {
+            run();
+        });
+    }
+
+    void PhysicsThread::wake()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_woken = true;
+        }
+        m_cv.notify_one();
+    }
+
+    void PhysicsThread::stop()
+    {
+        if (!running()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_cv.notify_one();
+        m_worker.join();
+    }
+
+    void PhysicsThread::run()
+    {
+        TracingLib::setThreadName("physics");
+        Clock::time_point last = Clock::now();
+        Clock::time_point next = last + m_period;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            {
+                TRACE_ZONE("wait for tick");
+                if (m_cv.wait_until(lock, next, [this]() {
+                        return m_stopping;
+                    })) {
+                    return;
+                }
+            }
+            m_woken = false;
+            lock.unlock();
+
+            Clock::time_point now = Clock::now();
+            bool moving = m_tick(std::chrono::duration<float>(now - last).count(), m_user_data);
+            last = now;
+            // Due a period after the previous tick was, or at once if this one overran it.
+            next = std::max(next + m_period, Clock::now());
+
+            lock.lock();
+            if (!moving && !m_woken) {
+                // At rest: sleep until woken, and leave the time asleep out of the next tick.
+                TRACE_ZONE("idle");
+                m_cv.wait(lock, [this]() {
+                    return m_stopping || m_woken;
+                });
+                last = Clock::now();
+                next = last + m_period;
+            }
+        }
+    }
+
+} // namespace Engine
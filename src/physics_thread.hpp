@@ -0,0 +1,81 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Engine
+{
+
+    //! One tick of the simulation, run on the physics thread: dt is the time since the previous
+    //! tick (or since start() or a wake() from idle) in seconds. Returns true while the simulation
+    //! is still moving, false to let the thread idle until the next wake().
+    using PhysicsTickFunction = bool (*)(float dt, void* user_data);
+
+    /*!
+        Ticks the simulation at a fixed rate on a thread of its own, whatever the frame loop does:
+        throttled frames, an occluded or minimised window and a stalled render thread no longer
+        stretch the steps the physics takes. A tick that overruns its period starts the next one
+        at once rather than bursting to catch up, so the tick function sees the real elapsed time.
+
+        The thread idles once a tick reports the simulation at rest, and ticks again after the next
+        wake() (which the render thread calls every frame, so input that wakes it wakes this too).
+    */
+    class PhysicsThread {
+    public:
+        PhysicsThread() = default;
+        ~PhysicsThread();
+
+        PhysicsThread(const PhysicsThread&) = delete;
+        PhysicsThread& operator=(const PhysicsThread&) = delete;
+        PhysicsThread(PhysicsThread&&) = delete;
+        PhysicsThread& operator=(PhysicsThread&&) = delete;
+
+        //! Starts the thread, calling tick(dt, user_data) rate_hz times a second (rate_hz > 0).
+        void start(float rate_hz, PhysicsTickFunction tick, void* user_data);
+
+        //! True between start() and stop().
+        [[nodiscard]] bool running() const
+        {
+            return m_worker.joinable();
+        }
+
+        //! Resumes ticking if the thread is idle; otherwise keeps it from idling after the current
+        //! tick. One uncontended lock. From any thread.
+        void wake();
+
+        //! Lets the current tick finish and joins the thread. Safe to call repeatedly.
+        void stop();
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        //! Worker: ticks until stop().
+        void run();
+
+        Clock::duration m_period{}; //!< Time between tick starts.
+        PhysicsTickFunction m_tick{nullptr}; //!< Called once per tick.
+        void* m_user_data{nullptr}; //!< Passed to m_tick.
+        std::mutex m_mutex; //!< Guards m_woken and m_stopping.
+        std::condition_variable m_cv; //!< Notified by wake() and stop().
+        bool m_woken{false}; //!< wake() since the worker last looked.
+        bool m_stopping{false}; //!< stop() has been called.
+        std::thread m_worker; //!< Runs run().
+    };
+
+} // namespace Engine
@@ -13,27 +13,57 @@
 */
 
 #include "pipeline.hpp"
-#include "shader_loader.hpp"
+#include "ribbon_spv.hpp"
+#include <trace/tracer.hpp>
 #include <array>
 #include <cstdint>
-#include <vector>
 
 namespace Engine
 {
 
-    bool Pipeline::init(const Device& device, vk::Format colour_format, std::string& out_error_message)
+    bool Pipeline::init(const Device& device, vk::Format colour_format, const vk::raii::PipelineCache& cache, std::string& out_error_message)
     {
-        std::vector<uint32_t> spirv;
-        if (!loadSpirv(executableDirectory() + "line.spv", spirv, out_error_message)) {
-            return false;
-        }
-
+        TRACE_ZONE("Pipeline::init");
         try {
             vk::ShaderModuleCreateInfo module_info{};
-            module_info.setCode(spirv);
+            module_info.codeSize = sizeof(RIBBON_SPV);
+            module_info.pCode = RIBBON_SPV;
             vk::raii::ShaderModule module{device.get(), module_info};
 
-            // Both entry points live in the one module (slangc -entry vertMain -entry fragMain).
+            // Ribbon expansion, bounds and culling: four storage buffers and the push constants, compute only.
+            std::array<vk::DescriptorSetLayoutBinding, RIBBON_BINDING_COUNT> bindings{};
+            for (uint32_t i = 0; i < bindings.size(); ++i) {
+                bindings[i].binding = i;
+                bindings[i].descriptorType = vk::DescriptorType::eStorageBuffer;
+                bindings[i].descriptorCount = 1;
+                bindings[i].stageFlags = vk::ShaderStageFlagBits::eCompute;
+            }
+            vk::DescriptorSetLayoutCreateInfo set_layout_info{};
+            set_layout_info.setBindings(bindings);
+            m_ribbon_set_layout = vk::raii::DescriptorSetLayout(device.get(), set_layout_info);
+
+            vk::PushConstantRange push_range{};
+            push_range.stageFlags = vk::ShaderStageFlagBits::eCompute;
+            push_range.offset = 0;
+            push_range.size = sizeof(RibbonPush);
+            vk::DescriptorSetLayout ribbon_set_layout = *m_ribbon_set_layout;
+            vk::PipelineLayoutCreateInfo ribbon_layout_info{};
+            ribbon_layout_info.setSetLayouts(ribbon_set_layout);
+            ribbon_layout_info.setPushConstantRanges(push_range);
+            m_ribbon_layout = vk::raii::PipelineLayout(device.get(), ribbon_layout_info);
+
+            vk::ComputePipelineCreateInfo ribbon_info{};
+            ribbon_info.stage.stage = vk::ShaderStageFlagBits::eCompute;
+            ribbon_info.stage.module = *module;
+            ribbon_info.stage.setPName("ribbonMain");
+            ribbon_info.layout = *m_ribbon_layout;
+            m_ribbon = vk::raii::Pipeline(device.get(), cache, ribbon_info);
+            ribbon_info.stage.setPName("ribbonBoundsMain");
+            m_ribbon_bounds = vk::raii::Pipeline(device.get(), cache, ribbon_info);
+            ribbon_info.stage.setPName("ribbonCullMain");
+            m_ribbon_cull = vk::raii::Pipeline(device.get(), cache, ribbon_info);
+
+            // The graphics entry points live in the same module (slangc -entry vertMain -entry fragMain).
             std::array<vk::PipelineShaderStageCreateInfo, 2> stages{};
             stages[0].stage = vk::ShaderStageFlagBits::eVertex;
             stages[0].module = *module;
@@ -42,7 +72,7 @@ namespace Engine
             stages[1].module = *module;
             stages[1].setPName("fragMain");
 
-            // Vertex input: one binding of tightly-packed Vec2 positions at location 0.
+            // Vertex input: one binding of tightly-packed Vec2 ribbon vertices at location 0.
             vk::VertexInputBindingDescription binding{};
             binding.binding = 0;
             binding.stride = sizeof(float) * 2;
@@ -59,7 +89,7 @@ namespace Engine
             vertex_input.setVertexAttributeDescriptions(attribute);
 
             vk::PipelineInputAssemblyStateCreateInfo input_assembly{};
-            input_assembly.topology = vk::PrimitiveTopology::eLineStrip;
+            input_assembly.topology = vk::PrimitiveTopology::eTriangleStrip;
             input_assembly.primitiveRestartEnable = vk::False;
 
             std::array<vk::DynamicState, 2> dynamic_states{vk::DynamicState::eViewport, vk::DynamicState::eScissor};
@@ -83,8 +113,15 @@ namespace Engine
             multisample.rasterizationSamples = vk::SampleCountFlagBits::e1;
             multisample.sampleShadingEnable = vk::False;
 
+            // Coverage in the fragment alpha: blend the string over the background.
             vk::PipelineColorBlendAttachmentState blend_attachment{};
-            blend_attachment.blendEnable = vk::False;
+            blend_attachment.blendEnable = vk::True;
+            blend_attachment.srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
+            blend_attachment.dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+            blend_attachment.colorBlendOp = vk::BlendOp::eAdd;
+            blend_attachment.srcAlphaBlendFactor = vk::BlendFactor::eOne;
+            blend_attachment.dstAlphaBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+            blend_attachment.alphaBlendOp = vk::BlendOp::eAdd;
             blend_attachment.colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB
                 | vk::ColorComponentFlagBits::eA;
 
@@ -92,7 +129,13 @@ namespace Engine
             colour_blend.logicOpEnable = vk::False;
             colour_blend.setAttachments(blend_attachment);
 
-            vk::PipelineLayoutCreateInfo layout_info{}; // empty: no descriptor sets or push constants yet.
+            // No descriptor sets; the colour and the erase flag are push constants of the vertex stage.
+            vk::PushConstantRange draw_push_range{};
+            draw_push_range.stageFlags = vk::ShaderStageFlagBits::eVertex;
+            draw_push_range.offset = 0;
+            draw_push_range.size = sizeof(DrawPush);
+            vk::PipelineLayoutCreateInfo layout_info{};
+            layout_info.setPushConstantRanges(draw_push_range);
             m_layout = vk::raii::PipelineLayout(device.get(), layout_info);
 
             // Dynamic rendering: declare the colour attachment format instead of a render pass.
@@ -112,7 +155,7 @@ namespace Engine
             pipeline_info.renderPass = nullptr; // using dynamic rendering
             pipeline_info.setPNext(&rendering_info);
 
-            m_pipeline = vk::raii::Pipeline(device.get(), nullptr, pipeline_info);
+            m_pipeline = vk::raii::Pipeline(device.get(), cache, pipeline_info);
         } catch (const vk::SystemError& e) {
             out_error_message = std::string("Vulkan error creating pipeline: ") + e.what();
             return false;
@@ -126,6 +169,11 @@ namespace Engine
 
     void Pipeline::destroy()
     {
+        m_ribbon_cull = nullptr;
+        m_ribbon_bounds = nullptr;
+        m_ribbon = nullptr;
+        m_ribbon_layout = nullptr;
+        m_ribbon_set_layout = nullptr;
         m_pipeline = nullptr;
         m_layout = nullptr;
     }
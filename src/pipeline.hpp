@@ -21,14 +21,73 @@
 #include <volk/volk.h>
 #endif
 #include <vulkan/vulkan_raii.hpp>
+#include <cstdint>
 #include <string>
 
 namespace Engine
 {
 
-    //! Graphics pipeline for the string: a single Vec2 vertex attribute, line-strip topology,
-    //! dynamic rendering (no render pass), dynamic viewport/scissor. Loads line.spv (compiled
-    //! from line.slang) sitting next to the executable.
+    //! Half-width of the opaque core of the string ribbon (pixels). Must match ribbon.slang.
+    static constexpr float RIBBON_HALF_WIDTH_PX = 1.5f;
+
+    //! Anti-aliasing fringe beyond the core on each side of the ribbon (pixels), over which the
+    //! coverage falls to 0. Must match ribbon.slang.
+    static constexpr float RIBBON_FRINGE_PX = 1.0f;
+
+    //! Ribbon vertices per string node (one on each side).
+    static constexpr uint32_t RIBBON_VERTICES_PER_NODE = 2;
+
+    //! Most Catmull-Rom spline pieces per segment the ribbon expansion draws. Must match ribbon.slang.
+    static constexpr uint32_t RIBBON_MAX_SUBDIVISIONS = 8;
+
+    //! Vertices of the erase quad (a triangle strip) after the ribbon vertices of the batch.
+    static constexpr uint32_t RIBBON_ERASE_VERTICES = 4;
+
+    //! Storage-buffer bindings of the ribbon descriptor set: node positions in, ribbon vertices
+    //! out, pixel bounds, indirect draws.
+    static constexpr uint32_t RIBBON_BINDING_COUNT = 4;
+
+    //! Target images whose drawn bounds the bounds buffer holds. Must match ribbon.slang.
+    static constexpr uint32_t RIBBON_MAX_TARGET_IMAGES = 8;
+
+    //! Words of the bounds buffer: the frame's running box, then the box last drawn into each
+    //! target image, each as {min x, min y, max x, max y} in pixels. Must match ribbon.slang.
+    static constexpr uint32_t RIBBON_BOUNDS_WORDS = 4 * (1 + RIBBON_MAX_TARGET_IMAGES);
+
+    //! First word of the draw commands in a ribbon draws buffer (word 0 is the draw count, padded
+    //! to one vk::DrawIndirectCommand). Must match ribbon.slang.
+    static constexpr uint32_t RIBBON_DRAW_COMMANDS_WORD = 4;
+
+    //! Push constants of the ribbon expansion. Must match the RibbonPush struct in ribbon.slang.
+    struct RibbonPush {
+        uint32_t node_count; //!< Nodes per string.
+        uint32_t total_nodes; //!< Nodes in the batch.
+        float pixel_ndc_x; //!< Width of one target pixel in NDC (2 / width).
+        float pixel_ndc_y; //!< Height of one target pixel in NDC (2 / height).
+        uint32_t target_image; //!< Image being drawn (its drawn-bounds entry, below RIBBON_MAX_TARGET_IMAGES).
+        uint32_t compact_draws; //!< 1: pack the kept draws for drawIndirectCount; 0: one draw per string, culled ones empty.
+        uint32_t subdivisions; //!< Spline pieces per segment, 1 to RIBBON_MAX_SUBDIVISIONS (1: straight segments).
+        uint32_t padding; //!< Keeps the size at 32 bytes on both sides.
+    };
+
+    //! Push constants of a ribbon draw. Must match the DrawPush struct in ribbon.slang.
+    struct DrawPush {
+        float colour_r; //!< Linear red of the draw.
+        float colour_g; //!< Linear green of the draw.
+        float colour_b; //!< Linear blue of the draw.
+        uint32_t erase; //!< 1: the erase quad, drawn opaque; 0: the ribbon, with coverage alpha.
+    };
+
+    //! The string geometry, built from the embedded RIBBON_SPV (compiled from ribbon.slang):
+    //! - ribbon(): a compute pipeline expanding node positions into a triangle-strip ribbon of
+    //!   RIBBON_VERTICES_PER_NODE vertices per node and per inner spline point (RibbonPush::subdivisions
+    //!   pieces per segment), and (ribbonBounds()) folding the ribbon's
+    //!   pixel bounds into an erase quad of RIBBON_ERASE_VERTICES after it, and (ribbonCull())
+    //!   writing the indirect draws of the strings that reach the target. All three share a
+    //!   descriptor-set layout (RIBBON_BINDING_COUNT storage buffers) and a RibbonPush range.
+    //! - get(): the graphics pipeline drawing the ribbon and the erase quad: a single Vec2 vertex
+    //!   attribute, triangle-strip topology, coverage alpha-blended over the target, a DrawPush
+    //!   range, dynamic rendering (no render pass), dynamic viewport/scissor.
     class Pipeline {
     public:
         Pipeline() = default;
@@ -39,11 +98,11 @@ namespace Engine
         Pipeline(Pipeline&&) = delete;
         Pipeline& operator=(Pipeline&&) = delete;
 
-        //! Builds the pipeline for the given device and swapchain colour format. Returns false
-        //! and fills out_error_message on failure (file + vk::raii errors caught here).
-        [[nodiscard]] bool init(const Device& device, vk::Format colour_format, std::string& out_error_message);
+        //! Builds the pipeline for the given device and swapchain colour format, through cache.
+        //! Returns false and fills out_error_message on failure (vk::raii errors caught here).
+        [[nodiscard]] bool init(const Device& device, vk::Format colour_format, const vk::raii::PipelineCache& cache, std::string& out_error_message);
 
-        //! Releases the pipeline + layout. Safe to call repeatedly.
+        //! Releases the pipelines + layouts. Safe to call repeatedly.
         void destroy();
 
         [[nodiscard]] const vk::raii::Pipeline& get() const
@@ -51,9 +110,44 @@ namespace Engine
             return m_pipeline;
         }
 
+        [[nodiscard]] const vk::raii::PipelineLayout& layout() const
+        {
+            return m_layout;
+        }
+
+        [[nodiscard]] const vk::raii::Pipeline& ribbon() const
+        {
+            return m_ribbon;
+        }
+
+        [[nodiscard]] const vk::raii::Pipeline& ribbonBounds() const
+        {
+            return m_ribbon_bounds;
+        }
+
+        [[nodiscard]] const vk::raii::Pipeline& ribbonCull() const
+        {
+            return m_ribbon_cull;
+        }
+
+        [[nodiscard]] const vk::raii::PipelineLayout& ribbonLayout() const
+        {
+            return m_ribbon_layout;
+        }
+
+        [[nodiscard]] const vk::raii::DescriptorSetLayout& ribbonSetLayout() const
+        {
+            return m_ribbon_set_layout;
+        }
+
     private:
-        vk::raii::PipelineLayout m_layout{nullptr}; //!< Empty layout (no descriptors / push constants yet).
+        vk::raii::PipelineLayout m_layout{nullptr}; //!< Graphics layout: the DrawPush range, no descriptors.
         vk::raii::Pipeline m_pipeline{nullptr}; //!< The graphics pipeline.
+        vk::raii::DescriptorSetLayout m_ribbon_set_layout{nullptr}; //!< Ribbon bindings: positions in, ribbon out, bounds, draws.
+        vk::raii::PipelineLayout m_ribbon_layout{nullptr}; //!< Ribbon set layout + RibbonPush range.
+        vk::raii::Pipeline m_ribbon{nullptr}; //!< The ribbon expansion compute pipeline.
+        vk::raii::Pipeline m_ribbon_bounds{nullptr}; //!< The bounds-to-erase-quad compute pipeline.
+        vk::raii::Pipeline m_ribbon_cull{nullptr}; //!< The visibility-to-indirect-draws compute pipeline.
     };
 
 } // namespace Engine
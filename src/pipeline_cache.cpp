@@ -0,0 +1,164 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "pipeline_cache.hpp"
+#include <trace/tracer.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <vector>
+
+namespace Engine
+{
+
+    //! First word of a cache file ("SWPC" little-endian).
+    static constexpr uint32_t CACHE_FILE_MAGIC = 0x43505753u;
+    //! Bumped whenever the file layout changes.
+    static constexpr uint32_t CACHE_FILE_VERSION = 1;
+
+    //! Header in front of the Vulkan cache data in the file.
+    struct CacheFileHeader {
+        uint32_t magic; //!< CACHE_FILE_MAGIC.
+        uint32_t version; //!< CACHE_FILE_VERSION.
+        uint32_t vendor_id; //!< Vendor the data was made on.
+        uint32_t device_id; //!< Device the data was made on.
+        uint32_t driver_version; //!< Driver the data was made with.
+        uint32_t data_size; //!< Bytes of Vulkan cache data after the header.
+    };
+
+    std::string userCacheDirectory()
+    {
+#ifdef _WIN32
+        const char* local_app_data = std::getenv("LOCALAPPDATA");
+        if ((local_app_data == nullptr) || (*local_app_data == '\0')) {
+            return {};
+        }
+        return std::string(local_app_data) + "\\StringWiggler\\";
+#else
+        const char* xdg_cache = std::getenv("XDG_CACHE_HOME");
+        if ((xdg_cache != nullptr) && (*xdg_cache == '/')) {
+            return std::string(xdg_cache) + "/stringwiggler/";
+        }
+        const char* home = std::getenv("HOME");
+        if ((home == nullptr) || (*home == '\0')) {
+            return {};
+        }
+        return std::string(home) + "/.cache/stringwiggler/";
+#endif
+    }
+
+    bool PipelineCache::init(const Device& device, const std::string& path, std::string& out_error_message)
+    {
+        TRACE_ZONE("PipelineCache::init");
+        vk::PhysicalDeviceProperties properties = device.physicalDevice().getProperties();
+        m_path = path;
+        m_vendor_id = properties.vendorID;
+        m_device_id = properties.deviceID;
+        m_driver_version = properties.driverVersion;
+        m_loaded_size = 0;
+        m_reject_reason.clear();
+
+        // Read and validate the file; anything wrong leaves data empty and the cache starts cold.
+        std::vector<char> data;
+        std::ifstream file;
+        if (!m_path.empty()) {
+            file.open(m_path, std::ios::binary);
+        }
+        if (file.is_open()) {
+            std::vector<char> contents{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+            CacheFileHeader header{};
+            vk::PipelineCacheHeaderVersionOne vulkan_header{};
+            if (contents.size() < sizeof(CacheFileHeader) + sizeof(vk::PipelineCacheHeaderVersionOne)) {
+                m_reject_reason = "truncated file";
+            } else {
+                std::memcpy(&header, contents.data(), sizeof(CacheFileHeader));
+                std::memcpy(&vulkan_header, contents.data() + sizeof(CacheFileHeader), sizeof(vk::PipelineCacheHeaderVersionOne));
+                if ((header.magic != CACHE_FILE_MAGIC) || (header.version != CACHE_FILE_VERSION)) {
+                    m_reject_reason = "not a cache file of this version";
+                } else if (header.data_size != contents.size() - sizeof(CacheFileHeader)) {
+                    m_reject_reason = "truncated file";
+                } else if ((header.vendor_id != m_vendor_id) || (header.device_id != m_device_id) || (header.driver_version != m_driver_version)) {
+                    m_reject_reason = "made on another device or driver";
+                } else if ((vulkan_header.headerVersion != vk::PipelineCacheHeaderVersion::eOne) || (vulkan_header.vendorID != m_vendor_id)
+                    || (vulkan_header.deviceID != m_device_id) || (vulkan_header.pipelineCacheUUID != properties.pipelineCacheUUID)) {
+                    m_reject_reason = "pipeline cache UUID mismatch";
+                } else {
+                    data.assign(contents.begin() + sizeof(CacheFileHeader), contents.end());
+                }
+            }
+        }
+
+        try {
+            vk::PipelineCacheCreateInfo create_info{};
+            create_info.initialDataSize = data.size();
+            create_info.pInitialData = data.empty() ? nullptr : data.data();
+            m_cache = vk::raii::PipelineCache(device.get(), create_info);
+        } catch (const vk::SystemError& e) {
+            out_error_message = std::string("Vulkan error creating the pipeline cache: ") + e.what();
+            return false;
+        }
+        m_loaded_size = data.size();
+        return true;
+    }
+
+    bool PipelineCache::save(std::string& out_error_message) const
+    {
+        if (m_path.empty() || !*m_cache) {
+            return true;
+        }
+
+        std::vector<uint8_t> data;
+        try {
+            data = m_cache.getData();
+        } catch (const vk::SystemError& e) {
+            out_error_message = std::string("Vulkan error reading the pipeline cache: ") + e.what();
+            return false;
+        }
+
+        std::error_code error;
+        std::filesystem::path file_path{m_path};
+        std::filesystem::create_directories(file_path.parent_path(), error);
+        if (error) {
+            out_error_message = "Failed to create the pipeline cache directory " + file_path.parent_path().string() + ": " + error.message() + ".";
+            return false;
+        }
+
+        CacheFileHeader header{CACHE_FILE_MAGIC, CACHE_FILE_VERSION, m_vendor_id, m_device_id, m_driver_version, static_cast<uint32_t>(data.size())};
+        std::filesystem::path temporary_path{m_path + ".tmp"};
+        {
+            std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(CacheFileHeader));
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file.good()) {
+                out_error_message = "Failed to write the pipeline cache file " + temporary_path.string() + ".";
+                return false;
+            }
+        }
+        std::filesystem::rename(temporary_path, file_path, error);
+        if (error) {
+            out_error_message = "Failed to replace the pipeline cache file " + m_path + ": " + error.message() + ".";
+            return false;
+        }
+        return true;
+    }
+
+    void PipelineCache::destroy()
+    {
+        m_cache = nullptr;
+    }
+
+} // namespace Engine
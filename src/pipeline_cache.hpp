@@ -0,0 +1,92 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include "device.hpp"
+#ifdef _WIN32
+#include <Volk/volk.h>
+#else
+#include <volk/volk.h>
+#endif
+#include <vulkan/vulkan_raii.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Engine
+{
+
+    //! Returns the per-user cache directory for StringWiggler (with a trailing separator):
+    //! %LOCALAPPDATA%\StringWiggler\ on Windows, $XDG_CACHE_HOME/stringwiggler/ (else
+    //! ~/.cache/stringwiggler/) elsewhere. Empty when no such location is known. Not created.
+    [[nodiscard]] std::string userCacheDirectory();
+
+    //! A VkPipelineCache persisted in a file, so the driver's shader compilation is paid once per
+    //! device and driver rather than on every launch. The file is the cache data behind a small
+    //! header naming the vendor, device and driver version it was made with; init() starts empty
+    //! when the file is missing, truncated, or from another device or driver (Vulkan's own cache
+    //! header is checked against the device's pipelineCacheUUID too). vk::raii exceptions are
+    //! caught in init() and save().
+    class PipelineCache {
+    public:
+        PipelineCache() = default;
+        ~PipelineCache() = default;
+
+        PipelineCache(const PipelineCache&) = delete;
+        PipelineCache& operator=(const PipelineCache&) = delete;
+        PipelineCache(PipelineCache&&) = delete;
+        PipelineCache& operator=(PipelineCache&&) = delete;
+
+        //! Creates the cache, seeded from the file at path when it holds valid data for this
+        //! device. An empty path gives an in-memory cache that save() never writes. Returns false
+        //! and fills out_error_message only when the cache object cannot be created.
+        [[nodiscard]] bool init(const Device& device, const std::string& path, std::string& out_error_message);
+
+        //! Writes the cache data to the file (through a temporary file, so a crash cannot leave a
+        //! torn cache), creating the directory if needed. Returns false and fills out_error_message
+        //! on failure; true without writing for an in-memory cache.
+        [[nodiscard]] bool save(std::string& out_error_message) const;
+
+        //! Releases the cache. Safe to call repeatedly.
+        void destroy();
+
+        [[nodiscard]] const vk::raii::PipelineCache& get() const
+        {
+            return m_cache;
+        }
+
+        //! Bytes of cache data init() loaded (0: started empty).
+        [[nodiscard]] size_t loadedSize() const
+        {
+            return m_loaded_size;
+        }
+
+        //! Why init() started empty despite a file (empty when it loaded, or there was no file).
+        [[nodiscard]] const std::string& rejectReason() const
+        {
+            return m_reject_reason;
+        }
+
+    private:
+        vk::raii::PipelineCache m_cache{nullptr}; //!< The cache handle.
+        std::string m_path; //!< Cache file (empty: in memory only).
+        uint32_t m_vendor_id{0}; //!< VkPhysicalDeviceProperties::vendorID of the device.
+        uint32_t m_device_id{0}; //!< VkPhysicalDeviceProperties::deviceID of the device.
+        uint32_t m_driver_version{0}; //!< VkPhysicalDeviceProperties::driverVersion of the device.
+        size_t m_loaded_size{0}; //!< See loadedSize().
+        std::string m_reject_reason; //!< See rejectReason().
+    };
+
+} // namespace Engine
@@ -0,0 +1,188 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "present_thread.hpp"
+#include <trace/tracer.hpp>
+
+namespace Engine
+{
+
+    PresentThread::~PresentThread()
+    {
+        stop();
+    }
+
+    void PresentThread::start(const Device& device, Swapchain& swapchain, std::mutex* queue_mutex)
+    {
+        if (running()) {
+            return;
+        }
+        m_device = &device;
+        m_swapchain = &swapchain;
+        m_queue_mutex = queue_mutex;
+        m_requested = 0;
+        m_completed.store(0, std::memory_order_relaxed);
+        m_present_result.store(static_cast<int32_t>(vk::Result::eSuccess), std::memory_order_relaxed);
+        m_stopping.store(false, std::memory_order_relaxed);
+        m_worker = std::thread([this]() {
+            run();
+        });
+    }
+
+    void PresentThread::requestAcquire(vk::Semaphore image_available)
+    {
+        PresentRequest request{};
+        request.type = PresentRequest::Type::Acquire;
+        request.semaphore = image_available;
+        emit(request);
+    }
+
+    AcquiredImage PresentThread::waitAcquired()
+    {
+        AcquiredImage image{};
+        for (;;) {
+            // Read before the ring, so an image arriving in between bumps it past what is waited on.
+            uint32_t seen = m_acquired_count.load(std::memory_order_acquire);
+            if (m_acquired.consume(image)) {
+                return image;
+            }
+            m_acquired_count.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    void PresentThread::requestPresent(uint32_t image_index)
+    {
+        PresentRequest request{};
+        request.type = PresentRequest::Type::Present;
+        request.image_index = image_index;
+        emit(request);
+    }
+
+    void PresentThread::drain()
+    {
+        uint64_t completed = m_completed.load(std::memory_order_acquire);
+        while (completed != m_requested) {
+            m_completed.wait(completed, std::memory_order_acquire);
+            completed = m_completed.load(std::memory_order_acquire);
+        }
+    }
+
+    void PresentThread::stop()
+    {
+        if (!running()) {
+            return;
+        }
+        m_stopping.store(true, std::memory_order_release);
+        m_wake.fetch_add(1, std::memory_order_release);
+        m_wake.notify_one();
+        m_worker.join();
+        // Images acquired but never picked up belong to a swapchain about to be destroyed.
+        AcquiredImage discarded{};
+        while (m_acquired.consume(discarded)) {
+        }
+    }
+
+    void PresentThread::emit(const PresentRequest& request)
+    {
+        // Never full: the renderer waits for each acquire before it requests the next.
+        (void)m_requests.emit(request);
+        ++m_requested;
+        m_wake.fetch_add(1, std::memory_order_release);
+        m_wake.notify_one();
+    }
+
+    void PresentThread::run()
+    {
+        TracingLib::setThreadName("present");
+        for (;;) {
+            uint32_t wake = m_wake.load(std::memory_order_acquire);
+            process();
+            // Every request precedes the stop, so processing after seeing it finds them all.
+            if (m_stopping.load(std::memory_order_acquire)) {
+                process();
+                return;
+            }
+            m_wake.wait(wake, std::memory_order_acquire);
+        }
+    }
+
+    void PresentThread::process()
+    {
+        PresentRequest request{};
+        while (m_requests.consume(request)) {
+            if (request.type == PresentRequest::Type::Acquire) {
+                (void)m_acquired.emit(acquire(request.semaphore));
+                m_acquired_count.fetch_add(1, std::memory_order_release);
+                m_acquired_count.notify_one();
+            } else {
+                present(request.image_index);
+            }
+            m_completed.fetch_add(1, std::memory_order_release);
+            m_completed.notify_one();
+        }
+    }
+
+    AcquiredImage PresentThread::acquire(vk::Semaphore semaphore)
+    {
+        TRACE_ZONE("acquireNextImage");
+        AcquiredImage image{};
+        try {
+            vk::ResultValue<uint32_t> acquired = m_swapchain->get().acquireNextImage(UINT64_MAX, semaphore);
+            image.image_index = acquired.value;
+            image.result = acquired.result;
+        } catch (const vk::SystemError& e) {
+            image.result = static_cast<vk::Result>(e.code().value());
+        }
+        return image;
+    }
+
+    void PresentThread::present(uint32_t image_index)
+    {
+        TRACE_ZONE("presentKHR");
+        vk::SwapchainKHR swapchain_handle = *m_swapchain->get();
+        vk::Semaphore render_finished = *m_swapchain->renderFinished(image_index);
+        vk::PresentInfoKHR present_info{};
+        present_info.setWaitSemaphores(render_finished);
+        present_info.setSwapchains(swapchain_handle);
+        present_info.setImageIndices(image_index);
+
+        vk::Result result = vk::Result::eSuccess;
+        try {
+            // Present fences (swapchain maintenance), as on the render thread's own presents.
+            vk::Fence present_fence = m_swapchain->presentFence(image_index);
+            vk::SwapchainPresentFenceInfoEXT present_fence_info{};
+            if (present_fence) {
+                present_fence_info.setFences(present_fence);
+                present_info.setPNext(&present_fence_info);
+            }
+
+            std::unique_lock<std::mutex> queue_lock;
+            if (m_queue_mutex != nullptr) {
+                queue_lock = std::unique_lock<std::mutex>(*m_queue_mutex);
+            }
+            result = m_device->presentQueue().presentKHR(present_info);
+        } catch (const vk::SystemError& e) {
+            result = static_cast<vk::Result>(e.code().value());
+        }
+
+        // An error replaces whatever is pending; suboptimal only replaces success.
+        if (static_cast<int32_t>(result) < 0) {
+            m_present_result.store(static_cast<int32_t>(result), std::memory_order_relaxed);
+        } else if (result == vk::Result::eSuboptimalKHR) {
+            int32_t expected = static_cast<int32_t>(vk::Result::eSuccess);
+            (void)m_present_result.compare_exchange_strong(expected, static_cast<int32_t>(result), std::memory_order_relaxed);
+        }
+    }
+
+} // namespace Engine
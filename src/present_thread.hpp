@@ -0,0 +1,137 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#pragma once
+
+#include "device.hpp"
+#include "swapchain.hpp"
+#include <signal/ring_signal.hpp>
+#include <vulkan/vulkan_raii.hpp>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace Engine
+{
+
+    //! What the present thread's vkAcquireNextImageKHR returned.
+    struct AcquiredImage {
+        uint32_t image_index{0}; //!< The acquired image (when result is eSuccess or eSuboptimalKHR).
+        vk::Result result{vk::Result::eSuccess}; //!< Its result (an error where the call threw).
+    };
+
+    //! One request of the render thread to the PresentThread.
+    struct PresentRequest {
+        //! Which call to make.
+        enum class Type : uint8_t {
+            Acquire, //!< vkAcquireNextImageKHR signalling semaphore.
+            Present //!< vkQueuePresentKHR of image_index.
+        };
+
+        Type type{Type::Present}; //!< Discriminator.
+        uint32_t image_index{0}; //!< Type::Present: image to present.
+        vk::Semaphore semaphore{nullptr}; //!< Type::Acquire: semaphore the acquire signals.
+    };
+
+    /*!
+        Acquires and presents swapchain images on a thread of its own, so the render thread
+        records and submits without blocking on the display: under FIFO both
+        vkAcquireNextImageKHR (no image free) and vkQueuePresentKHR (queue full) can wait for a
+        vblank. The render thread asks for an image with requestAcquire() and picks it up with
+        waitAcquired(), and hands each submitted frame over with requestPresent(); the requests
+        and the acquired images travel through lock-free rings and are carried out in order.
+
+        The swapchain is touched by the present thread alone while it runs: the render thread
+        drain()s it before recreating or destroying the swapchain. Present errors are not thrown
+        but collected for takePresentResult().
+    */
+    class PresentThread {
+    public:
+        //! Most requests queued at once (the renderer has a present and an acquire outstanding at most).
+        static constexpr uint32_t QUEUE_CAPACITY = 4;
+
+        PresentThread() = default;
+        ~PresentThread();
+
+        PresentThread(const PresentThread&) = delete;
+        PresentThread& operator=(const PresentThread&) = delete;
+        PresentThread(PresentThread&&) = delete;
+        PresentThread& operator=(PresentThread&&) = delete;
+
+        //! Starts the thread, presenting swapchain (both must outlive stop()) on the device's
+        //! present queue. queue_mutex, when not null, is held around each present: pass it where
+        //! the present queue is one the caller submits to, and hold it around those submits.
+        void start(const Device& device, Swapchain& swapchain, std::mutex* queue_mutex);
+
+        //! True between start() and stop().
+        [[nodiscard]] bool running() const
+        {
+            return m_worker.joinable();
+        }
+
+        //! Render thread: acquires the next image, signalling image_available once it can be drawn to.
+        void requestAcquire(vk::Semaphore image_available);
+
+        //! Render thread: waits for the oldest requestAcquire() not yet picked up.
+        [[nodiscard]] AcquiredImage waitAcquired();
+
+        //! Render thread: presents image_index once its render-finished semaphore has signalled.
+        void requestPresent(uint32_t image_index);
+
+        //! Render thread: waits until every request so far has been carried out, leaving the
+        //! swapchain to the caller until the next request (e.g. to recreate it).
+        void drain();
+
+        //! Render thread: the worst result of the presents since the last call — eSuccess, then
+        //! eSuboptimalKHR, then an error (eErrorOutOfDateKHR: the swapchain wants recreating).
+        [[nodiscard]] vk::Result takePresentResult()
+        {
+            return static_cast<vk::Result>(m_present_result.exchange(static_cast<int32_t>(vk::Result::eSuccess), std::memory_order_relaxed));
+        }
+
+        //! Carries out the queued requests and joins the thread. Safe to call repeatedly.
+        void stop();
+
+    private:
+        //! Hands request to the thread.
+        void emit(const PresentRequest& request);
+
+        //! Worker: carries out requests until stop().
+        void run();
+
+        //! Worker: carries out every request queued so far.
+        void process();
+
+        //! Worker: acquires the next image, signalling semaphore.
+        [[nodiscard]] AcquiredImage acquire(vk::Semaphore semaphore);
+
+        //! Worker: presents image_index, folding the result into m_present_result.
+        void present(uint32_t image_index);
+
+        const Device* m_device{nullptr}; //!< Device whose present queue is used (non-owning).
+        Swapchain* m_swapchain{nullptr}; //!< Swapchain acquired from and presented to (non-owning).
+        std::mutex* m_queue_mutex{nullptr}; //!< Held around presents (null: the queue is the thread's alone).
+        SignalsLib::SpscSignal<PresentRequest, QUEUE_CAPACITY> m_requests; //!< Render thread → worker, oldest first.
+        SignalsLib::SpscSignal<AcquiredImage, QUEUE_CAPACITY> m_acquired; //!< Worker → render thread, oldest first.
+        std::atomic<uint32_t> m_wake{0}; //!< Bumped and notified on each request and by stop().
+        std::atomic<uint32_t> m_acquired_count{0}; //!< Bumped and notified on each acquired image.
+        uint64_t m_requested{0}; //!< Render thread: requests emitted.
+        std::atomic<uint64_t> m_completed{0}; //!< Requests carried out (notified on each).
+        std::atomic<int32_t> m_present_result{0}; //!< See takePresentResult() (a VkResult).
+        std::atomic<bool> m_stopping{false}; //!< stop() has been called.
+        std::thread m_worker; //!< Runs run().
+    };
+
+} // namespace Engine
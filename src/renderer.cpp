@@ -14,29 +14,62 @@
 
 #include "renderer.hpp"
 #include "surface.hpp"
+#include <trace/tracer.hpp>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <vector>
 
 namespace Engine
 {
 
     //! Background clear colour (a dark blue). The final toy background may become black.
     static constexpr std::array<float, 4> CLEAR_COLOUR{0.05f, 0.05f, 0.15f, 1.0f};
+    //! Colour of the strings (cyan; linear, like CLEAR_COLOUR).
+    static constexpr std::array<float, 3> STRING_COLOUR{0.0f, 0.9f, 1.0f};
 
-    //! Total rest length of the string in normalised device coordinates.
+    //! Total rest length of the longest string in normalised device coordinates.
     static constexpr float STRING_LENGTH_NDC = 1.6f;
-    //! Rest distance between adjacent nodes.
-    static constexpr float SEGMENT_LENGTH = STRING_LENGTH_NDC / static_cast<float>(Renderer::NODE_COUNT - 1);
+    //! Shortest string relative to the longest; lengths vary across the batch so strands part.
+    static constexpr float MIN_LENGTH_FRACTION = 0.75f;
+    //! Horizontal distance between neighbouring anchors (NDC), narrowed so a batch spans at most
+    //! ANCHOR_SPAN_NDC.
+    static constexpr float ANCHOR_SPACING_NDC = 0.05f;
+    //! Widest spread of the anchors around the cursor (NDC).
+    static constexpr float ANCHOR_SPAN_NDC = 1.0f;
     //! Downward acceleration (NDC / s^2; +Y is down in Vulkan clip space).
     static constexpr float GRAVITY = 4.0f;
-    //! Constraint relaxation iterations per frame.
-    static constexpr uint32_t CONSTRAINT_ITERATIONS = 24;
-    //! Velocity damping per step so the string loses energy and settles to rest within the
-    //! render-on-demand settle window (lower = settles faster, still swings on a yank).
+    //! Velocity damping per 1/60 s so the string loses energy and settles to rest, letting the
+    //! render-on-demand loop go idle (lower = settles faster, still swings on a yank). Scaled to
+    //! Renderer::FIXED_TIMESTEP when the string parameters are built.
     static constexpr float DAMPING = 0.98f;
-    //! Clamp on dt so a stall (breakpoint, resize) cannot blow up the integration.
-    static constexpr float MAX_DELTA = 0.05f;
+    //! Alignment of each staged upload in the upload arena (every uploaded buffer holds 4-byte
+    //! words and vec4s).
+    static constexpr VkDeviceSize UPLOAD_ALIGNMENT = 16;
+
+    //! Name of a present mode for the start-up log.
+    [[nodiscard]] static const char* presentModeName(vk::PresentModeKHR mode)
+    {
+        switch (mode) {
+        case vk::PresentModeKHR::eMailbox:
+            return "mailbox";
+        case vk::PresentModeKHR::eImmediate:
+            return "immediate";
+        case vk::PresentModeKHR::eFifoRelaxed:
+            return "FIFO relaxed";
+        default:
+            return "FIFO";
+        }
+    }
 
     //! Maps a cursor in window client pixels to NDC (Vulkan: +Y down, matching screen pixels).
     [[nodiscard]] static MathLib::Vec2 cursorToNdc(uint32_t width, uint32_t height, int32_t cursor_x, int32_t cursor_y)
@@ -46,65 +79,385 @@ namespace Engine
         return MathLib::Vec2{x, y};
     }
 
-    //! Initial node layout: a straight string hanging down from the screen centre.
-    [[nodiscard]] static std::array<MathLib::Vec2, Renderer::NODE_COUNT> initialPositions()
+    //! Packs an NDC position into the 64-bit word the cursor trail stores: x in the low word, at
+    //! the lower address on the little-endian targets we support, so the shader reads a float2.
+    [[nodiscard]] static uint64_t packNdc(MathLib::Vec2 ndc)
     {
-        std::array<MathLib::Vec2, Renderer::NODE_COUNT> nodes{};
-        MathLib::Vec2 head{0.0f, -0.4f};
-        for (uint32_t i = 0; i < Renderer::NODE_COUNT; ++i) {
-            nodes[i] = head + MathLib::Vec2{0.0f, static_cast<float>(i) * SEGMENT_LENGTH};
+        return (static_cast<uint64_t>(std::bit_cast<uint32_t>(ndc.y)) << 32) | std::bit_cast<uint32_t>(ndc.x);
+    }
+
+    std::vector<StringParams> Renderer::initialStringParams(uint32_t string_count, uint32_t node_count)
+    {
+        float spacing = ANCHOR_SPACING_NDC;
+        if ((string_count > 1) && ((spacing * static_cast<float>(string_count - 1)) > ANCHOR_SPAN_NDC)) {
+            spacing = ANCHOR_SPAN_NDC / static_cast<float>(string_count - 1);
+        }
+
+        std::vector<StringParams> strings(string_count);
+        for (uint32_t s = 0; s < string_count; ++s) {
+            float sequence = static_cast<float>(s) * 0.618034f;
+            float fraction = sequence - std::floor(sequence); // 0 for the first string (full length)
+            float length = STRING_LENGTH_NDC * (1.0f - (1.0f - MIN_LENGTH_FRACTION) * fraction);
+            strings[s].anchor_x = (static_cast<float>(s) - static_cast<float>(string_count - 1) * 0.5f) * spacing;
+            strings[s].anchor_y = 0.0f;
+            strings[s].segment_length = length / static_cast<float>(node_count - 1);
+            strings[s].gravity = GRAVITY;
+            strings[s].damping = std::pow(DAMPING, FIXED_TIMESTEP * 60.0f);
+            strings[s].padding = 0.0f;
+        }
+        return strings;
+    }
+
+    std::vector<MathLib::Vec2> Renderer::initialPositions(const std::vector<StringParams>& strings, uint32_t node_count)
+    {
+        std::vector<MathLib::Vec2> nodes(strings.size() * node_count);
+        for (size_t s = 0; s < strings.size(); ++s) {
+            MathLib::Vec2 head{strings[s].anchor_x, -0.4f + strings[s].anchor_y};
+            for (uint32_t i = 0; i < node_count; ++i) {
+                nodes[s * node_count + i] = head + MathLib::Vec2{0.0f, static_cast<float>(i) * strings[s].segment_length};
+            }
         }
         return nodes;
     }
 
+    //! Workgroups needed to cover thread_count threads of the physics shaders.
+    [[nodiscard]] static uint32_t physicsGroupCount(uint32_t thread_count)
+    {
+        return (thread_count + PHYSICS_WORKGROUP_SIZE - 1) / PHYSICS_WORKGROUP_SIZE;
+    }
+
+    //! Words of a ribbon draws buffer for string_count strings: the draw count (padded to
+    //! RIBBON_DRAW_COMMANDS_WORD), a vk::DrawIndirectCommand and a visibility flag per string.
+    [[nodiscard]] static uint32_t ribbonDrawsWords(uint32_t string_count)
+    {
+        return RIBBON_DRAW_COMMANDS_WORD + (static_cast<uint32_t>(sizeof(vk::DrawIndirectCommand) / sizeof(uint32_t)) + 1) * string_count;
+    }
+
+    //! Ribbon vertices of one string of node_count nodes drawn with subdivisions spline pieces per
+    //! segment: a pair per node and per inner spline point.
+    [[nodiscard]] static uint32_t ribbonStringVertices(uint32_t node_count, uint32_t subdivisions)
+    {
+        return RIBBON_VERTICES_PER_NODE * ((node_count - 1) * subdivisions + 1);
+    }
+
+    //! Cells of the tiled solver's hash grid for total_nodes nodes: the power of two at or above
+    //! the node count (so about one node per cell), at least one scan block.
+    [[nodiscard]] static uint32_t gridCellCount(uint32_t total_nodes)
+    {
+        return std::clamp(std::bit_ceil(total_nodes), PHYSICS_GRID_SCAN_BLOCK, Renderer::MAX_GRID_CELLS);
+    }
+
+    //! Adds dt (clamped to Renderer::MAX_FRAME_DELTA) to accumulator and takes out the whole fixed
+    //! substeps it now holds, at most PHYSICS_MAX_SUBSTEPS; the remainder carries over.
+    [[nodiscard]] static uint32_t takeSubsteps(float& accumulator, float dt)
+    {
+        accumulator += (dt > Renderer::MAX_FRAME_DELTA) ? Renderer::MAX_FRAME_DELTA : dt;
+        uint32_t substeps = static_cast<uint32_t>(accumulator / Renderer::FIXED_TIMESTEP);
+        if (substeps > PHYSICS_MAX_SUBSTEPS) {
+            substeps = PHYSICS_MAX_SUBSTEPS;
+        }
+        accumulator -= static_cast<float>(substeps) * Renderer::FIXED_TIMESTEP;
+        return substeps;
+    }
+
+    //! Creates a timeline semaphore at value 0. May throw vk::SystemError.
+    [[nodiscard]] static vk::raii::Semaphore createTimeline(const vk::raii::Device& device)
+    {
+        vk::SemaphoreTypeCreateInfo timeline_type{};
+        timeline_type.semaphoreType = vk::SemaphoreType::eTimeline;
+        timeline_type.initialValue = 0;
+        vk::SemaphoreCreateInfo timeline_info{};
+        timeline_info.setPNext(&timeline_type);
+        return vk::raii::Semaphore(device, timeline_info);
+    }
+
+    //! Orders one tiled physics dispatch after the previous one (compute write -> compute read/write).
+    static void computeToComputeBarrier(const vk::raii::CommandBuffer& cmd)
+    {
+        vk::MemoryBarrier2 barrier{};
+        barrier.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader;
+        barrier.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite;
+        barrier.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader;
+        barrier.dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite;
+        vk::DependencyInfo dependency{};
+        dependency.setMemoryBarriers(barrier);
+        cmd.pipelineBarrier2(dependency);
+    }
+
     Renderer::~Renderer()
     {
         destroy();
     }
 
-    bool Renderer::init(LoggingLib::Logger& logger, const NativeWindowHandle& window_handle, uint32_t width, uint32_t height, std::string& out_error_message)
+    bool Renderer::init(LoggingLib::Logger& logger, const NativeWindowHandle& window_handle, uint32_t width, uint32_t height, const RendererConfig& config,
+        std::string& out_error_message)
     {
+        TRACE_ZONE("Renderer::init");
         if (m_initialised) {
             out_error_message = "Renderer already initialised.";
             return false;
         }
+        if ((config.node_count < MIN_NODE_COUNT) || (config.node_count > MAX_NODE_COUNT)) {
+            out_error_message = "Node count " + std::to_string(config.node_count) + " is outside the supported range [" + std::to_string(MIN_NODE_COUNT) + ", "
+                + std::to_string(MAX_NODE_COUNT) + "].";
+            return false;
+        }
+        if ((config.string_count < 1) || (config.string_count > MAX_STRING_COUNT)) {
+            out_error_message = "String count " + std::to_string(config.string_count) + " is outside the supported range [1, " + std::to_string(MAX_STRING_COUNT) + "].";
+            return false;
+        }
+        if ((static_cast<uint64_t>(config.node_count) * config.string_count) > MAX_TOTAL_NODES) {
+            out_error_message = "Batch of " + std::to_string(config.string_count) + " strings x " + std::to_string(config.node_count) + " nodes exceeds "
+                + std::to_string(MAX_TOTAL_NODES) + " nodes in total.";
+            return false;
+        }
+        if ((config.frames_in_flight < 1) || (config.frames_in_flight > MAX_FRAMES_IN_FLIGHT)) {
+            out_error_message = "Frames in flight " + std::to_string(config.frames_in_flight) + " is outside the supported range [1, " + std::to_string(MAX_FRAMES_IN_FLIGHT)
+                + "].";
+            return false;
+        }
+        if ((config.constraint_iterations < 1) || (config.constraint_iterations > MAX_CONSTRAINT_ITERATIONS)) {
+            out_error_message = "Constraint iterations " + std::to_string(config.constraint_iterations) + " is outside the supported range [1, "
+                + std::to_string(MAX_CONSTRAINT_ITERATIONS) + "].";
+            return false;
+        }
+        if ((config.render_scale != RENDER_SCALE_AUTO) && ((config.render_scale < MIN_RENDER_SCALE) || (config.render_scale > 1.0f))) {
+            out_error_message = "Render scale " + std::to_string(config.render_scale) + " is outside the supported range [" + std::to_string(MIN_RENDER_SCALE) + ", 1].";
+            return false;
+        }
+        if (config.ribbon_subdivisions > RIBBON_MAX_SUBDIVISIONS) {
+            out_error_message = "Ribbon subdivisions " + std::to_string(config.ribbon_subdivisions) + " exceed the supported " + std::to_string(RIBBON_MAX_SUBDIVISIONS)
+                + ".";
+            return false;
+        }
+        if (config.obstacles.size() > PHYSICS_MAX_OBSTACLES) {
+            out_error_message = std::to_string(config.obstacles.size()) + " obstacles exceed the supported " + std::to_string(PHYSICS_MAX_OBSTACLES) + ".";
+            return false;
+        }
+        for (const Obstacle& obstacle : config.obstacles) {
+            if (!(obstacle.extent_x > 0.0f) || ((obstacle.shape == ObstacleShape::Rectangle) && !(obstacle.extent_y > 0.0f))) {
+                out_error_message = "Obstacles need a positive radius or positive half extents.";
+                return false;
+            }
+        }
+        if (!(config.collision_radius > 0.0f) || (config.collision_radius > MAX_COLLISION_RADIUS)) {
+            out_error_message = "Collision radius " + std::to_string(config.collision_radius) + " is outside the supported range (0, " + std::to_string(MAX_COLLISION_RADIUS)
+                + "].";
+            return false;
+        }
+        if (!(config.gpu_budget_ms > 0.0f)) {
+            out_error_message = "GPU budget " + std::to_string(config.gpu_budget_ms) + " ms must be positive.";
+            return false;
+        }
+        if (config.physics_thread && !((config.physics_rate_hz >= MIN_PHYSICS_RATE) && (config.physics_rate_hz <= MAX_PHYSICS_RATE))) {
+            out_error_message = "Physics rate " + std::to_string(config.physics_rate_hz) + " Hz is outside the supported range [" + std::to_string(MIN_PHYSICS_RATE) + ", "
+                + std::to_string(MAX_PHYSICS_RATE) + "].";
+            return false;
+        }
+        if (config.headless && ((width == 0) || (height == 0))) {
+            out_error_message = "A headless renderer needs a non-zero size.";
+            return false;
+        }
         m_logger = &logger;
+        m_node_count = config.node_count;
+        m_string_count = config.string_count;
+        m_frames_in_flight = config.frames_in_flight;
+        m_constraint_iterations = config.constraint_iterations;
+        m_collision = (config.collide_edges ? PHYSICS_COLLIDE_EDGES : 0) | (config.self_collision ? PHYSICS_COLLIDE_SELF : 0);
+        m_obstacle_list = config.obstacles;
+        m_collision_radius = config.collision_radius;
+        // The subdivided ribbon of the batch stays within the vertex pairs of the largest plain one.
+        m_max_ribbon_subdivisions = std::clamp(MAX_TOTAL_NODES / (m_node_count * m_string_count), 1u, RIBBON_MAX_SUBDIVISIONS);
+        m_ribbon_subdivisions = config.ribbon_subdivisions;
+        if (m_ribbon_subdivisions > m_max_ribbon_subdivisions) {
+            LOG_INFO(logger, "Ribbon subdivisions capped at {} for this batch.", m_max_ribbon_subdivisions);
+            m_ribbon_subdivisions = m_max_ribbon_subdivisions;
+        }
+        m_headless = config.headless;
+        m_physics_threaded = config.physics_thread && !m_headless;
+        m_physics_rate_hz = config.physics_rate_hz;
+        m_physics_settle_speed = config.physics_settle_speed;
+        m_tick_accumulator = 0.0f;
+        m_tick_value = 0;
+        // A capture copies out only the frames it has a free slot for, which a reused command
+        // buffer cannot know; pre-recorded frames simulate, which the physics thread does instead.
+        m_prerecorded = config.prerecorded && config.capture_path.empty() && !m_physics_threaded;
+        if (config.prerecorded && !m_prerecorded) {
+            LOG_INFO(logger, m_physics_threaded ? "The physics thread simulates apart from the frames; not pre-recording."
+                                                : "Frame capture records every frame live; not pre-recording.");
+        }
+        m_partial_redraw = config.partial_redraw;
+        m_scaled = false;
+        m_auto_render_scale = false;
+        m_render_scale = 1.0f;
+        m_gpu_budget_ms = config.gpu_budget_ms;
+        m_render_scale_frame = 0;
+        m_profile_log_interval = config.profile_log_interval;
+        m_stats_log_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(config.stats_log_interval_s));
+        m_stats_logged_at = std::chrono::steady_clock::now();
+        m_stats_logged = m_stats.snapshot();
+        m_latency = config.latency;
+        m_present_id = 0;
+        m_latency_present_id = 0;
+        m_present_latency_ms = 0.0f;
+        // The physics thread needs a slot besides the newest and the one it writes (see the ring comment in the header).
+        m_state_slot_count = std::max(m_frames_in_flight, m_physics_threaded ? 3u : 2u);
+        m_current_frame = 0;
+        m_accumulator = 0.0f;
+        m_cursor_newest = 0;
+        m_capture_pending.assign(m_frames_in_flight, NO_CAPTURE_SLOT);
+        m_capture_extent = vk::Extent2D{};
+        m_solver = (m_node_count <= PHYSICS_WORKGROUP_SIZE) ? PhysicsSolver::Workgroup : PhysicsSolver::Tiled;
+        m_grid_cells = ((m_solver == PhysicsSolver::Tiled) && config.self_collision) ? gridCellCount(m_node_count * m_string_count) : 0;
+        std::chrono::steady_clock::time_point init_start = std::chrono::steady_clock::now();
 
         try {
-            if (!m_instance.init(logger, out_error_message)) {
+            if (!m_instance.init(logger, m_headless, out_error_message)) {
                 destroy();
                 return false;
             }
-            logger.logInfo("Vulkan instance created.");
+            LOG_INFO(logger, m_headless ? "Vulkan instance created (headless)." : "Vulkan instance created.");
 
-            if (!createSurface(m_instance.get(), window_handle, m_surface, out_error_message)) {
+            // Headless: m_surface stays null, which also tells the device not to require present.
+            if (!m_headless && !createSurface(m_instance.get(), window_handle, m_surface, out_error_message)) {
                 destroy();
                 return false;
             }
 
-            if (!m_device.init(m_instance, m_surface, out_error_message)) {
+            // Scores are only a hint: a missing or unreadable file selects by device type.
+            GpuScores gpu_scores{};
+            std::string scores_directory = userCacheDirectory();
+            std::string scores_error;
+            if (!scores_directory.empty() && !gpu_scores.load(scores_directory + GPU_SCORES_FILE_NAME, scores_error)) {
+                LOG_WARNING(logger, scores_error + " Selecting the GPU by type.");
+            }
+            if (!m_device.init(m_instance, m_surface, config.gpu, gpu_scores, out_error_message)) {
                 destroy();
                 return false;
             }
-            logger.logInfo("Selected GPU \"" + m_device.name() + "\" for rendering.");
+            LOG_INFO(logger, "Selected GPU \"" + m_device.name() + "\" for rendering (" + m_device.selectionReason() + ").");
 
-            if (!m_allocator.init(m_instance.handle(), *m_device.physicalDevice(), *m_device.get(), logger, out_error_message)) {
+            m_async_compute = (config.async_compute || m_physics_threaded) && m_device.hasAsyncCompute();
+            if (config.async_compute && !m_async_compute) {
+                LOG_INFO(logger, "No compute-only queue family; physics stays on the graphics queue.");
+            }
+
+            if (!m_allocator.init(m_instance.handle(), *m_device.physicalDevice(), *m_device.get(), m_device.supportsMemoryBudget(), logger, out_error_message)) {
                 destroy();
                 return false;
             }
 
-            if (!m_swapchain.init(m_device, *m_surface, width, height, out_error_message)) {
+            std::string cache_directory = config.pipeline_cache ? userCacheDirectory() : std::string();
+            if (!m_pipeline_cache.init(m_device, cache_directory.empty() ? std::string() : (cache_directory + PIPELINE_CACHE_FILE_NAME), out_error_message)) {
                 destroy();
                 return false;
             }
-            logger.logInfo("Swapchain created: " + std::to_string(m_swapchain.extent().width) + "x" + std::to_string(m_swapchain.extent().height) + ".");
+            if (!m_pipeline_cache.rejectReason().empty()) {
+                LOG_INFO(logger, "Pipeline cache file ignored (" + m_pipeline_cache.rejectReason() + "); starting cold.");
+            }
 
-            if (!m_pipeline.init(m_device, m_swapchain.format(), out_error_message)) {
+            // The pipelines need only the device, the cache and the colour format, so they are built
+            // on worker threads while this one creates the swapchain (the driver compiles shaders in
+            // vkCreate*Pipelines, the slowest part of init on a cold cache). The pipeline cache is
+            // internally synchronised. std::async futures join on destruction, so no exit path
+            // below can reach destroy() with a worker still running.
+            vk::Format colour_format = m_headless ? HEADLESS_FORMAT : Swapchain::preferredFormat(m_device, *m_surface);
+            std::chrono::steady_clock::time_point pipelines_start = std::chrono::steady_clock::now();
+            std::chrono::steady_clock::time_point pipeline_end{};
+            std::chrono::steady_clock::time_point compute_pipeline_end{};
+            std::string pipeline_error;
+            std::string compute_pipeline_error;
+            std::future<bool> pipeline_built = std::async(std::launch::async, [this, colour_format, &pipeline_end, &pipeline_error]() {
+                TracingLib::setThreadName("pipeline build");
+                bool built = m_pipeline.init(m_device, colour_format, m_pipeline_cache.get(), pipeline_error);
+                pipeline_end = std::chrono::steady_clock::now();
+                return built;
+            });
+            PhysicsSpecialisation specialisation{m_node_count, m_constraint_iterations, m_collision, static_cast<uint32_t>(m_obstacle_list.size())};
+            std::future<bool> compute_pipeline_built = std::async(std::launch::async, [this, specialisation, &compute_pipeline_end, &compute_pipeline_error]() {
+                TracingLib::setThreadName("compute pipeline build");
+                bool built = m_compute_pipeline.init(m_device, m_pipeline_cache.get(), specialisation, compute_pipeline_error);
+                compute_pipeline_end = std::chrono::steady_clock::now();
+                return built;
+            });
+
+            // Below full scale the swapchain images are the blit destination of the scaled target;
+            // a capture copies from them.
+            bool want_scaled = !m_headless && (config.render_scale != 1.0f);
+            vk::ImageUsageFlags extra_usage = want_scaled ? vk::ImageUsageFlags(vk::ImageUsageFlagBits::eTransferDst) : vk::ImageUsageFlags{};
+            if (!config.capture_path.empty()) {
+                extra_usage |= vk::ImageUsageFlagBits::eTransferSrc;
+            }
+            bool target_created = m_headless ? createOffscreenTarget(width, height, out_error_message)
+                                             : m_swapchain.init(m_device, *m_surface, width, height, m_latency, extra_usage, out_error_message);
+            bool pipeline_ok = pipeline_built.get();
+            bool compute_pipeline_ok = compute_pipeline_built.get();
+            if (!target_created || !pipeline_ok || !compute_pipeline_ok) {
+                if (target_created) {
+                    out_error_message = pipeline_ok ? compute_pipeline_error : pipeline_error;
+                }
                 destroy();
                 return false;
             }
 
-            if (!m_compute_pipeline.init(m_device, out_error_message)) {
+            if (m_headless) {
+                LOG_INFO(logger, "Offscreen target created: {}x{}.", width, height);
+            } else {
+                m_present_wait = !config.present_thread && m_device.supportsPresentWait();
+                if ((m_latency == PresentLatency::Paced) && !m_present_wait) {
+                    LOG_INFO(logger, config.present_thread ? "Frames are not paced with the present thread." : "No present wait support; frames are not paced.");
+                }
+                LOG_INFO(logger, "Swapchain created: " + std::to_string(m_swapchain.extent().width) + "x" + std::to_string(m_swapchain.extent().height) + ", "
+                    + presentModeName(m_swapchain.presentMode()) + " present" + (m_present_wait ? ", present wait" : "")
+                    + (m_device.supportsSwapchainMaintenance() ? ", present fences." : "."));
+            }
+
+            // Render scale: the blit needs a transfer-destination swapchain and a format that can be
+            // blitted from and to with linear filtering (optimal tiling); the automatic scale also
+            // needs the GPU frame time and live-recorded frames (pre-recorded ones bake the extent).
+            if (want_scaled) {
+                vk::FormatFeatureFlags needed = vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst | vk::FormatFeatureFlagBits::eSampledImageFilterLinear;
+                vk::FormatFeatureFlags features = m_device.physicalDevice().getFormatProperties(colour_format).optimalTilingFeatures;
+                bool auto_scale = (config.render_scale == RENDER_SCALE_AUTO);
+                m_scaled = (m_swapchain.usage() & vk::ImageUsageFlagBits::eTransferDst) && ((features & needed) == needed);
+                if (!m_scaled) {
+                    LOG_INFO(logger, "The swapchain cannot be blitted to; drawing at full resolution.");
+                } else if (auto_scale && (m_prerecorded || !m_device.supportsTimestamps(m_async_compute))) {
+                    LOG_INFO(logger, m_prerecorded ? "The automatic render scale needs live-recorded frames; drawing at full resolution."
+                                                   : "The automatic render scale needs GPU timestamps; drawing at full resolution.");
+                    m_scaled = false;
+                }
+                if (m_scaled) {
+                    m_auto_render_scale = auto_scale;
+                    m_render_scale = auto_scale ? 1.0f : config.render_scale;
+                    ensureScaledTarget();
+                    std::ostringstream scale_line;
+                    scale_line.setf(std::ios::fixed);
+                    scale_line.precision(2);
+                    scale_line << "Drawing at render scale " << m_render_scale;
+                    if (m_auto_render_scale) {
+                        scale_line.precision(1);
+                        scale_line << " (automatic, GPU budget " << m_gpu_budget_ms << " ms)";
+                    }
+                    scale_line << ", blitted to the swapchain.";
+                    LOG_INFO(logger, scale_line.str());
+                }
+            }
+
+            std::ostringstream pipelines_line;
+            pipelines_line.setf(std::ios::fixed);
+            pipelines_line.precision(1);
+            pipelines_line << "Pipelines created in " << std::chrono::duration<float, std::milli>(std::max(pipeline_end, compute_pipeline_end) - pipelines_start).count()
+                           << " ms alongside the " << (m_headless ? "offscreen target" : "swapchain") << " (";
+            if (m_pipeline_cache.loadedSize() > 0) {
+                pipelines_line << "warm cache, " << m_pipeline_cache.loadedSize() << " bytes).";
+            } else {
+                pipelines_line << "cold cache).";
+            }
+            LOG_INFO(logger, pipelines_line.str());
+
+            // Frame resources first: the physics buffers are seeded through the command pool.
+            if (!createFrameResources(out_error_message)) {
                 destroy();
                 return false;
             }
@@ -114,11 +467,55 @@ namespace Engine
                 return false;
             }
 
-            if (!createFrameResources(out_error_message)) {
+            if (m_physics_threaded && !createPhysicsThreadResources(out_error_message)) {
                 destroy();
                 return false;
             }
-            logger.logInfo("String physics ready (" + std::to_string(NODE_COUNT) + " GPU-simulated nodes).");
+
+            if (!config.capture_path.empty() && !createCapture(config, out_error_message)) {
+                destroy();
+                return false;
+            }
+            // The heads hang from the centre until the first latchCursor(): every sample of the trail
+            // starts there, so a lookup older than the newest sample finds it too.
+            MathLib::Vec2 centre = cursorToNdc(width, height, static_cast<int32_t>(width / 2), static_cast<int32_t>(height / 2));
+            CursorTrail trail{};
+            trail.samples.fill(CursorSample{packNdc(centre), static_cast<uint32_t>(nowMicroseconds()), 0});
+            m_allocator.writeMapped(m_cursor_trail, &trail, sizeof(CursorTrail));
+            LOG_INFO(logger, "String physics ready (" + std::to_string(m_string_count) + " string(s) x " + std::to_string(m_node_count) + " GPU-simulated nodes, "
+                + ((m_solver == PhysicsSolver::Workgroup) ? (m_compute_pipeline.usesSubgroups() ? "workgroup-per-string subgroup-shuffle" : "workgroup-per-string shared-memory")
+                                                          : "tiled")
+                + " solver, " + (m_physics_threaded ? "physics thread, " : "")
+                + (m_async_compute ? ("async compute on queue family " + std::to_string(m_device.queueFamilies().compute)) : std::string("graphics queue")) + ").");
+
+            if (m_prerecorded) {
+                recordPrerecorded();
+                LOG_INFO(logger, "Recorded {} reusable frame command buffers.", m_prerecorded_commands.size());
+            }
+
+            // Started last: the uploads above submit to the graphics queue without the queue mutex.
+            if (!m_headless && config.present_thread) {
+                m_present_queue_shared = (*m_device.presentQueue() == *m_device.graphicsQueue())
+                    || (m_async_compute && (*m_device.presentQueue() == *m_device.computeQueue()));
+                m_present_thread.start(m_device, m_swapchain, m_present_queue_shared ? &m_queue_mutex : nullptr);
+                LOG_INFO(logger, m_present_queue_shared ? "Acquiring and presenting on the present thread (queue shared with the render thread)."
+                                                        : "Acquiring and presenting on the present thread (queue of its own).");
+            }
+            if (m_physics_threaded) {
+                m_physics_queue_shared = !m_async_compute || (m_present_thread.running() && (*m_device.presentQueue() == *m_device.computeQueue()));
+                m_physics_thread.start(
+                    m_physics_rate_hz,
+                    [](float dt, void* user_data) {
+                        return static_cast<Renderer*>(user_data)->physicsTick(dt);
+                    },
+                    this);
+                std::ostringstream physics_line;
+                physics_line.setf(std::ios::fixed);
+                physics_line.precision(1);
+                physics_line << "Simulating on the physics thread at " << m_physics_rate_hz << " Hz (" << (m_async_compute ? "compute" : "graphics") << " queue"
+                             << (m_physics_queue_shared ? ", shared)." : ").");
+                LOG_INFO(logger, physics_line.str());
+            }
         } catch (const vk::SystemError& e) {
             out_error_message = std::string("Vulkan error during renderer initialisation: ") + e.what();
             destroy();
@@ -129,66 +526,215 @@ namespace Engine
             return false;
         }
 
+        std::ostringstream init_line;
+        init_line.setf(std::ios::fixed);
+        init_line.precision(1);
+        init_line << "Renderer initialised in " << std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - init_start).count() << " ms.";
+        LOG_INFO(logger, init_line.str());
+        LOG_INFO(logger, m_allocator.memoryBudget().summary());
         m_initialised = true;
         return true;
     }
 
     bool Renderer::createPhysicsResources(std::string& out_error_message)
     {
+        TRACE_ZONE("Renderer::createPhysicsResources");
         try {
-            VkDeviceSize buffer_size = NODE_COUNT * sizeof(MathLib::Vec2);
-
-            // positions: read/written by compute AND read by the vertex stage.
-            m_positions = m_allocator.createBuffer(buffer_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, VMA_MEMORY_USAGE_AUTO);
-            // prev positions: Verlet history (compute only).
-            m_prev_positions = m_allocator.createBuffer(buffer_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, VMA_MEMORY_USAGE_AUTO);
+            uint32_t total_nodes = m_node_count * m_string_count;
+            VkDeviceSize buffer_size = static_cast<VkDeviceSize>(total_nodes) * sizeof(MathLib::Vec2);
+            VkDeviceSize params_size = static_cast<VkDeviceSize>(m_string_count) * sizeof(StringParams);
+            VkDeviceSize draws_size = static_cast<VkDeviceSize>(ribbonDrawsWords(m_string_count)) * sizeof(uint32_t);
+
+            // Everything lives in device-local memory: the state slots are read-modify-written by
+            // compute every substep (and positions fetched by the vertex stage), the parameters
+            // are read every frame.
+            // State ring: positions (compute + vertex stage) and prev positions (Verlet history,
+            // compute only) per slot.
+            // With async compute every buffer the physics touches is shared concurrently between
+            // the graphics family (seed uploads, vertex fetch) and the compute family.
+            std::vector<uint32_t> sharing;
+            if (m_async_compute) {
+                sharing = {m_device.queueFamilies().graphics, m_device.queueFamilies().compute};
+            }
+            m_positions.clear();
+            m_prev_positions.clear();
+            for (uint32_t slot = 0; slot < m_state_slot_count; ++slot) {
+                m_positions.push_back(m_allocator.createDeviceLocalBuffer(buffer_size,
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, sharing));
+                m_prev_positions.push_back(m_allocator.createDeviceLocalBuffer(buffer_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, sharing));
+            }
+            // Motion reduction: stage-1 partials and the result (device-only, one queue), plus a
+            // host-readable copy of the result per frame in flight (and one for the physics
+            // thread's ticks) in a readback arena. Every frame copies out the same one
+            // MotionStats, so each region is carved once, here.
+            VkDeviceSize partials_size = static_cast<VkDeviceSize>(physicsGroupCount(total_nodes)) * sizeof(MotionStats);
+            m_motion_partials = m_allocator.createBuffer(partials_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE);
+            m_motion = m_allocator.createBuffer(sizeof(MotionStats), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 0,
+                VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE);
+            uint32_t readback_regions = m_frames_in_flight + (m_physics_threaded ? 1u : 0u);
+            if (!m_motion_arena.create(m_allocator, sizeof(MotionStats), readback_regions, VK_BUFFER_USAGE_TRANSFER_DST_BIT, FrameArena::Direction::Readback)) {
+                out_error_message = "No frames in flight to read the motion back for.";
+                return false;
+            }
+            m_motion_readbacks.clear();
+            for (uint32_t region = 0; region < readback_regions; ++region) {
+                m_motion_arena.beginFrame(region);
+                m_motion_readbacks.push_back(m_motion_arena.allocate(sizeof(MotionStats), alignof(MotionStats)));
+            }
+            m_physics_motion_readback = m_physics_threaded ? m_motion_readbacks.back() : ArenaAllocation{};
+            m_motion_readback_frame.assign(m_frames_in_flight, 0);
+            m_last_motion = MotionStats{};
+            m_last_motion_frame = 0;
+            m_frame_serial = 0;
+
+            // string params: read by compute.
+            m_string_params = m_allocator.createDeviceLocalBuffer(params_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, sharing);
+            // frame params: written by the CPU every frame, read by compute (and by dispatchIndirect).
+            m_frame_params.clear();
+            for (uint32_t slot = 0; slot < m_state_slot_count; ++slot) {
+                m_frame_params.push_back(m_allocator.createBuffer(sizeof(FrameParams), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                    VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, VMA_MEMORY_USAGE_AUTO, sharing));
+            }
+            // ribbon: expanded from the drawn slot by every frame, so one per frame in flight (the
+            // graphics queue alone touches it), with the erase quad after the strips.
+            VkDeviceSize ribbon_size = (static_cast<VkDeviceSize>(m_string_count) * ribbonStringVertices(m_node_count, m_max_ribbon_subdivisions) + RIBBON_ERASE_VERTICES)
+                * sizeof(MathLib::Vec2);
+            m_ribbon.clear();
+            for (uint32_t i = 0; i < m_frames_in_flight; ++i) {
+                m_ribbon.push_back(m_allocator.createBuffer(ribbon_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 0,
+                    VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE));
+            }
+            // ribbon draws: the indirect draws (and their count) the culling pass writes for the
+            // frame's ribbon, so one per frame in flight too.
+            m_ribbon_draws.clear();
+            for (uint32_t i = 0; i < m_frames_in_flight; ++i) {
+                m_ribbon_draws.push_back(m_allocator.createDeviceLocalBuffer(draws_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT));
+            }
+            // ribbon bounds: folded and rotated by the ribbon passes of every frame (graphics queue only).
+            m_ribbon_bounds = m_allocator.createDeviceLocalBuffer(RIBBON_BOUNDS_WORDS * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+            resetTargetContents();
+            // cursor trail: appended to by latchCursor() at any time, read by compute as it runs.
+            m_cursor_trail = m_allocator.createCoherentBuffer(sizeof(CursorTrail), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, sharing);
+            m_cursor_trail_data = static_cast<CursorTrail*>(m_cursor_trail.allocationInfo().pMappedData);
+            // obstacles: read by compute (one element at least, as a binding needs a buffer).
+            VkDeviceSize obstacles_size = static_cast<VkDeviceSize>(std::max<size_t>(m_obstacle_list.size(), 1)) * sizeof(Obstacle);
+            m_obstacles = m_allocator.createDeviceLocalBuffer(obstacles_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, sharing);
+            // Hash grid of the tiled self-collision, rebuilt by compute every substep; the cell
+            // counts start at zero (the scan resets them for the next substep). Placeholders when
+            // unused, so the descriptor sets stay complete.
+            VkDeviceSize grid_words = (m_grid_cells > 0) ? (2 * static_cast<VkDeviceSize>(m_grid_cells) + m_grid_cells / PHYSICS_GRID_SCAN_BLOCK) : 1;
+            m_grid = m_allocator.createDeviceLocalBuffer(grid_words * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, sharing);
+            VkDeviceSize grid_nodes = (m_grid_cells > 0) ? total_nodes : 1;
+            m_grid_node_cells = m_allocator.createBuffer(grid_nodes * 2 * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE);
+            m_grid_entries = m_allocator.createBuffer(grid_nodes * sizeof(GridEntry), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE);
+            LOG_INFO(*m_logger, "Physics state ring: " + std::to_string(m_state_slot_count) + " slots in " + m_allocator.describeMemory(m_positions.front()) + ", "
+                + (Allocator::isMapped(m_positions.front()) ? "mapped directly." : "seeded through staging."));
+
+            // Seed the newest slot with the initial layout (prev == pos -> zero initial velocity);
+            // the others are written by compute before anything reads them.
+            std::vector<StringParams> strings = initialStringParams(m_string_count, m_node_count);
+            std::vector<MathLib::Vec2> seed = initialPositions(strings, m_node_count);
+            m_state_slot = m_state_slot_count - 1;
+
+            // No draws and no string flagged visible: the culling pass writes the draws every frame.
+            std::vector<uint32_t> no_draws(ribbonDrawsWords(m_string_count), 0);
+
+            // Every box empty (min above max), the running one included.
+            std::array<uint32_t, RIBBON_BOUNDS_WORDS> empty_bounds{};
+            for (uint32_t box = 0; box < RIBBON_BOUNDS_WORDS; box += 4) {
+                empty_bounds[box] = UINT32_MAX;
+                empty_bounds[box + 1] = UINT32_MAX;
+            }
 
-            // Seed both buffers with the initial layout (prev == pos -> zero initial velocity).
-            std::array<MathLib::Vec2, NODE_COUNT> seed = initialPositions();
-            std::memcpy(m_positions.allocationInfo().pMappedData, seed.data(), static_cast<size_t>(buffer_size));
-            std::memcpy(m_prev_positions.allocationInfo().pMappedData, seed.data(), static_cast<size_t>(buffer_size));
+            std::vector<BufferUpload> uploads{
+                {&m_positions[m_state_slot], seed.data(), buffer_size},
+                {&m_prev_positions[m_state_slot], seed.data(), buffer_size},
+                {&m_string_params, strings.data(), params_size},
+                {&m_ribbon_bounds, empty_bounds.data(), sizeof(empty_bounds)},
+            };
+            for (const AllocatedBuffer& draws : m_ribbon_draws) {
+                uploads.push_back({&draws, no_draws.data(), draws_size});
+            }
+            if (!m_obstacle_list.empty()) {
+                uploads.push_back({&m_obstacles, m_obstacle_list.data(), m_obstacle_list.size() * sizeof(Obstacle)});
+            }
+            std::vector<uint32_t> zero_grid(grid_words, 0);
+            if (m_grid_cells > 0) {
+                uploads.push_back({&m_grid, zero_grid.data(), grid_words * sizeof(uint32_t)});
+            }
+            if (!uploadBuffers(uploads, out_error_message)) {
+                return false;
+            }
 
-            // One descriptor set binding both buffers to the compute shader.
+            // One physics descriptor set per slot: it writes that slot and reads the one before it.
+            // One ribbon set per slot and frame in flight: it reads that slot and writes that
+            // frame's ribbon.
+            uint32_t ribbon_set_count = m_state_slot_count * m_frames_in_flight;
             std::array<vk::DescriptorPoolSize, 1> pool_sizes{};
             pool_sizes[0].type = vk::DescriptorType::eStorageBuffer;
-            pool_sizes[0].descriptorCount = 2;
+            pool_sizes[0].descriptorCount = PHYSICS_BINDING_COUNT * m_state_slot_count + RIBBON_BINDING_COUNT * ribbon_set_count;
 
             vk::DescriptorPoolCreateInfo pool_info{};
             pool_info.flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet;
-            pool_info.maxSets = 1;
+            pool_info.maxSets = m_state_slot_count + ribbon_set_count;
             pool_info.setPoolSizes(pool_sizes);
             m_descriptor_pool = vk::raii::DescriptorPool(m_device.get(), pool_info);
 
+            std::vector<vk::DescriptorSetLayout> set_layouts(m_state_slot_count, *m_compute_pipeline.descriptorSetLayout());
             vk::DescriptorSetAllocateInfo alloc_info{};
             alloc_info.descriptorPool = *m_descriptor_pool;
-            alloc_info.setSetLayouts(*m_compute_pipeline.descriptorSetLayout());
-            std::vector<vk::raii::DescriptorSet> sets = m_device.get().allocateDescriptorSets(alloc_info);
-            m_descriptor_set = std::move(sets.front());
-
-            vk::DescriptorBufferInfo pos_info{};
-            pos_info.buffer = vk::Buffer(m_positions.buffer());
-            pos_info.offset = 0;
-            pos_info.range = VK_WHOLE_SIZE;
-
-            vk::DescriptorBufferInfo prev_info{};
-            prev_info.buffer = vk::Buffer(m_prev_positions.buffer());
-            prev_info.offset = 0;
-            prev_info.range = VK_WHOLE_SIZE;
-
-            std::array<vk::WriteDescriptorSet, 2> writes{};
-            writes[0].dstSet = *m_descriptor_set;
-            writes[0].dstBinding = 0;
-            writes[0].dstArrayElement = 0;
-            writes[0].descriptorType = vk::DescriptorType::eStorageBuffer;
-            writes[0].setBufferInfo(pos_info);
-            writes[1].dstSet = *m_descriptor_set;
-            writes[1].dstBinding = 1;
-            writes[1].dstArrayElement = 0;
-            writes[1].descriptorType = vk::DescriptorType::eStorageBuffer;
-            writes[1].setBufferInfo(prev_info);
-            m_device.get().updateDescriptorSets(writes, {});
+            alloc_info.setSetLayouts(set_layouts);
+            m_descriptor_sets = m_device.get().allocateDescriptorSets(alloc_info);
+
+            for (uint32_t slot = 0; slot < m_state_slot_count; ++slot) {
+                uint32_t source = (slot + m_state_slot_count - 1) % m_state_slot_count;
+
+                // Binding order matches physics.slang: out positions, out prev, string params,
+                // in positions, in prev, motion partials, motion, frame params, cursor trail,
+                // obstacles, grid, grid node cells, grid entries.
+                std::array<VkBuffer, PHYSICS_BINDING_COUNT> buffers{m_positions[slot].buffer(), m_prev_positions[slot].buffer(), m_string_params.buffer(),
+                    m_positions[source].buffer(), m_prev_positions[source].buffer(), m_motion_partials.buffer(), m_motion.buffer(), m_frame_params[slot].buffer(),
+                    m_cursor_trail.buffer(), m_obstacles.buffer(), m_grid.buffer(), m_grid_node_cells.buffer(), m_grid_entries.buffer()};
+                std::array<vk::DescriptorBufferInfo, PHYSICS_BINDING_COUNT> infos{};
+                std::array<vk::WriteDescriptorSet, PHYSICS_BINDING_COUNT> writes{};
+                for (uint32_t binding = 0; binding < PHYSICS_BINDING_COUNT; ++binding) {
+                    infos[binding].buffer = vk::Buffer(buffers[binding]);
+                    infos[binding].offset = 0;
+                    infos[binding].range = VK_WHOLE_SIZE;
+                    writes[binding].dstSet = *m_descriptor_sets[slot];
+                    writes[binding].dstBinding = binding;
+                    writes[binding].dstArrayElement = 0;
+                    writes[binding].descriptorType = vk::DescriptorType::eStorageBuffer;
+                    writes[binding].setBufferInfo(infos[binding]);
+                }
+                m_device.get().updateDescriptorSets(writes, {});
+            }
+
+            std::vector<vk::DescriptorSetLayout> ribbon_layouts(ribbon_set_count, *m_pipeline.ribbonSetLayout());
+            vk::DescriptorSetAllocateInfo ribbon_alloc_info{};
+            ribbon_alloc_info.descriptorPool = *m_descriptor_pool;
+            ribbon_alloc_info.setSetLayouts(ribbon_layouts);
+            m_ribbon_sets = m_device.get().allocateDescriptorSets(ribbon_alloc_info);
+            for (uint32_t slot = 0; slot < m_state_slot_count; ++slot) {
+                for (uint32_t frame = 0; frame < m_frames_in_flight; ++frame) {
+                    // Binding order matches ribbon.slang: node positions, ribbon vertices, bounds, draws.
+                    std::array<VkBuffer, RIBBON_BINDING_COUNT> buffers{m_positions[slot].buffer(), m_ribbon[frame].buffer(), m_ribbon_bounds.buffer(),
+                        m_ribbon_draws[frame].buffer()};
+                    std::array<vk::DescriptorBufferInfo, RIBBON_BINDING_COUNT> infos{};
+                    std::array<vk::WriteDescriptorSet, RIBBON_BINDING_COUNT> writes{};
+                    for (uint32_t binding = 0; binding < RIBBON_BINDING_COUNT; ++binding) {
+                        infos[binding].buffer = vk::Buffer(buffers[binding]);
+                        infos[binding].offset = 0;
+                        infos[binding].range = VK_WHOLE_SIZE;
+                        writes[binding].dstSet = *m_ribbon_sets[slot * m_frames_in_flight + frame];
+                        writes[binding].dstBinding = binding;
+                        writes[binding].dstArrayElement = 0;
+                        writes[binding].descriptorType = vk::DescriptorType::eStorageBuffer;
+                        writes[binding].setBufferInfo(infos[binding]);
+                    }
+                    m_device.get().updateDescriptorSets(writes, {});
+                }
+            }
         } catch (const vk::SystemError& e) {
             out_error_message = std::string("Vulkan error creating physics resources: ") + e.what();
             return false;
@@ -196,8 +742,250 @@ namespace Engine
         return true;
     }
 
+    bool Renderer::createPhysicsThreadResources(std::string& out_error_message)
+    {
+        TRACE_ZONE("Renderer::createPhysicsThreadResources");
+        try {
+            const vk::raii::Device& device = m_device.get();
+
+            vk::CommandPoolCreateInfo pool_info{};
+            pool_info.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+            pool_info.queueFamilyIndex = m_async_compute ? m_device.queueFamilies().compute : m_device.queueFamilies().graphics;
+            m_physics_command_pool = vk::raii::CommandPool(device, pool_info);
+
+            vk::CommandBufferAllocateInfo alloc_info{};
+            alloc_info.commandPool = *m_physics_command_pool;
+            alloc_info.level = vk::CommandBufferLevel::ePrimary;
+            alloc_info.commandBufferCount = 1;
+            m_physics_command_buffers = device.allocateCommandBuffers(alloc_info);
+
+            m_frame_timeline = createTimeline(device);
+
+            // Frames draw the seeded slot until the first tick is published.
+            std::lock_guard<std::mutex> lock(m_simulation_mutex);
+            m_simulation = SharedSimulation{};
+            m_simulation.newest_slot = m_state_slot;
+            m_simulation.slot_reader.assign(m_state_slot_count, 0);
+        } catch (const vk::SystemError& e) {
+            out_error_message = std::string("Vulkan error creating physics thread resources: ") + e.what();
+            return false;
+        }
+        return true;
+    }
+
+    bool Renderer::createOffscreenTarget(uint32_t width, uint32_t height, std::string& out_error_message)
+    {
+        TRACE_ZONE("Renderer::createOffscreenTarget");
+        try {
+            // Transfer source too, so a frame can be copied out for inspection.
+            m_offscreen_image = m_allocator.createImage(width, height, static_cast<VkFormat>(HEADLESS_FORMAT),
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+            m_offscreen_extent = vk::Extent2D{width, height};
+
+            vk::ImageViewCreateInfo view_info{};
+            view_info.image = vk::Image(m_offscreen_image.image());
+            view_info.viewType = vk::ImageViewType::e2D;
+            view_info.format = HEADLESS_FORMAT;
+            view_info.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+            view_info.subresourceRange.baseMipLevel = 0;
+            view_info.subresourceRange.levelCount = 1;
+            view_info.subresourceRange.baseArrayLayer = 0;
+            view_info.subresourceRange.layerCount = 1;
+            m_offscreen_view = vk::raii::ImageView(m_device.get(), view_info);
+        } catch (const vk::SystemError& e) {
+            out_error_message = std::string("Vulkan error creating the offscreen target: ") + e.what();
+            return false;
+        }
+        return true;
+    }
+
+    bool Renderer::createCapture(const RendererConfig& config, std::string& out_error_message)
+    {
+        TRACE_ZONE("Renderer::createCapture");
+        vk::Format format = m_headless ? HEADLESS_FORMAT : m_swapchain.format();
+        CapturePixelOrder order{CapturePixelOrder::Bgra};
+        if ((format == vk::Format::eR8G8B8A8Unorm) || (format == vk::Format::eR8G8B8A8Srgb)) {
+            order = CapturePixelOrder::Rgba;
+        } else if ((format != vk::Format::eB8G8R8A8Unorm) && (format != vk::Format::eB8G8R8A8Srgb)) {
+            out_error_message = "Frame capture needs an 8-bit RGBA or BGRA target.";
+            return false;
+        }
+        if (!m_headless && !(m_swapchain.usage() & vk::ImageUsageFlagBits::eTransferSrc)) {
+            out_error_message = "The swapchain images cannot be copied from, so frames cannot be captured.";
+            return false;
+        }
+
+        // Host-cached (random access) where the device has it: the writer reads every byte. The
+        // slots share a pool whose blocks are sized for all of them, so the ring is one device
+        // memory allocation (barring alignment padding) and shows apart in the VMA statistics.
+        m_capture_extent = m_headless ? m_offscreen_extent : m_swapchain.extent();
+        VkDeviceSize frame_size = static_cast<VkDeviceSize>(m_capture_extent.width) * m_capture_extent.height * 4;
+        uint32_t slot_count = m_frames_in_flight + CAPTURE_SPARE_SLOTS;
+        std::vector<const uint8_t*> slots;
+        m_capture_buffers.clear();
+        m_capture_pool = m_allocator.createBufferPool(frame_size * slot_count, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, VMA_MEMORY_USAGE_AUTO);
+        for (uint32_t i = 0; i < slot_count; ++i) {
+            m_capture_buffers.push_back(m_allocator.createPooledBuffer(m_capture_pool, frame_size));
+            slots.push_back(static_cast<const uint8_t*>(m_capture_buffers.back().allocationInfo().pMappedData));
+        }
+        if (!m_capture.open(config.capture_path, config.capture_format, order, m_capture_extent.width, m_capture_extent.height, config.capture_frame_rate, slots,
+                out_error_message)) {
+            return false;
+        }
+        LOG_INFO(*m_logger, "Capturing {}x{} frames at {} fps to \"{}\" as {} ({} readback slots).", m_capture_extent.width, m_capture_extent.height,
+            config.capture_frame_rate, config.capture_path,
+            (config.capture_format == CaptureFormat::Y4m) ? "Y4M 4:4:4" : ((order == CapturePixelOrder::Bgra) ? "raw BGRA" : "raw RGBA"), slots.size());
+        return true;
+    }
+
+    bool Renderer::uploadBuffers(std::span<const BufferUpload> uploads, std::string& out_error_message)
+    {
+        // ReBAR/UMA: a device-local buffer that is mapped is written directly; the rest are staged.
+        VkDeviceSize staged_bytes{0};
+        for (const BufferUpload& upload : uploads) {
+            if (Allocator::isMapped(*upload.buffer)) {
+                m_allocator.writeMapped(*upload.buffer, upload.data, upload.size);
+            } else {
+                staged_bytes += ArenaRegions::alignUp(upload.size, UPLOAD_ALIGNMENT);
+            }
+        }
+        if (staged_bytes == 0) {
+            return true;
+        }
+
+        try {
+            const vk::raii::Device& device = m_device.get();
+            FrameArena staging;
+            if (!staging.create(m_allocator, staged_bytes, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, FrameArena::Direction::Upload)) {
+                out_error_message = "Failed to create the upload arena.";
+                return false;
+            }
+            staging.beginFrame(0);
+
+            vk::CommandBufferAllocateInfo alloc_info{};
+            alloc_info.commandPool = *m_command_pool;
+            alloc_info.level = vk::CommandBufferLevel::ePrimary;
+            alloc_info.commandBufferCount = 1;
+            std::vector<vk::raii::CommandBuffer> cmds = device.allocateCommandBuffers(alloc_info);
+            const vk::raii::CommandBuffer& cmd = cmds.front();
+
+            vk::CommandBufferBeginInfo begin_info{};
+            begin_info.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+            cmd.begin(begin_info);
+            for (const BufferUpload& upload : uploads) {
+                if (Allocator::isMapped(*upload.buffer)) {
+                    continue;
+                }
+                // Sized for every staged upload above, so this always fits.
+                ArenaAllocation source = staging.allocate(upload.size, UPLOAD_ALIGNMENT);
+                std::memcpy(source.mapped, upload.data, static_cast<size_t>(upload.size));
+                vk::BufferCopy region{source.offset, 0, upload.size};
+                cmd.copyBuffer(vk::Buffer(source.buffer), vk::Buffer(upload.buffer->buffer()), region);
+            }
+            staging.flush();
+
+            // Make the copies visible to every later command on the queue (the frames that follow
+            // this submission read the buffers in compute, vertex-input and indirect stages).
+            vk::MemoryBarrier2 copy_barrier{};
+            copy_barrier.srcStageMask = vk::PipelineStageFlagBits2::eCopy;
+            copy_barrier.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+            copy_barrier.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands;
+            copy_barrier.dstAccessMask = vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite;
+            vk::DependencyInfo dependency{};
+            dependency.setMemoryBarriers(copy_barrier);
+            cmd.pipelineBarrier2(dependency);
+            cmd.end();
+
+            // Wait here so the arena can be freed on return (init-time only).
+            vk::raii::Fence fence{device, vk::FenceCreateInfo{}};
+            vk::CommandBufferSubmitInfo cmd_submit{};
+            cmd_submit.commandBuffer = *cmd;
+            vk::SubmitInfo2 submit{};
+            submit.setCommandBufferInfos(cmd_submit);
+            m_device.graphicsQueue().submit2(submit, *fence);
+            (void)device.waitForFences({*fence}, vk::True, UINT64_MAX);
+        } catch (const vk::SystemError& e) {
+            out_error_message = std::string("Vulkan error uploading buffers: ") + e.what();
+            return false;
+        }
+        return true;
+    }
+
+    bool Renderer::readPositions(std::vector<MathLib::Vec2>& out_positions, std::string& out_error_message)
+    {
+        TRACE_ZONE("Renderer::readPositions");
+        VkDeviceSize size = static_cast<VkDeviceSize>(m_node_count) * m_string_count * sizeof(MathLib::Vec2);
+        try {
+            const vk::raii::Device& device = m_device.get();
+            // Every submitted frame (and physics tick) has finished writing its slot after this.
+            device.waitIdle();
+            uint32_t newest_slot = m_state_slot;
+            if (m_physics_threaded) {
+                std::lock_guard<std::mutex> lock(m_simulation_mutex);
+                newest_slot = m_simulation.newest_slot;
+            }
+
+            FrameArena readback;
+            if (!readback.create(m_allocator, size, 1, VK_BUFFER_USAGE_TRANSFER_DST_BIT, FrameArena::Direction::Readback)) {
+                out_error_message = "Failed to create the positions readback arena.";
+                return false;
+            }
+            readback.beginFrame(0);
+            ArenaAllocation destination = readback.allocate(size, alignof(MathLib::Vec2));
+
+            vk::CommandBufferAllocateInfo alloc_info{};
+            alloc_info.commandPool = *m_command_pool;
+            alloc_info.level = vk::CommandBufferLevel::ePrimary;
+            alloc_info.commandBufferCount = 1;
+            std::vector<vk::raii::CommandBuffer> cmds = device.allocateCommandBuffers(alloc_info);
+            const vk::raii::CommandBuffer& cmd = cmds.front();
+
+            vk::CommandBufferBeginInfo begin_info{};
+            begin_info.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+            cmd.begin(begin_info);
+            // The slot was last written by compute, possibly on the compute queue.
+            vk::MemoryBarrier2 compute_barrier{};
+            compute_barrier.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader;
+            compute_barrier.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite;
+            compute_barrier.dstStageMask = vk::PipelineStageFlagBits2::eCopy;
+            compute_barrier.dstAccessMask = vk::AccessFlagBits2::eTransferRead;
+            vk::DependencyInfo compute_dependency{};
+            compute_dependency.setMemoryBarriers(compute_barrier);
+            cmd.pipelineBarrier2(compute_dependency);
+            vk::BufferCopy region{0, destination.offset, size};
+            cmd.copyBuffer(vk::Buffer(m_positions[newest_slot].buffer()), vk::Buffer(destination.buffer), region);
+            vk::MemoryBarrier2 host_barrier{};
+            host_barrier.srcStageMask = vk::PipelineStageFlagBits2::eCopy;
+            host_barrier.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+            host_barrier.dstStageMask = vk::PipelineStageFlagBits2::eHost;
+            host_barrier.dstAccessMask = vk::AccessFlagBits2::eHostRead;
+            vk::DependencyInfo host_dependency{};
+            host_dependency.setMemoryBarriers(host_barrier);
+            cmd.pipelineBarrier2(host_dependency);
+            cmd.end();
+
+            vk::raii::Fence fence{device, vk::FenceCreateInfo{}};
+            vk::CommandBufferSubmitInfo cmd_submit{};
+            cmd_submit.commandBuffer = *cmd;
+            vk::SubmitInfo2 submit{};
+            submit.setCommandBufferInfos(cmd_submit);
+            m_device.graphicsQueue().submit2(submit, *fence);
+            (void)device.waitForFences({*fence}, vk::True, UINT64_MAX);
+
+            readback.invalidate(destination);
+            out_positions.resize(static_cast<size_t>(m_node_count) * m_string_count);
+            std::memcpy(out_positions.data(), destination.mapped, static_cast<size_t>(size));
+        } catch (const vk::SystemError& e) {
+            out_error_message = std::string("Vulkan error reading the positions back: ") + e.what();
+            return false;
+        }
+        return true;
+    }
+
     bool Renderer::createFrameResources(std::string& out_error_message)
     {
+        TRACE_ZONE("Renderer::createFrameResources");
         try {
             const vk::raii::Device& device = m_device.get();
 
@@ -209,21 +997,42 @@ namespace Engine
             vk::CommandBufferAllocateInfo alloc_info{};
             alloc_info.commandPool = *m_command_pool;
             alloc_info.level = vk::CommandBufferLevel::ePrimary;
-            alloc_info.commandBufferCount = MAX_FRAMES_IN_FLIGHT;
+            alloc_info.commandBufferCount = m_frames_in_flight;
             m_command_buffers = device.allocateCommandBuffers(alloc_info);
 
             m_image_available.clear();
             m_in_flight.clear();
-            for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+            for (uint32_t i = 0; i < m_frames_in_flight; ++i) {
                 m_image_available.push_back(vk::raii::Semaphore(device, vk::SemaphoreCreateInfo{}));
                 vk::FenceCreateInfo fence_info{};
                 fence_info.flags = vk::FenceCreateFlagBits::eSignaled; // start signalled so the first wait returns immediately.
                 m_in_flight.push_back(vk::raii::Fence(device, fence_info));
             }
+            m_slot_frame.assign(m_frames_in_flight, 0);
+
+            // With the physics thread the frames submit no physics; it records into its own pool.
+            if (m_async_compute && !m_physics_threaded) {
+                vk::CommandPoolCreateInfo compute_pool_info{};
+                compute_pool_info.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+                compute_pool_info.queueFamilyIndex = m_device.queueFamilies().compute;
+                m_compute_command_pool = vk::raii::CommandPool(device, compute_pool_info);
+
+                vk::CommandBufferAllocateInfo compute_alloc_info{};
+                compute_alloc_info.commandPool = *m_compute_command_pool;
+                compute_alloc_info.level = vk::CommandBufferLevel::ePrimary;
+                compute_alloc_info.commandBufferCount = m_frames_in_flight;
+                m_compute_command_buffers = device.allocateCommandBuffers(compute_alloc_info);
+            }
+            if (m_async_compute || m_physics_threaded) {
+                m_physics_timeline = createTimeline(device);
+                m_physics_value = 0;
+            }
 
-            m_render_finished.clear();
-            for (uint32_t i = 0; i < m_swapchain.imageCount(); ++i) {
-                m_render_finished.push_back(vk::raii::Semaphore(device, vk::SemaphoreCreateInfo{}));
+            m_pending_timings.assign(m_frames_in_flight, PendingTimings{});
+            m_last_timings = FrameTimings{};
+            m_last_timings_frame = 0;
+            if (!m_profiler.init(m_device, m_frames_in_flight, m_async_compute, out_error_message)) {
+                return false;
             }
         } catch (const vk::SystemError& e) {
             out_error_message = std::string("Vulkan error creating frame resources: ") + e.what();
@@ -234,133 +1043,467 @@ namespace Engine
 
     void Renderer::recreateSwapchain(uint32_t width, uint32_t height)
     {
-        m_swapchain.recreate(width, height);
-        m_render_finished.clear();
-        for (uint32_t i = 0; i < m_swapchain.imageCount(); ++i) {
-            m_render_finished.push_back(vk::raii::Semaphore(m_device.get(), vk::SemaphoreCreateInfo{}));
+        TRACE_ZONE("Renderer::recreateSwapchain");
+        // The present thread is done with the old swapchain before it is rebuilt from it, and
+        // what its presents reported is about the old one.
+        if (m_present_thread.running()) {
+            m_present_thread.drain();
+            releasePendingAcquire();
+            (void)m_present_thread.takePresentResult();
+        }
+        // The old swapchain outlives the frames already submitted against it. With present fences
+        // it also waits for its presents; without them nothing reports those, and a further ring
+        // of frames in flight is the margin by which they are, in practice, long done.
+        uint64_t release_frame = m_frame_serial;
+        if (!m_device.supportsSwapchainMaintenance()) {
+            release_frame += m_frames_in_flight;
+        }
+        m_swapchain.recreate(width, height, release_frame);
+        m_stats.add(FrameCounter::SwapchainRecreations);
+        // Present ids belong to the old swapchain; the new one starts its own sequence.
+        m_present_id = 0;
+        m_latency_present_id = 0;
+        if (m_scaled) {
+            ensureScaledTarget();
+        }
+        resetTargetContents();
+        if (m_prerecorded) {
+            // Re-recording frees buffers the frames in flight may still be executing (not waiting
+            // for the device, so the old swapchain's presents are not waited).
+            waitForFramesInFlight();
+            recordPrerecorded();
         }
     }
 
-    void Renderer::drawFrame(uint32_t width, uint32_t height, int32_t cursor_x, int32_t cursor_y, float dt)
+    void Renderer::releasePendingAcquire()
     {
-        if (!m_initialised) {
+        if (!m_acquire_pending) {
+            return;
+        }
+        m_acquire_pending = false;
+        AcquiredImage acquired = m_present_thread.waitAcquired();
+        if ((acquired.result != vk::Result::eSuccess) && (acquired.result != vk::Result::eSuboptimalKHR)) {
             return;
         }
+        // The image goes with its swapchain, but the semaphore stays signalled until a wait
+        // consumes it; the next acquire into it needs that wait complete. Rare (a frame failed
+        // between its acquire and its submit), so it waits for the queue.
+        vk::SemaphoreSubmitInfo wait_submit{};
+        wait_submit.semaphore = *m_image_available[m_current_frame];
+        wait_submit.stageMask = vk::PipelineStageFlagBits2::eAllCommands;
+        vk::SubmitInfo2 submit{};
+        submit.setWaitSemaphoreInfos(wait_submit);
+        std::unique_lock<std::mutex> queue_lock = lockSharedQueue();
+        m_device.graphicsQueue().submit2(submit);
+        m_device.graphicsQueue().waitIdle();
+    }
 
-        if (m_swapchain.isZeroExtent()) {
-            if ((width > 0) && (height > 0)) {
-                try {
-                    recreateSwapchain(width, height);
-                } catch (const vk::SystemError&) {
-                    // Still not presentable; try again next frame.
-                }
+    std::unique_lock<std::mutex> Renderer::lockSharedQueue()
+    {
+        return (m_present_queue_shared || m_physics_queue_shared) ? std::unique_lock<std::mutex>(m_queue_mutex) : std::unique_lock<std::mutex>{};
+    }
+
+    void Renderer::waitForFramesInFlight() const
+    {
+        if (m_in_flight.empty()) {
+            return;
+        }
+        std::vector<vk::Fence> fences;
+        for (const vk::raii::Fence& fence : m_in_flight) {
+            fences.push_back(*fence);
+        }
+        (void)m_device.get().waitForFences(fences, vk::True, UINT64_MAX);
+    }
+
+    void Renderer::ensureScaledTarget()
+    {
+        vk::Extent2D extent = m_swapchain.extent();
+        if ((extent.width > m_scaled_capacity.width) || (extent.height > m_scaled_capacity.height)) {
+            // Outgrown: the frames in flight may still draw into or blit from the old image.
+            waitForFramesInFlight();
+            vk::Extent2D capacity{};
+            capacity.width = std::max(m_scaled_capacity.width, (extent.width + SCALED_TARGET_GRANULARITY - 1) / SCALED_TARGET_GRANULARITY * SCALED_TARGET_GRANULARITY);
+            capacity.height = std::max(m_scaled_capacity.height, (extent.height + SCALED_TARGET_GRANULARITY - 1) / SCALED_TARGET_GRANULARITY * SCALED_TARGET_GRANULARITY);
+
+            m_scaled_view = nullptr;
+            m_scaled_image = AllocatedImage{};
+            m_scaled_image = m_allocator.createImage(capacity.width, capacity.height, static_cast<VkFormat>(m_swapchain.format()),
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+            m_scaled_capacity = capacity;
+
+            vk::ImageViewCreateInfo view_info{};
+            view_info.image = vk::Image(m_scaled_image.image());
+            view_info.viewType = vk::ImageViewType::e2D;
+            view_info.format = m_swapchain.format();
+            view_info.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+            view_info.subresourceRange.baseMipLevel = 0;
+            view_info.subresourceRange.levelCount = 1;
+            view_info.subresourceRange.baseArrayLayer = 0;
+            view_info.subresourceRange.layerCount = 1;
+            m_scaled_view = vk::raii::ImageView(m_device.get(), view_info);
+        }
+        updateScaledExtent();
+    }
+
+    void Renderer::updateScaledExtent()
+    {
+        vk::Extent2D extent = m_swapchain.extent();
+        m_scaled_extent.width = std::max(1u, static_cast<uint32_t>(static_cast<float>(extent.width) * m_render_scale));
+        m_scaled_extent.height = std::max(1u, static_cast<uint32_t>(static_cast<float>(extent.height) * m_render_scale));
+    }
+
+    void Renderer::adjustRenderScale()
+    {
+        // Only frames drawn at the current scale count, and only once the cooldown has passed.
+        if (!m_auto_render_scale || (m_last_timings.gpu_frame_ms <= 0.0f) || (m_last_timings_frame <= m_render_scale_frame + RENDER_SCALE_COOLDOWN_FRAMES)) {
+            return;
+        }
+
+        // The draw and its clear scale with the pixel count, the physics does not.
+        float fill_ms = std::max(0.0f, m_last_timings.gpu_frame_ms - m_last_timings.gpu_physics_ms);
+        float scale = m_render_scale;
+        if (m_last_timings.gpu_frame_ms > m_gpu_budget_ms) {
+            scale = std::max(MIN_RENDER_SCALE, scale - RENDER_SCALE_STEP);
+        } else if (scale < 1.0f) {
+            float larger = std::min(1.0f, scale + RENDER_SCALE_STEP);
+            float predicted_ms = m_last_timings.gpu_physics_ms + fill_ms * (larger * larger) / (scale * scale);
+            if (predicted_ms < (m_gpu_budget_ms * RENDER_SCALE_HEADROOM)) {
+                scale = larger;
             }
+        }
+        if (scale == m_render_scale) {
             return;
         }
 
-        try {
-            const vk::raii::Device& device = m_device.get();
+        m_render_scale = scale;
+        m_render_scale_frame = m_frame_serial;
+        updateScaledExtent();
+        // The preserved contents and their erase boxes are at the old resolution.
+        resetTargetContents();
+    }
 
-            // 1. Wait for the previous frame to finish (also frees the shared physics buffers).
-            (void)device.waitForFences({*m_in_flight[m_current_frame]}, vk::True, UINT64_MAX);
+    void Renderer::recordPhysics(const vk::raii::CommandBuffer& cmd, uint32_t write_slot, uint32_t substeps) const
+    {
+        const vk::raii::PipelineLayout& layout = m_compute_pipeline.layout();
+        cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *layout, 0, *m_descriptor_sets[write_slot], nullptr);
+
+        PhysicsPush push{};
+        push.string_count = m_string_count;
+        push.phase = 0;
+        push.substep = 0;
+        push.collision_radius = m_collision_radius;
+        push.grid_cells = m_grid_cells;
+
+        // Order against earlier frames' physics on the queue: their writes to the slot read here
+        // (RAW) and their reads of the slot written here (WAR).
+        computeToComputeBarrier(cmd);
+
+        if (m_solver == PhysicsSolver::Workgroup) {
+            // One workgroup per string, each solving its string in shared memory over the frame
+            // parameters' substep count.
+            cmd.bindPipeline(vk::PipelineBindPoint::eCompute, *m_compute_pipeline.workgroup());
+            cmd.pushConstants<PhysicsPush>(*layout, vk::ShaderStageFlagBits::eCompute, 0, push);
+            cmd.dispatch(m_string_count, 1, 1);
+            return;
+        }
 
-            // 2. Acquire (throws vk::OutOfDateKHRError if the swapchain is stale).
-            vk::ResultValue<uint32_t> acquire = m_swapchain.get().acquireNextImage(UINT64_MAX, *m_image_available[m_current_frame]);
-            uint32_t image_index = acquire.value;
-            bool suboptimal = (acquire.result == vk::Result::eSuboptimalKHR);
+        // Tiled: per substep, one Verlet dispatch over all nodes of the batch, then each
+        // red-black half-pass of each iteration as its own dispatch over the constraints of that
+        // colour. The barriers between dispatches stand in for the shared-memory barriers of the
+        // workgroup solver. Pre-recorded buffers cover every possible substep with indirect
+        // dispatches the frame parameters size (zero groups past the frame's substeps); only the
+        // first integration is direct, as it also carries the state over when no substep is due.
+        uint32_t node_groups = physicsGroupCount(m_node_count * m_string_count);
+        uint32_t constraint_groups = physicsGroupCount((m_node_count / 2) * m_string_count);
+        uint32_t step_count = m_prerecorded ? PHYSICS_MAX_SUBSTEPS : substeps;
+        vk::Buffer params{m_frame_params[write_slot].buffer()};
+        for (uint32_t step = 0; step < step_count; ++step) {
+            if (step > 0) {
+                computeToComputeBarrier(cmd);
+            }
+            cmd.bindPipeline(vk::PipelineBindPoint::eCompute, *m_compute_pipeline.integrate());
+            push.phase = 0;
+            push.substep = step;
+            cmd.pushConstants<PhysicsPush>(*layout, vk::ShaderStageFlagBits::eCompute, 0, push);
+            if (m_prerecorded && (step > 0)) {
+                cmd.dispatchIndirect(params, offsetof(FrameParams, integrate_groups) + step * sizeof(vk::DispatchIndirectCommand));
+            } else {
+                cmd.dispatch(node_groups, 1, 1);
+            }
 
-            device.resetFences({*m_in_flight[m_current_frame]});
+            cmd.bindPipeline(vk::PipelineBindPoint::eCompute, *m_compute_pipeline.constrain());
+            for (uint32_t it = 0; it < m_constraint_iterations; ++it) {
+                for (uint32_t phase = 0; phase < 2; ++phase) {
+                    computeToComputeBarrier(cmd);
+                    push.phase = phase;
+                    cmd.pushConstants<PhysicsPush>(*layout, vk::ShaderStageFlagBits::eCompute, 0, push);
+                    if (m_prerecorded) {
+                        cmd.dispatchIndirect(params, offsetof(FrameParams, constrain_groups) + step * sizeof(vk::DispatchIndirectCommand));
+                    } else {
+                        cmd.dispatch(constraint_groups, 1, 1);
+                    }
+                }
+            }
 
-            const vk::raii::CommandBuffer& cmd = m_command_buffers[m_current_frame];
-            cmd.reset();
-            vk::CommandBufferBeginInfo begin_info{};
-            cmd.begin(begin_info);
+            // Self-collision: counting sort of the nodes into the hash grid (count, scan the
+            // blocks, scan the block totals, scatter), then the narrow phase. Pre-recorded, each
+            // pass is indirect, sized to nothing past the frame's substeps.
+            if (m_grid_cells > 0) {
+                auto gridPass = [&cmd, &params, step, this](const vk::raii::Pipeline& pipeline, uint32_t groups, size_t indirect_offset) {
+                    computeToComputeBarrier(cmd);
+                    cmd.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+                    if (m_prerecorded) {
+                        cmd.dispatchIndirect(params, indirect_offset + step * sizeof(vk::DispatchIndirectCommand));
+                    } else {
+                        cmd.dispatch(groups, 1, 1);
+                    }
+                };
+                gridPass(m_compute_pipeline.gridCount(), node_groups, offsetof(FrameParams, integrate_groups));
+                gridPass(m_compute_pipeline.gridScan(), m_grid_cells / PHYSICS_GRID_SCAN_BLOCK, offsetof(FrameParams, grid_scan_groups));
+                gridPass(m_compute_pipeline.gridTotals(), 1, offsetof(FrameParams, grid_total_groups));
+                gridPass(m_compute_pipeline.gridScatter(), node_groups, offsetof(FrameParams, integrate_groups));
+                gridPass(m_compute_pipeline.collide(), node_groups, offsetof(FrameParams, integrate_groups));
+            }
+        }
+    }
+
+    void Renderer::recordMotion(const vk::raii::CommandBuffer& cmd, const ArenaAllocation& readback) const
+    {
+        const vk::raii::PipelineLayout& layout = m_compute_pipeline.layout();
+        PhysicsPush push{};
+        push.string_count = m_string_count;
+
+        // Stage 1 reads the state the solver just wrote.
+        computeToComputeBarrier(cmd);
+        cmd.bindPipeline(vk::PipelineBindPoint::eCompute, *m_compute_pipeline.motion());
+        cmd.pushConstants<PhysicsPush>(*layout, vk::ShaderStageFlagBits::eCompute, 0, push);
+        cmd.dispatch(physicsGroupCount(m_node_count * m_string_count), 1, 1);
+
+        // Stage 2 reads the partials, and overwrites the result an earlier frame's copy read.
+        vk::MemoryBarrier2 to_reduce{};
+        to_reduce.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader | vk::PipelineStageFlagBits2::eCopy;
+        to_reduce.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite;
+        to_reduce.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader;
+        to_reduce.dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite;
+        vk::DependencyInfo dep_reduce{};
+        dep_reduce.setMemoryBarriers(to_reduce);
+        cmd.pipelineBarrier2(dep_reduce);
+        cmd.bindPipeline(vk::PipelineBindPoint::eCompute, *m_compute_pipeline.motionReduce());
+        cmd.dispatch(1, 1, 1);
+
+        // Copy the result into the readback buffer and make it visible to the host.
+        vk::MemoryBarrier2 to_copy{};
+        to_copy.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader;
+        to_copy.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite;
+        to_copy.dstStageMask = vk::PipelineStageFlagBits2::eCopy;
+        to_copy.dstAccessMask = vk::AccessFlagBits2::eTransferRead;
+        vk::DependencyInfo dep_copy{};
+        dep_copy.setMemoryBarriers(to_copy);
+        cmd.pipelineBarrier2(dep_copy);
+        vk::BufferCopy region{0, readback.offset, sizeof(MotionStats)};
+        cmd.copyBuffer(vk::Buffer(m_motion.buffer()), vk::Buffer(readback.buffer), region);
+
+        vk::MemoryBarrier2 to_host{};
+        to_host.srcStageMask = vk::PipelineStageFlagBits2::eCopy;
+        to_host.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+        to_host.dstStageMask = vk::PipelineStageFlagBits2::eHost;
+        to_host.dstAccessMask = vk::AccessFlagBits2::eHostRead;
+        vk::DependencyInfo dep_host{};
+        dep_host.setMemoryBarriers(to_host);
+        cmd.pipelineBarrier2(dep_host);
+    }
 
-            // --- Physics: dispatch the compute shader (one workgroup simulates the whole string).
-            MathLib::Vec2 cursor = cursorToNdc(width, height, cursor_x, cursor_y);
-            PhysicsPush push{};
-            push.cursor_x = cursor.x;
-            push.cursor_y = cursor.y;
-            push.dt = (dt > MAX_DELTA) ? MAX_DELTA : dt;
-            push.gravity = GRAVITY;
-            push.segment_length = SEGMENT_LENGTH;
-            push.damping = DAMPING;
-            push.node_count = NODE_COUNT;
-            push.iterations = CONSTRAINT_ITERATIONS;
-
-            cmd.bindPipeline(vk::PipelineBindPoint::eCompute, *m_compute_pipeline.get());
-            cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *m_compute_pipeline.layout(), 0, *m_descriptor_set, nullptr);
-            cmd.pushConstants<PhysicsPush>(*m_compute_pipeline.layout(), vk::ShaderStageFlagBits::eCompute, 0, push);
-            cmd.dispatch(1, 1, 1);
-
-            // Barrier: compute write to positions -> vertex-attribute read.
-            vk::MemoryBarrier2 compute_to_vertex{};
-            compute_to_vertex.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader;
-            compute_to_vertex.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite;
-            compute_to_vertex.dstStageMask = vk::PipelineStageFlagBits2::eVertexAttributeInput;
-            compute_to_vertex.dstAccessMask = vk::AccessFlagBits2::eVertexAttributeRead;
-            vk::DependencyInfo dep_compute{};
-            dep_compute.setMemoryBarriers(compute_to_vertex);
-            cmd.pipelineBarrier2(dep_compute);
-
-            vk::ImageSubresourceRange colour_range{};
-            colour_range.aspectMask = vk::ImageAspectFlagBits::eColor;
-            colour_range.baseMipLevel = 0;
-            colour_range.levelCount = 1;
-            colour_range.baseArrayLayer = 0;
-            colour_range.layerCount = 1;
-
-            // Barrier: UNDEFINED -> COLOR_ATTACHMENT_OPTIMAL.
-            vk::ImageMemoryBarrier2 to_attachment{};
-            to_attachment.srcStageMask = vk::PipelineStageFlagBits2::eTopOfPipe;
-            to_attachment.srcAccessMask = vk::AccessFlagBits2::eNone;
-            to_attachment.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput;
-            to_attachment.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite;
-            to_attachment.oldLayout = vk::ImageLayout::eUndefined;
-            to_attachment.newLayout = vk::ImageLayout::eColorAttachmentOptimal;
-            to_attachment.srcQueueFamilyIndex = vk::QueueFamilyIgnored;
-            to_attachment.dstQueueFamilyIndex = vk::QueueFamilyIgnored;
-            to_attachment.image = m_swapchain.images()[image_index];
-            to_attachment.subresourceRange = colour_range;
-            vk::DependencyInfo dep_to_attachment{};
-            dep_to_attachment.setImageMemoryBarriers(to_attachment);
-            cmd.pipelineBarrier2(dep_to_attachment);
-
-            vk::RenderingAttachmentInfo colour_attachment{};
-            colour_attachment.imageView = *m_swapchain.views()[image_index];
-            colour_attachment.imageLayout = vk::ImageLayout::eColorAttachmentOptimal;
-            colour_attachment.loadOp = vk::AttachmentLoadOp::eClear;
-            colour_attachment.storeOp = vk::AttachmentStoreOp::eStore;
-            colour_attachment.clearValue.color = vk::ClearColorValue(CLEAR_COLOUR);
-
-            vk::RenderingInfo rendering_info{};
-            rendering_info.renderArea = vk::Rect2D{vk::Offset2D{0, 0}, m_swapchain.extent()};
-            rendering_info.layerCount = 1;
-            rendering_info.setColorAttachments(colour_attachment);
-
-            cmd.beginRendering(rendering_info);
-
-            vk::Viewport viewport{};
-            viewport.x = 0.0f;
-            viewport.y = 0.0f;
-            viewport.width = static_cast<float>(m_swapchain.extent().width);
-            viewport.height = static_cast<float>(m_swapchain.extent().height);
-            viewport.minDepth = 0.0f;
-            viewport.maxDepth = 1.0f;
-            cmd.setViewport(0, viewport);
-
-            vk::Rect2D scissor{vk::Offset2D{0, 0}, m_swapchain.extent()};
-            cmd.setScissor(0, scissor);
-
-            cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, *m_pipeline.get());
-            vk::Buffer vertex_buffer{m_positions.buffer()};
-            vk::DeviceSize vertex_offset{0};
-            cmd.bindVertexBuffers(0, vertex_buffer, vertex_offset);
-            cmd.draw(NODE_COUNT, 1, 0, 0);
-
-            cmd.endRendering();
-
-            // Barrier: COLOR_ATTACHMENT_OPTIMAL -> PRESENT_SRC.
+    void Renderer::recordCompute(const vk::raii::CommandBuffer& cmd, uint32_t frame, uint32_t write_slot, uint32_t substeps)
+    {
+        cmd.reset();
+        cmd.begin(vk::CommandBufferBeginInfo{});
+        m_profiler.begin(cmd, frame, GpuPhase::Physics);
+        recordPhysics(cmd, write_slot, substeps);
+        recordMotion(cmd, m_motion_readbacks[frame]);
+        m_profiler.end(cmd, frame, GpuPhase::Physics);
+        cmd.end();
+    }
+
+    void Renderer::recordRibbon(const vk::raii::CommandBuffer& cmd, uint32_t frame, uint32_t draw_slot, uint32_t target_index, vk::Extent2D target_extent) const
+    {
+        // The drawn slot was written by compute earlier in this command buffer, by an earlier
+        // submit on this queue, or on the compute queue (ordered by the timeline wait).
+        computeToComputeBarrier(cmd);
+
+        RibbonPush push{};
+        push.node_count = m_node_count;
+        push.total_nodes = m_node_count * m_string_count;
+        push.pixel_ndc_x = 2.0f / static_cast<float>(target_extent.width);
+        push.pixel_ndc_y = 2.0f / static_cast<float>(target_extent.height);
+        // Past RIBBON_MAX_TARGET_IMAGES no image is preserved, so sharing an entry is harmless.
+        push.target_image = target_index % RIBBON_MAX_TARGET_IMAGES;
+        push.compact_draws = m_device.supportsDrawIndirectCount() ? 1 : 0;
+        push.subdivisions = ribbonSubdivisions(target_extent);
+        push.padding = 0;
+
+        cmd.bindPipeline(vk::PipelineBindPoint::eCompute, *m_pipeline.ribbon());
+        cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *m_pipeline.ribbonLayout(), 0, *m_ribbon_sets[draw_slot * m_frames_in_flight + frame], nullptr);
+        cmd.pushConstants<RibbonPush>(*m_pipeline.ribbonLayout(), vk::ShaderStageFlagBits::eCompute, 0, push);
+        cmd.dispatch(physicsGroupCount(push.total_nodes), 1, 1);
+
+        // The bounds pass reads the box every workgroup has folded in, and writes the erase quad;
+        // the culling pass, independent of it, reads the strings they flagged and writes the draws.
+        computeToComputeBarrier(cmd);
+        cmd.bindPipeline(vk::PipelineBindPoint::eCompute, *m_pipeline.ribbonBounds());
+        cmd.dispatch(1, 1, 1);
+        cmd.bindPipeline(vk::PipelineBindPoint::eCompute, *m_pipeline.ribbonCull());
+        cmd.dispatch(1, 1, 1);
+
+        // Barrier: compute write to the ribbon and the draws -> vertex-attribute and indirect
+        // reads. The previous readers of this frame's buffers finished before its fence, which
+        // has been waited on.
+        vk::MemoryBarrier2 compute_to_vertex{};
+        compute_to_vertex.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader;
+        compute_to_vertex.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite;
+        compute_to_vertex.dstStageMask = vk::PipelineStageFlagBits2::eDrawIndirect | vk::PipelineStageFlagBits2::eVertexAttributeInput;
+        compute_to_vertex.dstAccessMask = vk::AccessFlagBits2::eIndirectCommandRead | vk::AccessFlagBits2::eVertexAttributeRead;
+        vk::DependencyInfo dep_compute{};
+        dep_compute.setMemoryBarriers(compute_to_vertex);
+        cmd.pipelineBarrier2(dep_compute);
+    }
+
+    void Renderer::recordGraphics(const vk::raii::CommandBuffer& cmd, uint32_t frame, uint32_t image_index, uint32_t draw_slot, bool inline_physics, uint32_t substeps,
+        bool preserved, uint32_t capture_slot)
+    {
+        cmd.reset();
+        cmd.begin(vk::CommandBufferBeginInfo{});
+
+        if (inline_physics) {
+            m_profiler.begin(cmd, frame, GpuPhase::Physics);
+            recordPhysics(cmd, draw_slot, substeps);
+            recordMotion(cmd, m_motion_readbacks[frame]);
+            m_profiler.end(cmd, frame, GpuPhase::Physics);
+        }
+
+        // Headless frames always render into the one offscreen image, scaled ones into the region
+        // of the scaled image that is then blitted up to the swapchain image.
+        vk::Image target_image = m_headless ? vk::Image(m_offscreen_image.image()) : m_swapchain.images()[image_index];
+        vk::ImageView target_view = m_headless ? *m_offscreen_view : *m_swapchain.views()[image_index];
+        vk::Extent2D target_extent = m_headless ? m_offscreen_extent : m_swapchain.extent();
+        if (m_scaled) {
+            target_image = vk::Image(m_scaled_image.image());
+            target_view = *m_scaled_view;
+            target_extent = m_scaled_extent;
+        }
+
+        m_profiler.begin(cmd, frame, GpuPhase::Draw);
+        recordRibbon(cmd, frame, draw_slot, targetIndex(image_index), target_extent);
+        m_profiler.end(cmd, frame, GpuPhase::Draw);
+
+        vk::ImageSubresourceRange colour_range{};
+        colour_range.aspectMask = vk::ImageAspectFlagBits::eColor;
+        colour_range.baseMipLevel = 0;
+        colour_range.levelCount = 1;
+        colour_range.baseArrayLayer = 0;
+        colour_range.layerCount = 1;
+
+        // Barrier: -> COLOR_ATTACHMENT_OPTIMAL, from UNDEFINED (discarding the contents) unless the
+        // image is preserved and loaded, from where the previous frame into it left it. A swapchain
+        // image is ordered by the acquire semaphore, waited at the colour output stage; the
+        // offscreen image is rewritten every frame, so order this after the previous frame's
+        // colour writes instead (WAW), and the scaled image after the previous frame's blit read
+        // of it (WAR; its colour writes precede that blit).
+        vk::ImageLayout preserved_layout = m_headless ? vk::ImageLayout::eColorAttachmentOptimal : vk::ImageLayout::ePresentSrcKHR;
+        vk::ImageMemoryBarrier2 to_attachment{};
+        to_attachment.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput;
+        to_attachment.srcAccessMask = m_headless ? vk::AccessFlagBits2::eColorAttachmentWrite : vk::AccessFlagBits2::eNone;
+        if (m_scaled) {
+            preserved_layout = vk::ImageLayout::eTransferSrcOptimal;
+            to_attachment.srcStageMask = vk::PipelineStageFlagBits2::eBlit;
+        }
+        to_attachment.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput;
+        to_attachment.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentRead | vk::AccessFlagBits2::eColorAttachmentWrite;
+        to_attachment.oldLayout = preserved ? preserved_layout : vk::ImageLayout::eUndefined;
+        to_attachment.newLayout = vk::ImageLayout::eColorAttachmentOptimal;
+        to_attachment.srcQueueFamilyIndex = vk::QueueFamilyIgnored;
+        to_attachment.dstQueueFamilyIndex = vk::QueueFamilyIgnored;
+        to_attachment.image = target_image;
+        to_attachment.subresourceRange = colour_range;
+        vk::DependencyInfo dep_to_attachment{};
+        dep_to_attachment.setImageMemoryBarriers(to_attachment);
+        m_profiler.begin(cmd, frame, GpuPhase::Transitions);
+        cmd.pipelineBarrier2(dep_to_attachment);
+        m_profiler.end(cmd, frame, GpuPhase::Transitions);
+
+        vk::RenderingAttachmentInfo colour_attachment{};
+        colour_attachment.imageView = target_view;
+        colour_attachment.imageLayout = vk::ImageLayout::eColorAttachmentOptimal;
+        colour_attachment.loadOp = preserved ? vk::AttachmentLoadOp::eLoad : vk::AttachmentLoadOp::eClear;
+        colour_attachment.storeOp = vk::AttachmentStoreOp::eStore;
+        colour_attachment.clearValue.color = vk::ClearColorValue(CLEAR_COLOUR);
+
+        vk::RenderingInfo rendering_info{};
+        rendering_info.renderArea = vk::Rect2D{vk::Offset2D{0, 0}, target_extent};
+        rendering_info.layerCount = 1;
+        rendering_info.setColorAttachments(colour_attachment);
+
+        m_profiler.begin(cmd, frame, GpuPhase::Draw);
+        cmd.beginRendering(rendering_info);
+
+        vk::Viewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = static_cast<float>(target_extent.width);
+        viewport.height = static_cast<float>(target_extent.height);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        cmd.setViewport(0, viewport);
+
+        vk::Rect2D scissor{vk::Offset2D{0, 0}, target_extent};
+        cmd.setScissor(0, scissor);
+
+        cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, *m_pipeline.get());
+        vk::Buffer vertex_buffer{m_ribbon[frame].buffer()};
+        vk::DeviceSize vertex_offset{0};
+        cmd.bindVertexBuffers(0, vertex_buffer, vertex_offset);
+        uint32_t string_vertices = ribbonStringVertices(m_node_count, ribbonSubdivisions(target_extent));
+        uint32_t ribbon_vertices = m_string_count * string_vertices;
+        if (preserved) {
+            // Restore the background under the strings this image last showed.
+            DrawPush erase{CLEAR_COLOUR[0], CLEAR_COLOUR[1], CLEAR_COLOUR[2], 1};
+            cmd.pushConstants<DrawPush>(*m_pipeline.layout(), vk::ShaderStageFlagBits::eVertex, 0, erase);
+            cmd.draw(RIBBON_ERASE_VERTICES, 1, ribbon_vertices, 0);
+        }
+        DrawPush strings{STRING_COLOUR[0], STRING_COLOUR[1], STRING_COLOUR[2], 0};
+        cmd.pushConstants<DrawPush>(*m_pipeline.layout(), vk::ShaderStageFlagBits::eVertex, 0, strings);
+        // The strips the culling pass kept in one multi-draw, counted on the GPU where the device
+        // has drawIndirectCount (otherwise every string's, the culled ones empty); one draw per
+        // string, unculled, where multiDrawIndirect is missing.
+        vk::Buffer draws{m_ribbon_draws[frame].buffer()};
+        vk::DeviceSize commands_offset = RIBBON_DRAW_COMMANDS_WORD * sizeof(uint32_t);
+        uint32_t command_stride = static_cast<uint32_t>(sizeof(vk::DrawIndirectCommand));
+        if ((m_string_count <= m_device.maxDrawIndirectCount()) && m_device.supportsDrawIndirectCount()) {
+            cmd.drawIndirectCount(draws, commands_offset, draws, 0, m_string_count, command_stride);
+        } else if (m_string_count <= m_device.maxDrawIndirectCount()) {
+            cmd.drawIndirect(draws, commands_offset, m_string_count, command_stride);
+        } else {
+            for (uint32_t s = 0; s < m_string_count; ++s) {
+                cmd.draw(string_vertices, 1, s * string_vertices, 0);
+            }
+        }
+
+        cmd.endRendering();
+        m_profiler.end(cmd, frame, GpuPhase::Draw);
+
+        // Barrier: COLOR_ATTACHMENT_OPTIMAL -> PRESENT_SRC (the offscreen image stays an attachment,
+        // the scaled one is blitted to the swapchain image, which then goes to PRESENT_SRC). A
+        // captured frame goes through TRANSFER_SRC on the way, for the copy of what is presented.
+        bool capture = (capture_slot != NO_CAPTURE_SLOT);
+        if (m_scaled) {
+            recordUpscale(cmd, frame, image_index, !capture);
+            if (capture) {
+                recordCapture(cmd, frame, m_swapchain.images()[image_index], capture_slot, vk::ImageLayout::eTransferDstOptimal,
+                    vk::PipelineStageFlagBits2::eBlit, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::ePresentSrcKHR);
+            }
+        } else if (capture) {
+            recordCapture(cmd, frame, target_image, capture_slot, vk::ImageLayout::eColorAttachmentOptimal, vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+                vk::AccessFlagBits2::eColorAttachmentWrite, m_headless ? vk::ImageLayout::eColorAttachmentOptimal : vk::ImageLayout::ePresentSrcKHR);
+        } else if (!m_headless) {
             vk::ImageMemoryBarrier2 to_present{};
             to_present.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput;
             to_present.srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite;
@@ -370,64 +1513,833 @@ namespace Engine
             to_present.newLayout = vk::ImageLayout::ePresentSrcKHR;
             to_present.srcQueueFamilyIndex = vk::QueueFamilyIgnored;
             to_present.dstQueueFamilyIndex = vk::QueueFamilyIgnored;
-            to_present.image = m_swapchain.images()[image_index];
+            to_present.image = target_image;
             to_present.subresourceRange = colour_range;
             vk::DependencyInfo dep_to_present{};
             dep_to_present.setImageMemoryBarriers(to_present);
+            m_profiler.begin(cmd, frame, GpuPhase::Transitions);
             cmd.pipelineBarrier2(dep_to_present);
+            m_profiler.end(cmd, frame, GpuPhase::Transitions);
+        }
 
+        cmd.end();
+    }
+
+    void Renderer::recordUpscale(const vk::raii::CommandBuffer& cmd, uint32_t frame, uint32_t image_index, bool to_present) const
+    {
+        vk::ImageSubresourceRange colour_range{};
+        colour_range.aspectMask = vk::ImageAspectFlagBits::eColor;
+        colour_range.baseMipLevel = 0;
+        colour_range.levelCount = 1;
+        colour_range.baseArrayLayer = 0;
+        colour_range.layerCount = 1;
+        vk::Image swapchain_image = m_swapchain.images()[image_index];
+
+        // Barriers: the scaled image's colour writes -> blit read; the swapchain image, whose
+        // acquire semaphore is waited at the blit stage, from UNDEFINED (it is overwritten whole).
+        std::array<vk::ImageMemoryBarrier2, 2> to_blit{};
+        to_blit[0].srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput;
+        to_blit[0].srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite;
+        to_blit[0].dstStageMask = vk::PipelineStageFlagBits2::eBlit;
+        to_blit[0].dstAccessMask = vk::AccessFlagBits2::eTransferRead;
+        to_blit[0].oldLayout = vk::ImageLayout::eColorAttachmentOptimal;
+        to_blit[0].newLayout = vk::ImageLayout::eTransferSrcOptimal;
+        to_blit[0].image = vk::Image(m_scaled_image.image());
+        to_blit[1].srcStageMask = vk::PipelineStageFlagBits2::eBlit;
+        to_blit[1].srcAccessMask = vk::AccessFlagBits2::eNone;
+        to_blit[1].dstStageMask = vk::PipelineStageFlagBits2::eBlit;
+        to_blit[1].dstAccessMask = vk::AccessFlagBits2::eTransferWrite;
+        to_blit[1].oldLayout = vk::ImageLayout::eUndefined;
+        to_blit[1].newLayout = vk::ImageLayout::eTransferDstOptimal;
+        to_blit[1].image = swapchain_image;
+        for (vk::ImageMemoryBarrier2& barrier : to_blit) {
+            barrier.srcQueueFamilyIndex = vk::QueueFamilyIgnored;
+            barrier.dstQueueFamilyIndex = vk::QueueFamilyIgnored;
+            barrier.subresourceRange = colour_range;
+        }
+        vk::DependencyInfo dep_to_blit{};
+        dep_to_blit.setImageMemoryBarriers(to_blit);
+
+        vk::ImageBlit2 region{};
+        region.srcSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+        region.srcSubresource.layerCount = 1;
+        region.srcOffsets[1] = vk::Offset3D{static_cast<int32_t>(m_scaled_extent.width), static_cast<int32_t>(m_scaled_extent.height), 1};
+        region.dstSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+        region.dstSubresource.layerCount = 1;
+        region.dstOffsets[1] = vk::Offset3D{static_cast<int32_t>(m_swapchain.extent().width), static_cast<int32_t>(m_swapchain.extent().height), 1};
+        vk::BlitImageInfo2 blit_info{};
+        blit_info.srcImage = vk::Image(m_scaled_image.image());
+        blit_info.srcImageLayout = vk::ImageLayout::eTransferSrcOptimal;
+        blit_info.dstImage = swapchain_image;
+        blit_info.dstImageLayout = vk::ImageLayout::eTransferDstOptimal;
+        blit_info.setRegions(region);
+        blit_info.filter = vk::Filter::eLinear;
+
+        // Barrier: TRANSFER_DST -> PRESENT_SRC (the scaled image stays a transfer source until the
+        // next frame moves it back).
+        vk::ImageMemoryBarrier2 to_present{};
+        to_present.srcStageMask = vk::PipelineStageFlagBits2::eBlit;
+        to_present.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+        to_present.dstStageMask = vk::PipelineStageFlagBits2::eBottomOfPipe;
+        to_present.dstAccessMask = vk::AccessFlagBits2::eNone;
+        to_present.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+        to_present.newLayout = vk::ImageLayout::ePresentSrcKHR;
+        to_present.srcQueueFamilyIndex = vk::QueueFamilyIgnored;
+        to_present.dstQueueFamilyIndex = vk::QueueFamilyIgnored;
+        to_present.image = swapchain_image;
+        to_present.subresourceRange = colour_range;
+        vk::DependencyInfo dep_to_present{};
+        dep_to_present.setImageMemoryBarriers(to_present);
+
+        m_profiler.begin(cmd, frame, GpuPhase::Upscale);
+        cmd.pipelineBarrier2(dep_to_blit);
+        cmd.blitImage2(blit_info);
+        if (to_present) {
+            cmd.pipelineBarrier2(dep_to_present);
+        }
+        m_profiler.end(cmd, frame, GpuPhase::Upscale);
+    }
+
+    void Renderer::recordCapture(const vk::raii::CommandBuffer& cmd, uint32_t frame, vk::Image image, uint32_t slot, vk::ImageLayout old_layout,
+        vk::PipelineStageFlags2 src_stage, vk::AccessFlags2 src_access, vk::ImageLayout new_layout) const
+    {
+        vk::ImageSubresourceRange colour_range{};
+        colour_range.aspectMask = vk::ImageAspectFlagBits::eColor;
+        colour_range.baseMipLevel = 0;
+        colour_range.levelCount = 1;
+        colour_range.baseArrayLayer = 0;
+        colour_range.layerCount = 1;
+
+        // Barriers: the frame's last write -> copy read, then the copy read -> new_layout (before a
+        // present, or before the next frame's colour writes into the offscreen image: WAR).
+        vk::ImageMemoryBarrier2 to_copy{};
+        to_copy.srcStageMask = src_stage;
+        to_copy.srcAccessMask = src_access;
+        to_copy.dstStageMask = vk::PipelineStageFlagBits2::eCopy;
+        to_copy.dstAccessMask = vk::AccessFlagBits2::eTransferRead;
+        to_copy.oldLayout = old_layout;
+        to_copy.newLayout = vk::ImageLayout::eTransferSrcOptimal;
+        to_copy.srcQueueFamilyIndex = vk::QueueFamilyIgnored;
+        to_copy.dstQueueFamilyIndex = vk::QueueFamilyIgnored;
+        to_copy.image = image;
+        to_copy.subresourceRange = colour_range;
+        vk::DependencyInfo dep_to_copy{};
+        dep_to_copy.setImageMemoryBarriers(to_copy);
+
+        // Tightly packed rows (bufferRowLength 0), as FrameCapture reads them.
+        vk::BufferImageCopy2 region{};
+        region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = vk::Extent3D{m_capture_extent.width, m_capture_extent.height, 1};
+        vk::CopyImageToBufferInfo2 copy_info{};
+        copy_info.srcImage = image;
+        copy_info.srcImageLayout = vk::ImageLayout::eTransferSrcOptimal;
+        copy_info.dstBuffer = vk::Buffer(m_capture_buffers[slot].buffer());
+        copy_info.setRegions(region);
+
+        // The copy's writes are made visible to the host by the frame's fence (and the invalidate
+        // before the writer reads them); only the image needs a barrier afterwards. Before a
+        // present it ends at the copy stage, which the render-finished semaphore then signals at.
+        vk::ImageMemoryBarrier2 from_copy{};
+        from_copy.srcStageMask = vk::PipelineStageFlagBits2::eCopy;
+        from_copy.srcAccessMask = vk::AccessFlagBits2::eNone;
+        from_copy.dstStageMask = m_headless ? vk::PipelineStageFlagBits2::eColorAttachmentOutput : vk::PipelineStageFlagBits2::eCopy;
+        from_copy.dstAccessMask = vk::AccessFlagBits2::eNone;
+        from_copy.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+        from_copy.newLayout = new_layout;
+        from_copy.srcQueueFamilyIndex = vk::QueueFamilyIgnored;
+        from_copy.dstQueueFamilyIndex = vk::QueueFamilyIgnored;
+        from_copy.image = image;
+        from_copy.subresourceRange = colour_range;
+        vk::DependencyInfo dep_from_copy{};
+        dep_from_copy.setImageMemoryBarriers(from_copy);
+
+        m_profiler.begin(cmd, frame, GpuPhase::Capture);
+        cmd.pipelineBarrier2(dep_to_copy);
+        cmd.copyImageToBuffer2(copy_info);
+        cmd.pipelineBarrier2(dep_from_copy);
+        m_profiler.end(cmd, frame, GpuPhase::Capture);
+    }
+
+    uint32_t Renderer::targetImageCount() const
+    {
+        return (m_headless || m_scaled) ? 1 : m_swapchain.imageCount();
+    }
+
+    uint32_t Renderer::presentImageCount() const
+    {
+        return m_headless ? 1 : m_swapchain.imageCount();
+    }
+
+    uint32_t Renderer::targetIndex(uint32_t image_index) const
+    {
+        return m_scaled ? 0 : image_index;
+    }
+
+    vk::PipelineStageFlags2 Renderer::presentStages() const
+    {
+        return m_scaled ? vk::PipelineStageFlagBits2::eBlit : vk::PipelineStageFlagBits2::eColorAttachmentOutput;
+    }
+
+    void Renderer::resetTargetContents()
+    {
+        m_target_preserved.assign(targetImageCount(), false);
+    }
+
+    uint32_t Renderer::ribbonSubdivisions(vk::Extent2D target_extent) const
+    {
+        if (m_ribbon_subdivisions != RIBBON_SUBDIVISIONS_AUTO) {
+            return m_ribbon_subdivisions;
+        }
+        // The rest length of the longest string's segments, measured along the longer side: a
+        // fixed fraction of the target, so the same batch is cut finer at a higher resolution.
+        float segment_px = STRING_LENGTH_NDC / static_cast<float>(m_node_count - 1) * 0.5f * static_cast<float>(std::max(target_extent.width, target_extent.height));
+        uint32_t pieces = static_cast<uint32_t>(std::ceil(segment_px / RIBBON_PIECE_PX));
+        return std::clamp(pieces, 1u, m_max_ribbon_subdivisions);
+    }
+
+    bool Renderer::partialRedraw() const
+    {
+        return m_partial_redraw && (targetImageCount() <= RIBBON_MAX_TARGET_IMAGES);
+    }
+
+    void Renderer::recordPrerecorded()
+    {
+        const vk::raii::Device& device = m_device.get();
+        uint32_t image_count = presentImageCount();
+
+        m_prerecorded_commands.clear();
+        m_prerecorded_compute.clear();
+        if (image_count == 0) {
+            return; // minimised: recorded again once the swapchain has a size.
+        }
+
+        vk::CommandBufferAllocateInfo alloc_info{};
+        alloc_info.commandPool = *m_command_pool;
+        alloc_info.level = vk::CommandBufferLevel::ePrimary;
+        alloc_info.commandBufferCount = m_state_slot_count * image_count;
+        m_prerecorded_commands = device.allocateCommandBuffers(alloc_info);
+        if (m_async_compute) {
+            vk::CommandBufferAllocateInfo compute_alloc_info{};
+            compute_alloc_info.commandPool = *m_compute_command_pool;
+            compute_alloc_info.level = vk::CommandBufferLevel::ePrimary;
+            compute_alloc_info.commandBufferCount = m_state_slot_count;
+            m_prerecorded_compute = device.allocateCommandBuffers(compute_alloc_info);
+        }
+
+        // Every recording for one frame-in-flight slot lays out the same timestamp scopes, so the
+        // profiler's bookkeeping after the last one describes whichever buffer is submitted.
+        for (uint32_t slot = 0; slot < m_state_slot_count; ++slot) {
+            uint32_t frame = slot % m_frames_in_flight;
+            m_profiler.beginFrame(frame);
+            if (m_async_compute) {
+                recordCompute(m_prerecorded_compute[slot], frame, slot, 0);
+            }
+            uint32_t compute_scopes = m_profiler.scopeCount(frame);
+            // With partial redraw, recorded for a preserved image: drawFrame() records an image's
+            // first frame itself.
+            for (uint32_t image = 0; image < image_count; ++image) {
+                m_profiler.rewind(frame, compute_scopes);
+                recordGraphics(m_prerecorded_commands[slot * image_count + image], frame, image, slot, !m_async_compute, 0, partialRedraw(), NO_CAPTURE_SLOT);
+            }
+        }
+    }
+
+    void Renderer::latchCursor(uint32_t width, uint32_t height, int32_t cursor_x, int32_t cursor_y, uint64_t time_us)
+    {
+        if (m_cursor_trail_data == nullptr) {
+            return;
+        }
+        // Fill the slot after the newest, then publish it. The position is one 64-bit store (see
+        // packNdc()) so the GPU never sees x and y from different positions, and a dispatch reading while this runs sees
+        // the previous newest sample, intact: the slot being written is the oldest, which it only
+        // reaches after CURSOR_TRAIL_LENGTH samples in one dispatch. The memory is HOST_COHERENT,
+        // so no flush is needed. A store after a submit is outside Vulkan's host-write ordering,
+        // which is the point: a dispatch reads whichever samples are newest when it runs.
+        if (m_input_recorder != nullptr) {
+            m_input_recorder->recordCursor(width, height, cursor_x, cursor_y, time_us);
+        }
+        MathLib::Vec2 ndc = cursorToNdc(width, height, cursor_x, cursor_y);
+        uint32_t next = m_cursor_newest + 1;
+        CursorSample& sample = m_cursor_trail_data->samples[next % CURSOR_TRAIL_LENGTH];
+        std::atomic_ref<uint64_t>(sample.position).store(packNdc(ndc), std::memory_order_relaxed);
+        std::atomic_ref<uint32_t>(sample.time_us).store(static_cast<uint32_t>(time_us), std::memory_order_relaxed);
+        std::atomic_ref<uint32_t>(m_cursor_trail_data->newest).store(next, std::memory_order_release);
+        m_cursor_newest = next;
+    }
+
+    uint64_t Renderer::nowMicroseconds()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    uint64_t Renderer::trailTimeNow(float lag_s)
+    {
+        return nowMicroseconds() - static_cast<uint64_t>(lag_s * 1000000.0f);
+    }
+
+    void Renderer::writeFrameParams(uint32_t write_slot, uint32_t substeps, uint64_t trail_time_us)
+    {
+        uint32_t node_groups = physicsGroupCount(m_node_count * m_string_count);
+        uint32_t constraint_groups = physicsGroupCount((m_node_count / 2) * m_string_count);
+
+        FrameParams params{};
+        params.dt = FIXED_TIMESTEP;
+        params.substeps = substeps;
+        params.time_us = static_cast<uint32_t>(trail_time_us);
+        for (uint32_t step = 0; step < PHYSICS_MAX_SUBSTEPS; ++step) {
+            bool due = (step < substeps);
+            params.integrate_groups[step] = vk::DispatchIndirectCommand{due ? node_groups : 0, 1, 1};
+            params.constrain_groups[step] = vk::DispatchIndirectCommand{due ? constraint_groups : 0, 1, 1};
+            params.grid_scan_groups[step] = vk::DispatchIndirectCommand{due ? (m_grid_cells / PHYSICS_GRID_SCAN_BLOCK) : 0, 1, 1};
+            params.grid_total_groups[step] = vk::DispatchIndirectCommand{(due && (m_grid_cells > 0)) ? 1u : 0u, 1, 1};
+        }
+        m_allocator.writeMapped(m_frame_params[write_slot], &params, sizeof(FrameParams));
+    }
+
+    bool Renderer::physicsTick(float dt)
+    {
+        TRACE_ZONE("Renderer::physicsTick");
+        uint32_t substeps = takeSubsteps(m_tick_accumulator, dt);
+        if (substeps == 0) {
+            return true;
+        }
+
+        std::chrono::steady_clock::time_point tick_start = std::chrono::steady_clock::now();
+        try {
+            // The slot after the newest, its newest reader, and the frame this tick counts as after.
+            uint32_t write_slot = 0;
+            uint64_t reader_frame = 0;
+            uint64_t frame_serial = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_simulation_mutex);
+                write_slot = (m_simulation.newest_slot + 1) % m_state_slot_count;
+                reader_frame = m_simulation.slot_reader[write_slot];
+                frame_serial = m_simulation.frame_serial;
+            }
+            uint32_t cursor_newest = std::atomic_ref<uint32_t>(m_cursor_trail_data->newest).load(std::memory_order_acquire);
+
+            // The slot's parameters and state are rewritten below, so the last frame drawing it must
+            // be done. It is the one before last at most, so this rarely waits.
+            if (reader_frame > 0) {
+                TRACE_ZONE("wait for reader");
+                vk::Semaphore frame_timeline = *m_frame_timeline;
+                vk::SemaphoreWaitInfo reader_wait{};
+                reader_wait.setSemaphores(frame_timeline);
+                reader_wait.setValues(reader_frame);
+                (void)m_device.get().waitSemaphores(reader_wait, UINT64_MAX);
+            }
+
+            writeFrameParams(write_slot, substeps, trailTimeNow(m_tick_accumulator));
+            const vk::raii::CommandBuffer& cmd = m_physics_command_buffers.front();
+            cmd.reset();
+            cmd.begin(vk::CommandBufferBeginInfo{});
+            recordPhysics(cmd, write_slot, substeps);
+            recordMotion(cmd, m_physics_motion_readback);
             cmd.end();
 
-            // 3. Submit.
+            // Signals the tick's value once its motion has been copied out.
+            uint64_t tick_value = m_tick_value + 1;
+            vk::SemaphoreSubmitInfo tick_signal{};
+            tick_signal.semaphore = *m_physics_timeline;
+            tick_signal.value = tick_value;
+            tick_signal.stageMask = vk::PipelineStageFlagBits2::eAllCommands;
             vk::CommandBufferSubmitInfo cmd_submit{};
             cmd_submit.commandBuffer = *cmd;
+            vk::SubmitInfo2 submit{};
+            submit.setCommandBufferInfos(cmd_submit);
+            submit.setSignalSemaphoreInfos(tick_signal);
+            {
+                TRACE_ZONE("submit");
+                std::unique_lock<std::mutex> queue_lock = m_physics_queue_shared ? std::unique_lock<std::mutex>(m_queue_mutex) : std::unique_lock<std::mutex>{};
+                (m_async_compute ? m_device.computeQueue() : m_device.graphicsQueue()).submit2(submit);
+            }
+            m_tick_value = tick_value;
+
+            // Published only once finished, so a frame never waits for a tick on the GPU.
+            vk::Semaphore timeline = *m_physics_timeline;
+            vk::SemaphoreWaitInfo wait_info{};
+            wait_info.setSemaphores(timeline);
+            wait_info.setValues(tick_value);
+            {
+                TRACE_ZONE("wait for tick");
+                (void)m_device.get().waitSemaphores(wait_info, UINT64_MAX);
+            }
+            MotionStats motion{};
+            m_motion_arena.invalidate(m_physics_motion_readback);
+            std::memcpy(&motion, m_physics_motion_readback.mapped, sizeof(MotionStats));
+            {
+                std::lock_guard<std::mutex> lock(m_simulation_mutex);
+                m_simulation.newest_slot = write_slot;
+                m_simulation.newest_value = tick_value;
+                m_simulation.motion = motion;
+                m_simulation.motion_frame = frame_serial;
+            }
+            m_stats.add(FrameCounter::PhysicsTicks);
+            m_stats.recordMs(FrameHistogram::PhysicsTick, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - tick_start).count());
+
+            // Still moving, or the cursor moved while the tick ran (the next one follows it).
+            return (motion.max_speed >= m_physics_settle_speed) || (std::atomic_ref<uint32_t>(m_cursor_trail_data->newest).load(std::memory_order_acquire) != cursor_newest);
+        } catch (const vk::SystemError& e) {
+            // Idle until the next frame tries again: a lasting failure (device lost) would repeat every tick.
+            if (m_logger) {
+                LOG_THROTTLED(*m_logger, Error, "Physics tick failed: {}", e.what());
+            }
+            return false;
+        }
+    }
+
+    void Renderer::collectMotion()
+    {
+        uint64_t frame = m_motion_readback_frame[m_current_frame];
+        if (frame == 0) {
+            return;
+        }
+        const ArenaAllocation& readback = m_motion_readbacks[m_current_frame];
+        m_motion_arena.invalidate(readback);
+        std::memcpy(&m_last_motion, readback.mapped, sizeof(MotionStats));
+        m_last_motion_frame = frame;
+        m_motion_readback_frame[m_current_frame] = 0;
+    }
+
+    void Renderer::collectTimings()
+    {
+        PendingTimings& pending = m_pending_timings[m_current_frame];
+        if (pending.frame == 0) {
+            return;
+        }
+
+        FrameTimings timings{};
+        timings.cpu_record_ms = pending.cpu_record_ms;
+        timings.present_latency_ms = m_present_latency_ms;
+        GpuFrameProfile profile{};
+        if (m_profiler.collect(m_current_frame, profile)) {
+            timings.gpu_physics_ms = profile.phase_ms[static_cast<uint32_t>(GpuPhase::Physics)];
+            timings.gpu_frame_ms = profile.frame_ms;
+        }
+        m_last_timings = timings;
+        m_last_timings_frame = pending.frame;
+        pending.frame = 0;
+        adjustRenderScale();
 
-            vk::SemaphoreSubmitInfo wait_submit{};
-            wait_submit.semaphore = *m_image_available[m_current_frame];
-            wait_submit.stageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput;
+        if (profile.frame_ms > 0.0f) {
+            m_stats.recordMs(FrameHistogram::GpuFrame, profile.frame_ms);
+        }
+
+        // The summary is only built where Info is compiled in.
+        if constexpr (LoggingLib::severityEnabled(LoggingLib::Severity::Info)) {
+            if ((m_profile_log_interval > 0) && m_profiler.active() && ((m_last_timings_frame % m_profile_log_interval) == 0)) {
+                std::ostringstream line;
+                line << m_profiler.summary();
+                if (m_present_wait) {
+                    line.setf(std::ios::fixed);
+                    line.precision(3);
+                    line << "; present latency " << m_present_latency_ms << " ms";
+                }
+                m_logger->logInfo(line.str());
+            }
+        }
+    }
 
-            vk::SemaphoreSubmitInfo signal_submit{};
-            signal_submit.semaphore = *m_render_finished[image_index];
-            signal_submit.stageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput;
+    void Renderer::collectCapture(uint32_t frame)
+    {
+        uint32_t slot = m_capture_pending[frame];
+        if (slot == NO_CAPTURE_SLOT) {
+            return;
+        }
+        m_allocator.invalidateMapped(m_capture_buffers[slot], static_cast<VkDeviceSize>(m_capture_extent.width) * m_capture_extent.height * 4);
+        m_capture.submit(slot);
+        m_capture_pending[frame] = NO_CAPTURE_SLOT;
+    }
+
+    void Renderer::logStats(std::chrono::steady_clock::time_point now)
+    {
+        // The summary is only built where Info is compiled in.
+        if constexpr (LoggingLib::severityEnabled(LoggingLib::Severity::Info)) {
+            if ((m_stats_log_interval == std::chrono::steady_clock::duration::zero()) || ((now - m_stats_logged_at) < m_stats_log_interval)) {
+                return;
+            }
+            FrameStatsSnapshot current = m_stats.snapshot();
+            HeapBudget video_memory = m_allocator.memoryBudget().deviceLocal();
+            std::ostringstream memory_line;
+            memory_line.setf(std::ios::fixed);
+            memory_line.precision(1);
+            memory_line << "; device-local memory " << (static_cast<double>(video_memory.usage) / MemoryBudget::BYTES_PER_MIB) << " / "
+                        << (static_cast<double>(video_memory.budget) / MemoryBudget::BYTES_PER_MIB) << " MiB";
+            m_logger->logInfo(current.since(m_stats_logged).summary() + memory_line.str());
+            m_stats_logged = current;
+            m_stats_logged_at = now;
+        }
+    }
+
+    void Renderer::resolvePresentLatency(uint64_t timeout_ns)
+    {
+        if (m_latency_present_id == 0) {
+            return;
+        }
+        vk::Result result = m_swapchain.get().waitForPresent(m_latency_present_id, timeout_ns);
+        if ((result == vk::Result::eSuccess) || (result == vk::Result::eSuboptimalKHR)) {
+            m_present_latency_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_latency_start).count();
+            m_latency_present_id = 0;
+        }
+    }
+
+    void Renderer::paceFrame()
+    {
+        if (!m_initialised || !m_present_wait || (m_latency != PresentLatency::Paced) || (m_present_id == 0)) {
+            return;
+        }
+
+        TRACE_ZONE("Renderer::paceFrame");
+        try {
+            // FIFO queues a finished frame behind those already waiting for a vblank. Waiting for
+            // the newest present to reach the display keeps at most one frame queued, so input
+            // taken after this returns is shown at the next vblank but one at worst.
+            (void)m_swapchain.get().waitForPresent(m_present_id, PACE_TIMEOUT_NS);
+            resolvePresentLatency(0);
+        } catch (const vk::SystemError&) {
+            // Out of date or surface lost: drawFrame() recreates the swapchain.
+        }
+    }
+
+    void Renderer::drawFrame(uint32_t width, uint32_t height, float dt, uint64_t trail_time_us)
+    {
+        TRACE_ZONE("Renderer::drawFrame");
+        if (!m_initialised) {
+            return;
+        }
+        std::chrono::steady_clock::time_point frame_start = std::chrono::steady_clock::now();
+
+        // The present thread's presents report a stale swapchain here, a frame late; a lasting
+        // failure (device lost) repeats every frame, as below.
+        bool present_stale = false;
+        if (m_present_thread.running()) {
+            vk::Result present_result = m_present_thread.takePresentResult();
+            present_stale = (present_result == vk::Result::eSuboptimalKHR) || (present_result == vk::Result::eErrorOutOfDateKHR);
+            if (!present_stale && (present_result != vk::Result::eSuccess)) {
+                m_stats.add(FrameCounter::FrameFailures);
+                if (m_logger) {
+                    LOG_THROTTLED(*m_logger, Error, "Present failed: {}", vk::to_string(present_result));
+                }
+            }
+        }
+
+        // A resize rebuilds the swapchain at the newest size before the frame, so however many
+        // resize events arrived since the last one, it is rebuilt once.
+        if (!m_headless && (present_stale || !m_swapchain.isBuiltFor(width, height))) {
+            try {
+                recreateSwapchain(width, height);
+            } catch (const vk::SystemError&) {
+                // Not presentable at this size yet; try again next frame.
+                return;
+            }
+        }
+        if (!m_headless && m_swapchain.isZeroExtent()) {
+            return;
+        }
+
+        try {
+            const vk::raii::Device& device = m_device.get();
+
+            // 1. Wait for the frame that last used this frame-in-flight slot (m_frames_in_flight
+            //    frames back) to finish, freeing its command buffer and semaphore.
+            std::chrono::steady_clock::time_point fence_start = std::chrono::steady_clock::now();
+            {
+                TRACE_ZONE("fence wait");
+                (void)device.waitForFences({*m_in_flight[m_current_frame]}, vk::True, UINT64_MAX);
+            }
+            std::chrono::steady_clock::time_point fence_end = std::chrono::steady_clock::now();
+            // The slot's semaphore is free again: the present thread acquires into it while the
+            // readbacks below are collected. A frame that failed before picking its image up
+            // left the request outstanding, and picks that one up instead.
+            if (m_present_thread.running() && !m_acquire_pending) {
+                m_present_thread.requestAcquire(*m_image_available[m_current_frame]);
+                m_acquire_pending = true;
+            }
+            m_stats.record(FrameHistogram::FenceWait, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(fence_end - fence_start).count()));
+            m_stats.recordMs(FrameHistogram::Interval, dt * 1000.0f);
+            // Frames complete in submission order, so every frame up to that one is done.
+            m_swapchain.releaseRetired(m_slot_frame[m_current_frame]);
+            m_allocator.setCurrentFrame(m_frame_serial + 1);
+            if (m_present_wait) {
+                resolvePresentLatency(0);
+            }
+            collectMotion();
+            collectTimings();
+            collectCapture(m_current_frame);
+            logStats(fence_end);
+            std::chrono::steady_clock::time_point record_start = std::chrono::steady_clock::now();
+
+            // 2. Acquire (throws vk::OutOfDateKHRError if the swapchain is stale), or pick up the
+            //    present thread's. Headless frames always render into the one offscreen image.
+            uint32_t image_index = 0;
+            bool suboptimal = false;
+            if (m_present_thread.running()) {
+                TRACE_ZONE("wait for image");
+                AcquiredImage acquired = m_present_thread.waitAcquired();
+                m_acquire_pending = false;
+                if (acquired.result == vk::Result::eErrorOutOfDateKHR) {
+                    throw vk::OutOfDateKHRError("vkAcquireNextImageKHR");
+                }
+                if ((acquired.result != vk::Result::eSuccess) && (acquired.result != vk::Result::eSuboptimalKHR)) {
+                    throw vk::SystemError(vk::make_error_code(acquired.result), "vkAcquireNextImageKHR");
+                }
+                image_index = acquired.image_index;
+                suboptimal = (acquired.result == vk::Result::eSuboptimalKHR);
+            } else if (!m_headless) {
+                TRACE_ZONE("acquireNextImage");
+                vk::ResultValue<uint32_t> acquire = m_swapchain.get().acquireNextImage(UINT64_MAX, *m_image_available[m_current_frame]);
+                image_index = acquire.value;
+                suboptimal = (acquire.result == vk::Result::eSuboptimalKHR);
+            }
+
+            device.resetFences({*m_in_flight[m_current_frame]});
+
+            // --- Physics: advance the fixed-timestep accumulator by the (clamped) frame time and
+            // dispatch the whole substeps it now holds; the remainder carries to the next frame.
+            // This and the trail time are what a recording must reproduce, so it records the frame
+            // here (a replay passes its recorded trail time back in). With the
+            // physics thread the frame only draws the newest slot a tick has finished, holding the
+            // ring until its submit is recorded as that slot's reader (see the header).
+            uint32_t substeps = 0;
+            uint32_t draw_slot = m_state_slot;
+            uint64_t physics_wait_value = 0; // Timeline value the graphics submit waits for (0: none).
+            std::unique_lock<std::mutex> simulation_lock;
+            if (m_physics_threaded) {
+                simulation_lock = std::unique_lock<std::mutex>(m_simulation_mutex);
+                draw_slot = m_simulation.newest_slot;
+                physics_wait_value = m_simulation.newest_value;
+                if (m_simulation.newest_value > 0) {
+                    m_last_motion = m_simulation.motion;
+                    m_last_motion_frame = m_simulation.motion_frame;
+                }
+            } else {
+                substeps = takeSubsteps(m_accumulator, dt);
+                if (trail_time_us == 0) {
+                    trail_time_us = trailTimeNow(m_accumulator);
+                }
+                if (m_input_recorder != nullptr) {
+                    m_input_recorder->recordFrame(dt, trail_time_us);
+                }
+            }
+
+            // The newest state slot is drawn; a simulating frame writes the next slot and draws
+            // that. Pre-recorded frames always simulate (see the ring comment in the header).
+            bool simulate = !m_physics_threaded && (m_prerecorded || (substeps > 0));
+            if (simulate) {
+                draw_slot = (m_state_slot + 1) % m_state_slot_count;
+                writeFrameParams(draw_slot, substeps, trail_time_us);
+            }
+
+            // 3. Record — or pick the recorded buffers of this slot and image. An image not yet
+            //    drawn since (re)creation has no recorded erase box and must be cleared, so its
+            //    first frame is recorded here like any other (the same commands bar the clear).
+            bool preserved = partialRedraw() && m_target_preserved[targetIndex(image_index)];
+            const vk::raii::CommandBuffer* cmd = &m_command_buffers[m_current_frame];
+            const vk::raii::CommandBuffer* compute_cmd = nullptr;
+            if (m_prerecorded && (preserved == partialRedraw())) {
+                cmd = &m_prerecorded_commands[draw_slot * presentImageCount() + image_index];
+                if (m_async_compute) {
+                    compute_cmd = &m_prerecorded_compute[draw_slot];
+                }
+            } else {
+                TRACE_ZONE("record");
+                // A frame is captured into a free readback slot, or counted as dropped: the
+                // writer's backlog never holds up the frame. It is stamped with the trail time of
+                // what it shows (so a replay captures the recorded timing), or the time it is drawn.
+                uint32_t capture_slot = NO_CAPTURE_SLOT;
+                if (m_capture.isOpen()) {
+                    vk::Extent2D extent = m_headless ? m_offscreen_extent : m_swapchain.extent();
+                    bool same_size = (extent.width == m_capture_extent.width) && (extent.height == m_capture_extent.height);
+                    if (!same_size) {
+                        m_capture.drop();
+                    }
+                    if (!same_size || !m_capture.acquire((trail_time_us != 0) ? trail_time_us : nowMicroseconds(), capture_slot)) {
+                        capture_slot = NO_CAPTURE_SLOT;
+                        m_stats.add(FrameCounter::CaptureDrops);
+                    }
+                }
+                m_capture_pending[m_current_frame] = capture_slot;
+
+                m_profiler.beginFrame(m_current_frame);
+                if (simulate && m_async_compute) {
+                    compute_cmd = &m_compute_command_buffers[m_current_frame];
+                    recordCompute(*compute_cmd, m_current_frame, draw_slot, substeps);
+                }
+                recordGraphics(*cmd, m_current_frame, image_index, draw_slot, simulate && !m_async_compute, substeps, preserved, capture_slot);
+            }
+
+            // 4. Submit: the async physics first, where it runs this frame.
+            if (compute_cmd != nullptr) {
+                // Submitted first on the compute queue: it runs alongside the previous frame's
+                // rasterisation and present, and signals the timeline when done.
+                physics_wait_value = m_physics_value + 1;
+                vk::CommandBufferSubmitInfo compute_submit{};
+                compute_submit.commandBuffer = **compute_cmd;
+                vk::SemaphoreSubmitInfo timeline_signal{};
+                timeline_signal.semaphore = *m_physics_timeline;
+                timeline_signal.value = physics_wait_value;
+                timeline_signal.stageMask = vk::PipelineStageFlagBits2::eComputeShader;
+                vk::SubmitInfo2 submit{};
+                submit.setCommandBufferInfos(compute_submit);
+                submit.setSignalSemaphoreInfos(timeline_signal);
+                std::unique_lock<std::mutex> queue_lock = lockSharedQueue();
+                m_device.computeQueue().submit2(submit);
+                m_physics_value = physics_wait_value;
+            }
+
+            vk::CommandBufferSubmitInfo cmd_submit{};
+            cmd_submit.commandBuffer = **cmd;
+
+            std::array<vk::SemaphoreSubmitInfo, 2> wait_submits{};
+            uint32_t wait_count = 0;
+            if (!m_headless) {
+                wait_submits[wait_count].semaphore = *m_image_available[m_current_frame];
+                wait_submits[wait_count].stageMask = presentStages();
+                ++wait_count;
+            }
+            if (physics_wait_value > 0) {
+                // The async physics handoff: the ribbon expansion waits for this frame's compute
+                // submit, or the physics thread's tick. The semaphore wait is also the memory
+                // dependency (the buffers are shared concurrently, so no ownership transfer is needed).
+                wait_submits[wait_count].semaphore = *m_physics_timeline;
+                wait_submits[wait_count].value = physics_wait_value;
+                wait_submits[wait_count].stageMask = vk::PipelineStageFlagBits2::eComputeShader;
+                ++wait_count;
+            }
+
+            std::array<vk::SemaphoreSubmitInfo, 2> signal_submits{};
+            uint32_t signal_count = 0;
+            if (!m_headless) {
+                signal_submits[signal_count].semaphore = *m_swapchain.renderFinished(image_index);
+                signal_submits[signal_count].stageMask = presentStages();
+                if (m_capture_pending[m_current_frame] != NO_CAPTURE_SLOT) {
+                    signal_submits[signal_count].stageMask |= vk::PipelineStageFlagBits2::eCopy;
+                }
+                ++signal_count;
+            }
+            if (m_physics_threaded) {
+                // Tells the physics thread when this frame no longer reads its slot.
+                signal_submits[signal_count].semaphore = *m_frame_timeline;
+                signal_submits[signal_count].value = m_frame_serial + 1;
+                signal_submits[signal_count].stageMask = vk::PipelineStageFlagBits2::eAllCommands;
+                ++signal_count;
+            }
 
             vk::SubmitInfo2 submit{};
-            submit.setWaitSemaphoreInfos(wait_submit);
+            submit.waitSemaphoreInfoCount = wait_count;
+            submit.pWaitSemaphoreInfos = wait_submits.data();
             submit.setCommandBufferInfos(cmd_submit);
-            submit.setSignalSemaphoreInfos(signal_submit);
+            submit.signalSemaphoreInfoCount = signal_count;
+            submit.pSignalSemaphoreInfos = signal_submits.data();
 
-            m_device.graphicsQueue().submit2(submit, *m_in_flight[m_current_frame]);
+            {
+                TRACE_ZONE("submit");
+                std::unique_lock<std::mutex> queue_lock = lockSharedQueue();
+                m_device.graphicsQueue().submit2(submit, *m_in_flight[m_current_frame]);
+            }
+            m_target_preserved[targetIndex(image_index)] = true;
+            m_state_slot = draw_slot;
+            ++m_frame_serial;
+            m_slot_frame[m_current_frame] = m_frame_serial;
+            if (simulation_lock.owns_lock()) {
+                m_simulation.slot_reader[draw_slot] = m_frame_serial;
+                m_simulation.frame_serial = m_frame_serial;
+                simulation_lock.unlock();
+                m_physics_thread.wake();
+            }
+            if (simulate) {
+                m_motion_readback_frame[m_current_frame] = m_frame_serial;
+            }
+            PendingTimings& pending = m_pending_timings[m_current_frame];
+            pending.frame = m_frame_serial;
+            pending.cpu_record_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - record_start).count();
+            m_stats.add(FrameCounter::Frames);
+            m_stats.recordMs(FrameHistogram::CpuRecord, pending.cpu_record_ms);
+            // Advanced before present, so a present that throws still leaves the frame-in-flight
+            // slot in step with the state slot.
+            m_current_frame = (m_current_frame + 1) % m_frames_in_flight;
+
+            if (m_headless) {
+                return;
+            }
 
-            // 4. Present.
+            // 5. Present — on the present thread, which the frame does not wait for. A suboptimal
+            //    acquire still recreates after the present (recreateSwapchain() drains the thread).
+            if (m_present_thread.running()) {
+                m_present_thread.requestPresent(image_index);
+                if (suboptimal) {
+                    recreateSwapchain(width, height);
+                }
+                return;
+            }
             vk::SwapchainKHR swapchain_handle = *m_swapchain.get();
-            vk::Semaphore render_finished = *m_render_finished[image_index];
+            vk::Semaphore render_finished = *m_swapchain.renderFinished(image_index);
             vk::PresentInfoKHR present_info{};
             present_info.setWaitSemaphores(render_finished);
             present_info.setSwapchains(swapchain_handle);
             present_info.setImageIndices(image_index);
 
-            vk::Result present_result = m_device.presentQueue().presentKHR(present_info);
+            // Present ids (present wait): tag the present so paceFrame() can wait for it, and
+            // time it if no other measurement is pending.
+            uint64_t present_id = m_present_id + 1;
+            vk::PresentIdKHR present_id_info{};
+            if (m_present_wait) {
+                present_id_info.setPresentIds(present_id);
+                present_info.setPNext(&present_id_info);
+            }
+
+            // Present fences (swapchain maintenance): tell when this present no longer needs the
+            // swapchain, so a retired one is destroyed without waiting for the device.
+            vk::Fence present_fence = m_swapchain.presentFence(image_index);
+            vk::SwapchainPresentFenceInfoEXT present_fence_info{};
+            if (present_fence) {
+                present_fence_info.setFences(present_fence);
+                present_fence_info.pNext = present_info.pNext;
+                present_info.setPNext(&present_fence_info);
+            }
+
+            vk::Result present_result = vk::Result::eSuccess;
+            {
+                TRACE_ZONE("presentKHR");
+                present_result = m_device.presentQueue().presentKHR(present_info);
+            }
+            if (m_present_wait) {
+                m_present_id = present_id;
+                if (m_latency_present_id == 0) {
+                    m_latency_present_id = present_id;
+                    m_latency_start = frame_start;
+                }
+            }
             if (suboptimal || (present_result == vk::Result::eSuboptimalKHR)) {
                 recreateSwapchain(width, height);
             }
-
-            m_current_frame = (m_current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
         } catch (const vk::OutOfDateKHRError&) {
             try {
                 recreateSwapchain(width, height);
             } catch (const vk::SystemError& e) {
                 if (m_logger) {
-                    m_logger->logError(std::string("Failed to recreate swapchain: ") + e.what());
+                    LOG_THROTTLED(*m_logger, Error, "Failed to recreate swapchain: {}", e.what());
                 }
             }
         } catch (const vk::SystemError& e) {
+            // A lasting failure (device lost) repeats every frame: one line a second is plenty.
+            m_stats.add(FrameCounter::FrameFailures);
             if (m_logger) {
-                m_logger->logError(std::string("Frame render failed: ") + e.what());
+                LOG_THROTTLED(*m_logger, Error, "Frame render failed: {}", e.what());
             }
         }
     }
 
     void Renderer::destroy()
     {
+        // The device wait below needs every queue to itself.
+        m_physics_thread.stop();
+        m_physics_queue_shared = false;
+        m_physics_threaded = false;
+        m_present_thread.stop();
+        m_acquire_pending = false;
+        m_present_queue_shared = false;
         try {
             if (*m_device.get()) {
                 m_device.get().waitIdle();
@@ -436,19 +2348,69 @@ namespace Engine
             // Already failing; proceed with teardown regardless.
         }
 
+        // The device is idle: the frames still in flight, oldest first, are the capture's last.
+        if (m_capture.isOpen()) {
+            for (uint32_t i = 0; i < m_frames_in_flight; ++i) {
+                collectCapture((m_current_frame + i) % m_frames_in_flight);
+            }
+            std::string capture_error;
+            if (!m_capture.close(capture_error)) {
+                LOG_WARNING(*m_logger, capture_error);
+            }
+            LOG_INFO(*m_logger, "Captured {} frames ({} dropped).", m_capture.framesWritten(), m_capture.framesDropped());
+        }
+
+        // Write the cache back only after a complete init, so a half-built one never replaces a good file.
+        std::string cache_error;
+        if (m_initialised && !m_pipeline_cache.save(cache_error)) {
+            LOG_WARNING(*m_logger, cache_error);
+        }
+
         // Reverse construction order. Assigning nullptr to a vk::raii handle destroys it.
         m_in_flight.clear();
-        m_render_finished.clear();
         m_image_available.clear();
+        m_frame_timeline = nullptr;
+        m_physics_timeline = nullptr;
+        m_physics_command_buffers.clear();
+        m_physics_command_pool = nullptr;
+        m_prerecorded_compute.clear();
+        m_prerecorded_commands.clear();
+        m_compute_command_buffers.clear();
+        m_compute_command_pool = nullptr;
         m_command_buffers.clear();
         m_command_pool = nullptr;
-        m_descriptor_set = nullptr;
+        m_ribbon_sets.clear();
+        m_descriptor_sets.clear();
         m_descriptor_pool = nullptr;
+        m_profiler.destroy();
         m_compute_pipeline.destroy();
         m_pipeline.destroy();
+        m_pipeline_cache.destroy();
         m_swapchain.destroy();
-        m_prev_positions = AllocatedBuffer{}; // free while the allocator is still alive.
-        m_positions = AllocatedBuffer{};
+        m_offscreen_view = nullptr;
+        m_offscreen_image = AllocatedImage{}; // free while the allocator is still alive.
+        m_scaled_view = nullptr;
+        m_scaled_image = AllocatedImage{};
+        m_scaled_capacity = vk::Extent2D{};
+        m_capture_buffers.clear();
+        m_capture_pool = AllocatedPool{}; // after its buffers.
+        m_motion_readbacks.clear();
+        m_physics_motion_readback = ArenaAllocation{};
+        m_motion_arena.destroy();
+        m_motion = AllocatedBuffer{};
+        m_motion_partials = AllocatedBuffer{};
+        m_ribbon.clear();
+        m_grid_entries = AllocatedBuffer{};
+        m_grid_node_cells = AllocatedBuffer{};
+        m_grid = AllocatedBuffer{};
+        m_obstacles = AllocatedBuffer{};
+        m_cursor_trail_data = nullptr;
+        m_cursor_trail = AllocatedBuffer{};
+        m_frame_params.clear();
+        m_ribbon_draws.clear();
+        m_string_params = AllocatedBuffer{};
+        m_prev_positions.clear();
+        m_positions.clear();
         m_allocator.destroy();
         m_device.destroy();
         m_surface = nullptr;
@@ -17,24 +17,134 @@
 #include "allocator.hpp"
 #include "compute_pipeline.hpp"
 #include "device.hpp"
+#include "frame_capture.hpp"
+#include "frame_stats.hpp"
+#include "gpu_profiler.hpp"
+#include "input_recording.hpp"
 #include "instance.hpp"
 #include "native_window_handle.hpp"
 #include "pipeline.hpp"
+#include "physics_thread.hpp"
+#include "pipeline_cache.hpp"
+#include "present_thread.hpp"
 #include "swapchain.hpp"
 #include <log/logger.hpp>
 #include <math/vector.hpp>
 #include <vulkan/vulkan_raii.hpp>
 #include <array>
+#include <chrono>
 #include <cstdint>
+#include <mutex>
+#include <span>
 #include <string>
 #include <vector>
 
 namespace Engine
 {
 
-    //! Composition root for the Vulkan back end. The string is simulated on the GPU by a
-    //! compute shader (Verlet + distance constraints) writing the positions buffer, which the
-    //! graphics pipeline then draws as a line strip.
+    //! Renderer settings chosen at start-up.
+    struct RendererConfig {
+        //! Nodes (points) per string. Strings of up to PHYSICS_WORKGROUP_SIZE nodes are solved one
+        //! workgroup per string; longer ones use the tiled multi-workgroup solver.
+        uint32_t node_count{128};
+        //! Strings simulated and drawn as one batch (one dispatch, one multi-draw).
+        uint32_t string_count{1};
+        //! Frames the CPU may record ahead of the GPU (1 serialises recording with execution).
+        uint32_t frames_in_flight{2};
+        //! Run the physics on a dedicated compute queue, where the device has one, so it overlaps
+        //! the previous frame's rasterisation and present.
+        bool async_compute{false};
+        //! Constraint relaxation iterations per substep (4 substeps x 6 = 24 per 60 Hz frame).
+        uint32_t constraint_iterations{6};
+        //! Render into an offscreen image instead of a window: no surface, swapchain or present
+        //! (the window handle passed to init() is ignored). Used by the benchmark.
+        bool headless{false};
+        //! Which GPU to use (see GpuSelection). GpuPreference::HighPerformance ranks by the scores
+        //! in the per-user cache directory (GPU_SCORES_FILE_NAME) when every candidate has one.
+        GpuSelection gpu{};
+        //! Log the rolling GPU phase timings every this many frames (0: never).
+        uint32_t profile_log_interval{0};
+        //! Log a FrameStats summary of the preceding interval every this many seconds, with the
+        //! first frame drawn after each interval has passed (0: never).
+        float stats_log_interval_s{0.0f};
+        //! Record the frame command buffers once per state slot and swapchain image (again only
+        //! when the swapchain is recreated) and replay them, so a frame costs a parameter write
+        //! and a submit. Every frame then runs the physics passes, copying the state forward when
+        //! no substep is due.
+        bool prerecorded{false};
+        //! Present mode and pacing (see PresentLatency). Paced falls back to plain FIFO where the
+        //! device lacks present wait. Ignored when headless.
+        PresentLatency latency{PresentLatency::Vsync};
+        //! Acquire and present on a dedicated thread (see PresentThread), so recording and submitting
+        //! never wait for the display. Frames are then not paced and present latency is not
+        //! measured (present wait would race that thread's presents). Ignored when headless.
+        bool present_thread{false};
+        //! Simulate on a thread of its own (see PhysicsThread) at physics_rate_hz, on the compute
+        //! queue where the device has one, and draw the newest state it has finished: the motion then
+        //! no longer depends on when, or whether, frames are drawn. Frames are not pre-recorded with
+        //! it. Ignored when headless.
+        bool physics_thread{false};
+        //! Ticks per second of the physics thread, in [Renderer::MIN_PHYSICS_RATE, Renderer::MAX_PHYSICS_RATE];
+        //! each tick runs the fixed substeps its interval holds.
+        float physics_rate_hz{120.0f};
+        //! The physics thread idles once a tick measures every node slower than this (NDC / s) and
+        //! no cursor sample arrived during it, until the next drawFrame().
+        float physics_settle_speed{0.005f};
+        //! Seed pipeline creation from, and save it back on destroy() to, a pipeline cache file
+        //! in the per-user cache directory (see userCacheDirectory()).
+        bool pipeline_cache{true};
+        //! Load each target image as it was last drawn and repaint only the box the string covered
+        //! there (erased on the GPU) instead of clearing the whole image every frame. An image is
+        //! cleared in full the first time it is drawn after (re)creation.
+        bool partial_redraw{true};
+        //! Fraction of the window resolution the strings are drawn at, in [Renderer::MIN_RENDER_SCALE,
+        //! 1], into an offscreen image blitted (bilinear) up to the swapchain image; 1 draws
+        //! straight into the swapchain image. Renderer::RENDER_SCALE_AUTO adjusts it from the
+        //! measured GPU frame time to stay within gpu_budget_ms. Ignored when headless.
+        float render_scale{1.0f};
+        //! GPU frame time the automatic render scale keeps within (ms).
+        float gpu_budget_ms{4.0f};
+        //! Keep the nodes inside the window edges.
+        bool collide_edges{false};
+        //! Push apart the nodes of a string that come closer than two collision radii (its
+        //! neighbours along the string excepted): a hashed-grid broad phase once per substep.
+        bool self_collision{false};
+        //! Static obstacles the strings collide with (up to PHYSICS_MAX_OBSTACLES; not drawn).
+        std::vector<Obstacle> obstacles;
+        //! Radius of a node for every collision (NDC), in (0, Renderer::MAX_COLLISION_RADIUS].
+        float collision_radius{0.01f};
+        //! Capture every drawn frame, at the initial size, to this file — or to the standard input
+        //! of the command after a leading '|' — through a ring of readback buffers written on a
+        //! worker thread (see FrameCapture). Empty: no capture. Capturing records every frame live
+        //! (prerecorded is ignored).
+        std::string capture_path;
+        //! How captured frames are written.
+        CaptureFormat capture_format{CaptureFormat::Y4m};
+        //! Frames per second of the capture, 1 to FrameCapture::MAX_FRAME_RATE: drawn frames are
+        //! repeated or skipped to keep the time they were drawn at (see FrameCapture).
+        uint32_t capture_frame_rate{FrameCapture::DEFAULT_FRAME_RATE};
+        //! Catmull-Rom spline pieces each segment of a string is drawn as, 1 (straight segments) to
+        //! RIBBON_MAX_SUBDIVISIONS, for a smooth curve through few nodes. Renderer::RIBBON_SUBDIVISIONS_AUTO
+        //! (0, the default) picks enough for pieces of about Renderer::RIBBON_PIECE_PX on the target.
+        //! Either way it is capped so the ribbon holds no more than MAX_TOTAL_NODES vertex pairs.
+        uint32_t ribbon_subdivisions{0};
+    };
+
+    //! CPU and GPU cost of one frame, read back once its fence has been waited on.
+    struct FrameTimings {
+        float cpu_record_ms{0.0f}; //!< CPU time from the end of the fence wait to the graphics submit (recording + submits).
+        float gpu_physics_ms{0.0f}; //!< GPU time of the physics and motion passes (0 on a frame that ran no substep, and with the physics thread).
+        float gpu_frame_ms{0.0f}; //!< GPU time from the first physics or draw command to the end of the draw.
+        //! Time from drawFrame() entry until the presentation engine reported the frame presented,
+        //! for the newest frame measured (0 without present wait). The cursor samples the frame
+        //! shows are at least this fresh.
+        float present_latency_ms{0.0f};
+    };
+
+    //! Composition root for the Vulkan back end. The strings are simulated on the GPU as one
+    //! batch by a compute shader (Verlet + distance constraints) writing the positions buffer,
+    //! which a second compute pass expands into a triangle-strip ribbon per string for the
+    //! graphics pipeline to draw, anti-aliased.
     //!
     //! Exception policy: vk::raii throws on Vulkan errors; those are caught at the init() and
     //! drawFrame() boundaries (and in each sub-component) and never escape the public API.
@@ -48,56 +158,521 @@ namespace Engine
         Renderer(Renderer&&) = delete;
         Renderer& operator=(Renderer&&) = delete;
 
-        //! Number of nodes (points) in the string. Must match NODE_COUNT in physics.slang.
-        static constexpr uint32_t NODE_COUNT = 128;
+        //! Smallest supported string (a single segment).
+        static constexpr uint32_t MIN_NODE_COUNT = 2;
+        //! Largest supported string (1M nodes).
+        static constexpr uint32_t MAX_NODE_COUNT = 1u << 20;
+        //! Largest supported batch.
+        static constexpr uint32_t MAX_STRING_COUNT = 4096;
+        //! Largest supported node total across the batch (4M nodes; 32 MiB per state buffer).
+        static constexpr uint32_t MAX_TOTAL_NODES = 1u << 22;
+        //! Largest supported frames-in-flight count.
+        static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+        //! Largest supported constraint iteration count.
+        static constexpr uint32_t MAX_CONSTRAINT_ITERATIONS = 64;
+        //! Largest supported RendererConfig::collision_radius (NDC).
+        static constexpr float MAX_COLLISION_RADIUS = 0.1f;
+        //! Most cells of the tiled solver's hash grid (one per node of the largest batch).
+        static constexpr uint32_t MAX_GRID_CELLS = MAX_TOTAL_NODES;
+        //! Longest paceFrame() waits for a present (100 ms), so an occluded window cannot stall the loop.
+        static constexpr uint64_t PACE_TIMEOUT_NS = 100000000;
+        //! Frame capture readback slots beyond the frames in flight: the writer may hold these
+        //! while the GPU fills the others, so a slow frame write does not drop the next frame.
+        static constexpr uint32_t CAPTURE_SPARE_SLOTS = 2;
+        //! m_capture_pending entry of a frame that is not being captured.
+        static constexpr uint32_t NO_CAPTURE_SLOT = UINT32_MAX;
+        //! Colour format of the headless render target.
+        static constexpr vk::Format HEADLESS_FORMAT = vk::Format::eB8G8R8A8Unorm;
+        //! Pipeline cache file name inside the per-user cache directory.
+        static constexpr const char* PIPELINE_CACHE_FILE_NAME = "pipeline_cache.bin";
+        //! GpuScores file name inside the per-user cache directory.
+        static constexpr const char* GPU_SCORES_FILE_NAME = "gpu_scores.txt";
+        //! RendererConfig::render_scale asking for the scale to follow the GPU budget.
+        static constexpr float RENDER_SCALE_AUTO = 0.0f;
+        //! Physics substep (seconds). drawFrame() advances the simulation by whole substeps, so the
+        //! motion is the same at any refresh rate.
+        static constexpr float FIXED_TIMESTEP = 1.0f / 240.0f;
+        //! Clamp on drawFrame()'s dt so a stall (breakpoint, resize) cannot blow up the integration
+        //! or the GPU cost; MAX_FRAME_DELTA / the 1/240 s step is PHYSICS_MAX_SUBSTEPS. Frames spaced
+        //! further apart than this (under 20 Hz) make the simulation run slow.
+        static constexpr float MAX_FRAME_DELTA = 0.05f;
+        //! Slowest physics thread tick rate: a tick never holds more than MAX_FRAME_DELTA.
+        static constexpr float MIN_PHYSICS_RATE = 1.0f / MAX_FRAME_DELTA;
+        //! Fastest physics thread tick rate: one substep per tick.
+        static constexpr float MAX_PHYSICS_RATE = 240.0f;
+        //! Smallest render scale (a quarter of the resolution in each direction).
+        static constexpr float MIN_RENDER_SCALE = 0.25f;
+        //! Change of the automatic render scale per adjustment.
+        static constexpr float RENDER_SCALE_STEP = 0.0625f;
+        //! Frames the automatic render scale holds after a change before measuring again.
+        static constexpr uint64_t RENDER_SCALE_COOLDOWN_FRAMES = 30;
+        //! The automatic render scale steps up only if the predicted GPU time stays below this
+        //! fraction of the budget, so it does not oscillate around it.
+        static constexpr float RENDER_SCALE_HEADROOM = 0.8f;
+        //! RendererConfig::ribbon_subdivisions asking for them to follow the target resolution.
+        static constexpr uint32_t RIBBON_SUBDIVISIONS_AUTO = 0;
+        //! Length on the target (pixels) the automatic ribbon subdivision cuts a rest-length segment
+        //! down to, where RIBBON_MAX_SUBDIVISIONS allows.
+        static constexpr float RIBBON_PIECE_PX = 8.0f;
+        //! The reduced-scale target grows in steps of this many pixels per side, so a window drag
+        //! rarely reallocates it.
+        static constexpr uint32_t SCALED_TARGET_GRANULARITY = 256;
+
+        //! Initialises the Vulkan back end for the given native window at the given size (the size
+        //! of the offscreen target when headless). Returns false and fills out_error_message on
+        //! failure (including a count outside the limits above). The logger must outlive the renderer.
+        [[nodiscard]] bool init(LoggingLib::Logger& logger, const NativeWindowHandle& window_handle, uint32_t width, uint32_t height, const RendererConfig& config,
+            std::string& out_error_message);
+
+        //! Advances the GPU physics by the fixed substeps that fit in dt (the frame delta time in
+        //! seconds, clamped; the remainder carries over), with each substep's heads pinned around
+        //! the latched cursor trail at that substep's time, and renders the strings. With the physics
+        //! thread, dt is ignored: the frame draws the newest state a tick has finished, and wakes the
+        //! thread if it idles.
+        //! trail_time_us is where the last substep lands on the cursor trail (steady clock, µs);
+        //! 0 takes it from the clock, behind now by the time not yet simulated. A replay passes
+        //! the recorded one, so the cursor path does not depend on when the frame gets to it.
+        //! width/height drive swapchain recreation (resize/minimise); a headless renderer keeps its
+        //! init() size. Never throws.
+        void drawFrame(uint32_t width, uint32_t height, float dt, uint64_t trail_time_us = 0);
+
+        //! Late-latches a cursor sample (window client pixels in a width x height client area, at
+        //! time_us on the std::chrono::steady_clock in microseconds, e.g. when the window system
+        //! saw the move): appends it to the trail the physics reads when it executes on the GPU,
+        //! interpolating each substep's head target along it, so a frame already recorded or
+        //! submitted still follows every sample up to its own time, and a fast flick is followed
+        //! along its path. Samples must come in time order. Touches no Vulkan object and may be
+        //! called from any one thread at a time (e.g. the window event callback) between init()
+        //! and destroy(). Never throws.
+        void latchCursor(uint32_t width, uint32_t height, int32_t cursor_x, int32_t cursor_y, uint64_t time_us);
+
+        //! The std::chrono::steady_clock time in microseconds: the clock of latchCursor() samples.
+        [[nodiscard]] static uint64_t nowMicroseconds();
+
+        //! Records every latchCursor() sample, and the dt and trail time of every frame drawFrame()
+        //! advances the physics by, into recorder until set back to nullptr. Set it before the threads calling
+        //! those start and clear it after they stop; the recorder must outlive that.
+        void setInputRecorder(InputRecorder* recorder)
+        {
+            m_input_recorder = recorder;
+        }
+
+        //! With PresentLatency::Paced, blocks until the previous frame has been presented (at most
+        //! PACE_TIMEOUT_NS), so the caller takes its input and starts the next frame just in time
+        //! for the following vblank rather than queueing it behind the display. Returns at once in
+        //! the other modes. Never throws.
+        void paceFrame();
+
+        //! Serial of the newest frame drawFrame() submitted (frames count from 1; 0 before the first).
+        [[nodiscard]] uint64_t frameSerial() const
+        {
+            return m_frame_serial;
+        }
+
+        //! Kinetic energy and fastest node speed of the batch, measured on the GPU at the end of a
+        //! simulating frame and read back once that frame's fence is waited on (so it lags the
+        //! newest frame by up to the frames-in-flight count). With the physics thread, that of the
+        //! newest tick finished when the newest frame was drawn.
+        [[nodiscard]] const MotionStats& motion() const
+        {
+            return m_last_motion;
+        }
+
+        //! Serial of the frame motion() measures (0: nothing measured yet) — with the physics thread,
+        //! of the newest frame submitted before the tick that measured it. Compare against
+        //! frameSerial() to ignore measurements older than some event.
+        [[nodiscard]] uint64_t motionFrame() const
+        {
+            return m_last_motion_frame;
+        }
+
+        //! Copies the newest physics state slot's node positions (string after string, node_count
+        //! each) into out_positions, after waiting for the device to go idle. Call it between
+        //! drawFrame() calls, on the thread making them. Returns false and fills out_error_message
+        //! on failure. Slow: meant for checks such as bench --verify, not for frames.
+        [[nodiscard]] bool readPositions(std::vector<MathLib::Vec2>& out_positions, std::string& out_error_message);
+
+        //! Per-string parameters init() seeds: heads side by side around the cursor, lengths spread
+        //! over the batch by a golden-ratio sequence (so neighbours differ). Public so a CPU
+        //! reference can start from the same batch.
+        [[nodiscard]] static std::vector<StringParams> initialStringParams(uint32_t string_count, uint32_t node_count);
 
-        //! Initialises the Vulkan back end for the given native window at the given size.
-        //! Returns false and fills out_error_message on failure. The logger must outlive the
-        //! renderer.
-        [[nodiscard]] bool init(LoggingLib::Logger& logger, const NativeWindowHandle& window_handle, uint32_t width, uint32_t height, std::string& out_error_message);
+        //! Initial node layout init() seeds for strings: straight strings hanging down from the
+        //! screen centre, one after the other as in the state buffers, at rest.
+        [[nodiscard]] static std::vector<MathLib::Vec2> initialPositions(const std::vector<StringParams>& strings, uint32_t node_count);
 
-        //! Simulates one physics step on the GPU (head pinned to the cursor, given in window
-        //! client pixels) and renders the string. dt is the frame delta time in seconds.
-        //! width/height drive swapchain recreation (resize/minimise). Never throws.
-        void drawFrame(uint32_t width, uint32_t height, int32_t cursor_x, int32_t cursor_y, float dt);
+        //! CPU and GPU timings of the frame timingsFrame() names, read back like motion(). The GPU
+        //! fields stay 0 where the device has no timestamp support.
+        [[nodiscard]] const FrameTimings& timings() const
+        {
+            return m_last_timings;
+        }
+
+        //! Serial of the frame timings() measures (0: nothing measured yet).
+        [[nodiscard]] uint64_t timingsFrame() const
+        {
+            return m_last_timings_frame;
+        }
+
+        //! Render scale of the frames being drawn (1 when drawing straight into the swapchain).
+        [[nodiscard]] float renderScale() const
+        {
+            return m_scaled ? m_render_scale : 1.0f;
+        }
+
+        //! Frame counters and duration histograms since init(), updated as frames are drawn, for
+        //! the frame loop to add its own (input events, active / idle time) and for any thread to
+        //! read (FrameStats::snapshot()). Valid for the renderer's lifetime.
+        [[nodiscard]] FrameStats& stats()
+        {
+            return m_stats;
+        }
+
+        //! The GPU init() selected: its name and UUID (see Device::uuid()).
+        [[nodiscard]] const std::string& gpuName() const
+        {
+            return m_device.name();
+        }
+
+        [[nodiscard]] const std::string& gpuUuid() const
+        {
+            return m_device.uuid();
+        }
+
+        //! Per-heap device memory usage and budget right now (see Allocator::memoryBudget()); from
+        //! any thread, once init() has succeeded.
+        [[nodiscard]] MemoryBudget memoryBudget() const
+        {
+            return m_allocator.memoryBudget();
+        }
+
+        //! Rolling min / avg / p99 GPU time of one phase over its last GpuProfiler::HISTORY_SIZE
+        //! frames (no samples without timestamp support).
+        [[nodiscard]] GpuPhaseStats gpuPhaseStats(GpuPhase phase) const
+        {
+            return m_profiler.stats(phase);
+        }
 
         //! Tears down the back end in reverse construction order (waits for the GPU first).
         void destroy();
 
     private:
-        //! Creates the command pool, per-frame command buffers and synchronisation objects.
+        //! Which physics solver runs the string (picked from the node count in init()).
+        enum class PhysicsSolver {
+            Workgroup, //!< physicsWaveMain / physicsMain: one workgroup per string, subgroup shuffles or shared memory.
+            Tiled //!< integrateMain + constrainMain (+ the grid passes): many workgroups, one dispatch per pass.
+        };
+
+        //! What the render thread and the physics thread share about the state ring (guarded by
+        //! m_simulation_mutex).
+        struct SharedSimulation {
+            uint32_t newest_slot{0}; //!< Newest state slot a tick has finished writing (or the seeded one).
+            uint64_t newest_value{0}; //!< m_physics_timeline value that tick signalled (0: the seed, nothing to wait for).
+            MotionStats motion{}; //!< Measured by that tick.
+            uint64_t motion_frame{0}; //!< Serial of the newest frame submitted before that tick was (see motionFrame()).
+            uint64_t frame_serial{0}; //!< Serial of the newest frame submitted.
+            std::vector<uint64_t> slot_reader; //!< Per state slot: serial of the newest frame submitted that draws it (0: none).
+        };
+
+        //! Host data to fill a buffer with from its start (see uploadBuffers()).
+        struct BufferUpload {
+            const AllocatedBuffer* buffer{nullptr}; //!< Destination.
+            const void* data{nullptr}; //!< Source, size bytes.
+            VkDeviceSize size{0}; //!< Bytes to copy.
+        };
+
+        //! A frame's timings waiting for its fence (one per frame in flight).
+        struct PendingTimings {
+            uint64_t frame{0}; //!< Serial of the frame (0 = none).
+            float cpu_record_ms{0.0f}; //!< Measured on the CPU when the frame was submitted.
+        };
+
+        //! Creates the command pool, per-frame command buffers, synchronisation objects and the
+        //! GPU profiler.
         [[nodiscard]] bool createFrameResources(std::string& out_error_message);
 
-        //! Creates + fills the positions/previous-positions storage buffers and the compute
-        //! descriptor set.
+        //! Creates the headless colour target (image + view) at the given size.
+        [[nodiscard]] bool createOffscreenTarget(uint32_t width, uint32_t height, std::string& out_error_message);
+
+        //! Makes the reduced-scale target at least as large as the swapchain (rounded up to
+        //! SCALED_TARGET_GRANULARITY), waiting for the frames in flight before replacing it, and
+        //! sizes the drawn region for the render scale. May throw vk::SystemError.
+        void ensureScaledTarget();
+
+        //! Sets the region of the reduced-scale target drawn at m_render_scale of the swapchain extent.
+        void updateScaledExtent();
+
+        //! Steps the automatic render scale from the newest GPU frame time (see RENDER_SCALE_STEP).
+        void adjustRenderScale();
+
+        //! Blocks until every frame in flight has finished (their fences, not a device idle).
+        //! May throw vk::SystemError.
+        void waitForFramesInFlight() const;
+
+        //! Records the blit of the reduced-scale target up to swapchain image image_index and its
+        //! transition to present — unless to_present is false, which leaves it a transfer destination.
+        void recordUpscale(const vk::raii::CommandBuffer& cmd, uint32_t frame, uint32_t image_index, bool to_present) const;
+
+        //! Creates the frame capture readback buffers and opens m_capture (see RendererConfig::capture_path).
+        [[nodiscard]] bool createCapture(const RendererConfig& config, std::string& out_error_message);
+
+        //! Records the copy of the finished frame image (in old_layout, last written at src_stage
+        //! with src_access) into capture slot slot, then its transition to new_layout.
+        void recordCapture(const vk::raii::CommandBuffer& cmd, uint32_t frame, vk::Image image, uint32_t slot, vk::ImageLayout old_layout,
+            vk::PipelineStageFlags2 src_stage, vk::AccessFlags2 src_access, vk::ImageLayout new_layout) const;
+
+        //! Hands the capture slot of the frame that last used this frame-in-flight slot to the
+        //! capture writer. Call once its fence has been waited on.
+        void collectCapture(uint32_t frame);
+
+        //! Creates + fills the positions/previous-positions/string-parameter storage buffers, the
+        //! per-frame ribbon draws and the compute descriptor set.
         [[nodiscard]] bool createPhysicsResources(std::string& out_error_message);
 
-        //! Recreates the swapchain (and the per-image render-finished semaphores) at a new size.
+        //! Fills buffers from host memory: directly where they are mapped (ReBAR/UMA), the rest
+        //! through one upload arena and one batch of copies on the graphics queue that is waited for.
+        [[nodiscard]] bool uploadBuffers(std::span<const BufferUpload> uploads, std::string& out_error_message);
+
+        //! Recreates the swapchain at a new size without waiting for the device (the old one is
+        //! retired until its frames, and presents where fenced, are done), and re-records the
+        //! pre-recorded buffers once the frames in flight have finished.
         void recreateSwapchain(uint32_t width, uint32_t height);
 
-        // One frame in flight: the physics state lives in a single GPU buffer shared by compute
-        // and the vertex stage, so a single in-flight frame avoids a cross-frame data race and
-        // is plenty at v-sync.
-        static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 1; //!< Frames the CPU may run ahead of the GPU.
+        //! Records the motion reduction of the slot recordPhysics() just wrote on the same command
+        //! buffer, and its copy into the host-readable readback buffer.
+        void recordMotion(const vk::raii::CommandBuffer& cmd, const ArenaAllocation& readback) const;
+
+        //! Reads this frame-in-flight slot's motion readback if its fence-waited frame wrote one.
+        void collectMotion();
+
+        //! Resolves this frame-in-flight slot's timings once its fence has been waited on, logs
+        //! the profiler summary every profile_log_interval frames and adjusts the automatic render
+        //! scale.
+        void collectTimings();
+
+        //! Logs the FrameStats summary of the interval since the last one once stats_log_interval_s
+        //! has passed.
+        void logStats(std::chrono::steady_clock::time_point now);
+
+        //! Completes the pending present latency measurement if its present has been presented
+        //! within timeout_ns. May throw vk::SystemError.
+        void resolvePresentLatency(uint64_t timeout_ns);
+
+        //! Present thread: takes the image of an outstanding requestAcquire() that no frame picked up
+        //! (a frame failed in between) and, if one was acquired, has the graphics queue consume its
+        //! semaphore and waits for that, so the semaphore can be acquired with again. The present
+        //! thread must be drained. May throw vk::SystemError.
+        void releasePendingAcquire();
+
+        //! Locks m_queue_mutex where the present or physics thread shares a queue the render thread
+        //! submits to; an empty lock otherwise.
+        [[nodiscard]] std::unique_lock<std::mutex> lockSharedQueue();
+
+        //! Records a frame's physics dispatches with the selected solver, reading the state slot
+        //! before write_slot and writing write_slot. The tiled solver dispatches substeps substeps,
+        //! or, when pre-recorded, PHYSICS_MAX_SUBSTEPS indirect dispatches sized by the frame
+        //! parameters.
+        void recordPhysics(const vk::raii::CommandBuffer& cmd, uint32_t write_slot, uint32_t substeps) const;
+
+        //! Records frame's physics + motion for write_slot into the compute-queue command buffer.
+        void recordCompute(const vk::raii::CommandBuffer& cmd, uint32_t frame, uint32_t write_slot, uint32_t substeps);
+
+        //! Records the expansion of draw_slot's nodes into frame's ribbon vertex buffer, sized for
+        //! target_extent, then the erase quad of what target target_index last showed, and the
+        //! barrier before the draw reads them.
+        void recordRibbon(const vk::raii::CommandBuffer& cmd, uint32_t frame, uint32_t draw_slot, uint32_t target_index, vk::Extent2D target_extent) const;
+
+        //! Records frame's graphics command buffer: the physics + motion of draw_slot first when
+        //! inline_physics, then the ribbon of draw_slot and its draw into the target of swapchain
+        //! image image_index (see targetIndex()), blitted up to it when scaled, and its copy into
+        //! capture slot capture_slot (unless NO_CAPTURE_SLOT). A preserved target is loaded and
+        //! only its erase quad repainted, otherwise it is cleared.
+        void recordGraphics(const vk::raii::CommandBuffer& cmd, uint32_t frame, uint32_t image_index, uint32_t draw_slot, bool inline_physics, uint32_t substeps,
+            bool preserved, uint32_t capture_slot);
+
+        //! (Re)records the pre-recorded command buffers: per state slot one compute buffer (async
+        //! compute) and one graphics buffer per target image. The GPU must be idle.
+        void recordPrerecorded();
+
+        //! Writes the frame parameters of write_slot (substep count, trail_time_us — the cursor
+        //! trail time of the last substep — and the tiled solver's indirect group counts).
+        void writeFrameParams(uint32_t write_slot, uint32_t substeps, uint64_t trail_time_us);
+
+        //! Trail time of a last substep simulated now with lag_s seconds not yet simulated: the
+        //! simulation trails real time by the accumulator's remainder.
+        [[nodiscard]] static uint64_t trailTimeNow(float lag_s);
+
+        //! Physics thread: simulates the substeps dt adds to m_tick_accumulator into the state slot
+        //! after the newest, waits for the GPU to finish them and publishes the slot and its motion
+        //! to the render thread. Returns false once the batch is at rest (see
+        //! RendererConfig::physics_settle_speed) or a tick failed. Never throws.
+        [[nodiscard]] bool physicsTick(float dt);
+
+        //! Creates the physics thread's command pool and buffer, timelines and motion readback.
+        [[nodiscard]] bool createPhysicsThreadResources(std::string& out_error_message);
+
+        //! Images drawn into: the swapchain's, or the one offscreen image when headless or scaled.
+        [[nodiscard]] uint32_t targetImageCount() const;
+
+        //! Images presented (one pre-recorded graphics buffer per state slot each): the
+        //! swapchain's, or the one offscreen image when headless.
+        [[nodiscard]] uint32_t presentImageCount() const;
+
+        //! The target image a frame presenting swapchain image image_index draws into.
+        [[nodiscard]] uint32_t targetIndex(uint32_t image_index) const;
+
+        //! Stages the frame's swapchain image is first written and last written in: the blit when
+        //! scaled, else the colour output (the acquire wait and render-finished signal).
+        [[nodiscard]] vk::PipelineStageFlags2 presentStages() const;
+
+        //! Forgets what the target images hold, so each is cleared the next time it is drawn.
+        void resetTargetContents();
+
+        //! Spline pieces per segment of a ribbon drawn on a target of target_extent (see
+        //! RendererConfig::ribbon_subdivisions).
+        [[nodiscard]] uint32_t ribbonSubdivisions(vk::Extent2D target_extent) const;
+
+        //! Whether frames repaint only the erase quad of a preserved image: asked for, and every
+        //! target image has a drawn-bounds entry.
+        [[nodiscard]] bool partialRedraw() const;
+
+        // Frames in flight run against a ring of physics state slots. A simulating frame reads the
+        // newest slot and writes the next one, which the frame's ribbon pass then expands for the
+        // draw; frames that run no substep draw the newest slot again. A slot is rewritten m_state_slot_count simulating
+        // frames later, and the CPU has waited that frame's fence m_frames_in_flight frames back,
+        // so with m_state_slot_count = max(2, frames in flight) every draw of a slot has finished
+        // before compute overwrites it. Compute-to-compute hazards between frames on the queue are
+        // covered by a barrier at the start of each frame's physics. With async compute the physics
+        // is its own submit on the compute queue and the frame's draw waits for it on a timeline
+        // semaphore, so the frame's fence also covers its compute command buffer. Pre-recorded
+        // frames always simulate, so frame n writes slot n mod m_state_slot_count and runs in
+        // frame-in-flight slot n mod m_frames_in_flight, which divides it: the state slot alone
+        // picks the recorded command buffers, motion readback and timestamp range.
+        //
+        // With the physics thread, ticks write the ring instead and frames only draw. A tick writes
+        // the slot after the newest it has published, once the host has waited on m_frame_timeline
+        // for the newest frame that drew that slot (its parameters are host-written); a frame draws the newest published slot, holding
+        // m_simulation_mutex from picking it until its submit has recorded it as that slot's reader,
+        // and waits on m_physics_timeline for the tick (already finished: a tick is published once
+        // the host has waited for it, so this is only the memory dependency). Ticks run one at a time
+        // and frames draw only finished slots, so with at least 3 slots a tick never waits for the
+        // frame drawing the newest state.
 
         LoggingLib::Logger* m_logger{nullptr}; //!< Logger (non-owning), set in init().
         Instance m_instance; //!< Vulkan instance + debug messenger.
         vk::raii::SurfaceKHR m_surface{nullptr}; //!< Window surface.
         Device m_device; //!< Physical + logical device and queues.
         Allocator m_allocator; //!< VMA allocator.
-        AllocatedBuffer m_positions; //!< Current node positions (storage + vertex buffer; before allocator).
-        AllocatedBuffer m_prev_positions; //!< Previous node positions (Verlet history; before allocator).
-        Swapchain m_swapchain; //!< Swapchain + image views.
-        Pipeline m_pipeline; //!< Graphics pipeline (draws the line strip).
+        std::vector<AllocatedBuffer> m_positions; //!< Node positions per state slot (storage + vertex buffer; before allocator).
+        std::vector<AllocatedBuffer> m_prev_positions; //!< Previous node positions per state slot (Verlet history; before allocator).
+        AllocatedBuffer m_string_params; //!< One StringParams per string (before allocator).
+        std::vector<AllocatedBuffer> m_ribbon_draws; //!< Per frame in flight: the culled indirect draws of its ribbon (see ribbonDrawsWords(); before allocator).
+        std::vector<AllocatedBuffer> m_frame_params; //!< Persistently mapped FrameParams per state slot (before allocator).
+        std::vector<AllocatedBuffer> m_ribbon; //!< Ribbon + erase quad vertices per frame in flight (storage + vertex buffer; before allocator).
+        AllocatedBuffer m_ribbon_bounds; //!< RIBBON_BOUNDS_WORDS: running and per-image drawn pixel boxes (before allocator).
+        AllocatedBuffer m_cursor_trail; //!< Recent cursor samples (CursorTrail), mapped + coherent (before allocator).
+        AllocatedBuffer m_obstacles; //!< RendererConfig::obstacles as Obstacle elements (at least one; before allocator).
+        AllocatedBuffer m_grid; //!< Tiled self-collision: cell counts, cell starts, scan block starts (placeholder otherwise; before allocator).
+        AllocatedBuffer m_grid_node_cells; //!< Tiled self-collision: cell and slot per node (placeholder otherwise; before allocator).
+        AllocatedBuffer m_grid_entries; //!< Tiled self-collision: GridEntry per node, sorted by cell (placeholder otherwise; before allocator).
+        CursorTrail* m_cursor_trail_data{nullptr}; //!< Mapping of m_cursor_trail (null outside init()..destroy()).
+        uint32_t m_cursor_newest{0}; //!< CursorTrail::newest as last written (the latching thread's copy).
+        AllocatedImage m_offscreen_image; //!< Headless colour target (before allocator).
+        vk::raii::ImageView m_offscreen_view{nullptr}; //!< View of m_offscreen_image.
+        vk::Extent2D m_offscreen_extent{}; //!< Size of m_offscreen_image.
+        AllocatedImage m_scaled_image; //!< Reduced-scale colour target, blitted to the swapchain (before allocator).
+        vk::raii::ImageView m_scaled_view{nullptr}; //!< View of m_scaled_image.
+        vk::Extent2D m_scaled_capacity{}; //!< Size of m_scaled_image.
+        vk::Extent2D m_scaled_extent{}; //!< Region of m_scaled_image drawn at the current render scale.
+        Swapchain m_swapchain; //!< Swapchain + image views (unused when headless).
+        PipelineCache m_pipeline_cache; //!< Driver cache both pipelines are created through.
+        Pipeline m_pipeline; //!< Ribbon expansion + graphics pipeline (draws the strings).
         ComputePipeline m_compute_pipeline; //!< Compute pipeline (physics).
-        vk::raii::DescriptorPool m_descriptor_pool{nullptr}; //!< Pool for the compute descriptor set.
-        vk::raii::DescriptorSet m_descriptor_set{nullptr}; //!< Binds positions + prev to the compute shader.
+        vk::raii::DescriptorPool m_descriptor_pool{nullptr}; //!< Pool for the compute descriptor sets.
+        std::vector<vk::raii::DescriptorSet> m_descriptor_sets; //!< Per state slot: writes that slot, reads the one before it.
+        std::vector<vk::raii::DescriptorSet> m_ribbon_sets; //!< Ribbon expansion, indexed state slot * m_frames_in_flight + frame.
         vk::raii::CommandPool m_command_pool{nullptr}; //!< Graphics/compute command pool.
         std::vector<vk::raii::CommandBuffer> m_command_buffers; //!< One per frame-in-flight.
         std::vector<vk::raii::Semaphore> m_image_available; //!< Signalled when an image is acquired (per frame-in-flight).
-        std::vector<vk::raii::Semaphore> m_render_finished; //!< Signalled when rendering is done (per swapchain image).
         std::vector<vk::raii::Fence> m_in_flight; //!< CPU/GPU frame fence (per frame-in-flight).
+        GpuProfiler m_profiler; //!< Timestamps around each GPU phase of a frame.
+        std::vector<PendingTimings> m_pending_timings; //!< Per frame in flight.
+        std::vector<uint64_t> m_slot_frame; //!< Serial of the frame last submitted in each frame-in-flight slot (0 = none).
+        FrameTimings m_last_timings{}; //!< Newest timings resolved.
+        uint64_t m_last_timings_frame{0}; //!< Serial of the frame m_last_timings measures (0 = none yet).
         uint32_t m_current_frame{0}; //!< Index into the frame-in-flight arrays.
+        uint32_t m_frames_in_flight{0}; //!< Frames the CPU may run ahead of the GPU (from RendererConfig).
+        uint32_t m_state_slot_count{0}; //!< Physics state slots in the ring: max(2, m_frames_in_flight).
+        uint32_t m_state_slot{0}; //!< Newest written state slot (what the next frame draws or reads).
+        AllocatedBuffer m_motion_partials; //!< Motion reduction stage-1 partials, one per workgroup (before allocator).
+        AllocatedBuffer m_motion; //!< Motion reduction result, copied out each simulating frame (before allocator).
+        FrameArena m_motion_arena; //!< Host-readable MotionStats: a region per frame in flight, plus the physics thread's (before allocator).
+        std::vector<ArenaAllocation> m_motion_readbacks; //!< Each region's MotionStats, indexed by frame in flight (the physics thread's last).
+        std::vector<uint64_t> m_motion_readback_frame; //!< Serial of the frame each readback holds (0 = none).
+        MotionStats m_last_motion{}; //!< Newest motion read back.
+        uint64_t m_last_motion_frame{0}; //!< Serial of the frame m_last_motion measures (0 = none yet).
+        uint64_t m_frame_serial{0}; //!< Frames submitted so far (the serial of the newest one).
+        bool m_async_compute{false}; //!< Physics runs on the dedicated compute queue.
+        vk::raii::CommandPool m_compute_command_pool{nullptr}; //!< Pool on the compute family (async compute only).
+        std::vector<vk::raii::CommandBuffer> m_compute_command_buffers; //!< One physics command buffer per frame in flight (async compute only).
+        vk::raii::Semaphore m_physics_timeline{nullptr}; //!< Timeline signalled by each physics submit, waited by the frame's draw.
+        uint64_t m_physics_value{0}; //!< Last value a physics submit signals on m_physics_timeline.
+        uint32_t m_node_count{0}; //!< Nodes per string (from RendererConfig).
+        uint32_t m_string_count{0}; //!< Strings in the batch (from RendererConfig).
+        uint32_t m_constraint_iterations{0}; //!< Constraint iterations per substep (from RendererConfig).
+        uint32_t m_collision{0}; //!< PHYSICS_COLLIDE_* bits (from RendererConfig).
+        std::vector<Obstacle> m_obstacle_list; //!< Static obstacles (from RendererConfig).
+        float m_collision_radius{0.0f}; //!< Node radius (from RendererConfig).
+        uint32_t m_ribbon_subdivisions{0}; //!< Fixed spline pieces per segment, or RIBBON_SUBDIVISIONS_AUTO (from RendererConfig).
+        uint32_t m_max_ribbon_subdivisions{1}; //!< Most spline pieces per segment the ribbon buffers hold.
+        uint32_t m_grid_cells{0}; //!< Cells of the tiled solver's hash grid (0 without tiled self-collision).
+        bool m_headless{false}; //!< Rendering into m_offscreen_image (from RendererConfig).
+        uint32_t m_profile_log_interval{0}; //!< Frames between profiler log lines (from RendererConfig; 0 = off).
+        FrameStats m_stats; //!< Frame telemetry (see stats()).
+        InputRecorder* m_input_recorder{nullptr}; //!< See setInputRecorder() (null: not recording).
+        FrameCapture m_capture; //!< Writes captured frames (open only while capturing).
+        AllocatedPool m_capture_pool; //!< Memory of the capture slots (before allocator).
+        std::vector<AllocatedBuffer> m_capture_buffers; //!< Host-readable capture slots, one frame each, from m_capture_pool (before it).
+        std::vector<uint32_t> m_capture_pending; //!< Per frame in flight: capture slot its frame copies into (NO_CAPTURE_SLOT: none).
+        vk::Extent2D m_capture_extent{}; //!< Size of the captured frames; frames of another size are dropped.
+        std::chrono::steady_clock::duration m_stats_log_interval{}; //!< Between FrameStats log lines (from RendererConfig; zero = off).
+        std::chrono::steady_clock::time_point m_stats_logged_at{}; //!< When the last FrameStats line was logged (or init()).
+        FrameStatsSnapshot m_stats_logged{}; //!< m_stats as of m_stats_logged_at.
+        bool m_prerecorded{false}; //!< Replaying pre-recorded command buffers (from RendererConfig).
+        bool m_partial_redraw{false}; //!< Repaint only the erase quad of a preserved image (from RendererConfig).
+        std::vector<bool> m_target_preserved; //!< Per target image: holds a frame whose bounds are recorded in m_ribbon_bounds.
+        bool m_scaled{false}; //!< Drawing into m_scaled_image at m_render_scale (asked for and supported).
+        bool m_auto_render_scale{false}; //!< m_render_scale follows m_gpu_budget_ms.
+        float m_render_scale{1.0f}; //!< Current render scale while m_scaled.
+        float m_gpu_budget_ms{0.0f}; //!< See RendererConfig::gpu_budget_ms.
+        uint64_t m_render_scale_frame{0}; //!< Serial of the newest frame before the last render scale change.
+        std::vector<vk::raii::CommandBuffer> m_prerecorded_commands; //!< Graphics, indexed state slot * targetImageCount() + image.
+        std::vector<vk::raii::CommandBuffer> m_prerecorded_compute; //!< Compute-queue physics per state slot (async compute only).
+        PresentLatency m_latency{PresentLatency::Vsync}; //!< Requested present latency mode (from RendererConfig).
+        bool m_present_wait{false}; //!< Presents carry ids that can be waited for (device support, not headless).
+        uint64_t m_present_id{0}; //!< Id of the newest present on the current swapchain (0 = none yet).
+        uint64_t m_latency_present_id{0}; //!< Present whose latency is being measured (0 = none).
+        std::chrono::steady_clock::time_point m_latency_start{}; //!< drawFrame() entry of that present's frame.
+        float m_present_latency_ms{0.0f}; //!< Newest present latency measured.
+        PresentThread m_present_thread; //!< Acquires and presents (running with RendererConfig::present_thread).
+        std::mutex m_queue_mutex; //!< Held around submits to a queue two threads submit to (m_present_queue_shared, m_physics_queue_shared).
+        bool m_present_queue_shared{false}; //!< The present thread's queue is also the graphics or compute queue.
+        bool m_acquire_pending{false}; //!< A requestAcquire() of the current frame slot awaits waitAcquired().
+        PhysicsThread m_physics_thread; //!< Ticks the simulation (running with RendererConfig::physics_thread).
+        bool m_physics_threaded{false}; //!< Simulating on m_physics_thread (asked for, not headless).
+        bool m_physics_queue_shared{false}; //!< The physics thread's queue is also one the render or present thread submits to.
+        float m_physics_rate_hz{0.0f}; //!< See RendererConfig::physics_rate_hz.
+        float m_physics_settle_speed{0.0f}; //!< See RendererConfig::physics_settle_speed.
+        vk::raii::CommandPool m_physics_command_pool{nullptr}; //!< Pool on the physics queue's family (physics thread only).
+        std::vector<vk::raii::CommandBuffer> m_physics_command_buffers; //!< The tick's command buffer (ticks run one at a time).
+        vk::raii::Semaphore m_frame_timeline{nullptr}; //!< Signalled with its serial by each frame's submit (physics thread only).
+        ArenaAllocation m_physics_motion_readback; //!< MotionStats of the newest tick, in m_motion_arena.
+        float m_tick_accumulator{0.0f}; //!< Physics thread: tick time not yet simulated (seconds).
+        uint64_t m_tick_value{0}; //!< Physics thread: m_physics_timeline value of the newest tick.
+        std::mutex m_simulation_mutex; //!< Guards m_simulation.
+        SharedSimulation m_simulation; //!< State ring hand-over between the physics and render threads.
+        PhysicsSolver m_solver{PhysicsSolver::Workgroup}; //!< Solver picked from m_node_count.
+        float m_accumulator{0.0f}; //!< Frame time not yet simulated (seconds, below one substep between frames).
         bool m_initialised{false}; //!< True once init() has succeeded.
     };
 
@@ -13,10 +13,13 @@
 */
 
 #include "swapchain.hpp"
+#include <trace/tracer.hpp>
 #include <algorithm>
 #include <array>
 #include <limits>
 #include <ranges>
+#include <utility>
+#include <vector>
 
 namespace Engine
 {
@@ -34,10 +37,19 @@ namespace Engine
         return available.front();
     }
 
-    //! Selects the present mode. FIFO (v-sync): steady frame pacing for stable physics and easy
-    //! on integrated GPUs / laptop battery. Always available per the Vulkan spec.
-    [[nodiscard]] static vk::PresentModeKHR choosePresentMode([[maybe_unused]] const std::vector<vk::PresentModeKHR>& available)
+    //! Selects the present mode. FIFO (v-sync) — always available per the Vulkan spec — gives
+    //! steady frame pacing for stable physics and is easy on integrated GPUs / laptop battery, but
+    //! queues finished frames behind the display. PresentLatency::Low prefers MAILBOX, which shows
+    //! the newest frame at the next vblank without tearing, then IMMEDIATE.
+    [[nodiscard]] static vk::PresentModeKHR choosePresentMode(const std::vector<vk::PresentModeKHR>& available, PresentLatency latency)
     {
+        if (latency == PresentLatency::Low) {
+            for (vk::PresentModeKHR mode : {vk::PresentModeKHR::eMailbox, vk::PresentModeKHR::eImmediate}) {
+                if (std::ranges::find(available, mode) != available.end()) {
+                    return mode;
+                }
+            }
+        }
         return vk::PresentModeKHR::eFifo;
     }
 
@@ -53,12 +65,16 @@ namespace Engine
         return extent;
     }
 
-    bool Swapchain::init(const Device& device, vk::SurfaceKHR surface, uint32_t width, uint32_t height, std::string& out_error_message)
+    bool Swapchain::init(const Device& device, vk::SurfaceKHR surface, uint32_t width, uint32_t height, PresentLatency latency, vk::ImageUsageFlags extra_usage,
+        std::string& out_error_message)
     {
+        TRACE_ZONE("Swapchain::init");
         m_device = &device;
         m_surface = surface;
+        m_latency = latency;
+        m_extra_usage = extra_usage;
         try {
-            build(width, height);
+            build(width, height, 0);
         } catch (const vk::SystemError& e) {
             out_error_message = std::string("Vulkan error creating swapchain: ") + e.what();
             return false;
@@ -69,29 +85,100 @@ namespace Engine
         return true;
     }
 
-    void Swapchain::recreate(uint32_t width, uint32_t height)
+    vk::Format Swapchain::preferredFormat(const Device& device, vk::SurfaceKHR surface)
     {
-        // Wait for all GPU work (including present) to finish before destroying the old
-        // swapchain — fences only track command-buffer completion, not present.
-        m_device->get().waitIdle();
-        m_views.clear();
-        m_images.clear();
-        build(width, height);
+        return chooseSurfaceFormat(device.physicalDevice().getSurfaceFormatsKHR(surface)).format;
+    }
+
+    void Swapchain::recreate(uint32_t width, uint32_t height, uint64_t release_frame)
+    {
+        build(width, height, release_frame);
+    }
+
+    void Swapchain::releaseRetired(uint64_t completed_frame)
+    {
+        std::erase_if(m_retired, [this, completed_frame](const RetiredSwapchain& retired) {
+            return (retired.release_frame <= completed_frame) && fencesSignalled(retired.present_fences, 0);
+        });
+    }
+
+    vk::Fence Swapchain::presentFence(uint32_t image_index)
+    {
+        if (m_present_fences.empty()) {
+            return nullptr;
+        }
+        // The image has been acquired again, so its previous present is all but done.
+        const vk::raii::Fence& fence = m_present_fences[image_index];
+        if (m_present_pending[image_index]) {
+            (void)m_device->get().waitForFences({*fence}, vk::True, UINT64_MAX);
+            m_device->get().resetFences({*fence});
+        }
+        m_present_pending[image_index] = true;
+        return *fence;
     }
 
     void Swapchain::destroy()
     {
-        m_views.clear();
-        m_images.clear();
+        // Retiring the current swapchain keeps only the fences of presents actually made. Those
+        // presents the device idle did not cover get a bounded chance to finish first.
+        retire(0);
+        try {
+            for (const RetiredSwapchain& retired : m_retired) {
+                (void)fencesSignalled(retired.present_fences, PRESENT_FENCE_TIMEOUT_NS);
+            }
+        } catch (const vk::SystemError&) {
+            // Already failing; proceed with teardown regardless.
+        }
+        m_retired.clear();
+    }
+
+    void Swapchain::retire(uint64_t release_frame)
+    {
+        if (!*m_swapchain) {
+            return;
+        }
+        RetiredSwapchain retired{};
+        retired.swapchain = std::move(m_swapchain);
+        retired.views = std::move(m_views);
+        retired.render_finished = std::move(m_render_finished);
+        for (size_t i = 0; i < m_present_fences.size(); ++i) {
+            if (m_present_pending[i]) {
+                retired.present_fences.push_back(std::move(m_present_fences[i]));
+            }
+        }
+        retired.release_frame = release_frame;
+        m_retired.push_back(std::move(retired));
+
         m_swapchain = nullptr;
+        m_images.clear();
+        m_views.clear();
+        m_render_finished.clear();
+        m_present_fences.clear();
+        m_present_pending.clear();
+    }
+
+    bool Swapchain::fencesSignalled(const std::vector<vk::raii::Fence>& fences, uint64_t timeout_ns) const
+    {
+        if (fences.empty()) {
+            return true;
+        }
+        std::vector<vk::Fence> handles;
+        handles.reserve(fences.size());
+        for (const vk::raii::Fence& fence : fences) {
+            handles.push_back(*fence);
+        }
+        return m_device->get().waitForFences(handles, vk::True, timeout_ns) == vk::Result::eSuccess;
     }
 
-    void Swapchain::build(uint32_t width, uint32_t height)
+    void Swapchain::build(uint32_t width, uint32_t height, uint64_t release_frame)
     {
+        m_requested = vk::Extent2D{width, height};
+
         // Zero extent (minimised window): Vulkan requires imageExtent > 0. Leave the extent
-        // zero so callers skip rendering, and keep no images/views.
+        // zero so callers skip rendering, and keep no swapchain or images/views.
         if ((width == 0) || (height == 0)) {
             m_extent = vk::Extent2D{0, 0};
+            retire(release_frame);
             return;
         }
 
@@ -102,7 +189,7 @@ namespace Engine
         std::vector<vk::PresentModeKHR> present_modes{physical_device.getSurfacePresentModesKHR(m_surface)};
 
         m_format = chooseSurfaceFormat(formats);
-        m_present_mode = choosePresentMode(present_modes);
+        m_present_mode = choosePresentMode(present_modes, m_latency);
         m_extent = chooseExtent(capabilities, width, height);
 
         // One extra image over the minimum for triple-buffering headroom.
@@ -118,7 +205,8 @@ namespace Engine
         create_info.imageColorSpace = m_format.colorSpace;
         create_info.imageExtent = m_extent;
         create_info.imageArrayLayers = 1;
-        create_info.imageUsage = vk::ImageUsageFlagBits::eColorAttachment;
+        m_usage = vk::ImageUsageFlagBits::eColorAttachment | (m_extra_usage & capabilities.supportedUsageFlags);
+        create_info.imageUsage = m_usage;
 
         uint32_t graphics_family{m_device->queueFamilies().graphics};
         uint32_t present_family{m_device->queueFamilies().present};
@@ -137,7 +225,11 @@ namespace Engine
         create_info.clipped = vk::True;
         create_info.oldSwapchain = *m_swapchain; // VK_NULL_HANDLE on first build; old one on recreate.
 
-        m_swapchain = vk::raii::SwapchainKHR(m_device->get(), create_info);
+        // The old swapchain is retired only once its successor exists: if creation throws, it
+        // stays current and the next recreate tries again.
+        vk::raii::SwapchainKHR swapchain{m_device->get(), create_info};
+        retire(release_frame);
+        m_swapchain = std::move(swapchain);
         m_images = m_swapchain.getImages();
 
         m_views.clear();
@@ -153,7 +245,12 @@ namespace Engine
             view_info.subresourceRange.baseArrayLayer = 0;
             view_info.subresourceRange.layerCount = 1;
             m_views.push_back(vk::raii::ImageView(m_device->get(), view_info));
+            m_render_finished.push_back(vk::raii::Semaphore(m_device->get(), vk::SemaphoreCreateInfo{}));
+            if (m_device->supportsSwapchainMaintenance()) {
+                m_present_fences.push_back(vk::raii::Fence(m_device->get(), vk::FenceCreateInfo{}));
+            }
         }
+        m_present_pending.assign(m_present_fences.size(), false);
     }
 
 } // namespace Engine
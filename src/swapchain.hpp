@@ -28,8 +28,21 @@
 namespace Engine
 {
 
-    //! Owns the Vulkan swapchain and its per-image views. Supports recreation on resize.
-    //! Colour-attachment only (the toy renders directly; no compute/storage usage).
+    //! How presentation trades tearing and power for cursor-to-photon latency.
+    enum class PresentLatency {
+        Vsync, //!< FIFO: every frame is shown, queued up to the swapchain depth behind the display.
+        Paced, //!< FIFO, with the render thread waiting for the previous present before each frame (present wait).
+        Low //!< MAILBOX (newest frame replaces a queued one), else IMMEDIATE (may tear), else FIFO.
+    };
+
+    //! Owns the Vulkan swapchain, its per-image views and render-finished semaphores, and (with
+    //! VK_EXT_swapchain_maintenance1) per-image present fences. The images are colour
+    //! attachments, and blit destinations where the renderer draws at a reduced render scale.
+    //!
+    //! Recreation (resize / out-of-date) never waits for the GPU: the new swapchain is built from
+    //! the old one (oldSwapchain), which is retired with its views, semaphores and fences, and
+    //! destroyed by releaseRetired() once the frames recorded against it have finished and, with
+    //! present fences, its presents are done with it.
     class Swapchain {
     public:
         Swapchain() = default;
@@ -40,15 +53,33 @@ namespace Engine
         Swapchain(Swapchain&&) = delete;
         Swapchain& operator=(Swapchain&&) = delete;
 
-        //! Builds the swapchain for the given device + surface at the requested size. Returns
-        //! false and fills out_error_message on failure (vk::raii exceptions caught here).
-        [[nodiscard]] bool init(const Device& device, vk::SurfaceKHR surface, uint32_t width, uint32_t height, std::string& out_error_message);
-
-        //! Rebuilds the swapchain (after a resize / out-of-date). Waits for the device to be
-        //! idle first. May throw vk::SystemError — call from within the renderer's try/catch.
-        void recreate(uint32_t width, uint32_t height);
-
-        //! Releases the swapchain + views. Safe to call repeatedly.
+        //! Builds the swapchain for the given device + surface at the requested size, with the
+        //! present mode latency asks for among those the surface offers, and the images usable as
+        //! colour attachments plus whichever of extra_usage the surface supports (see usage()).
+        //! Returns false and fills out_error_message on failure (vk::raii exceptions caught here).
+        [[nodiscard]] bool init(const Device& device, vk::SurfaceKHR surface, uint32_t width, uint32_t height, PresentLatency latency, vk::ImageUsageFlags extra_usage,
+            std::string& out_error_message);
+
+        //! The colour format init() will choose for surface, so the graphics pipeline can be built
+        //! while the swapchain is. May throw vk::SystemError — call from within the renderer's try/catch.
+        [[nodiscard]] static vk::Format preferredFormat(const Device& device, vk::SurfaceKHR surface);
+
+        //! Rebuilds the swapchain (after a resize / out-of-date) without waiting for the device,
+        //! retiring the old one until releaseRetired() is given release_frame. A zero size only
+        //! retires it. May throw vk::SystemError — call from within the renderer's try/catch.
+        void recreate(uint32_t width, uint32_t height, uint64_t release_frame);
+
+        //! Destroys the retired swapchains whose release frame is at most completed_frame and whose
+        //! present fences (if any) have signalled. May throw vk::SystemError.
+        void releaseRetired(uint64_t completed_frame);
+
+        //! The fence the next present of image_index signals (VK_EXT_swapchain_maintenance1), after
+        //! waiting for and resetting the one its previous present signalled; null without the
+        //! extension. Call once per present. May throw vk::SystemError.
+        [[nodiscard]] vk::Fence presentFence(uint32_t image_index);
+
+        //! Releases the swapchain + views, and every retired swapchain, first waiting (bounded) for
+        //! the present fences. Safe to call repeatedly.
         void destroy();
 
         [[nodiscard]] const vk::raii::SwapchainKHR& get() const
@@ -66,11 +97,29 @@ namespace Engine
             return m_views;
         }
 
+        //! Signalled by the frame rendering into image_index, waited by its present.
+        [[nodiscard]] const vk::raii::Semaphore& renderFinished(uint32_t image_index) const
+        {
+            return m_render_finished[image_index];
+        }
+
         [[nodiscard]] vk::Format format() const
         {
             return m_format.format;
         }
 
+        //! Usage of the images at the last build: colour attachment and the supported extra usage.
+        [[nodiscard]] vk::ImageUsageFlags usage() const
+        {
+            return m_usage;
+        }
+
+        //! Present mode chosen at the last build (FIFO unless PresentLatency::Low found a faster one).
+        [[nodiscard]] vk::PresentModeKHR presentMode() const
+        {
+            return m_present_mode;
+        }
+
         [[nodiscard]] vk::Extent2D extent() const
         {
             return m_extent;
@@ -87,18 +136,52 @@ namespace Engine
             return (m_extent.width == 0) || (m_extent.height == 0);
         }
 
+        //! True when the last build was asked for width x height (the extent may differ where the
+        //! surface dictates it), so a resize to another size needs a recreate().
+        [[nodiscard]] bool isBuiltFor(uint32_t width, uint32_t height) const
+        {
+            return (m_requested.width == width) && (m_requested.height == height);
+        }
+
+        //! Longest destroy() waits for outstanding present fences (1 s).
+        static constexpr uint64_t PRESENT_FENCE_TIMEOUT_NS = 1000000000;
+
     private:
-        //! Queries the surface and builds the swapchain + image views. May throw.
-        void build(uint32_t width, uint32_t height);
+        //! A swapchain replaced by recreate(), kept until nothing uses it.
+        struct RetiredSwapchain {
+            vk::raii::SwapchainKHR swapchain{nullptr}; //!< The old swapchain.
+            std::vector<vk::raii::ImageView> views; //!< Its views (recorded frames may still use them).
+            std::vector<vk::raii::Semaphore> render_finished; //!< Its semaphores (its presents may still wait on them).
+            std::vector<vk::raii::Fence> present_fences; //!< Fences of its outstanding presents.
+            uint64_t release_frame{0}; //!< Frame that must have completed before it is destroyed.
+        };
+
+        //! Queries the surface and builds the swapchain + per-image objects, retiring the current
+        //! swapchain (if any) until release_frame. May throw.
+        void build(uint32_t width, uint32_t height, uint64_t release_frame);
+
+        //! Moves the current swapchain and its per-image objects to m_retired.
+        void retire(uint64_t release_frame);
+
+        //! True when every fence has signalled (or waited up to timeout_ns for them). May throw.
+        [[nodiscard]] bool fencesSignalled(const std::vector<vk::raii::Fence>& fences, uint64_t timeout_ns) const;
 
         const Device* m_device{nullptr}; //!< Back-pointer to the device (non-owning).
         vk::SurfaceKHR m_surface{nullptr}; //!< Surface handle (non-owning).
         vk::raii::SwapchainKHR m_swapchain{nullptr}; //!< Swapchain handle.
         std::vector<vk::Image> m_images; //!< Swapchain images (non-owning, owned by the swapchain).
         std::vector<vk::raii::ImageView> m_views; //!< Per-image colour views.
+        std::vector<vk::raii::Semaphore> m_render_finished; //!< Per-image render-finished semaphores.
+        std::vector<vk::raii::Fence> m_present_fences; //!< Per-image present fences (swapchain maintenance only).
+        std::vector<bool> m_present_pending; //!< Whether each image's present fence awaits a signal.
+        std::vector<RetiredSwapchain> m_retired; //!< Replaced swapchains awaiting releaseRetired().
         vk::SurfaceFormatKHR m_format{}; //!< Chosen surface format.
+        PresentLatency m_latency{PresentLatency::Vsync}; //!< Requested latency mode (from init()).
+        vk::ImageUsageFlags m_extra_usage{}; //!< Requested usage beyond colour attachment (from init()).
+        vk::ImageUsageFlags m_usage{}; //!< Image usage of the last build.
         vk::PresentModeKHR m_present_mode{vk::PresentModeKHR::eFifo}; //!< Chosen present mode.
         vk::Extent2D m_extent{}; //!< Current extent.
+        vk::Extent2D m_requested{}; //!< Size the last build was asked for (see isBuiltFor()).
         std::string m_last_log; //!< Most recent build description (for logging by the renderer).
     };
 
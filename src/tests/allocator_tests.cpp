@@ -0,0 +1,153 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "testing/testing.hpp"
+#include "allocator.hpp"
+#include <cstdint>
+
+// The arena's bookkeeping needs no device: ArenaRegions is tested directly, FrameArena only where
+// it refuses to create anything.
+
+using Engine::ArenaRegions;
+
+TEST_CASE(arena_align_up)
+{
+    TEST_CHECK_EQUAL(ArenaRegions::alignUp(0u, 16u), 0u);
+    TEST_CHECK_EQUAL(ArenaRegions::alignUp(1u, 16u), 16u);
+    TEST_CHECK_EQUAL(ArenaRegions::alignUp(16u, 16u), 16u);
+    TEST_CHECK_EQUAL(ArenaRegions::alignUp(17u, 256u), 256u);
+}
+
+TEST_CASE(arena_regions_round_up_to_region_alignment)
+{
+    ArenaRegions regions;
+    TEST_CHECK(regions.reset(100u, 3));
+    TEST_CHECK_EQUAL(regions.capacity(), ArenaRegions::REGION_ALIGNMENT);
+    TEST_CHECK_EQUAL(regions.frameCount(), 3u);
+    TEST_CHECK_EQUAL(regions.totalBytes(), 3u * ArenaRegions::REGION_ALIGNMENT);
+}
+
+TEST_CASE(arena_allocations_are_aligned)
+{
+    ArenaRegions regions;
+    TEST_CHECK(regions.reset(1024u, 2));
+    VkDeviceSize first = 1;
+    VkDeviceSize second = 1;
+    VkDeviceSize third = 1;
+    TEST_CHECK(regions.allocate(3u, 4u, first));
+    TEST_CHECK(regions.allocate(8u, 64u, second));
+    TEST_CHECK(regions.allocate(1u, 1u, third));
+    TEST_CHECK_EQUAL(first, 0u);
+    TEST_CHECK_EQUAL(second, 64u);
+    TEST_CHECK_EQUAL(third, 72u);
+    TEST_CHECK_EQUAL(regions.usedBytes(), 73u);
+}
+
+TEST_CASE(arena_overflow_fails_and_keeps_the_region)
+{
+    ArenaRegions regions;
+    TEST_CHECK(regions.reset(256u, 1));
+    VkDeviceSize offset = 0;
+    TEST_CHECK(regions.allocate(200u, 4u, offset));
+    TEST_CHECK(!regions.allocate(100u, 4u, offset));
+    TEST_CHECK_EQUAL(offset, 0u);
+    TEST_CHECK_EQUAL(regions.usedBytes(), 200u);
+    // Padding alone can push an allocation past the end.
+    TEST_CHECK(!regions.allocate(56u, 256u, offset));
+    // A size that would wrap the sum around does not fit either.
+    TEST_CHECK(!regions.allocate(UINT64_MAX, 1u, offset));
+    // What is left still fits, exactly.
+    TEST_CHECK(regions.allocate(56u, 4u, offset));
+    TEST_CHECK_EQUAL(offset, 200u);
+    TEST_CHECK_EQUAL(regions.usedBytes(), 256u);
+}
+
+TEST_CASE(arena_regions_rotate_with_the_frame)
+{
+    ArenaRegions regions;
+    TEST_CHECK(regions.reset(512u, 3));
+    VkDeviceSize offset = 0;
+    for (uint32_t frame = 0; frame < 7; ++frame) {
+        regions.beginFrame(frame);
+        TEST_CHECK_EQUAL(regions.regionStart(), (frame % 3u) * 512u);
+        TEST_CHECK_EQUAL(regions.usedBytes(), 0u);
+        TEST_CHECK(regions.allocate(16u, 16u, offset));
+        TEST_CHECK_EQUAL(offset, regions.regionStart());
+    }
+}
+
+TEST_CASE(arena_used_range_covers_the_current_region_only)
+{
+    // [regionStart(), regionStart() + usedBytes()) is what FrameArena flushes and invalidates.
+    ArenaRegions regions;
+    TEST_CHECK(regions.reset(256u, 2));
+    VkDeviceSize offset = 0;
+    regions.beginFrame(0);
+    TEST_CHECK(regions.allocate(100u, 4u, offset));
+    regions.beginFrame(1);
+    TEST_CHECK(regions.allocate(10u, 4u, offset));
+    TEST_CHECK(regions.allocate(20u, 16u, offset));
+    TEST_CHECK_EQUAL(regions.regionStart(), 256u);
+    TEST_CHECK_EQUAL(regions.usedBytes(), 36u);
+    TEST_CHECK_EQUAL(offset, 272u);
+    TEST_CHECK(offset + 20u <= regions.regionStart() + regions.usedBytes());
+    TEST_CHECK_EQUAL(regions.peakBytes(), 100u);
+}
+
+TEST_CASE(arena_rejects_zero_frames)
+{
+    ArenaRegions regions;
+    TEST_CHECK(!regions.reset(256u, 0));
+    TEST_CHECK_EQUAL(regions.frameCount(), 0u);
+    VkDeviceSize offset = 0;
+    TEST_CHECK(!regions.allocate(1u, 1u, offset));
+
+    Engine::Allocator allocator; // never initialised: create() must not touch it.
+    Engine::FrameArena arena;
+    TEST_CHECK(!arena.create(allocator, 256u, 0, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, Engine::FrameArena::Direction::Upload));
+    TEST_CHECK(arena.buffer().buffer() == VK_NULL_HANDLE);
+}
+
+TEST_CASE(arena_begin_frame_without_regions_is_a_no_op)
+{
+    ArenaRegions regions;
+    regions.beginFrame(5);
+    TEST_CHECK(regions.reset(256u, 2));
+    regions.clear();
+    regions.beginFrame(5);
+    TEST_CHECK_EQUAL(regions.regionStart(), 0u);
+    TEST_CHECK_EQUAL(regions.usedBytes(), 0u);
+
+    Engine::FrameArena arena;
+    arena.beginFrame(3);
+    arena.destroy();
+    arena.beginFrame(3);
+}
+
+TEST_CASE(arena_without_buffer_returns_null_allocations)
+{
+    Engine::FrameArena arena;
+    Engine::ArenaAllocation allocation = arena.allocate(16u, 16u);
+    TEST_CHECK(allocation.mapped == nullptr);
+    TEST_CHECK(allocation.buffer == VK_NULL_HANDLE);
+    TEST_CHECK_EQUAL(allocation.size, 0u);
+    arena.flush();
+    arena.invalidate();
+    arena.invalidate(allocation);
+}
+
+int main()
+{
+    return static_cast<int>(TestingLib::runAll());
+}
@@ -0,0 +1,117 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "testing/testing.hpp"
+#include "cli_args.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+
+TEST_CASE(cli_parses_whole_numbers_only)
+{
+    uint32_t value = 0;
+    TEST_CHECK(Engine::parseUint32("42", value));
+    TEST_CHECK_EQUAL(value, 42u);
+    TEST_CHECK(!Engine::parseUint32("", value));
+    TEST_CHECK(!Engine::parseUint32("4x", value));
+    TEST_CHECK(!Engine::parseUint32("-1", value));
+    TEST_CHECK(!Engine::parseUint32("4294967296", value));
+
+    float number = 0.0f;
+    TEST_CHECK(Engine::parseNonNegativeFloat("0.25", number));
+    TEST_CHECK_EQUAL(number, 0.25f);
+    TEST_CHECK(!Engine::parseNonNegativeFloat("-0.5", number));
+    TEST_CHECK(!Engine::parseNonNegativeFloat("1.5ms", number));
+}
+
+TEST_CASE(cli_parses_replay_speeds)
+{
+    Engine::ReplaySpeed speed = Engine::ReplaySpeed::Max;
+    TEST_CHECK(Engine::parseReplaySpeed("recorded", speed));
+    TEST_CHECK(speed == Engine::ReplaySpeed::Recorded);
+    TEST_CHECK(Engine::parseReplaySpeed("max", speed));
+    TEST_CHECK(speed == Engine::ReplaySpeed::Max);
+    TEST_CHECK(!Engine::parseReplaySpeed("fast", speed));
+}
+
+TEST_CASE(cli_parses_obstacles)
+{
+    Engine::Obstacle obstacle{};
+    TEST_CHECK(Engine::parseObstacle("circle:0.5,-0.25,0.1", obstacle));
+    TEST_CHECK(obstacle.shape == Engine::ObstacleShape::Circle);
+    TEST_CHECK_EQUAL(obstacle.centre_x, 0.5f);
+    TEST_CHECK_EQUAL(obstacle.centre_y, -0.25f);
+    TEST_CHECK_EQUAL(obstacle.extent_x, 0.1f);
+
+    // Corners in either order give the same centre and half extents.
+    TEST_CHECK(Engine::parseObstacle("rect:0.5,0.5,-0.5,0", obstacle));
+    TEST_CHECK(obstacle.shape == Engine::ObstacleShape::Rectangle);
+    TEST_CHECK_EQUAL(obstacle.centre_x, 0.0f);
+    TEST_CHECK_EQUAL(obstacle.centre_y, 0.25f);
+    TEST_CHECK_EQUAL(obstacle.extent_x, 0.5f);
+    TEST_CHECK_EQUAL(obstacle.extent_y, 0.25f);
+
+    TEST_CHECK(!Engine::parseObstacle("circle:0.5,0.5", obstacle));
+    TEST_CHECK(!Engine::parseObstacle("circle:0.5,0.5,0.1,", obstacle));
+    TEST_CHECK(!Engine::parseObstacle("square:0,0,1", obstacle));
+    TEST_CHECK(!Engine::parseObstacle("0,0,1", obstacle));
+}
+
+TEST_CASE(cli_applies_the_shared_renderer_options)
+{
+    std::array<std::string, 8> args{"app", "--frames-in-flight", "3", "--async-compute", "--full-redraw", "--gpu", "1", "--nodes"};
+    std::array<char*, 8> argv{};
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        argv[i] = args[i].data();
+    }
+    int argc = static_cast<int>(argv.size());
+
+    Engine::RendererConfig config{};
+    std::string error_message;
+    int index = 1;
+    TEST_CHECK(Engine::parseRendererOption(argc, argv.data(), index, config, "usage", error_message) == Engine::OptionMatch::Parsed);
+    TEST_CHECK_EQUAL(index, 2);
+    TEST_CHECK_EQUAL(config.frames_in_flight, 3u);
+    index = 3;
+    TEST_CHECK(Engine::parseRendererOption(argc, argv.data(), index, config, "usage", error_message) == Engine::OptionMatch::Parsed);
+    index = 4;
+    TEST_CHECK(Engine::parseRendererOption(argc, argv.data(), index, config, "usage", error_message) == Engine::OptionMatch::Parsed);
+    index = 5;
+    TEST_CHECK(Engine::parseRendererOption(argc, argv.data(), index, config, "usage", error_message) == Engine::OptionMatch::Parsed);
+    TEST_CHECK_EQUAL(index, 6);
+    TEST_CHECK(config.async_compute);
+    TEST_CHECK(!config.partial_redraw);
+    TEST_CHECK_EQUAL(config.gpu.device, std::string("1"));
+    index = 7;
+    TEST_CHECK(Engine::parseRendererOption(argc, argv.data(), index, config, "usage", error_message) == Engine::OptionMatch::None);
+    TEST_CHECK_EQUAL(index, 7);
+
+    std::array<std::string, 3> bad_args{"app", "--frames-in-flight", "two"};
+    std::array<char*, 3> bad_argv{bad_args[0].data(), bad_args[1].data(), bad_args[2].data()};
+    index = 1;
+    TEST_CHECK(Engine::parseRendererOption(3, bad_argv.data(), index, config, "usage", error_message) == Engine::OptionMatch::Invalid);
+    TEST_CHECK_EQUAL(error_message, std::string("Invalid frames-in-flight count \"two\". usage"));
+}
+
+TEST_CASE(cli_words_errors_alike)
+{
+    TEST_CHECK_EQUAL(Engine::invalidValue("node count", "x", "Usage: app"), std::string("Invalid node count \"x\". Usage: app"));
+    TEST_CHECK_EQUAL(Engine::invalidValue("capture frame rate", "0", "Usage: app", "1-240"), std::string("Invalid capture frame rate \"0\" (1-240). Usage: app"));
+    TEST_CHECK_EQUAL(Engine::unknownOption("--nope", "Usage: app"), std::string("Unknown option \"--nope\". Usage: app"));
+}
+
+int main()
+{
+    return static_cast<int>(TestingLib::runAll());
+}
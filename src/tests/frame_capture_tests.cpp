@@ -0,0 +1,125 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "testing/testing.hpp"
+#include "frame_capture.hpp"
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    //! Slots of the fake capture: one per frame fed, so no frame waits for the writer.
+    constexpr std::size_t SLOT_COUNT = Engine::FrameCapture::MAX_SLOTS;
+
+    //! What a capture of 1x1 raw frames wrote.
+    struct CaptureResult {
+        bool ok{false}; //!< open(), every acquire() and close() succeeded.
+        uint64_t written{0}; //!< framesWritten() after close().
+        std::vector<uint8_t> pixels; //!< First byte of each frame in the file, in order.
+    };
+
+    //! Captures one 1x1 frame per entry of times_us (frame i's pixel bytes all i + 1) at
+    //! frame_rate into a scratch file, and reads the file back.
+    CaptureResult capture(const std::vector<uint64_t>& times_us, uint32_t frame_rate)
+    {
+        CaptureResult result{};
+        std::filesystem::path path = std::filesystem::temp_directory_path() / "stringwiggler_frame_capture_test.raw";
+        std::array<std::array<uint8_t, 4>, SLOT_COUNT> slot_memory{};
+        std::vector<const uint8_t*> slots;
+        for (const std::array<uint8_t, 4>& slot : slot_memory) {
+            slots.push_back(slot.data());
+        }
+
+        Engine::FrameCapture frame_capture;
+        std::string error_message;
+        result.ok = frame_capture.open(path.string(), Engine::CaptureFormat::Raw, Engine::CapturePixelOrder::Bgra, 1, 1, frame_rate, slots, error_message);
+        if (!result.ok || (times_us.size() > SLOT_COUNT)) {
+            result.ok = false;
+            return result;
+        }
+        for (std::size_t i = 0; i < times_us.size(); ++i) {
+            uint32_t slot = 0;
+            result.ok = result.ok && frame_capture.acquire(times_us[i], slot);
+            if (result.ok) {
+                slot_memory[slot].fill(static_cast<uint8_t>(i + 1));
+                frame_capture.submit(slot);
+            }
+        }
+        result.ok = frame_capture.close(error_message) && result.ok;
+        result.written = frame_capture.framesWritten();
+
+        std::ifstream file(path, std::ios::binary);
+        std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        for (std::size_t offset = 0; offset < bytes.size(); offset += 4) {
+            result.pixels.push_back(bytes[offset]);
+        }
+        file.close();
+        std::filesystem::remove(path);
+        return result;
+    }
+
+} // namespace
+
+TEST_CASE(frame_capture_holds_a_frame_until_the_next)
+{
+    // 60 output frames in the first second (0, 16666, ..., 983333 µs), then the last frame once.
+    CaptureResult result = capture({0, 1000000}, 60);
+    TEST_CHECK(result.ok);
+    TEST_CHECK_EQUAL(result.written, 61u);
+    TEST_CHECK_EQUAL(result.pixels.size(), 61u);
+    TEST_CHECK_EQUAL(result.pixels.front(), 1u);
+    TEST_CHECK_EQUAL(result.pixels[59], 1u);
+    TEST_CHECK_EQUAL(result.pixels.back(), 2u);
+}
+
+TEST_CASE(frame_capture_does_not_drift_at_a_rate_that_does_not_divide_a_second)
+{
+    // A truncated 16666 µs period would fit 601 output frames before 10 s; exactly 600 do.
+    CaptureResult result = capture({5000000, 15000000}, 60);
+    TEST_CHECK(result.ok);
+    TEST_CHECK_EQUAL(result.written, 601u);
+
+    // At 7 fps: 142857.14 µs apart, so 70 before 10 s rather than 71.
+    result = capture({0, 10000000}, 7);
+    TEST_CHECK(result.ok);
+    TEST_CHECK_EQUAL(result.written, 71u);
+}
+
+TEST_CASE(frame_capture_skips_frames_replaced_before_their_time)
+{
+    // Frames 2 and 3 arrive before the second output frame is due: only 3 takes its place.
+    CaptureResult result = capture({0, 4000, 8000, 40000}, 60);
+    TEST_CHECK(result.ok);
+    TEST_CHECK_EQUAL(result.written, 4u);
+    TEST_CHECK(result.pixels == (std::vector<uint8_t>{1, 3, 3, 4}));
+}
+
+TEST_CASE(frame_capture_treats_a_time_going_back_as_unchanged)
+{
+    // The second frame's time is clamped to the first's: it replaces it without an output frame.
+    CaptureResult result = capture({100000, 50000, 150000}, 20);
+    TEST_CHECK(result.ok);
+    TEST_CHECK(result.pixels == (std::vector<uint8_t>{2, 3}));
+}
+
+int main()
+{
+    return static_cast<int>(TestingLib::runAll());
+}
@@ -0,0 +1,114 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "testing/testing.hpp"
+#include "frame_stats.hpp"
+#include <cstdint>
+
+using Engine::HistogramSnapshot;
+
+TEST_CASE(histogram_buckets_start_at_the_first_bucket_bound)
+{
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketOf(0), 0u);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketOf(63), 0u);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketOf(64), 1u);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketLowerUs(0), 0u);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketUpperUs(0), 64u);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketLowerUs(1), 64u);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketUpperUs(1), 72u);
+}
+
+TEST_CASE(histogram_buckets_split_each_octave_in_eight)
+{
+    // 64-127 µs is the first octave: buckets 1 to 8, 8 µs wide.
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketOf(71), 1u);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketOf(72), 2u);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketOf(127), 8u);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketOf(128), 9u);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketLowerUs(9), 128u);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketUpperUs(9), 144u);
+
+    // Every bucket below the last holds exactly [lower, upper).
+    for (uint32_t bucket = 1; (bucket + 1) < HistogramSnapshot::BUCKET_COUNT; ++bucket) {
+        uint64_t lower = HistogramSnapshot::bucketLowerUs(bucket);
+        uint64_t upper = HistogramSnapshot::bucketUpperUs(bucket);
+        TEST_CHECK_EQUAL(HistogramSnapshot::bucketOf(lower), bucket);
+        TEST_CHECK_EQUAL(HistogramSnapshot::bucketOf(upper - 1), bucket);
+        TEST_CHECK((upper - lower) * 8 <= lower);
+    }
+}
+
+TEST_CASE(histogram_last_bucket_holds_everything_above)
+{
+    constexpr uint32_t LAST = HistogramSnapshot::BUCKET_COUNT - 1;
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketLowerUs(LAST), 229376u);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketUpperUs(LAST), UINT64_MAX);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketOf(229375), LAST - 1);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketOf(229376), LAST);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketOf(10000000), LAST);
+    TEST_CHECK_EQUAL(HistogramSnapshot::bucketOf(UINT64_MAX), LAST);
+}
+
+TEST_CASE(histogram_quantiles_of_a_known_distribution)
+{
+    // 90 frames of 1 ms, 9 of 5 ms and one 300 ms hitch.
+    Engine::FrameStats stats;
+    for (uint32_t i = 0; i < 90; ++i) {
+        stats.record(Engine::FrameHistogram::Interval, 1000);
+    }
+    for (uint32_t i = 0; i < 9; ++i) {
+        stats.record(Engine::FrameHistogram::Interval, 5000);
+    }
+    stats.record(Engine::FrameHistogram::Interval, 300000);
+    HistogramSnapshot histogram = stats.snapshot().histogram(Engine::FrameHistogram::Interval);
+
+    TEST_CHECK_EQUAL(histogram.count, 100u);
+    TEST_CHECK_EQUAL(histogram.sum_us, 435000u);
+    TEST_CHECK_EQUAL(histogram.meanUs(), 4350.0);
+    // Each quantile is the upper bound of its sample's bucket: 1000 µs is in [960, 1024),
+    // 5000 µs in [4608, 5120).
+    TEST_CHECK_EQUAL(histogram.quantileUs(0.0), 1024u);
+    TEST_CHECK_EQUAL(histogram.quantileUs(0.5), 1024u);
+    TEST_CHECK_EQUAL(histogram.quantileUs(0.9), 1024u);
+    TEST_CHECK_EQUAL(histogram.quantileUs(0.91), 5120u);
+    TEST_CHECK_EQUAL(histogram.quantileUs(0.99), 5120u);
+    // The hitch is in the open-ended last bucket, reported as its lower bound.
+    TEST_CHECK_EQUAL(histogram.quantileUs(1.0), 229376u);
+
+    // A later snapshot minus this one holds only what came after.
+    stats.record(Engine::FrameHistogram::Interval, 2000);
+    HistogramSnapshot later = stats.snapshot().histogram(Engine::FrameHistogram::Interval).since(histogram);
+    TEST_CHECK_EQUAL(later.count, 1u);
+    TEST_CHECK_EQUAL(later.sum_us, 2000u);
+    TEST_CHECK_EQUAL(later.quantileUs(0.5), 2048u);
+}
+
+TEST_CASE(histogram_empty_snapshot_reports_zero)
+{
+    HistogramSnapshot empty{};
+    TEST_CHECK_EQUAL(empty.meanUs(), 0.0);
+    TEST_CHECK_EQUAL(empty.quantileUs(0.5), 0u);
+    TEST_CHECK_EQUAL(empty.quantileUs(0.99), 0u);
+    TEST_CHECK_EQUAL(empty.since(empty).count, 0u);
+
+    Engine::FrameStats stats;
+    HistogramSnapshot fresh = stats.snapshot().histogram(Engine::FrameHistogram::GpuFrame);
+    TEST_CHECK_EQUAL(fresh.count, 0u);
+    TEST_CHECK_EQUAL(fresh.quantileUs(0.99), 0u);
+}
+
+int main()
+{
+    return static_cast<int>(TestingLib::runAll());
+}
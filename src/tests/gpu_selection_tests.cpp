@@ -0,0 +1,204 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "testing/testing.hpp"
+#include "gpu_scores.hpp"
+#include "gpu_selection.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    const std::string INTEGRATED_UUID = "00112233445566778899aabbccddeeff";
+    const std::string DISCRETE_UUID = "0123456789abcdef0123456789abcdef";
+    const std::string SOFTWARE_UUID = "ffeeddccbbaa99887766554433221100";
+
+    //! A hybrid laptop plus a software rasteriser, rated as Device::rateDevice() would under preference.
+    std::vector<Engine::GpuCandidate> laptopGpus(Engine::GpuPreference preference)
+    {
+        bool low_power = (preference == Engine::GpuPreference::LowPower);
+        return {
+            Engine::GpuCandidate{0, "Intel(R) UHD Graphics 770", INTEGRATED_UUID, vk::PhysicalDeviceType::eIntegratedGpu, true, low_power ? 1010 : 110},
+            Engine::GpuCandidate{1, "NVIDIA GeForce RTX 4070 Laptop GPU", DISCRETE_UUID, vk::PhysicalDeviceType::eDiscreteGpu, true, low_power ? 100 : 1000},
+            Engine::GpuCandidate{2, "llvmpipe (LLVM 17.0.6, 256 bits)", SOFTWARE_UUID, vk::PhysicalDeviceType::eCpu, false, -1},
+        };
+    }
+
+    //! Selects from laptopGpus(preference) with device and scores; -1 on failure (see Engine::selectGpu()).
+    int select(const std::string& device, Engine::GpuPreference preference, const Engine::GpuScores& scores, std::string& out_reason,
+        std::string& out_error_message)
+    {
+        return Engine::selectGpu(laptopGpus(preference), Engine::GpuSelection{device, preference}, scores, out_reason, out_error_message);
+    }
+
+    //! A fresh, empty directory for scores files.
+    std::filesystem::path scratchDirectory()
+    {
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "stringwiggler_gpu_selection_tests";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        return directory;
+    }
+
+    std::string readFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+} // namespace
+
+TEST_CASE(gpu_selection_matches_an_index)
+{
+    Engine::GpuScores scores{};
+    std::string reason;
+    std::string error_message;
+    TEST_CHECK_EQUAL(select("0", Engine::GpuPreference::HighPerformance, scores, reason, error_message), 0);
+    TEST_CHECK_EQUAL(reason, std::string("named by the GPU selection \"0\""));
+    TEST_CHECK_EQUAL(select("1", Engine::GpuPreference::LowPower, scores, reason, error_message), 1);
+    TEST_CHECK_EQUAL(select("3", Engine::GpuPreference::HighPerformance, scores, reason, error_message), -1);
+    TEST_CHECK(error_message.starts_with("No GPU matches \"3\""));
+}
+
+TEST_CASE(gpu_selection_matches_a_uuid_with_or_without_dashes)
+{
+    Engine::GpuScores scores{};
+    std::string reason;
+    std::string error_message;
+    TEST_CHECK_EQUAL(select(DISCRETE_UUID, Engine::GpuPreference::LowPower, scores, reason, error_message), 1);
+    TEST_CHECK_EQUAL(select("00112233-4455-6677-8899-AABBCCDDEEFF", Engine::GpuPreference::HighPerformance, scores, reason, error_message), 0);
+}
+
+TEST_CASE(gpu_selection_matches_part_of_a_name)
+{
+    Engine::GpuScores scores{};
+    std::string reason;
+    std::string error_message;
+    TEST_CHECK_EQUAL(select("geforce", Engine::GpuPreference::LowPower, scores, reason, error_message), 1);
+    TEST_CHECK_EQUAL(select("UHD", Engine::GpuPreference::HighPerformance, scores, reason, error_message), 0);
+    TEST_CHECK_EQUAL(select("radeon", Engine::GpuPreference::HighPerformance, scores, reason, error_message), -1);
+}
+
+TEST_CASE(gpu_selection_rejects_an_unsuitable_match)
+{
+    Engine::GpuScores scores{};
+    std::string reason;
+    std::string error_message;
+    TEST_CHECK_EQUAL(select("llvmpipe", Engine::GpuPreference::HighPerformance, scores, reason, error_message), -1);
+    TEST_CHECK(error_message.starts_with("GPU \"llvmpipe (LLVM 17.0.6, 256 bits)\" (selected by \"llvmpipe\") lacks what the renderer needs."));
+    // The message lists the devices to choose from instead.
+    TEST_CHECK(error_message.find("1: \"NVIDIA GeForce RTX 4070 Laptop GPU\" (discrete, " + DISCRETE_UUID + ")") != std::string::npos);
+    TEST_CHECK(error_message.find("(CPU, " + SOFTWARE_UUID + ") - unsuitable") != std::string::npos);
+}
+
+TEST_CASE(gpu_selection_uses_scores_only_when_every_candidate_has_one)
+{
+    Engine::GpuScores scores{};
+    std::string reason;
+    std::string error_message;
+    TEST_CHECK_EQUAL(select("", Engine::GpuPreference::HighPerformance, scores, reason, error_message), 1);
+    TEST_CHECK_EQUAL(reason, std::string("high-performance preference, discrete"));
+
+    // One scored device cannot be ranked against the other: the device type decides.
+    scores.set(INTEGRATED_UUID, "Intel(R) UHD Graphics 770", 4.0);
+    TEST_CHECK_EQUAL(select("", Engine::GpuPreference::HighPerformance, scores, reason, error_message), 1);
+
+    // The unsuitable device needs no score.
+    scores.set(DISCRETE_UUID, "NVIDIA GeForce RTX 4070 Laptop GPU", 6.5);
+    TEST_CHECK_EQUAL(select("", Engine::GpuPreference::HighPerformance, scores, reason, error_message), 0);
+    TEST_CHECK(reason.starts_with("fastest by GPU score (4.0"));
+}
+
+TEST_CASE(gpu_selection_falls_back_to_the_power_preference)
+{
+    Engine::GpuScores scores{};
+    scores.set(INTEGRATED_UUID, "Intel(R) UHD Graphics 770", 9.0);
+    scores.set(DISCRETE_UUID, "NVIDIA GeForce RTX 4070 Laptop GPU", 3.0);
+    std::string reason;
+    std::string error_message;
+    // Low power ignores the scores: the integrated GPU wins although it is slower.
+    TEST_CHECK_EQUAL(select("", Engine::GpuPreference::LowPower, scores, reason, error_message), 0);
+    TEST_CHECK_EQUAL(reason, std::string("low-power preference, integrated"));
+
+    std::vector<Engine::GpuCandidate> only_software{laptopGpus(Engine::GpuPreference::HighPerformance)[2]};
+    TEST_CHECK_EQUAL(Engine::selectGpu(only_software, Engine::GpuSelection{}, scores, reason, error_message), -1);
+    TEST_CHECK_EQUAL(error_message, std::string("No supported Vulkan physical device found."));
+
+    std::vector<Engine::GpuCandidate> only_discrete{laptopGpus(Engine::GpuPreference::LowPower)[1]};
+    TEST_CHECK_EQUAL(Engine::selectGpu(only_discrete, Engine::GpuSelection{"", Engine::GpuPreference::LowPower}, scores, reason, error_message), 0);
+    TEST_CHECK_EQUAL(reason, std::string("the only suitable device"));
+}
+
+TEST_CASE(gpu_scores_round_trip_through_their_file)
+{
+    std::filesystem::path directory = scratchDirectory();
+    std::string path = (directory / "cache" / "gpu_scores.txt").string();
+
+    Engine::GpuScores scores{};
+    scores.set(DISCRETE_UUID, "NVIDIA GeForce RTX 4070 Laptop GPU", 6.5);
+    scores.set(INTEGRATED_UUID, "Intel(R) UHD Graphics 770", 12.25);
+    std::string error_message;
+    TEST_CHECK(scores.save(path, error_message));
+
+    Engine::GpuScores loaded{};
+    TEST_CHECK(loaded.load(path, error_message));
+    TEST_CHECK(loaded.frameMs(DISCRETE_UUID) == std::optional<double>{6.5});
+    TEST_CHECK(loaded.frameMs(INTEGRATED_UUID) == std::optional<double>{12.25});
+    TEST_CHECK(!loaded.frameMs(SOFTWARE_UUID).has_value());
+
+    // Names with spaces survive: saving what was loaded writes the same file.
+    std::string second_path = (directory / "again.txt").string();
+    TEST_CHECK(loaded.save(second_path, error_message));
+    TEST_CHECK_EQUAL(readFile(second_path), readFile(path));
+
+    // No file is no scores, not an error.
+    TEST_CHECK(loaded.load((directory / "missing.txt").string(), error_message));
+    TEST_CHECK(loaded.empty());
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE(gpu_scores_reject_a_malformed_line)
+{
+    std::filesystem::path directory = scratchDirectory();
+    std::string path = (directory / "gpu_scores.txt").string();
+    {
+        std::ofstream file(path);
+        file << "# comment\n" << DISCRETE_UUID << " 6.5 NVIDIA GeForce RTX 4070 Laptop GPU\n\n" << INTEGRATED_UUID << " fast Intel(R) UHD Graphics 770\n";
+    }
+
+    Engine::GpuScores scores{};
+    std::string error_message;
+    TEST_CHECK(!scores.load(path, error_message));
+    TEST_CHECK_EQUAL(error_message, "Line 4 of the GPU scores \"" + path + "\" is not \"<uuid> <frame ms> <name>\".");
+    // Nothing half-loaded is kept.
+    TEST_CHECK(scores.empty());
+
+    {
+        std::ofstream file(path, std::ios::trunc);
+        file << DISCRETE_UUID << " -1.0 NVIDIA GeForce RTX 4070 Laptop GPU\n";
+    }
+    TEST_CHECK(!scores.load(path, error_message));
+    TEST_CHECK(error_message.starts_with("Line 1 "));
+    std::filesystem::remove_all(directory);
+}
+
+int main()
+{
+    return static_cast<int>(TestingLib::runAll());
+}
@@ -0,0 +1,242 @@
+/*
+    Copyright (C) 2025 Matej Gomboc https://github.com/MatejGomboc/StringWiggler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+*/
+
+#include "testing/testing.hpp"
+#include "input_recording.hpp"
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    //! Scratch file for one test.
+    std::string scratchPath(const std::string& name)
+    {
+        return (std::filesystem::temp_directory_path() / ("stringwiggler_" + name + ".swir")).string();
+    }
+
+    std::vector<char> readBytes(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void writeBytes(const std::string& path, const std::vector<char>& bytes)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    //! A small recording: a cursor sample, a frame whose trail time is before it, and a frame
+    //! after a gap longer than the 32-bit time delta holds.
+    Engine::InputRecording sampleRecording()
+    {
+        Engine::InputRecording recording{};
+        recording.width = 1280;
+        recording.height = 720;
+        recording.node_count = 128;
+        recording.string_count = 64;
+        recording.constraint_iterations = 6;
+
+        Engine::InputRecord cursor{};
+        cursor.type = Engine::InputRecord::Type::Cursor;
+        cursor.time_us = 1500;
+        cursor.width = 1280;
+        cursor.height = 720;
+        cursor.cursor_x = -12;
+        cursor.cursor_y = 700;
+        recording.records.push_back(cursor);
+
+        Engine::InputRecord frame{};
+        frame.type = Engine::InputRecord::Type::Frame;
+        frame.time_us = 18000;
+        frame.dt = 1.0f / 60.0f;
+        frame.trail_offset_us = -4167;
+        recording.records.push_back(frame);
+
+        frame.time_us = 18000 + 5000000000ull;
+        frame.dt = 0.05f;
+        frame.trail_offset_us = 250;
+        recording.records.push_back(frame);
+        return recording;
+    }
+
+    //! Saves sampleRecording() to path, applies edit to the bytes, and loads the result into a
+    //! recording that already holds one record. Returns what load() did; out_recording keeps
+    //! what it held on failure.
+    bool loadEdited(const std::string& path, void (*edit)(std::vector<char>&), Engine::InputRecording& out_recording, std::string& out_error_message)
+    {
+        std::string error_message;
+        if (!sampleRecording().save(path, error_message)) {
+            return false;
+        }
+        std::vector<char> bytes = readBytes(path);
+        edit(bytes);
+        writeBytes(path, bytes);
+        out_recording = Engine::InputRecording{};
+        out_recording.records.resize(1);
+        bool loaded = out_recording.load(path, out_error_message);
+        std::filesystem::remove(path);
+        return loaded;
+    }
+
+} // namespace
+
+TEST_CASE(input_recording_round_trips)
+{
+    std::string path = scratchPath("round_trip");
+    Engine::InputRecording recording = sampleRecording();
+    std::string error_message;
+    TEST_CHECK(recording.save(path, error_message));
+    // 28-byte header, a 17-byte cursor sample and two 13-byte frames.
+    TEST_CHECK_EQUAL(readBytes(path).size(), 71u);
+
+    Engine::InputRecording loaded{};
+    TEST_CHECK(loaded.load(path, error_message));
+    std::filesystem::remove(path);
+    TEST_CHECK_EQUAL(loaded.width, 1280u);
+    TEST_CHECK_EQUAL(loaded.height, 720u);
+    TEST_CHECK_EQUAL(loaded.node_count, 128u);
+    TEST_CHECK_EQUAL(loaded.string_count, 64u);
+    TEST_CHECK_EQUAL(loaded.constraint_iterations, 6u);
+    TEST_CHECK_EQUAL(loaded.records.size(), 3u);
+    TEST_CHECK_EQUAL(loaded.frameCount(), 2u);
+
+    const Engine::InputRecord& cursor = loaded.records[0];
+    TEST_CHECK(cursor.type == Engine::InputRecord::Type::Cursor);
+    TEST_CHECK_EQUAL(cursor.time_us, 1500u);
+    TEST_CHECK_EQUAL(cursor.width, 1280u);
+    TEST_CHECK_EQUAL(cursor.height, 720u);
+    TEST_CHECK_EQUAL(cursor.cursor_x, -12);
+    TEST_CHECK_EQUAL(cursor.cursor_y, 700);
+
+    const Engine::InputRecord& frame = loaded.records[1];
+    TEST_CHECK(frame.type == Engine::InputRecord::Type::Frame);
+    TEST_CHECK_EQUAL(frame.time_us, 18000u);
+    TEST_CHECK_EQUAL(frame.dt, 1.0f / 60.0f);
+    TEST_CHECK_EQUAL(frame.trail_offset_us, -4167);
+
+    // The 5000 s gap is stored as the largest delta the format holds.
+    const Engine::InputRecord& late_frame = loaded.records[2];
+    TEST_CHECK_EQUAL(late_frame.time_us, uint64_t{18000} + UINT32_MAX);
+    TEST_CHECK_EQUAL(late_frame.dt, 0.05f);
+    TEST_CHECK_EQUAL(late_frame.trail_offset_us, 250);
+}
+
+TEST_CASE(input_recording_rejects_a_truncated_file)
+{
+    Engine::InputRecording recording{};
+    std::string error_message;
+    TEST_CHECK(!loadEdited(
+        scratchPath("truncated"),
+        [](std::vector<char>& bytes) {
+            bytes.pop_back();
+        },
+        recording, error_message));
+    // The last frame starts after the header, the cursor sample and the first frame.
+    TEST_CHECK(error_message.find("is corrupt or cut short at byte 58.") != std::string::npos);
+    TEST_CHECK_EQUAL(recording.records.size(), 1u);
+}
+
+TEST_CASE(input_recording_rejects_a_bad_type_byte)
+{
+    Engine::InputRecording recording{};
+    std::string error_message;
+    TEST_CHECK(!loadEdited(
+        scratchPath("bad_type"),
+        [](std::vector<char>& bytes) {
+            bytes[28] = 2;
+        },
+        recording, error_message));
+    TEST_CHECK(error_message.find("is corrupt or cut short at byte 28.") != std::string::npos);
+    TEST_CHECK_EQUAL(recording.records.size(), 1u);
+}
+
+TEST_CASE(input_recording_rejects_bad_magic)
+{
+    Engine::InputRecording recording{};
+    std::string error_message;
+    TEST_CHECK(!loadEdited(
+        scratchPath("bad_magic"),
+        [](std::vector<char>& bytes) {
+            bytes[3] = 'X';
+        },
+        recording, error_message));
+    TEST_CHECK(error_message.ends_with("\" is not an input recording."));
+
+    // Too short for a header is not a recording either.
+    TEST_CHECK(!loadEdited(
+        scratchPath("short"),
+        [](std::vector<char>& bytes) {
+            bytes.resize(27);
+        },
+        recording, error_message));
+    TEST_CHECK(error_message.ends_with("\" is not an input recording."));
+}
+
+TEST_CASE(input_recording_rejects_another_version)
+{
+    Engine::InputRecording recording{};
+    std::string error_message;
+    TEST_CHECK(!loadEdited(
+        scratchPath("version"),
+        [](std::vector<char>& bytes) {
+            bytes[4] = static_cast<char>(Engine::InputRecording::VERSION + 1);
+        },
+        recording, error_message));
+    TEST_CHECK(error_message.ends_with("\" is an input recording of version " + std::to_string(Engine::InputRecording::VERSION + 1) + "; this build reads version "
+        + std::to_string(Engine::InputRecording::VERSION) + "."));
+    TEST_CHECK_EQUAL(recording.records.size(), 1u);
+}
+
+TEST_CASE(input_recorder_keeps_records_in_time_order)
+{
+    uint64_t before_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    Engine::InputRecorder recorder{800, 600, 64, 1, 6};
+    // A sample stamped before the recording started counts from its start.
+    recorder.recordCursor(800, 600, 10, 20, before_us - 1000);
+    // A minute ahead, then a sample stamped before it: held at the later time.
+    recorder.recordCursor(800, 600, 30, 40, before_us + 60000000);
+    recorder.recordCursor(800, 600, 50, 60, before_us + 30000000);
+    // A frame drawn now is also behind the minute-ahead sample; its trail offset follows the clamp.
+    recorder.recordFrame(1.0f / 60.0f, before_us + 60000000);
+
+    std::string path = scratchPath("recorder");
+    std::string error_message;
+    TEST_CHECK(recorder.save(path, error_message));
+    Engine::InputRecording loaded{};
+    TEST_CHECK(loaded.load(path, error_message));
+    std::filesystem::remove(path);
+
+    TEST_CHECK_EQUAL(loaded.width, 800u);
+    TEST_CHECK_EQUAL(loaded.records.size(), 4u);
+    TEST_CHECK_EQUAL(loaded.records[0].time_us, 0u);
+    // The recorder started at or just after before_us.
+    TEST_CHECK(loaded.records[1].time_us <= 60000000u);
+    TEST_CHECK(loaded.records[1].time_us > 59000000u);
+    TEST_CHECK_EQUAL(loaded.records[2].time_us, loaded.records[1].time_us);
+    TEST_CHECK_EQUAL(loaded.records[2].cursor_x, 50);
+    TEST_CHECK_EQUAL(loaded.records[3].time_us, loaded.records[1].time_us);
+    TEST_CHECK_EQUAL(loaded.records[3].trail_offset_us, 0);
+}
+
+int main()
+{
+    return static_cast<int>(TestingLib::runAll());
+}